@@ -0,0 +1,182 @@
+#include "BenchRunner.h"
+#include <QTemporaryDir>
+#include <QElapsedTimer>
+#include <QStandardPaths>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QFile>
+#include <QDir>
+#include <cstdio>
+#include <exception>
+
+namespace {
+
+using BenchRunner::Result;
+
+QJsonObject toJson(const Result& r)
+{
+    const double s = qMax(r.seconds, 1e-9);
+    QJsonObject o;
+    o["name"] = r.name;
+    o["rows"] = r.rows;
+    o["bytes"] = r.bytes;
+    o["seconds"] = r.seconds;
+    o["rows_per_sec"] = r.rows / s;
+    o["mb_per_sec"] = r.bytes / 1048576.0 / s;
+    return o;
+}
+
+void printResult(const Result& r)
+{
+    const double s = qMax(r.seconds, 1e-9);
+    printf("  %-30s %10.3f s %14.0f rows/s %10.1f MB/s\n", qPrintable(r.name), r.seconds,
+           r.rows / s, r.bytes / 1048576.0 / s);
+}
+
+qint64 parseRowCount(const QString& text, bool* ok)
+{
+    QString digits = text.trimmed();
+    double scale = 1;
+    if (digits.endsWith('M', Qt::CaseInsensitive)) {
+        scale = 1e6;
+        digits.chop(1);
+    } else if (digits.endsWith('k', Qt::CaseInsensitive)) {
+        scale = 1e3;
+        digits.chop(1);
+    }
+    const double value = digits.toDouble(ok);
+    return static_cast<qint64>(value * scale);
+}
+
+void printComparison(const QJsonObject& baseline, const QString& dataset, const Result& r)
+{
+    for (const QJsonValue& d : baseline["datasets"].toArray()) {
+        if (d["type"].toString() != dataset)
+            continue;
+        for (const QJsonValue& old : d["results"].toArray()) {
+            if (old["name"].toString() != r.name)
+                continue;
+            const double before = old["rows_per_sec"].toDouble();
+            const double after = r.rows / qMax(r.seconds, 1e-9);
+            if (before > 0)
+                printf("  %-30s %+7.1f%% vs baseline\n", qPrintable(r.name), (after / before - 1) * 100);
+        }
+    }
+}
+
+} // namespace
+
+void BenchRunner::addOptions(QCommandLineParser& parser)
+{
+    parser.addOption(QCommandLineOption("rows", "Rows per timeline, e.g. 500k or 2M (default 1M).", "n", "1M"));
+    parser.addOption(QCommandLineOption("type", "super, filesystem or both (default both).", "type", "both"));
+    parser.addOption(QCommandLineOption("dir", "Keep generated timelines in <dir> and reuse them.", "dir"));
+    parser.addOption(QCommandLineOption("json", "Write the report to <file>.", "file"));
+    parser.addOption(QCommandLineOption("compare", "Compare against an earlier --json report.", "file"));
+}
+
+void BenchRunner::clearIndexCaches()
+{
+    QDir dir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation));
+    for (const QString& name : dir.entryList({"*.idx"}, QDir::Files))
+        dir.remove(name);
+}
+
+int BenchRunner::run(const QCommandLineParser& parser, const Suite& suite, const QJsonObject& info)
+{
+    bool ok = false;
+    const qint64 rows = parseRowCount(parser.value("rows"), &ok);
+    if (!ok || rows <= 0) {
+        fprintf(stderr, "Invalid --rows value\n");
+        return 2;
+    }
+    QVector<SyntheticTimeline::Kind> kinds;
+    const QString type = parser.value("type");
+    if (type == "super" || type == "both")
+        kinds << SyntheticTimeline::Super;
+    if (type == "filesystem" || type == "both")
+        kinds << SyntheticTimeline::Filesystem;
+    if (kinds.isEmpty()) {
+        fprintf(stderr, "Invalid --type value\n");
+        return 2;
+    }
+
+    QJsonObject baseline;
+    if (parser.isSet("compare")) {
+        QFile f(parser.value("compare"));
+        if (f.open(QIODevice::ReadOnly))
+            baseline = QJsonDocument::fromJson(f.readAll()).object();
+        if (baseline.isEmpty())
+            fprintf(stderr, "Cannot read baseline report; comparison skipped\n");
+    }
+
+    QTemporaryDir tempDir;
+    const QString dataDir = parser.isSet("dir") ? parser.value("dir") : tempDir.path();
+    QDir().mkpath(dataDir);
+
+    QJsonArray datasets;
+    for (SyntheticTimeline::Kind kind : kinds) {
+        const QString name = SyntheticTimeline::kindName(kind);
+        const QString path = QDir(dataDir).filePath(QString("%1-%2.csv").arg(name).arg(rows));
+        if (!QFileInfo::exists(path)) {
+            QElapsedTimer genTimer;
+            genTimer.start();
+            if (SyntheticTimeline::write(kind, path, rows) < 0) {
+                fprintf(stderr, "Cannot write %s\n", qPrintable(path));
+                return 1;
+            }
+            printf("Generated %s (%.1f MB) in %.1f s\n", qPrintable(path),
+                   QFileInfo(path).size() / 1048576.0, genTimer.elapsed() / 1000.0);
+        }
+
+        printf("%s timeline, %lld rows:\n", qPrintable(name), rows);
+        QVector<Result> results;
+        try {
+            results = suite(path, kind);
+        } catch (const std::exception& e) {
+            fprintf(stderr, "Benchmark failed: %s\n", e.what());
+            return 1;
+        }
+        QJsonArray resultArray;
+        for (const Result& r : results) {
+            printResult(r);
+            resultArray.append(toJson(r));
+        }
+        if (!baseline.isEmpty()) {
+            for (const Result& r : results)
+                printComparison(baseline, name, r);
+        }
+
+        QJsonObject dataset = info;
+        dataset["type"] = name;
+        dataset["rows"] = rows;
+        dataset["bytes"] = QFileInfo(path).size();
+        dataset["results"] = resultArray;
+        datasets.append(dataset);
+    }
+
+    if (parser.isSet("json")) {
+        QJsonObject report;
+        report["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+        report["qt_version"] = QT_VERSION_STR;
+#ifdef __VERSION__
+        report["compiler"] = __VERSION__;
+#endif
+#ifdef NDEBUG
+        report["build"] = "release";
+#else
+        report["build"] = "debug";
+#endif
+        report["datasets"] = datasets;
+        QFile out(parser.value("json"));
+        if (!out.open(QIODevice::WriteOnly)
+            || out.write(QJsonDocument(report).toJson(QJsonDocument::Indented)) < 0) {
+            fprintf(stderr, "Cannot write %s\n", qPrintable(parser.value("json")));
+            return 1;
+        }
+        printf("Report written to %s\n", qPrintable(parser.value("json")));
+    }
+    return 0;
+}
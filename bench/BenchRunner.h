@@ -0,0 +1,34 @@
+#pragma once
+#include "SyntheticTimeline.h"
+#include <QCommandLineParser>
+#include <QJsonObject>
+#include <QString>
+#include <QVector>
+#include <functional>
+
+/**
+ * @brief BenchRunner is the command line and report shared by the benchmarks.
+ *
+ * It generates (or reuses) one synthetic timeline per --type, runs a suite
+ * of timed stages on each, prints rows/s and MB/s, compares them with an
+ * earlier --json report and writes the new one.
+ */
+namespace BenchRunner {
+    struct Result {
+        QString name;
+        qint64 rows = 0;
+        qint64 bytes = 0;
+        double seconds = 0;
+    };
+    using Suite = std::function<QVector<Result>(const QString& path, SyntheticTimeline::Kind kind)>;
+
+    // Adds --rows, --type, --dir, --json and --compare
+    void addOptions(QCommandLineParser& parser);
+    // Runs the suite on every requested timeline; 'info' is added to each
+    // dataset of the report. Returns the process exit code.
+    int run(const QCommandLineParser& parser, const Suite& suite, const QJsonObject& info = {});
+
+    // Index caches live under the (test-mode) app data directory; removing
+    // them makes the next open a cold index build.
+    void clearIndexCaches();
+}
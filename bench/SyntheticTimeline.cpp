@@ -0,0 +1,169 @@
+#include "SyntheticTimeline.h"
+#include <QFile>
+#include <QDateTime>
+#include <QTimeZone>
+#include <QLocale>
+#include <QRandomGenerator>
+#include <QByteArray>
+#include <QDebug>
+
+namespace {
+
+const char* const FS_PATHS[] = {
+    "/usr/lib/x86_64-linux-gnu/libc.so.6", "/etc/passwd", "/var/log/auth.log",
+    "/home/analyst/.bash_history", "/tmp/.X11-unix/X0", "/usr/bin/ps",
+    "/var/lib/dpkg/info/openssh-server.list", "/root/.ssh/authorized_keys",
+};
+const char* const IMAGES[] = {
+    "/usr/bin/ps", "/usr/bin/bash", "/usr/sbin/sshd", "/usr/bin/curl",
+    "/usr/lib/systemd/systemd", "/tmp/.cache/kworker", "/usr/bin/python3.10",
+};
+const char* const USERS[] = { "root", "bmorse", "www-data", "analyst", "nobody" };
+const char* const SYSLOG[] = {
+    "[CRON] [756985]: pam_unix(cron:session): session closed for user bmorse",
+    "[sshd] [1021]: Accepted publickey for root from 10.0.4.17 port 50122 ssh2",
+    "[kernel] audit: type=1400 audit(1678924805.123:442): apparmor=\"DENIED\" operation=\"open\"",
+    "[sudo] analyst : TTY=pts/0 ; PWD=/home/analyst ; USER=root ; COMMAND=/usr/bin/apt update",
+};
+
+template <size_t N>
+const char* pick(QRandomGenerator& rng, const char* const (&list)[N])
+{
+    return list[rng.bounded(static_cast<quint32>(N))];
+}
+
+// Quotes a CSV field when it holds a comma, quote or line break.
+void appendField(QByteArray& line, const QByteArray& field)
+{
+    if (field.contains(',') || field.contains('"') || field.contains('\n')) {
+        QByteArray quoted = field;
+        quoted.replace("\"", "\"\"");
+        line += '"' + quoted + '"';
+    } else {
+        line += field;
+    }
+}
+
+QByteArray sysmonXml(QRandomGenerator& rng, const QDateTime& when, qint64 record)
+{
+    const int eventId = rng.bounded(2) ? 1 : 3;
+    const QByteArray image = pick(rng, IMAGES);
+    QByteArray xml;
+    xml.reserve(1600);
+    xml += "<Event><System><Provider Name=\"Linux-Sysmon\" Guid=\"{ff032593-a8d3-4f13-b0d6-01fc615a0f97}\"/>"
+           "<EventID>" + QByteArray::number(eventId) + "</EventID><Version>5</Version><Level>4</Level>"
+           "<Task>" + QByteArray::number(eventId) + "</Task><Opcode>0</Opcode><Keywords>0x8000000000000000</Keywords>"
+           "<TimeCreated SystemTime=\"" + when.toString(Qt::ISODateWithMs).toLatin1() + "\"/>"
+           "<EventRecordID>" + QByteArray::number(record) + "</EventRecordID><Correlation/>"
+           "<Execution ProcessID=\"834\" ThreadID=\"834\"/><Channel>Linux-Sysmon/Operational</Channel>"
+           "<Computer>starkskunk5</Computer><Security UserId=\"0\"/></System><EventData>"
+           "<Data Name=\"RuleName\">-</Data>"
+           "<Data Name=\"UtcTime\">" + when.toString("yyyy-MM-dd HH:mm:ss.zzz").toLatin1() + "</Data>"
+           "<Data Name=\"ProcessGuid\">{ec2ee89f-5c05-6412-f15b-" + QByteArray::number(record, 16).rightJustified(12, '0') + "}</Data>"
+           "<Data Name=\"ProcessId\">" + QByteArray::number(rng.bounded(1000, 4000000)) + "</Data>"
+           "<Data Name=\"Image\">" + image + "</Data>";
+    if (eventId == 1) {
+        xml += "<Data Name=\"CommandLine\">" + image + " -o pid,user,args --sort=-pcpu,pid &quot;"
+               + QByteArray::number(rng.generate()) + "&quot;</Data>"
+               "<Data Name=\"CurrentDirectory\">/root</Data>"
+               "<Data Name=\"LogonId\">0</Data><Data Name=\"IntegrityLevel\">no level</Data>"
+               "<Data Name=\"Hashes\">SHA256=" + QByteArray::number(rng.generate64(), 16).repeated(4) + "</Data>"
+               "<Data Name=\"ParentImage\">/usr/bin/bash</Data>";
+    } else {
+        xml += "<Data Name=\"Protocol\">tcp</Data><Data Name=\"Initiated\">true</Data>"
+               "<Data Name=\"SourceIp\">10.0." + QByteArray::number(rng.bounded(256)) + "." + QByteArray::number(rng.bounded(256)) + "</Data>"
+               "<Data Name=\"SourcePort\">" + QByteArray::number(rng.bounded(1024, 65535)) + "</Data>"
+               "<Data Name=\"DestinationIp\">185.220.101." + QByteArray::number(rng.bounded(256)) + "</Data>"
+               "<Data Name=\"DestinationPort\">443</Data>";
+    }
+    xml += "<Data Name=\"User\">" + QByteArray(pick(rng, USERS)) + "</Data></EventData></Event>";
+    return xml;
+}
+
+QByteArray jsonMessage(QRandomGenerator& rng, qint64 record)
+{
+    return "{\"MESSAGE\": \"Started Session " + QByteArray::number(record) + " of user "
+           + pick(rng, USERS) + ", via ssh\", \"PRIORITY\": \"6\", \"_PID\": \""
+           + QByteArray::number(rng.bounded(1, 40000)) + "\", \"_COMM\": \"systemd-logind\"}";
+}
+
+} // namespace
+
+namespace SyntheticTimeline {
+
+QString kindName(Kind kind)
+{
+    return kind == Filesystem ? "filesystem" : "super";
+}
+
+qint64 write(Kind kind, const QString& path, qint64 rows, quint32 seed)
+{
+    QFile out(path);
+    if (!out.open(QIODevice::WriteOnly)) {
+        qWarning() << "SyntheticTimeline: cannot write" << path;
+        return -1;
+    }
+
+    QRandomGenerator rng(seed);
+    QDateTime when = QDateTime(QDate(2023, 3, 15), QTime(0, 0), QTimeZone::utc());
+    QByteArray line;
+    QByteArray buffer;
+    buffer.reserve(4 * 1024 * 1024);
+    buffer += kind == Filesystem
+        ? "Date,Size,Type,Mode,UID,GID,Meta,File Name\n"
+        : "datetime,timestamp_desc,source,source_long,message,parser,display_name,tag\n";
+
+    for (qint64 row = 0; row < rows; ++row) {
+        when = when.addMSecs(rng.bounded(0, 2000));
+        line.clear();
+        if (kind == Filesystem) {
+            line += QLocale::c().toString(when, "ddd MMM dd yyyy HH:mm:ss").toLatin1() + ',';
+            line += QByteArray::number(rng.bounded(0, 5000000)) + ',';
+            line += QByteArray("macb").left(rng.bounded(1, 5)) + ',';
+            line += (rng.bounded(4) ? "r/rrw-r--r--," : "d/drwxr-xr-x,");
+            line += QByteArray::number(rng.bounded(2) ? 0 : 1000) + ',' + QByteArray::number(rng.bounded(2) ? 0 : 1000) + ',';
+            line += QByteArray::number(rng.bounded(1000, 2000000)) + "-128-1,";
+            QByteArray name = pick(rng, FS_PATHS);
+            if (rng.bounded(10) == 0)
+                name += ",v" + QByteArray::number(row) + " (deleted)";
+            appendField(line, name);
+        } else {
+            line += when.toString("yyyy-MM-ddTHH:mm:ss.zzz000+00:00").toLatin1() + ',';
+            const quint32 shape = rng.bounded(10);
+            QByteArray message;
+            QByteArray source, sourceLong, parser, display;
+            if (shape < 3) {
+                message = sysmonXml(rng, when, row);
+                source = "EVT"; sourceLong = "WinEVTX"; parser = "winevtx";
+                display = "OS:/var/log/sysmon/Sysmon.evtx";
+            } else if (shape < 4) {
+                message = "starkskunk5 [sysmon  pid: 834] " + sysmonXml(rng, when, row);
+                source = "LOG"; sourceLong = "Systemd journal"; parser = "systemd_journal";
+                display = "EXT:/var/log/journal/system.journal";
+            } else if (shape < 5) {
+                message = jsonMessage(rng, row);
+                source = "LOG"; sourceLong = "Systemd journal"; parser = "systemd_journal";
+                display = "EXT:/var/log/journal/system.journal";
+            } else {
+                message = pick(rng, SYSLOG);
+                source = "LOG"; sourceLong = "Log File"; parser = "text/syslog_traditional";
+                display = "EXT:/var/log/auth.log";
+            }
+            line += "Content Modification Time," + source + ',' + sourceLong + ',';
+            appendField(line, message);
+            line += ',' + parser + ',' + display + ",-";
+        }
+        line += '\n';
+        buffer += line;
+        if (buffer.size() >= 4 * 1024 * 1024) {
+            if (out.write(buffer) != buffer.size())
+                return -1;
+            buffer.clear();
+        }
+    }
+    if (out.write(buffer) != buffer.size())
+        return -1;
+    return out.size();
+}
+
+} // namespace SyntheticTimeline
@@ -0,0 +1,21 @@
+#pragma once
+#include <QString>
+
+/**
+ * @brief SyntheticTimeline writes reproducible timelines for benchmarking.
+ *
+ * Output follows the mactime (Filesystem) and psort (Super) CSV layouts,
+ * including quoted fields with embedded commas and doubled quotes, long
+ * Sysmon XML messages and JSON messages. The same seed gives the same file.
+ */
+namespace SyntheticTimeline {
+    enum Kind {
+        Filesystem,
+        Super
+    };
+
+    // Writes 'rows' data rows after the header. Returns the bytes written,
+    // or -1 on error.
+    qint64 write(Kind kind, const QString& path, qint64 rows, quint32 seed = 1);
+    QString kindName(Kind kind);
+}
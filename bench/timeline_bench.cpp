@@ -0,0 +1,303 @@
+// timeline_bench — times the engine's hot paths on synthetic timelines.
+//
+//   timeline_bench [--rows 1M] [--type super|filesystem|both] [--dir DIR]
+//                  [--io-latency-us N] [--json report.json] [--compare baseline.json]
+//
+// Each stage reports rows/s and MB/s; --json writes the same numbers for
+// comparison against another build with --compare. The "io" stages repeat
+// index build, full scan and viewport reads for every I/O backend with the
+// file dropped from the page cache first; --io-latency-us adds a delay to
+// each of their reads, as on a slow network share.
+
+#include "BenchRunner.h"
+#include "SyntheticTimeline.h"
+#include "core/RowStore.h"
+#include "core/RowChunk.h"
+#include "core/FilterEngine.h"
+#include "core/IoBackend.h"
+#include "core/AnalysisCache.h"
+#include "utils/FileUtils.h"
+#include "utils/JsonXmlFormatter.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QStandardPaths>
+#include <QJsonObject>
+#include <QFileInfo>
+#include <QFile>
+#include <QRandomGenerator>
+#include <QThread>
+#include <atomic>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+using BenchRunner::Result;
+
+// Asks the kernel to drop the file's cached pages so the next read is cold.
+// Pages that are dirty or mapped elsewhere may stay.
+void dropPageCache(const QString& path)
+{
+    const int fd = ::open(QFile::encodeName(path).constData(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return;
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    ::close(fd);
+}
+
+// Cold-cache index build, full scan and batched viewport reads through each
+// I/O backend
+QVector<Result> runIoSuite(const QString& path, int latencyUs)
+{
+    QVector<Result> results;
+    const qint64 fileBytes = QFileInfo(path).size();
+    IoBackend::setSimulatedLatencyUs(latencyUs);
+    QElapsedTimer timer;
+    for (IoBackend::Kind kind : {IoBackend::Buffered, IoBackend::Mmap, IoBackend::Async}) {
+        BenchRunner::clearIndexCaches();
+        dropPageCache(path);
+        timer.start();
+        RowStore store(path, kind);
+        store.open();
+        const int rows = store.rowCount();
+        const QString name = QString("io %1").arg(IoBackend::kindName(kind));
+        results.append({name + " index", rows, fileBytes, timer.nsecsElapsed() / 1e9});
+        printf("  %s: %s\n", qPrintable(name), qPrintable(store.ioBackendName()));
+
+        dropPageCache(path);
+        qint64 scanned = 0;
+        timer.restart();
+        store.scan(0, rows, [&](int, const QByteArray& raw) { scanned += raw.size(); });
+        results.append({name + " scan", rows, scanned, timer.nsecsElapsed() / 1e9});
+
+        // Viewport reads as scrolling a merged or sorted view does: a batch
+        // of scattered 50-row runs per screen
+        dropPageCache(path);
+        QRandomGenerator rng(11);
+        const int batches = 200, runsPerBatch = 16, runRows = 50;
+        QVector<QVector<QByteArray>> lines;
+        qint64 readRows = 0, readBytes = 0;
+        timer.restart();
+        for (int b = 0; b < batches && rows > runRows; ++b) {
+            QVector<QPair<int, int>> ranges;
+            for (int r = 0; r < runsPerBatch; ++r) {
+                const int first = rng.bounded(rows - runRows);
+                ranges.append({first, first + runRows});
+            }
+            store.readRanges(ranges, lines);
+            for (const QVector<QByteArray>& run : lines) {
+                readRows += run.size();
+                for (const QByteArray& raw : run)
+                    readBytes += raw.size();
+            }
+        }
+        results.append({name + " viewport", readRows, readBytes, timer.nsecsElapsed() / 1e9});
+    }
+    IoBackend::setSimulatedLatencyUs(0);
+    BenchRunner::clearIndexCaches();
+    return results;
+}
+
+QVector<Result> runSuite(const QString& path, SyntheticTimeline::Kind kind)
+{
+    QVector<Result> results;
+    const qint64 fileBytes = QFileInfo(path).size();
+    QElapsedTimer timer;
+
+    // Line index: cold build, then reopen from the index cache
+    BenchRunner::clearIndexCaches();
+    timer.start();
+    {
+        RowStore cold(path);
+        cold.open();
+        results.append({"buildLineIndex", cold.rowCount(), fileBytes, timer.nsecsElapsed() / 1e9});
+    }
+    timer.restart();
+    RowStore store(path);
+    store.open();
+    const int rows = store.rowCount();
+    results.append({"indexCacheLoad", rows, fileBytes, timer.nsecsElapsed() / 1e9});
+
+    // CSV tokenizer on raw lines already in memory
+    const int sampleRows = qMin(rows, 200000);
+    QVector<QString> lines;
+    lines.reserve(sampleRows);
+    qint64 sampleBytes = 0;
+    QByteArray raw;
+    for (int r = 0; r < sampleRows; ++r) {
+        store.readRaw(r, raw);
+        sampleBytes += raw.size();
+        lines.append(QString::fromUtf8(raw.trimmed()));
+    }
+    timer.restart();
+    qint64 fields = 0;
+    for (const QString& line : lines) {
+        try {
+            fields += FileUtils::parseCsvLine(line).size();
+        } catch (...) {}
+    }
+    results.append({"parseCsvLine", sampleRows, sampleBytes, timer.nsecsElapsed() / 1e9});
+    if (fields == 0)
+        printf("  (no fields parsed)\n");
+
+    // The same rows read and decoded a chunk at a time into one reused
+    // columnar chunk, as bulk passes do
+    timer.restart();
+    RowChunk chunk;
+    qint64 chunkBytes = 0;
+    for (int first = 0; first < sampleRows; first += RowStore::CHUNK_ROWS) {
+        store.readChunk(first, qMin(sampleRows, first + RowStore::CHUNK_ROWS), chunk);
+        chunkBytes += chunk.byteSize();
+    }
+    results.append({"decodeRows", sampleRows, sampleBytes, timer.nsecsElapsed() / 1e9});
+    if (chunkBytes == 0)
+        printf("  (no rows decoded)\n");
+
+    // Full-file search, all columns, with a term that hits a few percent;
+    // on one thread as the viewer does, then split across all cores as the
+    // headless mode does
+    const QString term = kind == SyntheticTimeline::Super ? "185.220.101.4" : "(deleted)";
+    const FilterEngine filter(-1, term);
+    timer.restart();
+    const int matches = filter.scan(store).size();
+    results.append({"FilterEngine::scan", rows, fileBytes, timer.nsecsElapsed() / 1e9});
+    printf("  FilterEngine::scan('%s'): %d matches\n", qPrintable(term), matches);
+    timer.restart();
+    filter.scan(store, 0);
+    results.append({QString("FilterEngine::scan x%1 threads").arg(QThread::idealThreadCount()), rows, fileBytes,
+                    timer.nsecsElapsed() / 1e9});
+
+    // The same search on an analysis cache of the file, which decompresses
+    // only the string columns and matches dictionary values once each
+    const QString cachePath = AnalysisCache::suggestedPath(path);
+    const std::atomic<bool> noCancel{false};
+    timer.restart();
+    AnalysisCache::convert(store, cachePath, noCancel);
+    results.append({"writeAnalysisCache", rows, fileBytes, timer.nsecsElapsed() / 1e9});
+    {
+        RowStore cached(cachePath);
+        cached.open();
+        timer.restart();
+        const int cacheMatches = filter.scan(cached).size();
+        results.append({"FilterEngine::scan (cache)", rows, fileBytes, timer.nsecsElapsed() / 1e9});
+        printf("  FilterEngine::scan on the analysis cache (%.1f MB): %d matches\n",
+               QFileInfo(cachePath).size() / 1048576.0, cacheMatches);
+    }
+    QFile::remove(cachePath);
+
+    // Scrolling: page-sized windows of rows, read and tokenized one row at a
+    // time (sequential, then random jumps), then as one batched read per
+    // page the way the table model fills its row cache
+    const int pageRows = 50;
+    auto readPage = [&](int first) {
+        qint64 chars = 0;
+        QStringList rowFields;
+        for (int r = first; r < qMin(first + pageRows, rows); ++r) {
+            if (store.readFields(r, rowFields)) {
+                for (const QString& field : rowFields)
+                    chars += field.size();
+            }
+        }
+        return chars;
+    };
+    const int sequentialRows = qMin(rows, 200000);
+    timer.restart();
+    qint64 chars = 0;
+    for (int first = 0; first < sequentialRows; first += pageRows)
+        chars += readPage(first);
+    results.append({"readFields sequential", sequentialRows, chars * 2, timer.nsecsElapsed() / 1e9});
+    QRandomGenerator rng(7);
+    const int jumps = 2000;
+    timer.restart();
+    chars = 0;
+    for (int j = 0; j < jumps && rows > 0; ++j)
+        chars += readPage(rng.bounded(rows));
+    results.append({"readFields random pages", qint64(jumps) * qMin(pageRows, rows), chars * 2,
+                    timer.nsecsElapsed() / 1e9});
+    timer.restart();
+    qint64 pageBytes = 0;
+    for (int first = 0; first < sequentialRows; first += pageRows) {
+        store.readChunk(first, qMin(first + pageRows, sequentialRows), chunk);
+        pageBytes += chunk.byteSize();
+    }
+    results.append({"readChunk pages", sequentialRows, pageBytes, timer.nsecsElapsed() / 1e9});
+
+    // Random row reads from several threads through one shared RowStore,
+    // as painting, read-ahead and searches do; with positional reads the
+    // rows/s should grow with the thread count instead of flattening out
+    const int readsPerThread = 50000;
+    for (int threads = 1; threads <= qMin(8, QThread::idealThreadCount()) && rows > 0; threads *= 2) {
+        std::atomic<qint64> readBytes{0};
+        QVector<QThread*> workers;
+        timer.restart();
+        for (int t = 0; t < threads; ++t) {
+            workers.append(QThread::create([&store, &readBytes, rows, readsPerThread, t]() {
+                QRandomGenerator threadRng(100 + t);
+                QByteArray raw;
+                qint64 local = 0;
+                for (int i = 0; i < readsPerThread; ++i) {
+                    if (store.readRaw(threadRng.bounded(rows), raw))
+                        local += raw.size();
+                }
+                readBytes += local;
+            }));
+            workers.last()->start();
+        }
+        for (QThread* worker : workers) {
+            worker->wait();
+            delete worker;
+        }
+        results.append({QString("readRaw x%1 threads").arg(threads), qint64(threads) * readsPerThread,
+                        readBytes.load(), timer.nsecsElapsed() / 1e9});
+    }
+
+    // Detail-window formatting of message fields
+    const int messageColumn = store.headers().indexOf(kind == SyntheticTimeline::Super ? "message" : "File Name");
+    QVector<QString> messages;
+    qint64 messageBytes = 0;
+    QStringList rowFields;
+    for (int r = 0; r < qMin(rows, 20000); ++r) {
+        messages.append(store.readFields(r, rowFields) ? rowFields.value(messageColumn) : QString());
+        messageBytes += messages.last().size() * 2;
+    }
+    timer.restart();
+    qint64 formatted = 0;
+    for (const QString& m : messages)
+        formatted += JsonXmlFormatter::formatIfApplicable(m).size();
+    results.append({"formatIfApplicable", messages.size(), messageBytes, timer.nsecsElapsed() / 1e9});
+    return results;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("timeline_bench");
+    // Keep index caches away from the viewer's real app data directory
+    QStandardPaths::setTestModeEnabled(true);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Benchmarks the timeline engine on synthetic data");
+    parser.addHelpOption();
+    BenchRunner::addOptions(parser);
+    const QCommandLineOption latencyOption("io-latency-us",
+        "Delay every read of the io stages by <us> microseconds (default 0).", "us", "0");
+    parser.addOption(latencyOption);
+    parser.process(app);
+
+    bool ok = false;
+    const int latencyUs = parser.value(latencyOption).toInt(&ok);
+    if (!ok || latencyUs < 0) {
+        fprintf(stderr, "Invalid --io-latency-us value\n");
+        return 2;
+    }
+    QJsonObject info;
+    info["io_latency_us"] = latencyUs;
+    return BenchRunner::run(parser, [latencyUs](const QString& path, SyntheticTimeline::Kind kind) {
+        return runSuite(path, kind) + runIoSuite(path, latencyUs);
+    }, info);
+}
@@ -0,0 +1,35 @@
+// timeline_gen — writes a synthetic timeline for benchmarking or manual testing.
+//
+//   timeline_gen super|filesystem <rows> <output.csv> [seed]
+
+#include "SyntheticTimeline.h"
+#include <QCoreApplication>
+#include <QStringList>
+#include <cstdio>
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    const QStringList args = app.arguments();
+    if (args.size() < 4 || (args[1] != "super" && args[1] != "filesystem")) {
+        fprintf(stderr, "Usage: timeline_gen super|filesystem <rows> <output.csv> [seed]\n");
+        return 2;
+    }
+
+    bool ok = false;
+    const qint64 rows = args[2].toLongLong(&ok);
+    if (!ok || rows <= 0) {
+        fprintf(stderr, "Invalid row count: %s\n", qPrintable(args[2]));
+        return 2;
+    }
+    const quint32 seed = args.size() > 4 ? args[4].toUInt() : 1;
+    const SyntheticTimeline::Kind kind = args[1] == "super" ? SyntheticTimeline::Super
+                                                            : SyntheticTimeline::Filesystem;
+    const qint64 bytes = SyntheticTimeline::write(kind, args[3], rows, seed);
+    if (bytes < 0) {
+        fprintf(stderr, "Cannot write %s\n", qPrintable(args[3]));
+        return 1;
+    }
+    printf("%s: %lld rows, %lld bytes\n", qPrintable(args[3]), rows, bytes);
+    return 0;
+}
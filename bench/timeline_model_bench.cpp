@@ -0,0 +1,138 @@
+// timeline_model_bench — times TimelineModel, the table model the viewer
+// scrolls, on synthetic timelines.
+//
+//   timeline_model_bench [--rows 1M] [--type super|filesystem|both] [--dir DIR]
+//                        [--json report.json] [--compare baseline.json]
+//
+// Where timeline_bench times the timeline_core reads, these stages go
+// through the model as the table view does: data() served from the row
+// cache with long fields decoded only up to their display prefix, the
+// visible range read in one batch with read-ahead on the prefetch thread,
+// and the blocking applyFilter() search. Options and report are those of
+// timeline_bench.
+
+#include "BenchRunner.h"
+#include "SyntheticTimeline.h"
+#include "TimelineModel.h"
+#include "core/AnalysisCache.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QStandardPaths>
+#include <QFileInfo>
+#include <QFile>
+#include <QRandomGenerator>
+#include <atomic>
+#include <cstdio>
+
+namespace {
+
+using BenchRunner::Result;
+
+QVector<Result> runModelSuite(const QString& path, SyntheticTimeline::Kind kind)
+{
+    QVector<Result> results;
+    const qint64 fileBytes = QFileInfo(path).size();
+    QElapsedTimer timer;
+
+    BenchRunner::clearIndexCaches();
+    timer.start();
+    TimelineModel model(path);
+    const int rows = model.totalRowCount();
+    results.append({"TimelineModel open", rows, fileBytes, timer.nsecsElapsed() / 1e9});
+
+    // Scrolling: page-sized windows of data() calls, sequential then random
+    // jumps. Every row is read on its own as its first cell is asked for.
+    const int pageRows = 50;
+    const int columns = model.columnCount();
+    auto sweepPage = [&](int first) {
+        qint64 chars = 0;
+        for (int r = first; r < qMin(first + pageRows, rows); ++r) {
+            for (int c = 0; c < columns; ++c)
+                chars += model.data(model.index(r, c), Qt::DisplayRole).toString().size();
+        }
+        return chars;
+    };
+    const int sequentialRows = qMin(rows, 200000);
+    timer.restart();
+    qint64 chars = 0;
+    for (int first = 0; first < sequentialRows; first += pageRows)
+        chars += sweepPage(first);
+    results.append({"data() sequential", sequentialRows, chars * 2, timer.nsecsElapsed() / 1e9});
+    QRandomGenerator rng(7);
+    const int jumps = 2000;
+    timer.restart();
+    chars = 0;
+    for (int j = 0; j < jumps && rows > 0; ++j)
+        chars += sweepPage(rng.bounded(rows));
+    results.append({"data() random pages", qint64(jumps) * qMin(pageRows, rows), chars * 2,
+                    timer.nsecsElapsed() / 1e9});
+
+    // The same sweeps on a fresh model with the view's visible range
+    // announced first, as TimelineTab does: one batched read per page plus
+    // read-ahead of the next page in the scroll direction
+    TimelineModel viewed(path);
+    auto viewPage = [&](int first) {
+        viewed.setVisibleRange(first, first + pageRows - 1);
+        qint64 pageChars = 0;
+        for (int r = first; r < qMin(first + pageRows, rows); ++r) {
+            for (int c = 0; c < columns; ++c)
+                pageChars += viewed.data(viewed.index(r, c), Qt::DisplayRole).toString().size();
+        }
+        QCoreApplication::processEvents();  // deliver read-ahead results
+        return pageChars;
+    };
+    timer.restart();
+    chars = 0;
+    for (int first = 0; first < sequentialRows; first += pageRows)
+        chars += viewPage(first);
+    results.append({"data() batched pages", sequentialRows, chars * 2, timer.nsecsElapsed() / 1e9});
+    timer.restart();
+    chars = 0;
+    for (int j = 0; j < jumps && rows > 0; ++j)
+        chars += viewPage(rng.bounded(rows));
+    results.append({"data() batched random pages", qint64(jumps) * qMin(pageRows, rows), chars * 2,
+                    timer.nsecsElapsed() / 1e9});
+    printf("  read-ahead: %llu rows prefetched\n",
+           static_cast<unsigned long long>(viewed.metrics().prefetchedRows.load()));
+
+    // Blocking search through the model, as Enter in the search box runs it
+    const QString term = kind == SyntheticTimeline::Super ? "185.220.101.4" : "(deleted)";
+    timer.restart();
+    model.applyFilter("All Columns", term);
+    results.append({"applyFilter", rows, fileBytes, timer.nsecsElapsed() / 1e9});
+    printf("  applyFilter('%s'): %d matches\n", qPrintable(term), model.filteredRowCount());
+    model.clearFilter();
+
+    // The same search on an analysis cache of the file
+    const QString cachePath = AnalysisCache::suggestedPath(path);
+    const std::atomic<bool> noCancel{false};
+    model.writeAnalysisCache(cachePath, noCancel);
+    {
+        TimelineModel cached(cachePath);
+        timer.restart();
+        cached.applyFilter("All Columns", term);
+        results.append({"applyFilter (cache)", rows, fileBytes, timer.nsecsElapsed() / 1e9});
+        printf("  applyFilter on the analysis cache: %d matches\n", cached.filteredRowCount());
+    }
+    QFile::remove(cachePath);
+    BenchRunner::clearIndexCaches();
+    return results;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("timeline_model_bench");
+    // Keep index caches away from the viewer's real app data directory
+    QStandardPaths::setTestModeEnabled(true);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Benchmarks the timeline table model on synthetic data");
+    parser.addHelpOption();
+    BenchRunner::addOptions(parser);
+    parser.process(app);
+    return BenchRunner::run(parser, runModelSuite);
+}
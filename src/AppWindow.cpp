@@ -3,6 +3,41 @@
 #include <QMessageBox>
 #include <QDebug>
 #include <QFileInfo>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <memory>
+#include <stdexcept>
+#include "core/AnalysisCache.h"
+#include "core/AppDataPaths.h"
+#include "core/RowStore.h"
+#include <unistd.h>
+
+namespace {
+
+QString formatBytes(qint64 bytes)
+{
+    if (bytes >= 1024LL * 1024 * 1024)
+        return QString("%1 GB").arg(bytes / (1024.0 * 1024 * 1024), 0, 'f', 1);
+    return QString("%1 MB").arg(bytes / (1024.0 * 1024), 0, 'f', 0);
+}
+
+QString tabTitle(const QStringList& files)
+{
+    if (files.size() == 1)
+        return QFileInfo(files.first()).fileName();
+    return QString("Merged (%1 files)").arg(files.size());
+}
+
+QStringList sessionFiles(const QJsonObject& state)
+{
+    QStringList files;
+    for (const QJsonValue& file : state["files"].toArray())
+        files << file.toString();
+    return files;
+}
+
+} // namespace
 
 AppWindow::AppWindow(QWidget* parent)
     : QMainWindow(parent)
@@ -15,29 +50,65 @@ AppWindow::AppWindow(QWidget* parent)
     resize(1200, 800);
     connect(tabs, &QTabWidget::currentChanged, this, &AppWindow::onTabChanged);
     connect(tabs, &QTabWidget::tabCloseRequested, this, &AppWindow::closeTab);
+
+    // Half of physical memory by default, leaving room for the page cache
+    const long pages = sysconf(_SC_PHYS_PAGES);
+    const long pageSize = sysconf(_SC_PAGE_SIZE);
+    if (pages > 0 && pageSize > 0)
+        memoryBudget = static_cast<qint64>(pages) * pageSize / 2;
+    memoryLabel = new QLabel(this);
+    statusBar()->addPermanentWidget(memoryLabel);
+    memoryTimer = new QTimer(this);
+    memoryTimer->setInterval(MEMORY_CHECK_MS);
+    connect(memoryTimer, &QTimer::timeout, this, &AppWindow::enforceMemoryBudget);
+    memoryTimer->start();
+    enforceMemoryBudget();
 }
 
-AppWindow::~AppWindow() {}
+AppWindow::~AppWindow()
+{
+    indexCancel = true;
+    if (indexThread)
+        indexThread->wait();
+}
 
 void AppWindow::setupMenu()
 {
     QMenuBar* menuBar = this->menuBar();
     QMenu* fileMenu = menuBar->addMenu("&File");
     openAction = new QAction("&Open", this);
+    openMergedAction = new QAction("Open &Merged View...", this);
+    attachServerAction = new QAction("Attach to &Server...", this);
     saveAction = new QAction("&Save", this);
     saveAction->setShortcut(QKeySequence::Save);
     saveAction->setEnabled(false);
+    exportAction = new QAction("&Export Shown Rows...", this);
+    exportAction->setEnabled(false);
+    exportTaggedAction = new QAction("Export &Tagged Rows...", this);
+    exportTaggedAction->setEnabled(false);
+    convertAction = new QAction("Convert to &Analysis Cache...", this);
+    convertAction->setEnabled(false);
     closeTabAction = new QAction("&Close Tab", this);
     closeTabAction->setShortcut(QKeySequence::Close);
     closeTabAction->setEnabled(false);
     exitAction = new QAction("E&xit", this);
     fileMenu->addAction(openAction);
+    fileMenu->addAction(openMergedAction);
+    fileMenu->addAction(attachServerAction);
     fileMenu->addAction(saveAction);
+    fileMenu->addAction(exportAction);
+    fileMenu->addAction(exportTaggedAction);
+    fileMenu->addAction(convertAction);
     fileMenu->addAction(closeTabAction);
     fileMenu->addSeparator();
     fileMenu->addAction(exitAction);
     connect(openAction, &QAction::triggered, this, &AppWindow::openFile);
+    connect(openMergedAction, &QAction::triggered, this, &AppWindow::openMergedView);
+    connect(attachServerAction, &QAction::triggered, this, &AppWindow::attachToServer);
     connect(saveAction, &QAction::triggered, this, &AppWindow::saveFile);
+    connect(exportAction, &QAction::triggered, this, &AppWindow::exportRows);
+    connect(exportTaggedAction, &QAction::triggered, this, &AppWindow::exportTaggedRows);
+    connect(convertAction, &QAction::triggered, this, &AppWindow::convertToAnalysisCache);
     connect(closeTabAction, &QAction::triggered, this, &AppWindow::closeCurrentTab);
     connect(exitAction, &QAction::triggered, this, &QWidget::close);
 
@@ -49,9 +120,33 @@ void AppWindow::setupMenu()
     viewMenu->addAction(fontDecAction);
     viewMenu->addSeparator();
     viewMenu->addAction(resetFontAction);
+    followAction = new QAction("&Follow File (Live Tail)", this);
+    followAction->setCheckable(true);
+    followAction->setEnabled(false);
+    viewMenu->addSeparator();
+    viewMenu->addAction(followAction);
+    performanceAction = new QAction("&Performance...", this);
+    performanceAction->setEnabled(false);
+    viewMenu->addAction(performanceAction);
+    groupDuplicatesAction = new QAction("&Group Duplicates...", this);
+    groupDuplicatesAction->setEnabled(false);
+    collapseDuplicatesAction = new QAction("&Collapse Duplicates", this);
+    collapseDuplicatesAction->setCheckable(true);
+    collapseDuplicatesAction->setEnabled(false);
+    viewMenu->addSeparator();
+    viewMenu->addAction(groupDuplicatesAction);
+    viewMenu->addAction(collapseDuplicatesAction);
+    memoryBudgetAction = new QAction("&Memory Budget...", this);
+    viewMenu->addSeparator();
+    viewMenu->addAction(memoryBudgetAction);
     connect(fontIncAction, &QAction::triggered, this, &AppWindow::increaseFontSize);
     connect(fontDecAction, &QAction::triggered, this, &AppWindow::decreaseFontSize);
     connect(resetFontAction, &QAction::triggered, this, &AppWindow::resetFontAndLineHeight);
+    connect(followAction, &QAction::triggered, this, &AppWindow::toggleFollow);
+    connect(performanceAction, &QAction::triggered, this, &AppWindow::showPerformance);
+    connect(groupDuplicatesAction, &QAction::triggered, this, &AppWindow::groupDuplicates);
+    connect(collapseDuplicatesAction, &QAction::triggered, this, &AppWindow::toggleCollapseDuplicates);
+    connect(memoryBudgetAction, &QAction::triggered, this, &AppWindow::setMemoryBudget);
 
     QMenu* searchMenu = menuBar->addMenu("&Search");
     searchCurrentTabAction = new QAction("Search in Current Tab...", this);
@@ -61,9 +156,13 @@ void AppWindow::setupMenu()
     searchMenu->addAction(searchAllTabsAction);
     searchMenu->addSeparator();
     searchMenu->addAction(clearSearchAction);
+    iocSweepAction = new QAction("&IOC Sweep...", this);
+    searchMenu->addSeparator();
+    searchMenu->addAction(iocSweepAction);
     connect(searchCurrentTabAction, &QAction::triggered, this, &AppWindow::searchInCurrentTab);
     connect(searchAllTabsAction, &QAction::triggered, this, &AppWindow::searchInAllTabs);
     connect(clearSearchAction, &QAction::triggered, this, &AppWindow::clearSearch);
+    connect(iocSweepAction, &QAction::triggered, this, &AppWindow::iocSweep);
 }
 
 void AppWindow::openFile()
@@ -72,7 +171,7 @@ void AppWindow::openFile()
     // block the event loop for 10-15 seconds on Wayland/XCB sessions.
     QString fileName = QFileDialog::getOpenFileName(
         this, "Open Timeline File", QString(),
-        "Timeline Files (*.csv *.txt)", nullptr,
+        "Timeline Files (*.csv *.txt *.csv.gz *.txt.gz *.csv.zst *.txt.zst *.tlac)", nullptr,
         QFileDialog::DontUseNativeDialog);
     if (fileName.isEmpty())
         return;
@@ -101,19 +200,11 @@ void AppWindow::openFile()
     }
     
     try {
-        TimelineTab* tab = new TimelineTab(fileName, this);
-        tab->setFontSize(currentFontSize);
-        tabs->addTab(tab, fileInfo.fileName());
+        TimelineTab* tab = createTab({fileName});
         tabs->setCurrentWidget(tab);
         updateWindowTitle();
-        
-        // Connect to model's dataChanged signal to update save action and window title
-        connect(tab->getModel(), &TimelineModel::tagsModified, this, [this](bool hasUnsaved) {
-            updateWindowTitle();
-            saveAction->setEnabled(hasUnsaved);
-        });
-        
         statusBar()->showMessage("File loaded successfully", 2000);
+        enforceMemoryBudget();
     } catch (const std::exception& e) {
         QMessageBox::critical(this, "Error Loading File", 
             QString("Failed to load the timeline file: %1").arg(e.what()));
@@ -123,6 +214,82 @@ void AppWindow::openFile()
     }
 }
 
+void AppWindow::openMergedView()
+{
+    QStringList fileNames = QFileDialog::getOpenFileNames(
+        this, "Open Timeline Files to Merge", QString(),
+        "Timeline Files (*.csv *.txt *.csv.gz *.txt.gz *.csv.zst *.txt.zst *.tlac)", nullptr,
+        QFileDialog::DontUseNativeDialog);
+    if (fileNames.isEmpty())
+        return;
+    if (fileNames.size() < 2) {
+        QMessageBox::warning(this, "Merged View", "Select at least two timeline files to merge.");
+        return;
+    }
+
+    for (const QString& fileName : fileNames) {
+        QFileInfo fileInfo(fileName);
+        if (!fileInfo.isReadable() || fileInfo.size() == 0) {
+            QMessageBox::warning(this, "File Error",
+                QString("'%1' is missing, empty or not readable.").arg(fileInfo.fileName()));
+            return;
+        }
+    }
+
+    try {
+        TimelineTab* tab = createTab(fileNames);
+        tabs->setCurrentWidget(tab);
+        updateWindowTitle();
+        enforceMemoryBudget();
+    } catch (const std::exception& e) {
+        QMessageBox::critical(this, "Error Loading File",
+            QString("Failed to open the merged view: %1").arg(e.what()));
+    } catch (...) {
+        QMessageBox::critical(this, "Error Loading File",
+            "An unexpected error occurred while loading the files.");
+    }
+}
+
+void AppWindow::attachToServer()
+{
+    bool ok = false;
+    const QString serverName = QInputDialog::getText(this, "Attach to Server",
+        "Server name (as given to --serve):", QLineEdit::Normal, QString(), &ok).trimmed();
+    if (!ok || serverName.isEmpty())
+        return;
+
+    QVector<RemoteTimelineModel::TimelineInfo> timelines;
+    try {
+        timelines = RemoteTimelineModel::listTimelines(serverName);
+    } catch (const std::exception& e) {
+        QMessageBox::warning(this, "Attach to Server", e.what());
+        return;
+    }
+    if (timelines.isEmpty()) {
+        QMessageBox::warning(this, "Attach to Server", "The server hosts no timelines.");
+        return;
+    }
+    QStringList choices;
+    for (const RemoteTimelineModel::TimelineInfo& timeline : timelines)
+        choices << QString("%1 (%2 rows)").arg(timeline.path).arg(timeline.rows);
+    const QString choice = QInputDialog::getItem(this, "Attach to Server", "Timeline:", choices, 0, false, &ok);
+    if (!ok)
+        return;
+    const RemoteTimelineModel::TimelineInfo& timeline = timelines[choices.indexOf(choice)];
+
+    try {
+        TimelineTab* tab = new TimelineTab(serverName, timeline, this);
+        tab->setFontSize(currentFontSize);
+        const int index = tabs->addTab(tab, QString("%1 @ %2").arg(timeline.name, serverName));
+        tabs->setTabToolTip(index, timeline.path);
+        tabs->setCurrentWidget(tab);
+        updateWindowTitle();
+    } catch (const std::exception& e) {
+        QMessageBox::critical(this, "Attach to Server",
+            QString("Failed to open the remote timeline: %1").arg(e.what()));
+    }
+}
+
 void AppWindow::saveFile()
 {
     TimelineTab* tab = qobject_cast<TimelineTab*>(tabs->currentWidget());
@@ -137,6 +304,71 @@ void AppWindow::saveFile()
     }
 }
 
+void AppWindow::exportRows() { startExport(false); }
+void AppWindow::exportTaggedRows() { startExport(true); }
+
+void AppWindow::startExport(bool taggedOnly)
+{
+    TimelineTab* tab = qobject_cast<TimelineTab*>(tabs->currentWidget());
+    if (!tab || !tab->getModel())
+        return;
+    if (tab->isExporting()) {
+        statusBar()->showMessage("An export is already running for this tab.", 3000);
+        return;
+    }
+    if (taggedOnly && tab->getModel()->taggedSourceRows().isEmpty()) {
+        statusBar()->showMessage("No rows are tagged.", 3000);
+        return;
+    }
+
+    // Exports copy rows out of the original CSV, which an analysis cache
+    // only refers to
+    const QString sourcePath = tab->getModel()->exportSourcePath();
+    if (sourcePath.isEmpty()) {
+        QMessageBox::warning(this, "Export Error",
+            "Exporting from an analysis cache needs the CSV it was converted from, "
+            "which has been moved or changed since.");
+        return;
+    }
+
+    QString outPath = QFileDialog::getSaveFileName(
+        this, taggedOnly ? "Export Tagged Rows" : "Export Shown Rows", QString(),
+        "CSV Files (*.csv)", nullptr, QFileDialog::DontUseNativeDialog);
+    if (outPath.isEmpty())
+        return;
+    if (QFileInfo(outPath).absoluteFilePath() == QFileInfo(sourcePath).absoluteFilePath()) {
+        QMessageBox::warning(this, "Export Error", "Cannot export a timeline onto itself.");
+        return;
+    }
+    tab->exportRows(taggedOnly, outPath);
+}
+
+void AppWindow::convertToAnalysisCache()
+{
+    TimelineTab* tab = qobject_cast<TimelineTab*>(tabs->currentWidget());
+    if (!tab || !tab->getModel())
+        return;
+    if (tab->getModel()->isAnalysisCache()) {
+        statusBar()->showMessage("This timeline is already an analysis cache.", 3000);
+        return;
+    }
+    if (tab->isConverting()) {
+        statusBar()->showMessage("An analysis cache is already being written for this tab.", 3000);
+        return;
+    }
+
+    QString outPath = QFileDialog::getSaveFileName(
+        this, "Convert to Analysis Cache", AnalysisCache::suggestedPath(tab->getFilePath()),
+        "Analysis Caches (*.tlac)", nullptr, QFileDialog::DontUseNativeDialog);
+    if (outPath.isEmpty())
+        return;
+    if (QFileInfo(outPath).absoluteFilePath() == QFileInfo(tab->getFilePath()).absoluteFilePath()) {
+        QMessageBox::warning(this, "Conversion Error", "Cannot write the cache over the timeline itself.");
+        return;
+    }
+    tab->convertToAnalysisCache(outPath);
+}
+
 void AppWindow::closeCurrentTab()
 {
     closeTab(tabs->currentIndex());
@@ -148,8 +380,16 @@ void AppWindow::closeTab(int index)
         return;
 
     TimelineTab* tab = qobject_cast<TimelineTab*>(tabs->widget(index));
-    if (!tab)
+    if (!tab) {
+        // A session placeholder, or the error page left by one that failed to load
+        QWidget* placeholder = tabs->widget(index);
+        pendingTabs.remove(placeholder);
+        waitingTabs.remove(placeholder);
+        tabs->removeTab(index);
+        delete placeholder;
+        updateWindowTitle();
         return;
+    }
 
     if (tab->hasUnsavedChanges()) {
         QMessageBox::StandardButton result = QMessageBox::question(
@@ -168,8 +408,10 @@ void AppWindow::closeTab(int index)
     }
 
     tabs->removeTab(index);
+    tabUsage.removeAll(tab);
     delete tab;
     updateWindowTitle();
+    enforceMemoryBudget();
 }
 
 void AppWindow::increaseFontSize() { currentFontSize = qMin(currentFontSize + 1, 32); applyFontAndLineHeight(); }
@@ -196,9 +438,150 @@ void AppWindow::clearSearch() {
             ++cleared;
         }
     }
+    for (QJsonObject& state : pendingTabs) {
+        state.remove("search_column");
+        state.remove("search_term");
+    }
     statusBar()->showMessage(QString("Cleared search in %1 tab(s)." ).arg(cleared));
 }
 
+void AppWindow::iocSweep()
+{
+    QString fileName = QFileDialog::getOpenFileName(
+        this, "Open Indicator List", QString(),
+        "Indicator Lists (*.txt *.csv *.ioc);;All Files (*)", nullptr,
+        QFileDialog::DontUseNativeDialog);
+    if (fileName.isEmpty())
+        return;
+
+    // One automaton for all tabs; each tab is then swept in a single pass
+    std::shared_ptr<const IocSweep> sweep;
+    int skipped = 0;
+    try {
+        sweep = std::make_shared<const IocSweep>(IocSweep::loadPatterns(fileName, &skipped));
+    } catch (const std::exception& e) {
+        QMessageBox::warning(this, "IOC Sweep", QString("Cannot load the indicators: %1").arg(e.what()));
+        return;
+    }
+
+    int tabsHit = 0, rowsHit = 0, swept = 0;
+    for (int i = 0; i < tabs->count(); ++i) {
+        TimelineTab* tab = qobject_cast<TimelineTab*>(tabs->widget(i));
+        if (!tab)
+            continue;
+        const int hits = tab->iocSweep(sweep);
+        if (hits < 0)
+            continue;  // merged and remote views
+        ++swept;
+        rowsHit += hits;
+        if (hits > 0)
+            ++tabsHit;
+    }
+    QString message = QString("IOC sweep: %1 indicators, %2 rows hit in %3 of %4 tab(s).")
+        .arg(sweep->patternCount()).arg(rowsHit).arg(tabsHit).arg(swept);
+    if (skipped > 0)
+        message += QString(" %1 duplicate or too-short entries skipped.").arg(skipped);
+    statusBar()->showMessage(message);
+}
+
+void AppWindow::toggleFollow(bool enabled)
+{
+    TimelineTab* tab = qobject_cast<TimelineTab*>(tabs->currentWidget());
+    if (!tab)
+        return;
+    if (!tab->setFollowing(enabled)) {
+        followAction->setChecked(false);
+        statusBar()->showMessage(tab->isMergedView() ? "Merged views cannot be followed."
+                                 : tab->isRemoteView() ? "Remote views cannot be followed."
+                                 : "Compressed timelines cannot be followed.", 3000);
+    }
+}
+
+void AppWindow::showPerformance()
+{
+    TimelineTab* tab = qobject_cast<TimelineTab*>(tabs->currentWidget());
+    if (tab)
+        tab->showPerformanceDialog();
+}
+
+void AppWindow::groupDuplicates()
+{
+    TimelineTab* tab = qobject_cast<TimelineTab*>(tabs->currentWidget());
+    if (tab)
+        tab->groupDuplicates();
+}
+
+void AppWindow::toggleCollapseDuplicates(bool collapse)
+{
+    TimelineTab* tab = qobject_cast<TimelineTab*>(tabs->currentWidget());
+    if (tab)
+        tab->setCollapseDuplicates(collapse);
+    updateGroupingActions();
+}
+
+void AppWindow::updateGroupingActions()
+{
+    TimelineTab* tab = qobject_cast<TimelineTab*>(tabs->currentWidget());
+    groupDuplicatesAction->setEnabled(tab && tab->getModel());
+    collapseDuplicatesAction->setEnabled(tab && tab->canCollapseDuplicates());
+    collapseDuplicatesAction->setChecked(tab && tab->isCollapsingDuplicates());
+}
+
+void AppWindow::setMemoryBudget()
+{
+    bool ok = false;
+    const int mb = QInputDialog::getInt(this, "Memory Budget",
+        "Memory for line indexes, caches and derived columns of all tabs (MB):",
+        static_cast<int>(memoryBudget / (1024 * 1024)), 256, 1024 * 1024, 256, &ok);
+    if (!ok)
+        return;
+    memoryBudget = static_cast<qint64>(mb) * 1024 * 1024;
+    enforceMemoryBudget();
+}
+
+void AppWindow::enforceMemoryBudget()
+{
+    qint64 used = 0;
+    for (TimelineTab* tab : tabUsage)
+        used += tab->memoryBytes();
+
+    if (used > memoryBudget) {
+        // Caches are cheapest to rebuild; the tab on screen is last in
+        // tabUsage, so its caches go only if nothing else is left
+        const qint64 over = used;
+        for (TimelineTab* tab : tabUsage) {
+            if (used <= memoryBudget)
+                break;
+            used -= tab->releaseCaches();
+        }
+        // Then derived columns of tabs not on screen, which must be rebuilt by hand
+        for (TimelineTab* tab : tabUsage) {
+            if (used <= memoryBudget)
+                break;
+            if (tab != tabs->currentWidget())
+                used -= tab->releaseDerivedData();
+        }
+        // Logged only when it helped; the check runs every few seconds
+        if (over > used) {
+            qDebug() << "AppWindow: memory budget exceeded," << over << "bytes in use; released"
+                     << over - used << "bytes";
+        }
+    }
+
+    memoryLabel->setText(QString("Memory: %1 / %2").arg(formatBytes(used)).arg(formatBytes(memoryBudget)));
+    // What is left is mostly line indexes, which cannot be released while a tab is open
+    const bool overBudget = used > memoryBudget;
+    if (overBudget != wasOverBudget) {
+        qDebug() << "AppWindow:" << (overBudget ? "over" : "back within") << "the memory budget,"
+                 << used << "of" << memoryBudget << "bytes in use";
+        wasOverBudget = overBudget;
+    }
+    memoryLabel->setStyleSheet(overBudget ? QStringLiteral("color: #b00020;") : QString());
+    memoryLabel->setToolTip(overBudget
+        ? "Over the memory budget: close tabs to free their line indexes."
+        : "Line indexes, caches and derived columns of all open tabs.");
+}
+
 void AppWindow::showSearchDialog(bool allTabs)
 {
     // Gather columns
@@ -206,6 +589,8 @@ void AppWindow::showSearchDialog(bool allTabs)
     if (allTabs) {
         QSet<QString> colSet;
         for (int i = 0; i < tabs->count(); ++i) {
+            if (pendingTabs.contains(tabs->widget(i)))
+                continue;
             TimelineTab* tab = qobject_cast<TimelineTab*>(tabs->widget(i));
             if (!tab) {
                 qWarning() << "Null TimelineTab at index" << i;
@@ -267,6 +652,13 @@ void AppWindow::showSearchDialog(bool allTabs)
     int firstTabWithMatch = -1;
     int firstRow = -1;
     for (int i = 0; i < tabs->count(); ++i) {
+        // Tabs not loaded yet run the search when they are first shown
+        auto pending = pendingTabs.find(tabs->widget(i));
+        if (pending != pendingTabs.end()) {
+            pending->insert("search_column", col);
+            pending->insert("search_term", term);
+            continue;
+        }
         TimelineTab* tab = qobject_cast<TimelineTab*>(tabs->widget(i));
         if (!tab) {
             qWarning() << "Null TimelineTab at index" << i;
@@ -297,22 +689,46 @@ void AppWindow::showSearchDialog(bool allTabs)
 
 void AppWindow::onTabChanged(int index)
 {
+    if (loadingTab)
+        return;
+    if (pendingTabs.contains(tabs->widget(index))) {
+        loadPendingTab(index);  // calls back once the tab is in place
+        return;
+    }
     updateWindowTitle();
     if (index >= 0) {
         TimelineTab* tab = qobject_cast<TimelineTab*>(tabs->widget(index));
         if (tab) {
+            tabUsage.removeAll(tab);
+            tabUsage.append(tab);
             saveAction->setEnabled(tab->hasUnsavedChanges());
+            followAction->setChecked(tab->isFollowing());
+            // Single-file tabs only; merged and remote views have no local model
+            const bool local = tab->getModel() != nullptr;
+            exportAction->setEnabled(local);
+            exportTaggedAction->setEnabled(local);
+            convertAction->setEnabled(local);
+            performanceAction->setEnabled(local);
         }
         closeTabAction->setEnabled(true);
+        followAction->setEnabled(true);
     } else {
         saveAction->setEnabled(false);
+        exportAction->setEnabled(false);
+        exportTaggedAction->setEnabled(false);
+        convertAction->setEnabled(false);
+        performanceAction->setEnabled(false);
         closeTabAction->setEnabled(false);
+        followAction->setChecked(false);
+        followAction->setEnabled(false);
     }
+    updateGroupingActions();
 }
 
 void AppWindow::closeEvent(QCloseEvent* event)
 {
     if (checkUnsavedChanges()) {
+        saveSession();
         event->accept();
     } else {
         event->ignore();
@@ -371,12 +787,272 @@ void AppWindow::updateWindowTitle()
     
     TimelineTab* currentTab = qobject_cast<TimelineTab*>(tabs->currentWidget());
     if (currentTab) {
-        QString fileName = QFileInfo(currentTab->getFilePath()).fileName();
-        title += " - " + fileName;
+        title += " - " + tabs->tabText(tabs->currentIndex());
         if (currentTab->hasUnsavedChanges()) {
             title += " *";
         }
     }
     
     setWindowTitle(title);
-} 
\ No newline at end of file
+}
+
+TimelineTab* AppWindow::createTab(const QStringList& files, int index)
+{
+    TimelineTab* tab = files.size() == 1 ? new TimelineTab(files.first(), this)
+                                         : new TimelineTab(files, this);
+    tab->setFontSize(currentFontSize);
+    index = tabs->insertTab(index, tab, tabTitle(files));
+    if (files.size() > 1)
+        tabs->setTabToolTip(index, files.join("\n"));
+
+    if (TimelineModel* model = tab->getModel()) {
+        // Connect to model's dataChanged signal to update save action and window title
+        connect(model, &TimelineModel::tagsModified, this, [this](bool hasUnsaved) {
+            updateWindowTitle();
+            saveAction->setEnabled(hasUnsaved);
+        });
+        connect(model, &TimelineModel::groupingChanged, this, &AppWindow::updateGroupingActions);
+    }
+    return tab;
+}
+
+void AppWindow::saveSession() const
+{
+    QJsonArray tabStates;
+    for (int i = 0; i < tabs->count(); ++i) {
+        QWidget* widget = tabs->widget(i);
+        if (TimelineTab* tab = qobject_cast<TimelineTab*>(widget))
+            tabStates.append(tab->sessionState());
+        else
+            tabStates.append(pendingTabs.value(widget));
+    }
+
+    // Load order for the next start: most recently shown first, then the
+    // tabs that were never shown
+    QJsonArray priority;
+    QSet<int> ranked;
+    for (auto it = tabUsage.crbegin(); it != tabUsage.crend(); ++it) {
+        const int index = tabs->indexOf(*it);
+        if (index >= 0 && !ranked.contains(index)) {
+            priority.append(index);
+            ranked.insert(index);
+        }
+    }
+    for (int i = 0; i < tabs->count(); ++i) {
+        if (!ranked.contains(i))
+            priority.append(i);
+    }
+
+    QJsonObject session;
+    session["version"] = 1;
+    session["tabs"] = tabStates;
+    session["current"] = tabs->currentIndex();
+    session["priority"] = priority;
+
+    const QString path = AppDataPaths::sessionFilePath();
+    QFile file(path);
+    if (path.isEmpty() || !file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Failed to save session (check permissions)";
+        return;
+    }
+    file.write(QJsonDocument(session).toJson());
+}
+
+void AppWindow::restoreSession()
+{
+    const QString path = AppDataPaths::sessionFilePath();
+    QFile file(path);
+    if (path.isEmpty() || !file.open(QIODevice::ReadOnly))
+        return;  // no previous session
+    const QJsonObject session = QJsonDocument::fromJson(file.readAll()).object();
+    const QJsonArray states = session["tabs"].toArray();
+    if (states.isEmpty())
+        return;
+
+    // Placeholders stand in for every tab until it is first shown
+    loadingTab = true;
+    QList<QWidget*> placeholders;
+    for (const QJsonValue& value : states) {
+        const QJsonObject state = value.toObject();
+        if (state.contains("server")) {
+            // Remote views need their server, which may not be running now
+            placeholders.append(nullptr);
+            continue;
+        }
+        const QStringList files = sessionFiles(state);
+        bool available = !files.isEmpty();
+        for (const QString& f : files) {
+            const QFileInfo info(f);
+            available = available && info.isReadable() && info.size() > 0;
+        }
+        if (!available) {
+            qWarning() << "Session: skipping tab whose files are gone:" << files;
+            placeholders.append(nullptr);
+            continue;
+        }
+        QLabel* placeholder = new QLabel(this);
+        placeholder->setAlignment(Qt::AlignCenter);
+        placeholder->setWordWrap(true);
+        const int index = tabs->addTab(placeholder, tabTitle(files));
+        if (files.size() > 1)
+            tabs->setTabToolTip(index, files.join("\n"));
+        pendingTabs.insert(placeholder, state);
+        placeholders.append(placeholder);
+        updatePlaceholder(placeholder);
+    }
+    loadingTab = false;
+    if (pendingTabs.isEmpty())
+        return;
+
+    QStringList queue;
+    auto enqueue = [&](QWidget* placeholder) {
+        if (!placeholder)
+            return;
+        for (const QString& f : sessionFiles(pendingTabs.value(placeholder))) {
+            if (!queue.contains(f))
+                queue << f;
+        }
+    };
+    for (const QJsonValue& index : session["priority"].toArray())
+        enqueue(placeholders.value(index.toInt(-1)));
+    for (QWidget* placeholder : placeholders)
+        enqueue(placeholder);
+
+    // The current tab is loaded right away, the rest indexed behind it
+    QWidget* current = placeholders.value(session["current"].toInt(0));
+    if (!current)
+        current = tabs->widget(0);
+    tabs->setCurrentWidget(current);
+    onTabChanged(tabs->currentIndex());
+    startIndexing(queue);
+}
+
+void AppWindow::loadPendingTab(int index)
+{
+    QWidget* placeholder = tabs->widget(index);
+    if (!pendingTabs.contains(placeholder))
+        return;
+    const QJsonObject state = pendingTabs.value(placeholder);
+    const QStringList files = sessionFiles(state);
+    {
+        QMutexLocker locker(&indexQueueMutex);
+        for (const QString& f : files)
+            indexQueue.removeAll(f);
+        // A file being indexed right now would be indexed a second time
+        // here; the tab is loaded by onFileIndexed() once its cache is
+        // written, and the window stays responsive meanwhile
+        if (!indexingFile.isEmpty() && files.contains(indexingFile)) {
+            locker.unlock();
+            waitingTabs.insert(placeholder);
+            updatePlaceholder(placeholder);
+            return;
+        }
+    }
+
+    // The tab is inserted in front of its placeholder, which is removed
+    // once the tab has taken its place
+    const bool wasCurrent = (tabs->currentIndex() == index);
+    placeholder->setText(QString("Loading %1…").arg(tabs->tabText(index)));
+    loadingTab = true;
+    try {
+        TimelineTab* tab = createTab(files, index);
+        if (wasCurrent)
+            tabs->setCurrentWidget(tab);
+        tabs->removeTab(tabs->indexOf(placeholder));
+        pendingTabs.remove(placeholder);
+        placeholder->deleteLater();
+        loadingTab = false;
+        tab->restoreSessionState(state);
+    } catch (const std::exception& e) {
+        loadingTab = false;
+        pendingTabs.remove(placeholder);  // left as a closable error page
+        static_cast<QLabel*>(placeholder)->setText(
+            QString("Failed to load the timeline file: %1").arg(e.what()));
+    }
+    onTabChanged(tabs->currentIndex());
+    enforceMemoryBudget();
+}
+
+void AppWindow::startIndexing(const QStringList& files)
+{
+    {
+        QMutexLocker locker(&indexQueueMutex);
+        for (const QString& f : files) {
+            if (!indexQueue.contains(f) && !indexedFiles.contains(f))
+                indexQueue << f;
+        }
+    }
+    if (indexThread)
+        return;  // the running thread picks up the new files
+
+    // Opening a RowStore builds the line index and writes the index cache;
+    // the store itself is dropped, the tab loads the cache when shown
+    indexThread = QThread::create([this]() {
+        for (;;) {
+            QString file;
+            {
+                QMutexLocker locker(&indexQueueMutex);
+                if (indexQueue.isEmpty() || indexCancel)
+                    return;
+                file = indexQueue.takeFirst();
+                indexingFile = file;
+            }
+            bool indexed = true;
+            try {
+                RowStore store(file);
+                store.open([this](int) {
+                    if (indexCancel)
+                        throw std::runtime_error("Indexing cancelled");
+                });
+            } catch (const std::exception& e) {
+                qWarning() << "Session: background indexing of" << file << "failed:" << e.what();
+                indexed = false;
+            }
+            {
+                QMutexLocker locker(&indexQueueMutex);
+                indexingFile.clear();
+            }
+            QMetaObject::invokeMethod(this, [this, file, indexed]() { onFileIndexed(file, indexed); },
+                                      Qt::QueuedConnection);
+        }
+    });
+    connect(indexThread, &QThread::finished, this, [this]() {
+        indexThread->deleteLater();
+        indexThread = nullptr;
+    });
+    indexThread->start();
+}
+
+void AppWindow::onFileIndexed(const QString& file, bool indexed)
+{
+    if (indexed)
+        indexedFiles.insert(file);
+
+    // A tab selected while this file was being indexed loads now if it is
+    // still shown (on failure too, so that it reports the error itself)
+    const QList<QWidget*> waiting = waitingTabs.values();
+    for (QWidget* placeholder : waiting) {
+        if (!sessionFiles(pendingTabs.value(placeholder)).contains(file))
+            continue;
+        waitingTabs.remove(placeholder);
+        if (placeholder == tabs->currentWidget())
+            loadPendingTab(tabs->indexOf(placeholder));
+    }
+    for (auto it = pendingTabs.cbegin(); it != pendingTabs.cend(); ++it)
+        updatePlaceholder(it.key());
+}
+
+void AppWindow::updatePlaceholder(QWidget* placeholder)
+{
+    const QStringList files = sessionFiles(pendingTabs.value(placeholder));
+    int indexed = 0;
+    for (const QString& f : files)
+        indexed += indexedFiles.contains(f) ? 1 : 0;
+    const QString status = waitingTabs.contains(placeholder)
+        ? QString("Being indexed in the background; the tab loads as soon as it is done.")
+        : (indexed == files.size())
+        ? QString("Indexed; loads when selected.")
+        : QString("Waiting to be indexed in the background (%1 / %2 files done); "
+                  "select the tab to load it now.").arg(indexed).arg(files.size());
+    static_cast<QLabel*>(placeholder)->setText(QString("%1\n\n%2").arg(files.join("\n"), status));
+}
@@ -11,6 +11,14 @@
 #include <QLabel>
 #include <QDialogButtonBox>
 #include <QCloseEvent>
+#include <QTimer>
+#include <QList>
+#include <QHash>
+#include <QSet>
+#include <QMutex>
+#include <QThread>
+#include <QJsonObject>
+#include <atomic>
 
 class TimelineTab;
 
@@ -22,10 +30,17 @@ class AppWindow : public QMainWindow {
 public:
     AppWindow(QWidget* parent = nullptr);
     ~AppWindow();
+    // Reopens the tabs of the last session (see saveSession())
+    void restoreSession();
 
 private slots:
     void openFile();
+    void openMergedView();
+    void attachToServer();
     void saveFile();
+    void exportRows();
+    void exportTaggedRows();
+    void convertToAnalysisCache();
     void closeTab(int index);
     void closeCurrentTab();
     void increaseFontSize();
@@ -34,6 +49,13 @@ private slots:
     void searchInCurrentTab();
     void searchInAllTabs();
     void clearSearch();
+    void iocSweep();
+    void toggleFollow(bool enabled);
+    void showPerformance();
+    void groupDuplicates();
+    void toggleCollapseDuplicates(bool collapse);
+    void setMemoryBudget();
+    void enforceMemoryBudget();
     void onTabChanged(int index);
 
 protected:
@@ -42,20 +64,66 @@ protected:
 private:
     QTabWidget* tabs;
     QAction* openAction;
+    QAction* openMergedAction;
+    QAction* attachServerAction;
     QAction* saveAction;
+    QAction* exportAction;
+    QAction* exportTaggedAction;
+    QAction* convertAction;
     QAction* closeTabAction;
     QAction* exitAction;
     QAction* fontIncAction;
     QAction* fontDecAction;
     QAction* resetFontAction;
+    QAction* followAction;
+    QAction* performanceAction;
+    QAction* groupDuplicatesAction;
+    QAction* collapseDuplicatesAction;
+    QAction* memoryBudgetAction;
     QAction* searchCurrentTabAction;
     QAction* searchAllTabsAction;
     QAction* clearSearchAction;
+    QAction* iocSweepAction;
     void setupMenu();
     void applyFontAndLineHeight();
     int currentFontSize = 10;
     int currentLineHeight = 20;
     void showSearchDialog(bool allTabs);
+    void startExport(bool taggedOnly);
     bool checkUnsavedChanges();
     void updateWindowTitle();
+    void updateGroupingActions();
+    // Builds a tab for one file (or a merged view of several) and inserts it
+    // at index (-1 = last); throws like the TimelineTab constructors
+    TimelineTab* createTab(const QStringList& files, int index = -1);
+
+    // Session restore. Only the current tab is loaded at start; the others
+    // are placeholders, loaded when first shown. Meanwhile a background
+    // thread builds (and caches on disk) their line indexes, most recently
+    // used tab first, so that loading them later is quick.
+    void saveSession() const;
+    void loadPendingTab(int index);
+    void startIndexing(const QStringList& files);
+    void onFileIndexed(const QString& file, bool indexed);
+    void updatePlaceholder(QWidget* placeholder);
+    QHash<QWidget*, QJsonObject> pendingTabs;  // placeholder → saved tab state
+    bool loadingTab = false;                   // ignore tab changes while swapping widgets
+    QThread* indexThread = nullptr;
+    QMutex indexQueueMutex;
+    QStringList indexQueue;                    // files still to index, by priority
+    QString indexingFile;                      // file the thread is indexing now
+    QSet<QWidget*> waitingTabs;                // selected placeholders waiting for indexingFile
+    QSet<QString> indexedFiles;
+    std::atomic<bool> indexCancel{false};
+
+    // Process-wide memory budget over every tab's index, caches and derived
+    // columns. When it is exceeded, caches are released first, least
+    // recently used tab first, then the derived columns of inactive tabs.
+    static constexpr int MEMORY_CHECK_MS = 5000;
+    static constexpr qint64 DEFAULT_MEMORY_BUDGET = 4LL * 1024 * 1024 * 1024;  // if RAM size is unknown
+    qint64 memoryBudget = DEFAULT_MEMORY_BUDGET;
+    QLabel* memoryLabel;
+    QTimer* memoryTimer;
+    QList<TimelineTab*> tabUsage;  // least recently shown first
+    bool wasOverBudget = false;    // after the last check, for logging changes only
 }; 
\ No newline at end of file
@@ -6,13 +6,34 @@ FilterBar::FilterBar(QWidget* parent)
     columnPicker = new QComboBox(this);
     columnPicker->setToolTip("Select a column to search, or choose 'All Columns' to search the entire table.");
     input = new QLineEdit(this);
+    input->setClearButtonEnabled(true);
     searchButton = new QPushButton("Search", this);
+    matchLabel = new QLabel(this);
     QHBoxLayout* layout = new QHBoxLayout(this);
     layout->addWidget(columnPicker);
     layout->addWidget(input);
+    layout->addWidget(matchLabel);
     layout->addWidget(searchButton);
     setLayout(layout);
     connect(searchButton, &QPushButton::clicked, this, &FilterBar::onSearchClicked);
+    connect(input, &QLineEdit::returnPressed, this, &FilterBar::onSearchClicked);
+
+    // Every keystroke restarts the timer, so only the term the user pauses
+    // on is searched
+    debounceTimer = new QTimer(this);
+    debounceTimer->setSingleShot(true);
+    debounceTimer->setInterval(DEBOUNCE_MS);
+    connect(input, &QLineEdit::textEdited, this, [this]() {
+        if (liveSearch)
+            debounceTimer->start();
+    });
+    connect(columnPicker, &QComboBox::activated, this, [this]() {
+        if (liveSearch && !input->text().isEmpty())
+            debounceTimer->start();
+    });
+    connect(debounceTimer, &QTimer::timeout, this, [this]() {
+        emit liveSearchRequested(columnPicker->currentText(), input->text());
+    });
 }
 
 void FilterBar::setColumns(const QStringList& columns)
@@ -21,7 +42,31 @@ void FilterBar::setColumns(const QStringList& columns)
     columnPicker->addItems(columns);
 }
 
+bool FilterBar::setSearch(const QString& column, const QString& term)
+{
+    const int index = columnPicker->findText(column);
+    if (index < 0)
+        return false;
+    debounceTimer->stop();
+    columnPicker->setCurrentIndex(index);
+    input->setText(term);
+    return true;
+}
+
+void FilterBar::setLiveSearchEnabled(bool enabled)
+{
+    liveSearch = enabled;
+    if (!enabled)
+        debounceTimer->stop();
+}
+
+void FilterBar::setMatchStatus(const QString& text)
+{
+    matchLabel->setText(text);
+}
+
 void FilterBar::onSearchClicked()
 {
+    debounceTimer->stop();
     emit searchRequested(columnPicker->currentText(), input->text());
-} 
\ No newline at end of file
+}
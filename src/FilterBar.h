@@ -3,19 +3,30 @@
 #include <QComboBox>
 #include <QLineEdit>
 #include <QPushButton>
+#include <QLabel>
+#include <QTimer>
 #include <QHBoxLayout>
 
 /**
  * @brief FilterBar provides a UI for selecting a column and entering a search term.
+ *
+ * Typing emits liveSearchRequested() once the keystrokes pause; the Search
+ * button and Enter emit searchRequested() right away.
  */
 class FilterBar : public QWidget {
     Q_OBJECT
 public:
+    static constexpr int DEBOUNCE_MS = 80;  // pause in typing before a live search starts
+
     explicit FilterBar(QWidget* parent = nullptr);
     void setColumns(const QStringList& columns);
+    bool setSearch(const QString& column, const QString& term);  // false if the column is not listed
+    void setLiveSearchEnabled(bool enabled);  // off for views that cannot search in the background
+    void setMatchStatus(const QString& text);  // running match count next to the button
 
 signals:
     void searchRequested(const QString& column, const QString& term);
+    void liveSearchRequested(const QString& column, const QString& term);
     // Future: void fontSizeChanged(int pointSize);
     // Future: void lineHeightChanged(int px);
 
@@ -26,4 +37,7 @@ private:
     QComboBox* columnPicker;
     QLineEdit* input;
     QPushButton* searchButton;
-}; 
\ No newline at end of file
+    QLabel* matchLabel;
+    QTimer* debounceTimer;
+    bool liveSearch = true;
+};
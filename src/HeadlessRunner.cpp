@@ -0,0 +1,384 @@
+#include "HeadlessRunner.h"
+#include "core/RowStore.h"
+#include "core/AnalysisCache.h"
+#include "core/IoBackend.h"
+#include "core/FilterEngine.h"
+#include "core/TagStore.h"
+#include "utils/RangeExporter.h"
+#include <QCommandLineParser>
+#include <QJsonDocument>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QThread>
+#include <QDir>
+#include <QSet>
+#include <QDebug>
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <vector>
+#include <cstdio>
+
+namespace {
+
+// Rows in both ascending lists
+QVector<int> intersect(const QVector<int>& a, const QVector<int>& b)
+{
+    QVector<int> rows;
+    std::set_intersection(a.cbegin(), a.cend(), b.cbegin(), b.cend(), std::back_inserter(rows));
+    return rows;
+}
+
+} // namespace
+
+bool HeadlessRunner::isHeadlessInvocation(int argc, char* argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        const QString arg = QString::fromLocal8Bit(argv[i]);
+        if (arg == "--index" || arg.startsWith("--search") || arg.startsWith("--ioc")
+            || arg.startsWith("--export") || arg.startsWith("--convert"))
+            return true;
+    }
+    return false;
+}
+
+HeadlessRunner::HeadlessRunner(const QStringList& arguments)
+    : m_arguments(arguments)
+{
+}
+
+bool HeadlessRunner::parseArguments(QString& error)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Headless timeline indexing, search and export");
+    const QCommandLineOption indexOption("index", "Build (or refresh) the line index cache of each file.");
+    const QCommandLineOption searchOption("search", "Count rows containing <term> (case-insensitive).", "term");
+    const QCommandLineOption columnOption("column", "Restrict --search to one column.", "name");
+    const QCommandLineOption iocOption("ioc",
+        "Sweep for the indicators listed in <file>, one per line, in a single pass.", "file");
+    const QCommandLineOption exportOption("export",
+        "Write the matching rows (or the tagged rows, without --search or --ioc) of each file as CSV into <dir>.", "dir");
+    const QCommandLineOption convertOption("convert",
+        "Write an analysis cache (.tlac) of each file into <dir>; open it instead of the CSV for faster searches.", "dir");
+    const QCommandLineOption fromOption("from",
+        "Restrict --search, --ioc and --export to rows at or after <time> (ISO 8601, e.g. 2023-03-15T00:00:00).", "time");
+    const QCommandLineOption toOption("to", "Restrict them to rows at or before <time>.", "time");
+    const QCommandLineOption threadsOption("threads", "Worker threads (default: all cores).", "n");
+    const QCommandLineOption ioOption("io",
+        "How plain files are read: buffered, mmap or async (default: $TIMELINE_IO, else buffered).", "backend");
+    const QCommandLineOption debugOption("debug", "Enable debug logging.");
+    parser.addOptions({indexOption, searchOption, columnOption, iocOption, exportOption, convertOption, fromOption, toOption, threadsOption, ioOption, debugOption});
+    parser.addPositionalArgument("files", "Timeline files to process.", "<file>...");
+
+    if (!parser.parse(m_arguments)) {
+        error = parser.errorText();
+        return false;
+    }
+
+    m_files = parser.positionalArguments();
+    if (m_files.isEmpty()) {
+        error = "No timeline files given";
+        return false;
+    }
+    if (parser.isSet(searchOption)) {
+        m_term = parser.value(searchOption);
+        if (m_term.isEmpty()) {
+            error = "--search needs a non-empty term";
+            return false;
+        }
+    }
+    if (parser.isSet(columnOption))
+        m_column = parser.value(columnOption);
+    if (parser.isSet(iocOption)) {
+        if (!m_term.isEmpty()) {
+            error = "--search and --ioc cannot be combined";
+            return false;
+        }
+        try {
+            m_iocSweep = std::make_shared<const IocSweep>(IocSweep::loadPatterns(parser.value(iocOption)));
+        } catch (const std::exception& e) {
+            error = QString("--ioc: %1").arg(e.what());
+            return false;
+        }
+    }
+    if (parser.isSet(exportOption)) {
+        m_exportDir = parser.value(exportOption);
+        if (!QDir().mkpath(m_exportDir)) {
+            error = QString("Cannot create export directory %1").arg(m_exportDir);
+            return false;
+        }
+        m_exportPaths = outputPaths(m_exportDir, (m_term.isEmpty() && !m_iocSweep) ? ".tagged.csv" : ".hits.csv");
+    }
+    if (parser.isSet(convertOption)) {
+        m_convertDir = parser.value(convertOption);
+        if (!QDir().mkpath(m_convertDir)) {
+            error = QString("Cannot create cache directory %1").arg(m_convertDir);
+            return false;
+        }
+        m_cachePaths = outputPaths(m_convertDir, ".tlac");
+    }
+
+    for (const QCommandLineOption* option : {&fromOption, &toOption}) {
+        if (!parser.isSet(*option))
+            continue;
+        const qint64 time = TimelineParser::parseTimestamp(parser.value(*option).toUtf8());
+        if (time == TimelineParser::INVALID_TIMESTAMP) {
+            error = QString("--%1 needs a time such as 2023-03-15T00:00:00").arg(option->names().first());
+            return false;
+        }
+        (option == &fromOption ? m_from : m_to) = time;
+        m_hasTimeRange = true;
+    }
+
+    if (parser.isSet(ioOption)) {
+        IoBackend::Kind kind = IoBackend::Buffered;
+        if (!IoBackend::parseKind(parser.value(ioOption), &kind)) {
+            error = "--io needs buffered, mmap or async";
+            return false;
+        }
+        IoBackend::setDefaultKind(kind);
+    }
+
+    m_threads = QThread::idealThreadCount();
+    if (parser.isSet(threadsOption)) {
+        bool ok = false;
+        m_threads = parser.value(threadsOption).toInt(&ok);
+        if (!ok || m_threads < 1) {
+            error = "--threads needs a positive number";
+            return false;
+        }
+    }
+    const int requested = m_threads;
+    m_threads = qMax(1, qMin(m_threads, static_cast<int>(m_files.size())));
+    m_sweepThreads = qMax(1, requested / m_threads);
+    return true;
+}
+
+QStringList HeadlessRunner::outputPaths(const QString& dir, const QString& suffix) const
+{
+    // e.g. <name>.hits.csv; same-named inputs from different directories
+    // get a numeric suffix instead of overwriting each other.
+    QStringList paths;
+    QSet<QString> used;
+    for (const QString& path : m_files) {
+        QString name = QFileInfo(path).fileName();
+        if (name.endsWith(".gz"))
+            name.chop(3);
+        else if (name.endsWith(".zst"))
+            name.chop(4);
+        else if (name.endsWith(".tlac"))
+            name.chop(5);
+        name = QFileInfo(name).completeBaseName();
+        QString candidate = name;
+        for (int n = 2; used.contains(candidate); ++n)
+            candidate = QString("%1-%2").arg(name).arg(n);
+        used.insert(candidate);
+        paths << QDir(dir).filePath(candidate + suffix);
+    }
+    return paths;
+}
+
+int HeadlessRunner::exec()
+{
+    QString error;
+    if (!parseArguments(error)) {
+        fprintf(stderr, "%s\n", error.toLocal8Bit().constData());
+        fprintf(stderr, "Usage: LinuxTimelineViewer [--index] [--search <term> [--column <name>] | --ioc <file>] "
+                        "[--export <dir>] [--convert <dir>] [--from <time>] [--to <time>] [--threads <n>] [--io <backend>] <file>...\n");
+        return 2;
+    }
+
+    QElapsedTimer wallTimer;
+    wallTimer.start();
+    std::vector<FileResult> results(m_files.size());
+    std::atomic<int> nextFile{0};
+
+    // Each worker pulls the next file until none are left, so a few very
+    // large timelines do not leave the other cores idle.
+    QVector<QThread*> workers;
+    for (int t = 0; t < m_threads; ++t) {
+        workers << QThread::create([this, &results, &nextFile]() {
+            for (int i = nextFile++; i < m_files.size(); i = nextFile++) {
+                results[i] = processFile(i);
+                printJson(toJson(results[i]));
+            }
+        });
+        workers.last()->start();
+    }
+    for (QThread* worker : workers) {
+        worker->wait();
+        delete worker;
+    }
+
+    qint64 bytes = 0, rows = 0, matches = 0, exported = 0;
+    int failed = 0;
+    for (const FileResult& r : results) {
+        if (!r.error.isEmpty()) {
+            ++failed;
+            continue;
+        }
+        bytes += r.bytes;
+        rows += r.rows;
+        matches += qMax(0, r.matches);
+        exported += qMax(0, r.exported);
+    }
+    const qint64 wallMs = qMax<qint64>(1, wallTimer.elapsed());
+    QJsonObject summary;
+    summary["summary"] = true;
+    summary["files"] = static_cast<int>(m_files.size());
+    summary["failed"] = failed;
+    summary["threads"] = m_threads;
+    summary["bytes"] = bytes;
+    summary["rows"] = rows;
+    if (!m_term.isEmpty() || m_iocSweep)
+        summary["matches"] = matches;
+    if (!m_exportDir.isEmpty())
+        summary["exported"] = exported;
+    summary["wall_ms"] = wallMs;
+    summary["rows_per_sec"] = rows * 1000.0 / wallMs;
+    summary["mb_per_sec"] = bytes / 1048576.0 * 1000.0 / wallMs;
+    printJson(summary);
+    return failed == 0 ? 0 : 1;
+}
+
+HeadlessRunner::FileResult HeadlessRunner::processFile(int fileIndex) const
+{
+    FileResult result;
+    result.path = m_files[fileIndex];
+    QElapsedTimer timer;
+    timer.start();
+    try {
+        // Opening the store builds (or loads) the line index and saves the
+        // index cache, which is all --index needs.
+        RowStore store(result.path);
+        store.open();
+        result.bytes = QFileInfo(result.path).size();
+        result.rows = store.rowCount();
+        result.indexMs = timer.elapsed();
+
+        // Rows in the --from/--to range; an analysis cache skips the blocks
+        // outside it
+        QVector<int> timeRows;
+        if (m_hasTimeRange) {
+            timeRows = store.rowsInTimeRange(m_from, m_to);
+            result.inTimeRange = timeRows.size();
+        }
+        auto inTimeRange = [&](int row) {
+            return !m_hasTimeRange || std::binary_search(timeRows.cbegin(), timeRows.cend(), row);
+        };
+
+        QVector<int> matches;
+        if (!m_term.isEmpty()) {
+            const int column = m_column == "All Columns" ? -1 : store.headers().indexOf(m_column);
+            if (m_column != "All Columns" && column < 0) {
+                result.error = QString("No column named '%1'").arg(m_column);
+                return result;
+            }
+            timer.restart();
+            matches = FilterEngine(column, m_term).scan(store, m_sweepThreads);
+            if (m_hasTimeRange)
+                matches = intersect(matches, timeRows);
+            result.matches = matches.size();
+            result.searchMs = timer.elapsed();
+        } else if (m_iocSweep) {
+            timer.restart();
+            const QVector<IocSweep::Hit> hits = m_iocSweep->scan(store, m_sweepThreads);
+            QVector<int> rowsPerPattern(m_iocSweep->patternCount(), 0);
+            for (const IocSweep::Hit& hit : hits) {
+                if (!inTimeRange(hit.row))
+                    continue;
+                matches.append(hit.row);
+                for (int id : hit.patterns)
+                    ++rowsPerPattern[id];
+            }
+            for (int id = 0; id < rowsPerPattern.size(); ++id) {
+                if (rowsPerPattern[id] > 0)
+                    result.iocHits[m_iocSweep->patternText(id)] = rowsPerPattern[id];
+            }
+            result.matches = matches.size();
+            result.searchMs = timer.elapsed();
+        }
+
+        if (!m_exportDir.isEmpty()) {
+            timer.restart();
+            QVector<int> rows = matches;
+            if (m_term.isEmpty() && !m_iocSweep) {
+                TagStore tags(result.path);
+                tags.load(store.rowCount());
+                rows = tags.sortedRows();
+                if (m_hasTimeRange)
+                    rows = intersect(rows, timeRows);
+            }
+            result.exported = exportRows(store, rows, m_exportPaths[fileIndex], result.error);
+            result.exportMs = timer.elapsed();
+        }
+
+        if (!m_convertDir.isEmpty() && result.error.isEmpty()) {
+            timer.restart();
+            const std::atomic<bool> cancel{false};
+            result.cachePath = m_cachePaths[fileIndex];
+            AnalysisCache::convert(store, result.cachePath, cancel);
+            result.convertMs = timer.elapsed();
+        }
+    } catch (const std::exception& e) {
+        result.error = QString::fromUtf8(e.what());
+    }
+    return result;
+}
+
+int HeadlessRunner::exportRows(const RowStore& store, const QVector<int>& rows,
+                               const QString& outPath, QString& error) const
+{
+    const QString sourcePath = store.exportSourcePath();
+    if (sourcePath.isEmpty()) {
+        error = "The CSV this analysis cache was converted from has been moved or changed";
+        return -1;
+    }
+    RangeExporter exporter(sourcePath, store.exportSpans(rows), outPath);
+    if (!exporter.run()) {
+        error = exporter.errorString();
+        return -1;
+    }
+    return static_cast<int>(rows.size());
+}
+
+void HeadlessRunner::printJson(const QJsonObject& object)
+{
+    const QByteArray json = QJsonDocument(object).toJson(QJsonDocument::Compact);
+    QMutexLocker locker(&m_outputMutex);
+    fwrite(json.constData(), 1, json.size(), stdout);
+    fputc('\n', stdout);
+    fflush(stdout);
+}
+
+QJsonObject HeadlessRunner::toJson(const FileResult& result)
+{
+    QJsonObject object;
+    object["file"] = result.path;
+    if (!result.error.isEmpty()) {
+        object["error"] = result.error;
+        return object;
+    }
+    object["bytes"] = result.bytes;
+    object["rows"] = result.rows;
+    object["index_ms"] = result.indexMs;
+    object["index_mb_per_sec"] = result.bytes / 1048576.0 * 1000.0 / qMax<qint64>(1, result.indexMs);
+    if (result.inTimeRange >= 0)
+        object["rows_in_time_range"] = result.inTimeRange;
+    if (result.matches >= 0) {
+        object["matches"] = result.matches;
+        object["search_ms"] = result.searchMs;
+        object["search_rows_per_sec"] = result.rows * 1000.0 / qMax<qint64>(1, result.searchMs);
+        if (!result.iocHits.isEmpty())
+            object["ioc_hits"] = result.iocHits;
+    }
+    if (result.exported >= 0) {
+        object["exported"] = result.exported;
+        object["export_ms"] = result.exportMs;
+    }
+    if (result.convertMs >= 0) {
+        object["cache"] = result.cachePath;
+        object["convert_ms"] = result.convertMs;
+    }
+    return object;
+}
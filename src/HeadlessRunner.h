@@ -0,0 +1,71 @@
+#pragma once
+#include <QString>
+#include <QStringList>
+#include <QJsonObject>
+#include <QMutex>
+#include <QVector>
+#include <memory>
+#include <limits>
+#include "core/IocSweep.h"
+
+class RowStore;
+
+/**
+ * @brief HeadlessRunner drives the timeline_core engine from the command line, without a GUI.
+ *
+ * Files are processed in parallel, one RowStore per worker thread. Each
+ * finished file is reported as one JSON object per line on stdout, followed
+ * by a summary object.
+ */
+class HeadlessRunner {
+public:
+    // True if the arguments ask for a headless job (--index, --search, --ioc,
+    // --export, --convert)
+    static bool isHeadlessInvocation(int argc, char* argv[]);
+
+    explicit HeadlessRunner(const QStringList& arguments);
+    int exec();
+
+private:
+    struct FileResult {
+        QString path;
+        qint64 bytes = 0;
+        int rows = 0;
+        qint64 indexMs = 0;
+        qint64 searchMs = -1;
+        int matches = -1;
+        int inTimeRange = -1;
+        QJsonObject iocHits;  // indicator → rows hit
+        qint64 exportMs = -1;
+        int exported = -1;
+        qint64 convertMs = -1;
+        QString cachePath;
+        QString error;
+    };
+
+    QStringList m_arguments;
+    QStringList m_files;
+    QStringList m_exportPaths;  // one output file per input when exporting
+    QString m_convertDir;
+    QStringList m_cachePaths;   // one analysis cache per input when converting
+    QString m_term;
+    QString m_column = "All Columns";
+    QString m_exportDir;
+    // --from/--to, in microseconds since the epoch
+    bool m_hasTimeRange = false;
+    qint64 m_from = std::numeric_limits<qint64>::min();
+    qint64 m_to = std::numeric_limits<qint64>::max();
+    std::shared_ptr<const IocSweep> m_iocSweep;
+    int m_sweepThreads = 1;  // per file for --search and --ioc, so all cores are busy when there are few files
+    int m_threads = 1;
+    QMutex m_outputMutex;
+
+    bool parseArguments(QString& error);
+    // <dir>/<name><suffix> per input file, unique among the inputs
+    QStringList outputPaths(const QString& dir, const QString& suffix) const;
+    FileResult processFile(int fileIndex) const;
+    int exportRows(const RowStore& store, const QVector<int>& rows,
+                   const QString& outPath, QString& error) const;
+    void printJson(const QJsonObject& object);
+    static QJsonObject toJson(const FileResult& result);
+};
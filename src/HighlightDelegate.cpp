@@ -0,0 +1,66 @@
+#include "HighlightDelegate.h"
+#include "TimelineModel.h"
+#include <QApplication>
+#include <QPainter>
+#include <QTextLayout>
+
+HighlightDelegate::HighlightDelegate(QObject* parent)
+    : QStyledItemDelegate(parent)
+{
+}
+
+void HighlightDelegate::paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const
+{
+    const QList<int> spans = index.data(TimelineModel::MatchSpansRole).value<QList<int>>();
+    if (spans.isEmpty()) {
+        QStyledItemDelegate::paint(painter, option, index);
+        return;
+    }
+
+    // Background, selection and focus as usual, then the text on top
+    QStyleOptionViewItem opt = option;
+    initStyleOption(&opt, index);
+    const QString text = opt.text;
+    opt.text.clear();
+    const QWidget* widget = opt.widget;
+    QStyle* style = widget ? widget->style() : QApplication::style();
+    style->drawControl(QStyle::CE_ItemViewItem, &opt, painter, widget);
+
+    // Same text margins and eliding as QCommonStyle uses for item views
+    const int margin = style->pixelMetric(QStyle::PM_FocusFrameHMargin, nullptr, widget) + 1;
+    const QRect textRect = style->subElementRect(QStyle::SE_ItemViewItemText, &opt, widget)
+                               .adjusted(margin, 0, -margin, 0);
+    const QString shown = opt.fontMetrics.elidedText(text, Qt::ElideRight, textRect.width());
+    const int visibleChars = (shown == text) ? text.size() : shown.size() - 1;  // minus the ellipsis
+
+    QVector<QTextLayout::FormatRange> ranges;
+    for (int i = 0; i + 1 < spans.size(); i += 2) {
+        if (spans[i] < 0 || spans[i] >= visibleChars)
+            continue;  // spans may overlap and are not always in order
+        QTextLayout::FormatRange range;
+        range.start = spans[i];
+        range.length = qMin(spans[i + 1], visibleChars - spans[i]);
+        range.format.setBackground(highlightColor);
+        range.format.setForeground(QColor(Qt::black));
+        ranges.append(range);
+    }
+
+    QTextLayout layout(shown, opt.font);
+    QTextOption textOption;
+    textOption.setWrapMode(QTextOption::NoWrap);
+    textOption.setTextDirection(opt.direction);
+    layout.setTextOption(textOption);
+    layout.setFormats(ranges);
+    layout.beginLayout();
+    QTextLine line = layout.createLine();
+    line.setLineWidth(textRect.width());
+    layout.endLayout();
+
+    const bool selected = opt.state & QStyle::State_Selected;
+    const QPalette::ColorGroup group = (opt.state & QStyle::State_Enabled) ? QPalette::Normal : QPalette::Disabled;
+    painter->save();
+    painter->setClipRect(textRect);
+    painter->setPen(opt.palette.color(group, selected ? QPalette::HighlightedText : QPalette::Text));
+    layout.draw(painter, QPointF(textRect.left(), textRect.top() + (textRect.height() - line.height()) / 2));
+    painter->restore();
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include <QStyledItemDelegate>
+#include <QColor>
+
+/**
+ * @brief HighlightDelegate paints cells with the search term's matches highlighted.
+ *
+ * Match spans come from the model's TimelineModel::MatchSpansRole, which
+ * computes them once per cell and caches them; cells without spans are
+ * painted by QStyledItemDelegate unchanged.
+ */
+class HighlightDelegate : public QStyledItemDelegate {
+    Q_OBJECT
+public:
+    explicit HighlightDelegate(QObject* parent = nullptr);
+    void paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+
+private:
+    QColor highlightColor{255, 226, 84};
+};
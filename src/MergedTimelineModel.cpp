@@ -0,0 +1,342 @@
+#include "MergedTimelineModel.h"
+#include "core/RowChunk.h"
+#include "core/TimelineParser.h"
+#include <QFileInfo>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <queue>
+#include <vector>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+
+MergedTimelineModel::MergedTimelineModel(const QStringList& filePaths, QObject* parent)
+    : QAbstractTableModel(parent)
+{
+    if (filePaths.size() < 2)
+        throw std::runtime_error("A merged view needs at least two timeline files");
+    if (filePaths.size() > MAX_SOURCES)
+        throw std::runtime_error("Too many files for one merged view (limit 255)");
+
+    for (const QString& path : filePaths) {
+        TimelineModel* source = new TimelineModel(path, this);
+        connect(source, &TimelineModel::searchProgress, this, &MergedTimelineModel::searchProgress);
+        m_sources.append(source);
+        m_originNames.append(QFileInfo(path).fileName());
+    }
+    // Merged rows are addressed by int; the sources are deleted with this
+    // object as their parent
+    qint64 total = 0;
+    for (TimelineModel* source : m_sources)
+        total += source->totalRowCount();
+    if (total > std::numeric_limits<int>::max())
+        throw std::runtime_error("Too many rows for one merged view (limit 2147483647)");
+
+    // Column set: origin, then every source column by name in first-seen order
+    m_headers << "origin";
+    for (TimelineModel* source : m_sources) {
+        for (int c = 0; c < source->columnCount(); ++c) {
+            const QString name = source->headerData(c, Qt::Horizontal, Qt::DisplayRole).toString();
+            if (!m_headers.contains(name))
+                m_headers << name;
+        }
+    }
+    for (TimelineModel* source : m_sources) {
+        QVector<int> map(m_headers.size(), -1);
+        for (int c = 1; c < m_headers.size(); ++c)
+            map[c] = source->columnIndex(m_headers[c]);
+        m_columnMap.append(map);
+    }
+
+    startMerge();
+}
+
+MergedTimelineModel::~MergedTimelineModel()
+{
+    if (m_mergeThread) {
+        m_mergeThread->requestInterruption();
+        m_mergeThread->wait();
+        delete m_mergeThread;
+    }
+}
+
+void MergedTimelineModel::startMerge()
+{
+    const QVector<TimelineModel*> sources = m_sources;
+    m_mergeThread = QThread::create([this, sources]() {
+        QElapsedTimer timer;
+        timer.start();
+        const int k = sources.size();
+        int total = 0;  // fits in an int, as checked in the constructor
+        for (TimelineModel* source : sources)
+            total += source->totalRowCount();
+
+        QVector<quint8> origin;
+        origin.reserve(total);
+        QVector<quint32> blockCounts;
+        blockCounts.reserve((total / BLOCK_SIZE + 1) * k);
+        QVector<quint32> taken(k, 0);
+
+        // Min-heap of (timestamp, source); equal timestamps keep file order.
+        // Each file is already chronological, so only its next row competes.
+        using Head = std::pair<qint64, int>;
+        std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heap;
+        // Each file's timestamps are parsed MERGE_CHUNK_ROWS rows at a time
+        // from one read, since the merge walks every file in order. Analysis
+        // caches have them parsed already.
+        struct Cursor {
+            int first = 0;
+            QVector<qint64> stamps;  // of rows [first, first + stamps.size())
+        };
+        QVector<Cursor> cursors(k);
+        RowChunk chunk;
+        auto timestampAt = [&](int s, int row) -> qint64 {
+            TimelineModel* source = sources[s];
+            if (source->isAnalysisCache())
+                return source->rowTimestamp(row);
+            Cursor& cursor = cursors[s];
+            if (row < cursor.first || row >= cursor.first + cursor.stamps.size()) {
+                cursor.first = row;
+                cursor.stamps.clear();
+                source->decodeRows(row, qMin(source->totalRowCount(), row + MERGE_CHUNK_ROWS), chunk);
+                for (int r = 0; r < chunk.rowCount(); ++r) {
+                    const QByteArrayView field = chunk.field(r, 0);
+                    cursor.stamps.append(chunk.isValid(r)
+                        ? TimelineParser::parseTimestamp(QByteArray::fromRawData(field.data(), field.size()))
+                        : source->rowTimestamp(chunk.firstRow() + r));
+                }
+                if (cursor.stamps.isEmpty())
+                    return source->rowTimestamp(row);
+            }
+            return cursor.stamps[row - cursor.first];
+        };
+        for (int s = 0; s < k; ++s) {
+            if (sources[s]->totalRowCount() > 0)
+                heap.push({timestampAt(s, 0), s});
+        }
+
+        while (!heap.empty()) {
+            if (origin.size() % BLOCK_SIZE == 0) {
+                blockCounts += taken;
+                if (QThread::currentThread()->isInterruptionRequested())
+                    return;
+                if (origin.size() % (BLOCK_SIZE * 256) == 0)
+                    emit mergeProgress(origin.size(), total);
+            }
+            const int s = heap.top().second;
+            heap.pop();
+            origin.append(static_cast<quint8>(s));
+            const quint32 next = ++taken[s];
+            if (static_cast<int>(next) < sources[s]->totalRowCount())
+                heap.push({timestampAt(s, static_cast<int>(next)), s});
+        }
+
+        qDebug() << "MergedTimelineModel: merged" << origin.size() << "rows from" << k
+                 << "files in" << timer.elapsed() << "ms";
+        QMetaObject::invokeMethod(this, [this, origin, blockCounts]() {
+            beginResetModel();
+            m_origin = origin;
+            m_blockCounts = blockCounts;
+            endResetModel();
+            emit mergeFinished(m_origin.size());
+        }, Qt::QueuedConnection);
+    });
+    m_mergeThread->start();
+}
+
+bool MergedTimelineModel::isMerged() const
+{
+    return m_mergeThread && m_mergeThread->isFinished() && !m_origin.isEmpty();
+}
+
+bool MergedTimelineModel::locate(int mergedRow, int& source, int& sourceRow) const
+{
+    if (mergedRow < 0 || mergedRow >= m_origin.size())
+        return false;
+    // Start from the block's per-source count and count matching origins
+    // up to the row; at most BLOCK_SIZE bytes are scanned.
+    source = m_origin[mergedRow];
+    const int block = mergedRow / BLOCK_SIZE;
+    int count = static_cast<int>(m_blockCounts[block * m_sources.size() + source]);
+    for (int r = block * BLOCK_SIZE; r < mergedRow; ++r) {
+        if (m_origin[r] == source)
+            ++count;
+    }
+    sourceRow = count;
+    return true;
+}
+
+int MergedTimelineModel::toMergedRow(int viewRow) const
+{
+    if (m_isFiltered && viewRow >= 0 && viewRow < m_filteredRows.size())
+        return m_filteredRows[viewRow];
+    return viewRow;
+}
+
+int MergedTimelineModel::rowCount(const QModelIndex&) const
+{
+    return m_isFiltered ? m_filteredRows.size() : m_origin.size();
+}
+
+int MergedTimelineModel::columnCount(const QModelIndex&) const
+{
+    return m_headers.size();
+}
+
+QVariant MergedTimelineModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || (role != Qt::DisplayRole && role != TimelineModel::FullTextRole))
+        return QVariant();
+
+    int source = 0, sourceRow = 0;
+    if (!locate(toMergedRow(index.row()), source, sourceRow))
+        return QVariant();
+    if (index.column() == 0)
+        return m_originNames[source];
+
+    const int column = m_columnMap[source].value(index.column(), -1);
+    if (column < 0)
+        return QVariant();
+    if (role == TimelineModel::FullTextRole)
+        return m_sources[source]->fullCellText(sourceRow, column);
+    return m_sources[source]->cellText(sourceRow, column);
+}
+
+QStringList MergedTimelineModel::fullRowText(int viewRow, const QVector<int>& columns) const
+{
+    QStringList values;
+    int source = 0, sourceRow = 0;
+    if (!locate(toMergedRow(viewRow), source, sourceRow)) {
+        for (int i = 0; i < columns.size(); ++i)
+            values << QString();
+        return values;
+    }
+
+    QVector<int> sourceColumns;
+    for (int column : columns) {
+        const int sourceColumn = column == 0 ? -1 : m_columnMap[source].value(column, -1);
+        if (sourceColumn >= 0)
+            sourceColumns.append(sourceColumn);
+    }
+    const QStringList sourceValues = m_sources[source]->fullRowText(sourceRow, sourceColumns);
+    int next = 0;
+    for (int column : columns) {
+        if (column == 0)
+            values << m_originNames[source];
+        else if (m_columnMap[source].value(column, -1) >= 0)
+            values << sourceValues.value(next++);
+        else
+            values << QString();
+    }
+    return values;
+}
+
+QString MergedTimelineModel::formattedData(const QModelIndex& index) const
+{
+    int source = 0, sourceRow = 0;
+    if (!index.isValid() || !locate(toMergedRow(index.row()), source, sourceRow))
+        return QString();
+    if (index.column() == 0)
+        return m_sources[source]->getFilePath();
+
+    const int column = m_columnMap[source].value(index.column(), -1);
+    return column < 0 ? QString() : m_sources[source]->formattedCell(sourceRow, column);
+}
+
+QVariant MergedTimelineModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (role != Qt::DisplayRole || orientation != Qt::Horizontal)
+        return QVariant();
+    if (section < 0 || section >= m_headers.size())
+        return QVariant();
+    return m_headers[section];
+}
+
+QStringList MergedTimelineModel::filePaths() const
+{
+    QStringList paths;
+    for (TimelineModel* source : m_sources)
+        paths << source->getFilePath();
+    return paths;
+}
+
+qint64 MergedTimelineModel::memoryBytes() const
+{
+    qint64 bytes = m_origin.capacity()
+                 + m_blockCounts.capacity() * static_cast<qint64>(sizeof(quint32))
+                 + m_filteredRows.capacity() * static_cast<qint64>(sizeof(int));
+    for (const TimelineModel* source : m_sources)
+        bytes += source->memoryBytes();
+    return bytes;
+}
+
+qint64 MergedTimelineModel::releaseCaches()
+{
+    qint64 freed = 0;
+    for (TimelineModel* source : m_sources)
+        freed += source->releaseCaches();
+    return freed;
+}
+
+int MergedTimelineModel::filteredRowCount() const
+{
+    return m_isFiltered ? m_filteredRows.size() : -1;
+}
+
+void MergedTimelineModel::clearFilter()
+{
+    if (!m_isFiltered)
+        return;
+    for (TimelineModel* source : m_sources)
+        source->clearFilter();
+    beginResetModel();
+    m_filteredRows.clear();
+    m_isFiltered = false;
+    endResetModel();
+}
+
+void MergedTimelineModel::applyFilter(const QString& column, const QString& term)
+{
+    if (term.isEmpty()) {
+        clearFilter();
+        return;
+    }
+
+    // Each source scans its own file; its hits (ascending source rows) are
+    // then matched against the merged order in a single pass.
+    const int k = m_sources.size();
+    const bool originColumn = (column == m_headers.first());
+    QVector<const QVector<int>*> hits(k, nullptr);
+    QVector<bool> wholeSource(k, false);
+    for (int s = 0; s < k; ++s) {
+        if (originColumn) {
+            wholeSource[s] = m_originNames[s].contains(term, Qt::CaseInsensitive);
+        } else if (column == "All Columns" || m_sources[s]->columnIndex(column) >= 0) {
+            m_sources[s]->applyFilter(column, term);
+            hits[s] = &m_sources[s]->filteredSourceRows();
+        }
+    }
+
+    QVector<int> matches;
+    QVector<int> cursor(k, 0);
+    QVector<int> taken(k, 0);
+    for (int r = 0; r < m_origin.size(); ++r) {
+        const int s = m_origin[r];
+        const int sourceRow = taken[s]++;
+        bool match = wholeSource[s];
+        if (!match && hits[s]) {
+            const QVector<int>& h = *hits[s];
+            int& c = cursor[s];
+            while (c < h.size() && h[c] < sourceRow)
+                ++c;
+            match = (c < h.size() && h[c] == sourceRow);
+        }
+        if (match)
+            matches.append(r);
+    }
+
+    beginResetModel();
+    m_filteredRows = matches;
+    m_isFiltered = true;
+    endResetModel();
+}
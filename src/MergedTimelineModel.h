@@ -0,0 +1,69 @@
+#pragma once
+#include <QAbstractTableModel>
+#include <QStringList>
+#include <QVector>
+#include <QThread>
+#include "TimelineModel.h"
+
+/**
+ * @brief MergedTimelineModel interleaves several timeline files chronologically.
+ *
+ * Each file keeps its own TimelineModel (and line index). A background k-way
+ * merge over the first-column timestamps produces the merged order, stored as
+ * one origin byte per row plus per-block source counts; rows are read from
+ * the source files on demand, so nothing is copied.
+ */
+class MergedTimelineModel : public QAbstractTableModel {
+    Q_OBJECT
+public:
+    static constexpr int MAX_SOURCES = 255;
+
+    // Throws std::runtime_error for fewer than two or more than MAX_SOURCES
+    // files, or when they hold more rows than an int can count
+    explicit MergedTimelineModel(const QStringList& filePaths, QObject* parent = nullptr);
+    ~MergedTimelineModel();
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    QString formattedData(const QModelIndex& index) const;
+    // Untruncated values of several cells of one view row, in the order
+    // given; the source row is read once
+    QStringList fullRowText(int viewRow, const QVector<int>& columns) const;
+    QStringList filePaths() const;
+    bool isMerged() const; // false while the background merge is running
+
+    // Filter (search) — delegates to each source's scan, then maps the hits
+    void applyFilter(const QString& column, const QString& term);
+    void clearFilter();
+    int  filteredRowCount() const; // -1 when no filter is active
+
+    // Memory budget (see AppWindow): the merged order plus the memory of
+    // every source; releaseCaches() returns the bytes freed
+    qint64 memoryBytes() const;
+    qint64 releaseCaches();
+
+signals:
+    void mergeProgress(int rowsMerged, int totalRows);
+    void mergeFinished(int totalRows);
+    void searchProgress(int linesScanned, int totalLines);
+
+private:
+    static constexpr int BLOCK_SIZE = 1024; // merged rows per source-count checkpoint
+    static constexpr int MERGE_CHUNK_ROWS = 4096;  // rows per source decoded at once while merging
+
+    QVector<TimelineModel*> m_sources;
+    QStringList m_originNames;          // file name shown in the origin column
+    QStringList m_headers;              // "origin" + union of source columns
+    QVector<QVector<int>> m_columnMap;  // [source][merged column] → source column, -1 if absent
+    QVector<quint8> m_origin;           // source index of each merged row
+    QVector<quint32> m_blockCounts;     // [block * sources + s] → rows of s before the block
+    QThread* m_mergeThread = nullptr;
+
+    QVector<int> m_filteredRows;        // merged rows matching the current search
+    bool m_isFiltered = false;
+
+    void startMerge();
+    bool locate(int mergedRow, int& source, int& sourceRow) const;
+    int toMergedRow(int viewRow) const;
+};
@@ -0,0 +1,91 @@
+#include "PerformanceDialog.h"
+#include "TimelineModel.h"
+#include <QVBoxLayout>
+#include <QPushButton>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMessageBox>
+#include <QFont>
+#include <QScrollBar>
+
+PerformanceDialog::PerformanceDialog(TimelineModel* model, QWidget* parent)
+    : QDialog(parent), model(model)
+{
+    setWindowTitle(QString("Performance: %1").arg(QFileInfo(model->getFilePath()).fileName()));
+    setModal(false);
+    resize(640, 420);
+    setupUI();
+
+    refreshTimer = new QTimer(this);
+    refreshTimer->setInterval(REFRESH_MS);
+    connect(refreshTimer, &QTimer::timeout, this, &PerformanceDialog::refresh);
+    refreshTimer->start();
+    refresh();
+}
+
+void PerformanceDialog::setupUI()
+{
+    QVBoxLayout* layout = new QVBoxLayout(this);
+    titleLabel = new QLabel(model->getFilePath(), this);
+    titleLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    layout->addWidget(titleLabel);
+
+    reportEdit = new QPlainTextEdit(this);
+    reportEdit->setReadOnly(true);
+    reportEdit->setLineWrapMode(QPlainTextEdit::NoWrap);
+    QFont monoFont("Consolas, Monaco, monospace");
+    monoFont.setStyleHint(QFont::Monospace);
+    reportEdit->setFont(monoFont);
+    layout->addWidget(reportEdit);
+
+    QDialogButtonBox* buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    QPushButton* resetButton = buttonBox->addButton("Reset Counters", QDialogButtonBox::ResetRole);
+    QPushButton* saveButton = buttonBox->addButton("Save JSON...", QDialogButtonBox::ActionRole);
+    connect(resetButton, &QPushButton::clicked, this, &PerformanceDialog::resetCounters);
+    connect(saveButton, &QPushButton::clicked, this, &PerformanceDialog::saveJson);
+    connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    layout->addWidget(buttonBox);
+    setLayout(layout);
+}
+
+void PerformanceDialog::refresh()
+{
+    const QJsonObject memory = model->metricsSnapshot()["memory_bytes"].toObject();
+    QString text = model->metrics().summary();
+    text += "\n\nMemory held:\n";
+    qint64 total = 0;
+    for (auto it = memory.begin(); it != memory.end(); ++it) {
+        const qint64 bytes = it.value().toInteger();
+        total += bytes;
+        text += QString("  %1 %2 MB\n").arg(it.key() + ':', -18).arg(bytes / 1048576.0, 8, 'f', 2);
+    }
+    text += QString("  %1 %2 MB\n").arg(QString("total:"), -18).arg(total / 1048576.0, 8, 'f', 2);
+
+    // Keep the scroll position while the report updates
+    const int scroll = reportEdit->verticalScrollBar()->value();
+    reportEdit->setPlainText(text);
+    reportEdit->verticalScrollBar()->setValue(scroll);
+}
+
+void PerformanceDialog::resetCounters()
+{
+    model->metrics().resetCounters();
+    refresh();
+}
+
+void PerformanceDialog::saveJson()
+{
+    const QString path = QFileDialog::getSaveFileName(
+        this, "Save Performance Metrics", QFileInfo(model->getFilePath()).completeBaseName() + "-metrics.json",
+        "JSON Files (*.json)", nullptr, QFileDialog::DontUseNativeDialog);
+    if (path.isEmpty())
+        return;
+    QFile out(path);
+    if (!out.open(QIODevice::WriteOnly)
+        || out.write(QJsonDocument(model->metricsSnapshot()).toJson(QJsonDocument::Indented)) < 0) {
+        QMessageBox::warning(this, "Save Error", "Failed to write the metrics file.");
+    }
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <QDialog>
+#include <QPlainTextEdit>
+#include <QLabel>
+#include <QTimer>
+#include <QDialogButtonBox>
+
+class TimelineModel;
+
+/**
+ * @brief PerformanceDialog shows a tab's live engine metrics and saves them as JSON.
+ */
+class PerformanceDialog : public QDialog {
+    Q_OBJECT
+public:
+    explicit PerformanceDialog(TimelineModel* model, QWidget* parent = nullptr);
+
+private slots:
+    void refresh();
+    void resetCounters();
+    void saveJson();
+
+private:
+    static constexpr int REFRESH_MS = 1000;
+    TimelineModel* model;
+    QLabel* titleLabel;
+    QPlainTextEdit* reportEdit;
+    QTimer* refreshTimer;
+
+    void setupUI();
+};
@@ -0,0 +1,396 @@
+#include "RemoteTimelineModel.h"
+#include "TimelineModel.h"
+#include "TimelineServer.h"
+#include "utils/JsonXmlFormatter.h"
+#include <QColor>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QLocalSocket>
+#include <QTimer>
+#include <stdexcept>
+
+QVector<RemoteTimelineModel::TimelineInfo> RemoteTimelineModel::listTimelines(const QString& serverName)
+{
+    QLocalSocket socket;
+    socket.connectToServer(serverName);
+    if (!socket.waitForConnected(CONNECT_TIMEOUT_MS)) {
+        throw std::runtime_error(QString("Cannot connect to server '%1': %2")
+            .arg(serverName, socket.errorString()).toStdString());
+    }
+    socket.write("{\"id\":1,\"op\":\"list\"}\n");
+    socket.flush();
+    QElapsedTimer timer;
+    timer.start();
+    while (!socket.canReadLine()) {
+        const qint64 left = CONNECT_TIMEOUT_MS - timer.elapsed();
+        if (left <= 0 || !socket.waitForReadyRead(static_cast<int>(left)))
+            throw std::runtime_error(QString("Server '%1' did not answer").arg(serverName).toStdString());
+    }
+
+    const QJsonObject reply = QJsonDocument::fromJson(socket.readLine()).object();
+    if (reply["protocol"].toInt() != TimelineServer::PROTOCOL_VERSION) {
+        throw std::runtime_error(QString("Server '%1' speaks protocol %2, this viewer %3")
+            .arg(serverName).arg(reply["protocol"].toInt()).arg(TimelineServer::PROTOCOL_VERSION).toStdString());
+    }
+    QVector<TimelineInfo> timelines;
+    for (const QJsonValue& value : reply["timelines"].toArray()) {
+        const QJsonObject entry = value.toObject();
+        TimelineInfo info;
+        info.timeline = entry["timeline"].toInt(-1);
+        info.name = entry["name"].toString();
+        info.path = entry["path"].toString();
+        for (const QJsonValue& header : entry["headers"].toArray())
+            info.headers << header.toString();
+        const int type = entry["type"].toInt(TimelineParser::Unknown);
+        info.type = (type >= TimelineParser::Filesystem && type <= TimelineParser::Unknown)
+            ? static_cast<TimelineParser::TimelineType>(type) : TimelineParser::Unknown;
+        info.rows = entry["rows"].toInt();
+        timelines.append(info);
+    }
+    return timelines;
+}
+
+RemoteTimelineModel::RemoteTimelineModel(const QString& serverName, const TimelineInfo& timeline, QObject* parent)
+    : QAbstractTableModel(parent), m_serverName(serverName), m_timeline(timeline)
+{
+    m_socket = new QLocalSocket(this);
+    m_socket->connectToServer(serverName);
+    if (!m_socket->waitForConnected(CONNECT_TIMEOUT_MS)) {
+        throw std::runtime_error(QString("Cannot connect to server '%1': %2")
+            .arg(serverName, m_socket->errorString()).toStdString());
+    }
+    connect(m_socket, &QLocalSocket::readyRead, this, &RemoteTimelineModel::onReadyRead);
+    connect(m_socket, &QLocalSocket::disconnected, this, [this]() {
+        qWarning() << "RemoteTimelineModel: lost the connection to" << m_serverName;
+        m_pending.clear();
+        m_filterRequest = -1;
+        emit connectionLost();
+    });
+
+    m_fetchTimer = new QTimer(this);
+    m_fetchTimer->setSingleShot(true);
+    m_fetchTimer->setInterval(0);
+    connect(m_fetchTimer, &QTimer::timeout, this, &RemoteTimelineModel::fetchWantedPages);
+}
+
+RemoteTimelineModel::~RemoteTimelineModel()
+{
+    // Closing the socket must not call back into a half-destroyed model
+    m_socket->disconnect(this);
+    m_socket->abort();
+}
+
+int RemoteTimelineModel::rowCount(const QModelIndex&) const
+{
+    return m_filteredRows >= 0 ? m_filteredRows : m_timeline.rows;
+}
+
+int RemoteTimelineModel::columnCount(const QModelIndex&) const
+{
+    return m_timeline.headers.size();
+}
+
+const RemoteTimelineModel::Row* RemoteTimelineModel::cachedRow(int viewRow) const
+{
+    const int page = viewRow / PAGE_ROWS;
+    const Page* rows = m_pages.object(page);
+    if (!rows) {
+        m_wantedPages.insert(page);
+        m_fetchTimer->start();
+        return nullptr;
+    }
+    const int k = viewRow % PAGE_ROWS;
+    return k < rows->size() ? &(*rows)[k] : nullptr;
+}
+
+QVariant RemoteTimelineModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() < 0 || index.row() >= rowCount())
+        return QVariant();
+    const Row* row = cachedRow(index.row());
+    if (!row)
+        return QVariant();
+
+    // Tag column for Super timelines, as in TimelineModel
+    if (type() == TimelineParser::Super && index.column() == 7) {
+        if (role == Qt::CheckStateRole)
+            return row->tagged ? Qt::Checked : Qt::Unchecked;
+        if (role == Qt::DisplayRole)
+            return QVariant();
+    }
+    if (role == Qt::BackgroundRole && row->tagged)
+        return QColor(240, 240, 240);
+
+    // Only the cut display text is held here, so FullTextRole is not
+    // answered; the detail window and Copy fetch the whole value (see
+    // fetchFullText())
+    if (role != Qt::DisplayRole)
+        return QVariant();
+    if (index.column() >= row->fields.size())
+        return QString();
+    if (type() == TimelineParser::Super && index.column() == 4)
+        return JsonXmlFormatter::toSingleLine(row->fields[index.column()]);
+    return row->fields[index.column()];
+}
+
+QVariant RemoteTimelineModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole && section >= 0 && section < m_timeline.headers.size())
+        return m_timeline.headers[section];
+    return QAbstractTableModel::headerData(section, orientation, role);
+}
+
+bool RemoteTimelineModel::setData(const QModelIndex& index, const QVariant& value, int role)
+{
+    if (!index.isValid() || role != Qt::CheckStateRole || type() != TimelineParser::Super || index.column() != 7)
+        return false;
+    const Row* row = cachedRow(index.row());
+    if (!row)
+        return false;
+
+    // Shown at once; undone if the server refuses it
+    const int source = row->source;
+    const bool tagged = value.toInt() == Qt::Checked;
+    setCachedTag(source, tagged);
+    QJsonObject request;
+    request["op"] = "tag";
+    request["timeline"] = m_timeline.timeline;
+    request["row"] = source;
+    request["tagged"] = tagged;
+    send(request, [this, source, tagged](const QJsonObject& reply) {
+        if (reply.contains("error")) {
+            setCachedTag(source, !tagged);
+            emit requestFailed(reply["error"].toString());
+        }
+    });
+    return true;
+}
+
+Qt::ItemFlags RemoteTimelineModel::flags(const QModelIndex& index) const
+{
+    if (!index.isValid())
+        return Qt::NoItemFlags;
+    Qt::ItemFlags flags = Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+    if (type() == TimelineParser::Super && index.column() == 7)
+        flags |= Qt::ItemIsUserCheckable;
+    return flags;
+}
+
+bool RemoteTimelineModel::isConnected() const
+{
+    return m_socket->state() == QLocalSocket::ConnectedState;
+}
+
+void RemoteTimelineModel::applyFilter(const QString& column, const QString& term)
+{
+    if (term.isEmpty()) {
+        clearFilter();
+        return;
+    }
+
+    // The server drops the reply of a filter it replaces
+    if (m_filterRequest >= 0)
+        m_pending.remove(m_filterRequest);
+    QJsonObject request;
+    request["op"] = "filter";
+    request["timeline"] = m_timeline.timeline;
+    request["column"] = (column == "All Columns") ? -1 : m_timeline.headers.indexOf(column);
+    request["term"] = term;
+    m_filterRequest = send(request, [this](const QJsonObject& reply) {
+        m_filterRequest = -1;
+        if (reply.contains("error")) {
+            emit requestFailed(reply["error"].toString());
+            return;
+        }
+        const int matches = reply["matches"].toInt();
+        resetView(matches);
+        emit filterFinished(matches);
+    });
+}
+
+void RemoteTimelineModel::clearFilter()
+{
+    if (m_filteredRows < 0 && m_filterRequest < 0)
+        return;
+    if (m_filterRequest >= 0) {
+        m_pending.remove(m_filterRequest);
+        m_filterRequest = -1;
+    }
+    QJsonObject request;
+    request["op"] = "filter";
+    request["timeline"] = m_timeline.timeline;
+    request["term"] = QString();
+    send(request);
+    if (m_filteredRows >= 0)
+        resetView(-1);
+}
+
+int RemoteTimelineModel::filteredRowCount() const
+{
+    return m_filteredRows;
+}
+
+bool RemoteTimelineModel::isFilterRunning() const
+{
+    return m_filterRequest >= 0;
+}
+
+int RemoteTimelineModel::toSourceRow(int viewRow) const
+{
+    const Row* row = (viewRow >= 0 && viewRow < rowCount()) ? cachedRow(viewRow) : nullptr;
+    return row ? row->source : -1;
+}
+
+bool RemoteTimelineModel::fetchFullText(const QModelIndex& index, const std::function<void(const QString&)>& done)
+{
+    const Row* row = (index.isValid() && index.row() < rowCount()) ? cachedRow(index.row()) : nullptr;
+    if (!row)
+        return false;
+    QJsonObject request;
+    request["op"] = "field";
+    request["timeline"] = m_timeline.timeline;
+    request["row"] = row->source;
+    request["column"] = index.column();
+    send(request, [this, done](const QJsonObject& reply) {
+        if (reply.contains("error")) {
+            emit requestFailed(reply["error"].toString());
+            return;
+        }
+        done(reply["text"].toString());
+    });
+    return true;
+}
+
+qint64 RemoteTimelineModel::memoryBytes() const
+{
+    qint64 bytes = 0;
+    for (int page : m_pages.keys()) {
+        const Page* rows = m_pages.object(page);
+        for (const Row& row : *rows) {
+            bytes += sizeof(Row);
+            for (const QString& field : row.fields)
+                bytes += field.size() * static_cast<qint64>(sizeof(QChar));
+        }
+    }
+    return bytes;
+}
+
+qint64 RemoteTimelineModel::releaseCaches()
+{
+    // Rows on screen are fetched again when they are next painted
+    const qint64 bytes = memoryBytes();
+    m_pages.clear();
+    return bytes;
+}
+
+int RemoteTimelineModel::send(QJsonObject request, const ReplyHandler& onReply)
+{
+    const int id = m_nextId++;
+    request["id"] = id;
+    if (onReply)
+        m_pending.insert(id, onReply);
+    m_socket->write(QJsonDocument(request).toJson(QJsonDocument::Compact) + '\n');
+    return id;
+}
+
+void RemoteTimelineModel::onReadyRead()
+{
+    while (m_socket->canReadLine()) {
+        const QJsonObject message = QJsonDocument::fromJson(m_socket->readLine()).object();
+        if (message.contains("event")) {
+            handleEvent(message);
+            continue;
+        }
+        // Replies nobody waits for (tag changes, replaced filters) are dropped
+        const ReplyHandler handler = m_pending.take(message["id"].toInt(-1));
+        if (handler)
+            handler(message);
+    }
+}
+
+void RemoteTimelineModel::handleEvent(const QJsonObject& event)
+{
+    const QString type = event["event"].toString();
+    if (type == "tag") {
+        if (event["timeline"].toInt(-1) == m_timeline.timeline)
+            setCachedTag(event["row"].toInt(-1), event["tagged"].toBool());
+    } else if (type == "progress") {
+        if (m_filterRequest >= 0 && event["request"].toInt(-1) == m_filterRequest)
+            emit searchProgress(event["scanned"].toInt(), event["total"].toInt());
+    }
+}
+
+void RemoteTimelineModel::fetchWantedPages()
+{
+    const int generation = m_generation;
+    const bool filtered = m_filteredRows >= 0;
+    for (int page : std::as_const(m_wantedPages)) {
+        if (m_requestedPages.contains(page) || m_pages.contains(page))
+            continue;
+        m_requestedPages.insert(page);
+        QJsonObject request;
+        request["op"] = "rows";
+        request["timeline"] = m_timeline.timeline;
+        request["first"] = page * PAGE_ROWS;
+        request["count"] = PAGE_ROWS;
+        request["filtered"] = filtered;
+        send(request, [this, page, generation](const QJsonObject& reply) {
+            if (generation != m_generation)
+                return;  // the view has been reset since
+            if (reply.contains("error")) {
+                // Left marked as requested, so it is not asked for again
+                // on every repaint
+                emit requestFailed(reply["error"].toString());
+                return;
+            }
+            m_requestedPages.remove(page);
+            Page* rows = new Page;
+            for (const QJsonValue& value : reply["rows"].toArray()) {
+                const QJsonObject entry = value.toObject();
+                Row row;
+                row.source = entry["row"].toInt(-1);
+                row.tagged = entry["tagged"].toBool();
+                for (const QJsonValue& field : entry["fields"].toArray())
+                    row.fields << field.toString();
+                rows->append(row);
+            }
+            if (rows->isEmpty()) {
+                delete rows;
+                return;
+            }
+            const int first = page * PAGE_ROWS;
+            const int last = first + rows->size() - 1;
+            m_pages.insert(page, rows);
+            emit dataChanged(index(first, 0), index(last, columnCount() - 1));
+        });
+    }
+    m_wantedPages.clear();
+}
+
+void RemoteTimelineModel::resetView(int filteredRows)
+{
+    beginResetModel();
+    m_filteredRows = filteredRows;
+    ++m_generation;
+    m_pages.clear();
+    m_wantedPages.clear();
+    m_requestedPages.clear();
+    endResetModel();
+}
+
+void RemoteTimelineModel::setCachedTag(int sourceRow, bool tagged)
+{
+    for (int page : m_pages.keys()) {
+        Page* rows = m_pages.object(page);
+        for (int k = 0; k < rows->size(); ++k) {
+            Row& row = (*rows)[k];
+            if (row.source != sourceRow || row.tagged == tagged)
+                continue;
+            row.tagged = tagged;
+            const int viewRow = page * PAGE_ROWS + k;
+            emit dataChanged(index(viewRow, 0), index(viewRow, columnCount() - 1));
+        }
+    }
+}
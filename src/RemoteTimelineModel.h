@@ -0,0 +1,118 @@
+#pragma once
+#include <QAbstractTableModel>
+#include <QCache>
+#include <QHash>
+#include <QJsonObject>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <functional>
+#include "core/TimelineParser.h"
+
+class QLocalSocket;
+class QTimer;
+
+/**
+ * @brief RemoteTimelineModel shows a timeline hosted by a TimelineServer.
+ *
+ * Nothing is read locally: rows are fetched from the server in pages of
+ * PAGE_ROWS as the view asks for them, and the most recent pages are kept.
+ * data() never blocks; a row whose page has not arrived yet is empty until
+ * the reply comes in and dataChanged() is emitted. Filters run on the
+ * server and tags are stored there, so tags set by other clients show up
+ * here as they are made.
+ */
+class RemoteTimelineModel : public QAbstractTableModel {
+    Q_OBJECT
+public:
+    static constexpr int PAGE_ROWS = 200;
+    static constexpr int CACHED_PAGES = 100;          // pages kept for scrolling back
+    static constexpr int CONNECT_TIMEOUT_MS = 5000;   // also the list request's timeout
+
+    struct TimelineInfo {
+        int timeline = -1;  // the server's index
+        QString name;
+        QString path;       // on the server's machine
+        QStringList headers;
+        TimelineParser::TimelineType type = TimelineParser::Unknown;
+        int rows = 0;
+    };
+    // The timelines a server hosts; blocks for at most CONNECT_TIMEOUT_MS
+    // per step and throws std::runtime_error if the server does not answer
+    static QVector<TimelineInfo> listTimelines(const QString& serverName);
+
+    // Connects to the server; throws std::runtime_error if it cannot
+    RemoteTimelineModel(const QString& serverName, const TimelineInfo& timeline, QObject* parent = nullptr);
+    ~RemoteTimelineModel();
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    bool setData(const QModelIndex& index, const QVariant& value, int role = Qt::EditRole) override;
+    Qt::ItemFlags flags(const QModelIndex& index) const override;
+
+    QString serverName() const { return m_serverName; }
+    const TimelineInfo& timeline() const { return m_timeline; }
+    TimelineParser::TimelineType type() const { return m_timeline.type; }
+    bool isConnected() const;
+
+    // Filter (search) — runs on the server; the view is reset and
+    // filterFinished() emitted when the matches have arrived. A new filter
+    // replaces one still running.
+    void applyFilter(const QString& column, const QString& term);
+    void clearFilter();
+    int filteredRowCount() const;  // -1 when no filter is active
+    bool isFilterRunning() const;
+
+    // Source row of a view row, -1 while its page has not arrived
+    int toSourceRow(int viewRow) const;
+    // Fetches the untruncated value of a cell and passes it to done(),
+    // unless the model is destroyed or the connection lost first. False if
+    // the row itself has not arrived yet.
+    bool fetchFullText(const QModelIndex& index, const std::function<void(const QString&)>& done);
+
+    // Memory budget (see AppWindow): the cached pages
+    qint64 memoryBytes() const;
+    qint64 releaseCaches();
+
+signals:
+    void searchProgress(int linesScanned, int totalLines);
+    void filterFinished(int matches);
+    void requestFailed(const QString& error);
+    void connectionLost();
+
+private:
+    struct Row {
+        int source = -1;
+        QStringList fields;
+        bool tagged = false;
+    };
+    using Page = QVector<Row>;
+    using ReplyHandler = std::function<void(const QJsonObject&)>;
+
+    QString m_serverName;
+    TimelineInfo m_timeline;
+    QLocalSocket* m_socket;
+    int m_nextId = 1;
+    QHash<int, ReplyHandler> m_pending;  // request id → handler of its reply
+
+    // data() only notes the pages it misses; they are requested together
+    // once the view has finished painting
+    mutable QCache<int, Page> m_pages{CACHED_PAGES};
+    mutable QSet<int> m_wantedPages;
+    QSet<int> m_requestedPages;
+    QTimer* m_fetchTimer;
+
+    int m_filteredRows = -1;
+    int m_filterRequest = -1;  // id of the running filter
+    int m_generation = 0;      // bumped whenever the view rows change meaning
+
+    int send(QJsonObject request, const ReplyHandler& onReply = {});
+    void onReadyRead();
+    void handleEvent(const QJsonObject& event);
+    void fetchWantedPages();
+    void resetView(int filteredRows);
+    void setCachedTag(int sourceRow, bool tagged);  // in every cached page holding the row
+    const Row* cachedRow(int viewRow) const;
+};
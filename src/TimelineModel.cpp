@@ -1,141 +1,106 @@
 #include "TimelineModel.h"
 #include "utils/JsonXmlFormatter.h"
 #include "utils/FileUtils.h"
-#include <QTextStream>
-#include <QFileInfo>
+#include "utils/SysmonFields.h"
+#include "core/AhoCorasick.h"
+#include "core/AnalysisCache.h"
 #include <QDebug>
-#include <QDir>
-#include <QStandardPaths>
 #include <QElapsedTimer>
 #include <QCoreApplication>
+#include <QThread>
+#include <QFileInfo>
 #include <QColor>
+#include <QJsonObject>
+#include <QJsonDocument>
+#include <QPair>
+#include <algorithm>
+#include <numeric>
 
-TimelineModel::TimelineModel(const QString& filePath, QObject* parent)
-    : QAbstractTableModel(parent), filePath(filePath), timelineType(Unknown), file(filePath), unsavedChanges(false)
-{
-    // Validate file size before processing
-    QFileInfo fileInfo(filePath);
-    if (fileInfo.size() > MAX_FILE_SIZE) {
-        throw std::runtime_error("File size exceeds maximum limit (2GB)");
-    }
-    
-    if (!fileInfo.exists()) {
-        throw std::runtime_error("File does not exist");
-    }
-    
-    if (!fileInfo.isReadable()) {
-        throw std::runtime_error("File is not readable");
-    }
-    
-    detectFormat();
-    buildLineIndex();
-    loadTaggedRows();
-}
-
-TimelineModel::~TimelineModel() { file.close(); }
+namespace {
 
-void TimelineModel::detectFormat()
+// Display fields: only a bounded prefix of long fields is decoded
+bool parseRow(const QByteArray& raw, QStringList& fields)
 {
-    QMutexLocker locker(&fileMutex);
-    QElapsedTimer timer;
-    timer.start();
-
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        timelineType = Unknown;
-        return;
-    }
-    QTextStream in(&file);
-    QString headerLine = in.readLine();
-    
     try {
-        headers = FileUtils::parseCsvLine(headerLine);
+        fields = FileUtils::parseCsvLinePrefix(raw.trimmed(), TimelineModel::DISPLAY_FIELD_BYTES);
     } catch (const std::exception& e) {
-        qWarning() << "Error parsing CSV header:" << e.what();
-        timelineType = Unknown;
-        return;
+        qWarning() << "Error parsing CSV line:" << e.what();
+        return false;
     }
-    
-    if (headers == QStringList({"Date","Size","Type","Mode","UID","GID","Meta","File Name"}))
-        timelineType = Filesystem;
-    else if (headers == QStringList({"datetime","timestamp_desc","source","source_long","message","parser","display_name","tag"}))
-        timelineType = Super;
-    else
-        timelineType = Unknown;
-    file.seek(0);
-    qDebug() << "TimelineModel: format detection took" << timer.elapsed() << "ms, type:"
-             << (timelineType == Filesystem ? "Filesystem" :
-                 timelineType == Super      ? "Super"      : "Unknown");
+    return true;
 }
 
-void TimelineModel::buildLineIndex()
+// Splits ascending rows into [first, last) runs; runs at most maxGap rows
+// apart are joined, since reading a few extra rows is cheaper than a seek
+QVector<QPair<int, int>> rowRuns(const QVector<int>& rows, int maxGap)
 {
-    QMutexLocker locker(&fileMutex);
-    QElapsedTimer timer;
-    timer.start();
-    qDebug() << "TimelineModel: building line index for" << filePath;
-
-    lineOffsets.clear();
-    if (!file.isOpen()) {
-        if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-            throw std::runtime_error("Failed to open file for reading");
-        }
+    QVector<QPair<int, int>> runs;
+    for (int row : rows) {
+        if (!runs.isEmpty() && row - runs.last().second <= maxGap)
+            runs.last().second = row + 1;
+        else
+            runs.append({row, row + 1});
     }
+    return runs;
+}
 
-    qint64 offset = 0;
-    QTextStream in(&file);
-    QString line;
-
-    line = in.readLine();
-    if (line.isNull())
-        throw std::runtime_error("File appears to be empty or corrupted");
-    offset += line.toUtf8().size() + 1;
-
-    int lineCount = 0;
-    while (!in.atEnd()) {
-        if (lineCount >= MAX_LINE_COUNT)
-            throw std::runtime_error("File exceeds maximum line count limit (10 million lines)");
-
-        if (lineOffsets.size() * static_cast<qint64>(sizeof(qint64)) > MAX_INDEX_MEMORY)
-            throw std::runtime_error("File index exceeds memory limit (500MB)");
-
-        lineOffsets.append(offset);
-        line = in.readLine();
-        if (line.isNull())
-            break;
-
-        offset += line.toUtf8().size() + 1;
-        ++lineCount;
+} // namespace
 
-        // Every 50 000 lines, briefly yield to the event loop so the UI stays
-        // responsive. ExcludeUserInputEvents prevents re-entrancy issues.
-        if (lineCount % 50000 == 0) {
-            locker.unlock();
-            QCoreApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
-            locker.relock();
-            qDebug() << "TimelineModel: indexed" << lineCount << "lines so far...";
-        }
-    }
+TimelineModel::TimelineModel(const QString& filePath, QObject* parent)
+    : QAbstractTableModel(parent), m_store(filePath), m_tags(filePath)
+{
+    // Briefly yield to the event loop while indexing so the UI stays
+    // responsive. ExcludeUserInputEvents prevents re-entrancy issues.
+    m_store.open([](int) {
+        QCoreApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
+    });
+    m_tags.load(m_store.rowCount());
+    m_prefetchPool.setMaxThreadCount(1);
+    m_fileBytes = QFileInfo(filePath).size();
+}
 
-    file.seek(0);
-    qDebug() << "TimelineModel: indexed" << lineCount << "lines in" << timer.elapsed()
-             << "ms, index memory:" << (lineOffsets.size() * static_cast<qint64>(sizeof(qint64))) << "bytes";
+TimelineModel::~TimelineModel()
+{
+    cancelGrouping();
+    if (m_groupThread)
+        m_groupThread->wait();
+    cancelExtraction();
+    if (m_extractThread)
+        m_extractThread->wait();
+    cancelLiveFilter();
+    cancelEstimate();
+    for (QThread* thread : m_liveThreads)
+        thread->wait();
+    m_prefetchPool.waitForDone();
+    qDebug().noquote() << "TimelineModel: metrics"
+                       << QJsonDocument(metricsSnapshot()).toJson(QJsonDocument::Compact);
 }
 
 int TimelineModel::rowCount(const QModelIndex&) const
 {
-    return m_isFiltered ? m_filteredRows.size() : lineOffsets.size();
+    const int rows = (m_isFiltered || m_isSorted) ? m_filteredRows.size() : m_store.rowCount();
+    return m_isGrouped ? m_groups.viewCount(rows) : rows;
 }
 
 int TimelineModel::toSourceRow(int viewRow) const
 {
-    if (m_isFiltered && viewRow >= 0 && viewRow < m_filteredRows.size())
-        return m_filteredRows[viewRow];
-    return viewRow;
+    const int position = m_isGrouped ? m_groups.toPosition(viewRow) : viewRow;
+    if ((m_isFiltered || m_isSorted) && position >= 0 && position < m_filteredRows.size())
+        return m_filteredRows[position];
+    return position;
+}
+
+int TimelineModel::toViewRow(int srcRow) const
+{
+    const int position = (m_isFiltered || m_isSorted) ? m_filteredRows.indexOf(srcRow) : srcRow;
+    if (position < 0 || !m_isGrouped)
+        return position;
+    return m_groups.toViewRow(position);
 }
 
 int TimelineModel::columnCount(const QModelIndex&) const
 {
-    return headers.size();
+    return m_store.headers().size() + m_virtualColumns.size();
 }
 
 QVariant TimelineModel::data(const QModelIndex& index, int role) const
@@ -146,77 +111,317 @@ QVariant TimelineModel::data(const QModelIndex& index, int role) const
     const int srcRow = toSourceRow(index.row());
 
     // Handle tag column for Super timelines
-    if (timelineType == Super && index.column() == 7) {
+    if (type() == TimelineParser::Super && index.column() == 7) {
         if (role == Qt::CheckStateRole)
-            return taggedRows.contains(srcRow) ? Qt::Checked : Qt::Unchecked;
+            return m_tags.contains(srcRow) ? Qt::Checked : Qt::Unchecked;
         if (role == Qt::DisplayRole)
             return QVariant();
     }
 
     // Background tint for tagged rows
-    if (role == Qt::BackgroundRole && taggedRows.contains(srcRow))
+    if (role == Qt::BackgroundRole && m_tags.contains(srcRow))
         return QColor(240, 240, 240);
 
+    if (role == MatchSpansRole)
+        return matchSpans(srcRow, index.column());
+
+    if (role == FullTextRole)
+        return fullCellText(srcRow, index.column());
+
     if (role != Qt::DisplayRole)
         return QVariant();
 
-    QMutexLocker locker(&fileMutex);
+    QElapsedTimer timer;
+    timer.start();
+    const QString text = cellText(srcRow, index.column());
+    m_store.metrics().dataLatency.record(timer.nsecsElapsed());
+    return text;
+}
 
-    if (!file.isOpen()) {
-        if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-            qWarning() << "Failed to open file for reading";
-            return QVariant();
+QString TimelineModel::cellText(int srcRow, int column) const
+{
+    // Virtual columns are held in memory; no file access needed
+    if (const VirtualColumn* vc = virtualColumn(column)) {
+        if (srcRow < 0 || srcRow >= vc->codes.size())
+            return QString();
+        return vc->dictionary[vc->codes[srcRow]];
+    }
+
+    QStringList fields;
+    if (!rowFields(srcRow, fields))
+        return QString();
+
+    if (column < 0 || column >= fields.size())
+        return QString();
+
+    // Message fields are shown on a single line; pretty-printing is deferred
+    // to formattedData() so no JSON/XML parsing happens while scrolling.
+    if (type() == TimelineParser::Super && column == 4)
+        return JsonXmlFormatter::toSingleLine(fields[column]);
+
+    return fields[column];
+}
+
+QString TimelineModel::fullCellText(int srcRow, int column) const
+{
+    return fullRowText(srcRow, {column}).value(0);
+}
+
+QStringList TimelineModel::fullRowText(int srcRow, const QVector<int>& columns) const
+{
+    // Not cached: this is only used for cells the user copies or opens
+    QStringList values;
+    values.reserve(columns.size());
+    QStringList fields;
+    bool read = false;
+    for (int column : columns) {
+        if (const VirtualColumn* vc = virtualColumn(column)) {
+            values << ((srcRow >= 0 && srcRow < vc->codes.size()) ? vc->dictionary[vc->codes[srcRow]] : QString());
+            continue;
         }
+        if (!read) {
+            read = true;
+            if (!m_store.readFields(srcRow, fields))
+                fields.clear();
+        }
+        values << fields.value(column);
     }
+    return values;
+}
 
-    if (srcRow < 0 || srcRow >= lineOffsets.size())
-        return QVariant();
+bool TimelineModel::decodeRows(int firstSrcRow, int lastSrcRow, RowChunk& chunk) const
+{
+    return m_store.readChunk(firstSrcRow, lastSrcRow, chunk);
+}
 
-    if (!file.seek(lineOffsets[srcRow])) {
-        qWarning() << "Failed to seek to file position";
+QVariant TimelineModel::matchSpans(int srcRow, int column) const
+{
+    const bool iocView = m_isFiltered && m_isIocView;
+    if (!iocView && (!m_isFiltered || !m_filter.isActive()
+                     || (m_filter.column() >= 0 && m_filter.column() != column)))
         return QVariant();
+
+    const quint64 key = (static_cast<quint64>(srcRow) << 16) | static_cast<quint16>(column);
+    const QList<int>* spans = m_spanCache.object(key);
+    if (!spans) {
+        // Case-insensitive like FilterEngine, but on the text as displayed
+        const QString text = cellText(srcRow, column);
+        QList<int>* found = new QList<int>();
+        if (iocView) {
+            // The sweep matched UTF-8 bytes, so the text is matched as UTF-8
+            // too and byte offsets are mapped back to UTF-16 offsets: each
+            // sequence is one QChar, or two for 4-byte sequences (surrogates)
+            const QByteArray bytes = text.toUtf8();
+            QVector<int> charAt(bytes.size() + 1);
+            int chars = 0;
+            for (qsizetype i = 0; i < bytes.size(); ++i) {
+                const uchar b = static_cast<uchar>(bytes[i]);
+                charAt[i] = chars;
+                if ((b & 0xC0) != 0x80)
+                    chars += b >= 0xF0 ? 2 : 1;
+            }
+            charAt[bytes.size()] = chars;
+            const AhoCorasick& matcher = m_iocSweep->matcher();
+            matcher.findAll(bytes.constData(), bytes.size(), [&](qsizetype end, int id) {
+                const int begin = charAt[end - matcher.pattern(id).size()];
+                found->append(begin);
+                found->append(charAt[end] - begin);
+            });
+        } else {
+            const QString& term = m_filter.term();
+            for (qsizetype at = text.indexOf(term, 0, Qt::CaseInsensitive); at >= 0;
+                 at = text.indexOf(term, at + term.size(), Qt::CaseInsensitive)) {
+                found->append(static_cast<int>(at));
+                found->append(static_cast<int>(term.size()));
+            }
+        }
+        spans = found;
+        m_spanCache.insert(key, found);
     }
-    
-    QString line = QString::fromUtf8(file.readLine().trimmed());
+    return spans->isEmpty() ? QVariant() : QVariant::fromValue(*spans);
+}
+
+bool TimelineModel::rowFields(int srcRow, QStringList& fields) const
+{
+    if (const QStringList* cached = m_rowCache.object(srcRow)) {
+        m_store.metrics().rowCacheHits.fetch_add(1, std::memory_order_relaxed);
+        fields = *cached;
+        return true;
+    }
+    m_store.metrics().rowCacheMisses.fetch_add(1, std::memory_order_relaxed);
+    QByteArray raw;
+    if (!m_store.readRaw(srcRow, raw) || !parseRow(raw, fields))
+        return false;
+    m_rowCache.insert(srcRow, new QStringList(fields));
+    return true;
+}
+
+bool TimelineModel::readRawLine(int srcRow, QByteArray& line) const
+{
+    return m_store.readRaw(srcRow, line);
+}
+
+QVector<int> TimelineModel::sourceRows(int firstViewRow, int lastViewRow) const
+{
+    QVector<int> rows;
+    rows.reserve(lastViewRow - firstViewRow + 1);
+    for (int r = firstViewRow; r <= lastViewRow; ++r)
+        rows.append(toSourceRow(r));
+    if (m_isSorted)
+        std::sort(rows.begin(), rows.end());
+    return rows;
+}
+
+void TimelineModel::setVisibleRange(int firstRow, int lastRow)
+{
+    const int rows = rowCount();
+    if (rows == 0 || firstRow < 0 || firstRow >= rows)
+        return;
+    lastRow = qBound(firstRow, lastRow, rows - 1);
+    const int page = lastRow - firstRow + 1;
+    const bool forward = m_visibleFirst < 0 || firstRow >= m_visibleFirst;
+    m_visibleFirst = firstRow;
+
+    loadRows(sourceRows(firstRow, lastRow));
+
+    // Read one screen ahead in the scroll direction
+    const int aheadFirst = forward ? lastRow + 1 : qMax(0, firstRow - page);
+    const int aheadLast = forward ? qMin(rows - 1, lastRow + page) : firstRow - 1;
+    if (aheadFirst <= aheadLast && !m_store.seeksFromStart())
+        prefetchRows(sourceRows(aheadFirst, aheadLast));
+}
+
+void TimelineModel::loadRows(const QVector<int>& srcRows)
+{
+    QVector<int> missing;
+    for (int row : srcRows) {
+        if (!m_rowCache.contains(row))
+            missing.append(row);
+    }
+
+    // All runs are read in one batch (in parallel with the async backend);
+    // a run that fails (e.g. too large) is left to data()'s single-row reads
+    const QVector<QPair<int, int>> runs = rowRuns(missing, MAX_RUN_GAP);
+    QVector<QVector<QByteArray>> lines;
+    m_store.readRanges(runs, lines);
     QStringList fields;
-    
-    try {
-        fields = FileUtils::parseCsvLine(line);
-    } catch (const std::exception& e) {
-        qWarning() << "Error parsing CSV line:" << e.what();
-        return QVariant();
+    for (int i = 0; i < runs.size(); ++i) {
+        for (int k = 0; k < lines[i].size(); ++k) {
+            if (parseRow(lines[i][k], fields))
+                m_rowCache.insert(runs[i].first + k, new QStringList(fields));
+        }
     }
-    
-    if (index.column() < 0 || index.column() >= fields.size())
-        return QVariant();
-    
-    QString cellData = fields[index.column()];
-    
-    // Apply JSON/XML formatting for message field in Super timelines
-    if (timelineType == Super && index.column() == 4) { // message field
-        return JsonXmlFormatter::formatIfApplicable(cellData);
+}
+
+void TimelineModel::prefetchRows(const QVector<int>& srcRows)
+{
+    // One read-ahead at a time; a later scroll asks again
+    if (m_prefetchPending)
+        return;
+    QVector<int> missing;
+    for (int row : srcRows) {
+        if (!m_rowCache.contains(row))
+            missing.append(row);
     }
-    
-    return cellData;
+    if (missing.isEmpty())
+        return;
+
+    const QVector<QPair<int, int>> runs = rowRuns(missing, MAX_RUN_GAP);
+    for (const QPair<int, int>& run : runs)
+        m_store.adviseRange(run.first, run.second);
+
+    m_prefetchPending = true;
+    const quint64 generation = m_rowCacheGeneration;
+    m_prefetchPool.start([this, runs, generation]() {
+        QVector<QPair<int, QStringList>> parsed;
+        QVector<QVector<QByteArray>> lines;
+        m_store.readRanges(runs, lines);
+        QStringList fields;
+        for (int i = 0; i < runs.size(); ++i) {
+            for (int k = 0; k < lines[i].size(); ++k) {
+                if (parseRow(lines[i][k], fields))
+                    parsed.append({runs[i].first + k, fields});
+            }
+        }
+        // The cache belongs to the GUI thread; hand the rows over there
+        QMetaObject::invokeMethod(this, [this, parsed, generation]() {
+            m_prefetchPending = false;
+            if (generation != m_rowCacheGeneration)
+                return;
+            for (const QPair<int, QStringList>& row : parsed) {
+                if (!m_rowCache.contains(row.first))
+                    m_rowCache.insert(row.first, new QStringList(row.second));
+            }
+            m_store.metrics().prefetchedRows.fetch_add(parsed.size(), std::memory_order_relaxed);
+        }, Qt::QueuedConnection);
+    });
+}
+
+QString TimelineModel::formattedData(const QModelIndex& index) const
+{
+    if (!index.isValid() || index.row() < 0 || index.row() >= rowCount())
+        return QString();
+    return formattedCell(toSourceRow(index.row()), index.column());
+}
+
+QString TimelineModel::formattedCell(int srcRow, int column) const
+{
+    const bool isMessage = (type() == TimelineParser::Super && column == 4);
+    if (!isMessage)
+        return fullCellText(srcRow, column);
+
+    if (const QString* cached = m_formatCache.object(srcRow)) {
+        ++m_store.metrics().formatCacheHits;
+        return *cached;
+    }
+    ++m_store.metrics().formatCacheMisses;
+
+    const QString message = fullCellText(srcRow, column);
+    if (message.isEmpty())
+        return QString();
+    const QString formatted = JsonXmlFormatter::formatIfApplicable(message);
+    m_formatCache.insert(srcRow, new QString(formatted), qMax<qsizetype>(1, formatted.size()));
+    return formatted;
 }
 
 QVariant TimelineModel::headerData(int section, Qt::Orientation orientation, int role) const
 {
-    if (role != Qt::DisplayRole || orientation != Qt::Horizontal)
+    if (orientation == Qt::Vertical) {
+        // Grouped rows show their run length, e.g. "▸ 42×"
+        const int length = groupLength(section);
+        if (length <= 1)
+            return QVariant();
+        const bool expanded = m_groups.isExpanded(m_groups.runAt(m_groups.toPosition(section)));
+        if (role == Qt::DisplayRole)
+            return QString("%1 %2×").arg(expanded ? QStringLiteral("▾") : QStringLiteral("▸")).arg(length);
+        if (role == Qt::ToolTipRole)
+            return QString("%1 similar rows; double-click to %2").arg(length).arg(expanded ? QStringLiteral("collapse") : QStringLiteral("expand"));
         return QVariant();
-    if (section < 0 || section >= headers.size())
+    }
+    if (role != Qt::DisplayRole)
         return QVariant();
-    return headers[section];
+    if (const VirtualColumn* vc = virtualColumn(section))
+        return vc->name;
+    if (section < 0 || section >= m_store.headers().size())
+        return QVariant();
+    return m_store.headers()[section];
 }
 
 int TimelineModel::columnIndex(const QString& name) const
 {
-    return headers.indexOf(name);
+    const int idx = m_store.headers().indexOf(name);
+    if (idx >= 0)
+        return idx;
+    for (int v = 0; v < m_virtualColumns.size(); ++v) {
+        if (m_virtualColumns[v].name == name)
+            return m_store.headers().size() + v;
+    }
+    return -1;
 }
 
 bool TimelineModel::setData(const QModelIndex& index, const QVariant& value, int role)
 {
-    if (!index.isValid() || timelineType != Super || index.column() != 7)
+    if (!index.isValid() || type() != TimelineParser::Super || index.column() != 7)
         return false;
 
     if (role == Qt::CheckStateRole) {
@@ -234,7 +439,7 @@ Qt::ItemFlags TimelineModel::flags(const QModelIndex& index) const
     Qt::ItemFlags flags = Qt::ItemIsEnabled | Qt::ItemIsSelectable;
     
     // Make tag column checkable for Super timelines
-    if (timelineType == Super && index.column() == 7) {
+    if (type() == TimelineParser::Super && index.column() == 7) {
         flags |= Qt::ItemIsUserCheckable;
     }
     
@@ -243,151 +448,190 @@ Qt::ItemFlags TimelineModel::flags(const QModelIndex& index) const
 
 TimelineModel::TimelineType TimelineModel::type() const
 {
-    return timelineType;
+    return m_store.type();
 }
 
 bool TimelineModel::isRowTagged(int row) const
 {
-    return taggedRows.contains(row);
+    return m_tags.contains(row);
+}
+
+QVector<int> TimelineModel::taggedSourceRows() const
+{
+    return m_tags.sortedRows();
 }
 
 void TimelineModel::setRowTagged(int sourceRow, bool tagged)
 {
-    bool changed = false;
-    if (tagged && !taggedRows.contains(sourceRow)) {
-        taggedRows.insert(sourceRow);
-        changed = true;
-    } else if (!tagged && taggedRows.contains(sourceRow)) {
-        taggedRows.remove(sourceRow);
-        changed = true;
-    }
+    if (!m_tags.set(sourceRow, tagged))
+        return;
 
-    if (changed) {
-        unsavedChanges = true;
-        // Notify the view using the view-row index, not the source row.
-        int viewRow = m_isFiltered ? m_filteredRows.indexOf(sourceRow) : sourceRow;
-        if (viewRow >= 0)
-            emit dataChanged(createIndex(viewRow, 0), createIndex(viewRow, columnCount() - 1));
-        emit tagsModified(unsavedChanges);
-    }
+    // Notify the view using the view-row index, not the source row.
+    const int viewRow = toViewRow(sourceRow);
+    if (viewRow >= 0)
+        emit dataChanged(createIndex(viewRow, 0), createIndex(viewRow, columnCount() - 1));
+    emit tagsModified(m_tags.hasUnsavedChanges());
 }
 
 bool TimelineModel::hasUnsavedChanges() const
 {
-    return unsavedChanges;
+    return m_tags.hasUnsavedChanges();
 }
 
 bool TimelineModel::saveTaggedRows()
 {
-    QString tagFilePath = getTagFilePath();
-    if (tagFilePath.isEmpty()) {
-        qWarning() << "Failed to determine tag file path";
-        return false;
-    }
-    
-    QFile tagFile(tagFilePath);
-    
-    if (!tagFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        qWarning() << "Failed to open tag file for writing (check permissions)";
-        return false;
-    }
-    
-    QTextStream out(&tagFile);
-    for (int row : taggedRows) {
-        out << row << "\n";
-    }
-    
-    if (out.status() != QTextStream::Ok) {
-        qWarning() << "Error occurred while writing tag file";
+    if (!m_tags.save())
         return false;
-    }
-    
-    unsavedChanges = false;
-    emit tagsModified(unsavedChanges);
+    emit tagsModified(m_tags.hasUnsavedChanges());
     return true;
 }
 
 QString TimelineModel::getFilePath() const
 {
-    return filePath;
+    return m_store.filePath();
 }
 
-void TimelineModel::loadTaggedRows()
+bool TimelineModel::isFiltered() const { return m_isFiltered; }
+
+int TimelineModel::totalRowCount() const { return m_store.rowCount(); }
+
+const QVector<int>& TimelineModel::filteredSourceRows() const { return m_filteredRows; }
+
+PerfMetrics& TimelineModel::metrics() const { return m_store.metrics(); }
+
+qint64 TimelineModel::virtualColumnBytes() const
 {
-    QString tagFilePath = getTagFilePath();
-    if (tagFilePath.isEmpty()) {
-        return; // No valid tag file path
-    }
-    
-    QFile tagFile(tagFilePath);
-    
-    if (!tagFile.exists()) {
-        return; // No tag file exists, start with empty set
-    }
-    
-    if (!tagFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        qWarning() << "Failed to open tag file for reading (check permissions)";
-        return;
-    }
-    
-    QTextStream in(&tagFile);
-    int loadedCount = 0;
-    const int MAX_TAGS = 1000000; // Limit number of tags to prevent memory issues
-    
-    while (!in.atEnd() && loadedCount < MAX_TAGS) {
-        QString line = in.readLine().trimmed();
-        if (line.length() > 20) { // Sanity check - row numbers shouldn't be this long
-            qWarning() << "Invalid tag data detected, skipping";
-            continue;
-        }
-        
-        bool ok;
-        int row = line.toInt(&ok);
-        if (ok && row >= 0 && row < lineOffsets.size()) {
-            taggedRows.insert(row);
-            loadedCount++;
-        } else if (ok) {
-            qWarning() << "Tag references invalid row number, skipping";
-        }
-    }
-    
-    if (loadedCount >= MAX_TAGS) {
-        qWarning() << "Tag file contains too many entries, some may not be loaded";
+    qint64 bytes = 0;
+    for (const VirtualColumn& vc : m_virtualColumns) {
+        bytes += vc.codes.capacity() * static_cast<qint64>(sizeof(quint32));
+        for (const QString& value : vc.dictionary)
+            bytes += value.capacity() * 2 + 32;  // string data plus hash entry
     }
+    return bytes;
 }
 
-QString TimelineModel::sanitizeFileName(const QString& fileName) const
+QJsonObject TimelineModel::memoryUsage() const
 {
-    QString sanitized = fileName;
-    
-    sanitized.remove(QRegularExpression(R"([.]{2,})"));   // Remove .. sequences
-    sanitized.remove(QRegularExpression(R"([/\\])"));    // Remove path separators
-    sanitized.remove(QRegularExpression(R"([<>:"|?*])"));// Remove invalid filename chars
-    
-    // Limit filename length
-    if (sanitized.length() > 200) {
-        sanitized = sanitized.left(200);
+    // Cached rows are estimated from the average line length, at most
+    // DISPLAY_FIELD_BYTES per field: UTF-16 text plus the QStringList and
+    // QString headers
+    const int rows = m_store.rowCount();
+    const qint64 lineBytes = rows > 0
+        ? qMin<qint64>(m_fileBytes / rows, m_store.headers().size() * static_cast<qint64>(DISPLAY_FIELD_BYTES))
+        : 0;
+    const qint64 rowBytes = rows > 0 ? lineBytes * 2 + ROW_CACHE_OVERHEAD : 0;
+
+    QJsonObject memory;
+    memory["line_index"] = m_store.memoryBytes();
+    memory["filter"] = m_filteredRows.capacity() * static_cast<qint64>(sizeof(int));
+    memory["virtual_columns"] = virtualColumnBytes();
+    memory["row_cache"] = m_rowCache.totalCost() * rowBytes;
+    memory["format_cache"] = m_formatCache.totalCost() * static_cast<qint64>(sizeof(QChar));
+    memory["match_spans"] = m_spanCache.totalCost() * 64;  // key, list header and a few spans
+    memory["tags"] = m_tags.memoryBytes();
+    memory["duplicate_groups"] = m_groups.memoryBytes();
+    return memory;
+}
+
+QJsonObject TimelineModel::metricsSnapshot() const
+{
+    QJsonObject o = m_store.metrics().toJson();
+    o["file"] = m_store.filePath();
+    o["rows"] = m_store.rowCount();
+    o["memory_bytes"] = memoryUsage();
+    return o;
+}
+
+qint64 TimelineModel::memoryBytes() const
+{
+    qint64 total = 0;
+    const QJsonObject memory = memoryUsage();
+    for (auto it = memory.begin(); it != memory.end(); ++it)
+        total += it.value().toInteger();
+    return total;
+}
+
+qint64 TimelineModel::releaseCaches()
+{
+    const QJsonObject memory = memoryUsage();
+    const qint64 freed = memory["row_cache"].toInteger() + memory["format_cache"].toInteger()
+                       + memory["match_spans"].toInteger();
+    m_rowCache.clear();
+    m_formatCache.clear();
+    m_spanCache.clear();
+    ++m_rowCacheGeneration;  // drop a read-ahead still in flight
+    return freed;
+}
+
+qint64 TimelineModel::releaseDerivedData()
+{
+    qint64 freed = 0;
+    if (!m_isGrouped && m_hasGroups) {
+        freed += m_groups.memoryBytes();
+        m_groups = DuplicateGroups();
+        m_hasGroups = false;
+        emit groupingChanged();
     }
-    
-    // Ensure we have a valid filename
-    if (sanitized.isEmpty()) {
-        sanitized = "timeline";
+
+    // Virtual columns can be extracted again; keep them while a search or
+    // sort depends on them, or while a scan is adding to them
+    const bool inUse = m_isSorted || (m_isFiltered && virtualColumn(m_filter.column()))
+                    || isIocView() || m_scanInProgress;
+    if (!m_virtualColumns.isEmpty() && !inUse) {
+        freed += virtualColumnBytes();
+        const int first = m_store.headers().size();
+        beginRemoveColumns(QModelIndex(), first, first + m_virtualColumns.size() - 1);
+        m_virtualColumns.clear();
+        m_virtualColumns.squeeze();
+        m_iocSweep.reset();
+        endRemoveColumns();
     }
-    
-    return sanitized;
+    return freed;
 }
 
-bool TimelineModel::ensureTagDirectory() const
+QVector<int> TimelineModel::visibleSourceRows() const
 {
-    QString tagDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
-    QDir dir;
-    if (!dir.exists(tagDir)) {
-        return dir.mkpath(tagDir);
+    if (!m_isFiltered && !m_isSorted) {
+        QVector<int> rows(m_store.rowCount());
+        std::iota(rows.begin(), rows.end(), 0);
+        return rows;
     }
-    return true;
+    QVector<int> rows = m_filteredRows;
+    if (m_isSorted)
+        std::sort(rows.begin(), rows.end());
+    return rows;
 }
 
-bool TimelineModel::isFiltered() const { return m_isFiltered; }
+QVector<RangeExporter::Span> TimelineModel::exportSpans(const QVector<int>& srcRows) const
+{
+    return m_store.exportSpans(srcRows);
+}
+
+qint64 TimelineModel::rowTimestamp(int srcRow) const
+{
+    return m_store.timestamp(srcRow);
+}
+
+QString TimelineModel::exportSourcePath() const
+{
+    return m_store.exportSourcePath();
+}
+
+bool TimelineModel::isAnalysisCache() const
+{
+    return m_store.analysisCache() != nullptr;
+}
+
+bool TimelineModel::seeksFromStart() const
+{
+    return m_store.seeksFromStart();
+}
+
+bool TimelineModel::writeAnalysisCache(const QString& outPath, const std::atomic<bool>& cancel,
+                                       const std::function<void(int, int)>& progress) const
+{
+    return AnalysisCache::convert(m_store, outPath, cancel, progress);
+}
 
 int TimelineModel::filteredRowCount() const
 {
@@ -396,12 +640,18 @@ int TimelineModel::filteredRowCount() const
 
 void TimelineModel::clearFilter()
 {
+    cancelLiveFilter();
     if (!m_isFiltered)
         return;
     beginResetModel();
     m_filteredRows.clear();
     m_isFiltered = false;
+    m_isSorted = false;
+    m_isIocView = false;
+    m_spanCache.clear();
+    dropGroups();
     endResetModel();
+    emit groupingChanged();
 }
 
 void TimelineModel::applyFilter(const QString& column, const QString& term)
@@ -412,69 +662,657 @@ void TimelineModel::applyFilter(const QString& column, const QString& term)
     }
 
     const int colIdx = (column == "All Columns") ? -1 : columnIndex(column);
-    const QString lowerTerm = term.toLower();
-    const int total = lineOffsets.size();
+    cancelLiveFilter();
+    m_filter = FilterEngine(colIdx, term);
+    cancelGrouping();
+    ScanGuard guard(m_scanInProgress);
+
     QVector<int> matches;
+    if (const VirtualColumn* vc = virtualColumn(colIdx)) {
+        // Match each distinct value once, then sweep the code column
+        QElapsedTimer searchTimer;
+        searchTimer.start();
+        QVector<bool> hit(vc->dictionary.size());
+        for (int d = 0; d < vc->dictionary.size(); ++d)
+            hit[d] = vc->dictionary[d].toLower().contains(m_filter.term());
+        for (int i = 0; i < vc->codes.size(); ++i) {
+            if (hit[vc->codes[i]])
+                matches.append(i);
+        }
+        const qint64 searchMs = searchTimer.elapsed();
+        m_store.metrics().recordSearch(searchMs, 0, searchMs, vc->codes.size(), matches.size());
+    } else {
+        matches = m_filter.scan(m_store, [this](int row, int total) {
+            emit searchProgress(row, total);
+            QCoreApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
+        });
+    }
 
-    QMutexLocker locker(&fileMutex);
-    if (!file.isOpen()) {
-        if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
-            return;
-    }
-
-    for (int i = 0; i < total; ++i) {
-        file.seek(lineOffsets[i]);
-        const QString line = QString::fromUtf8(file.readLine().trimmed());
-
-        try {
-            const QStringList fields = FileUtils::parseCsvLine(line);
-            bool match = false;
-            if (colIdx < 0) {
-                for (const QString& f : fields) {
-                    if (f.toLower().contains(lowerTerm)) { match = true; break; }
-                }
-            } else if (colIdx < fields.size()) {
-                match = fields[colIdx].toLower().contains(lowerTerm);
+    beginResetModel();
+    m_filteredRows = matches;
+    m_isFiltered = true;
+    m_isSorted = false;
+    m_isIocView = false;
+    m_liveScannedTo = m_store.rowCount();
+    m_spanCache.clear();
+    dropGroups();
+    endResetModel();
+    emit groupingChanged();
+}
+
+void TimelineModel::startLiveFilter(const QString& column, const QString& term)
+{
+    if (term.isEmpty()) {
+        clearFilter();
+        return;
+    }
+    const int colIdx = (column == "All Columns") ? -1 : columnIndex(column);
+    if (virtualColumn(colIdx)) {
+        applyFilter(column, term);  // dictionary matching needs no file scan
+        return;
+    }
+
+    // Rows matching the new term are a subset of the old hits if the new
+    // term contains the old one
+    const FilterEngine filter(colIdx, term);
+    const bool seeded = m_isFiltered && !m_isSorted && !m_isIocView && m_filter.isActive()
+                     && filter.column() == m_filter.column() && filter.term().contains(m_filter.term());
+    const QVector<int> candidates = seeded ? m_filteredRows : QVector<int>();
+    const int seedEnd = seeded ? m_liveScannedTo : 0;
+
+    cancelLiveFilter();
+    cancelGrouping();
+    beginResetModel();
+    m_filter = filter;
+    m_filteredRows.clear();
+    m_isFiltered = true;
+    m_isSorted = false;
+    m_isIocView = false;
+    m_liveScannedTo = 0;
+    m_spanCache.clear();
+    dropGroups();
+    endResetModel();
+    emit groupingChanged();
+
+    auto cancel = std::make_shared<std::atomic<bool>>(false);
+    m_liveCancel = cancel;
+    const quint64 generation = ++m_liveGeneration;
+    m_liveRunning = true;
+    m_liveTimer.start();
+
+    startBackgroundSearch([this, filter, candidates, seedEnd, cancel, generation]() {
+        const int total = m_store.rowCount();
+        QVector<int> batch;
+        QElapsedTimer sinceFlush, phase;
+        sinceFlush.start();
+        qint64 parseNs = 0;
+        auto flush = [&](int scannedTo, bool finished) {
+            QMetaObject::invokeMethod(this, [this, generation, batch, scannedTo, finished, parseNs]() {
+                applyLiveBatch(generation, batch, scannedTo, finished, parseNs);
+            }, Qt::QueuedConnection);
+            batch.clear();
+            sinceFlush.restart();
+        };
+
+        // Previous hits in the part of the file the previous scan covered
+        QByteArray raw;
+        for (int i = 0; i < candidates.size(); ++i) {
+            if (i % LIVE_CHUNK_ROWS == 0 && cancel->load())
+                return;
+            if (!m_store.readRaw(candidates[i], raw))
+                continue;
+            phase.start();
+            if (filter.matchesLine(raw))
+                batch.append(candidates[i]);
+            parseNs += phase.nsecsElapsed();
+            if (sinceFlush.elapsed() >= LIVE_FLUSH_MS)
+                flush(candidates[i] + 1, false);
+        }
+
+        // The rest of the file, decoded into one reused chunk (or, for an
+        // analysis cache, just the searched columns); the first rows are
+        // shown as soon as they are done
+        RowChunk chunk;
+        const AnalysisCache* cache = m_store.analysisCache();
+        const std::unique_ptr<FilterEngine::CacheScan> cacheScan(
+            cache ? new FilterEngine::CacheScan(filter, *cache) : nullptr);
+        for (int first = seedEnd; first < total; first += LIVE_CHUNK_ROWS) {
+            if (cancel->load())
+                return;
+            const int last = qMin(total, first + LIVE_CHUNK_ROWS);
+            if (cacheScan) {
+                batch += cacheScan->rows(first, last, parseNs);
+            } else {
+                m_store.scanChunks(first, last, chunk, [&](const RowChunk& rows) {
+                    phase.start();
+                    for (int r = 0; r < rows.rowCount(); ++r) {
+                        if (filter.matches(rows, r))
+                            batch.append(rows.firstRow() + r);
+                    }
+                    parseNs += phase.nsecsElapsed();
+                });
             }
-            if (match)
-                matches.append(i);
-        } catch (...) {}
+            if (first == seedEnd || sinceFlush.elapsed() >= LIVE_FLUSH_MS)
+                flush(last, false);
+        }
+        if (!cancel->load())
+            flush(qMax(total, seedEnd), true);
+    });
+}
 
-        if (i % 10000 == 0) {
-            locker.unlock();
-            emit searchProgress(i, total);
+void TimelineModel::startBackgroundSearch(const std::function<void()>& work)
+{
+    QThread* thread = QThread::create(work);
+    thread->setParent(this);
+    connect(thread, &QThread::finished, this, [this, thread]() {
+        m_liveThreads.removeAll(thread);
+        thread->deleteLater();
+    });
+    m_liveThreads.append(thread);
+    thread->start();
+}
+
+void TimelineModel::applyLiveBatch(quint64 generation, const QVector<int>& rows, int scannedTo,
+                                   bool finished, qint64 parseNs)
+{
+    if (generation != m_liveGeneration)
+        return;
+    if (!rows.isEmpty()) {
+        const int first = rowCount();
+        beginInsertRows(QModelIndex(), first, first + rows.size() - 1);
+        m_filteredRows += rows;
+        endInsertRows();
+    }
+    m_liveScannedTo = scannedTo;
+
+    if (finished) {
+        m_liveRunning = false;
+        const qint64 searchMs = m_liveTimer.elapsed();
+        const qint64 parseMs = parseNs / 1000000;
+        m_store.metrics().recordSearch(searchMs, qMax<qint64>(0, searchMs - parseMs), parseMs,
+                                       scannedTo, m_filteredRows.size());
+    }
+    emit liveFilterProgress(m_filteredRows.size(), scannedTo, m_store.rowCount(), finished);
+}
+
+void TimelineModel::cancelLiveFilter()
+{
+    if (m_liveCancel)
+        *m_liveCancel = true;
+    ++m_liveGeneration;
+    m_liveRunning = false;
+}
+
+bool TimelineModel::isLiveFilterRunning() const
+{
+    return m_liveRunning;
+}
+
+bool TimelineModel::estimateMatches(const QString& column, const QString& term)
+{
+    cancelEstimate();
+    const int colIdx = (column == "All Columns") ? -1 : columnIndex(column);
+    if (term.isEmpty() || virtualColumn(colIdx) || !m_store.isPositional())
+        return false;
+
+    const FilterEngine filter(colIdx, term);
+    auto cancel = std::make_shared<std::atomic<bool>>(false);
+    m_estimateCancel = cancel;
+    const quint64 generation = ++m_estimateGeneration;
+    startBackgroundSearch([this, filter, cancel, generation]() {
+        MatchEstimator::run(m_store, filter, *cancel, [this, generation](const MatchEstimator::Estimate& e) {
+            QMetaObject::invokeMethod(this, [this, generation, e]() {
+                if (generation == m_estimateGeneration)
+                    emit matchEstimated(e);
+            }, Qt::QueuedConnection);
+        });
+    });
+    return true;
+}
+
+void TimelineModel::cancelEstimate()
+{
+    if (m_estimateCancel)
+        *m_estimateCancel = true;
+    ++m_estimateGeneration;
+}
+
+int TimelineModel::applyIocSweep(const std::shared_ptr<const IocSweep>& sweep)
+{
+    cancelLiveFilter();
+    cancelGrouping();
+    const int total = m_store.rowCount();
+    QVector<IocSweep::Hit> hits;
+    {
+        ScanGuard guard(m_scanInProgress);
+        hits = sweep->scan(m_store, 0, [this](int done, int totalRows) {
+            emit searchProgress(done, totalRows);
             QCoreApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
-            locker.relock();
+        });
+    }
+
+    // Dictionary-encoded like the Sysmon columns: one code per distinct
+    // combination of indicators
+    VirtualColumn column;
+    column.name = IOC_COLUMN;
+    column.dictionary.append(QString());
+    column.lookup.insert(QString(), 0);
+    column.codes.fill(0, total);
+    QVector<int> rows;
+    rows.reserve(hits.size());
+    for (const IocSweep::Hit& hit : hits) {
+        const QString label = sweep->describe(hit.patterns);
+        auto it = column.lookup.constFind(label);
+        if (it == column.lookup.constEnd()) {
+            it = column.lookup.insert(label, column.dictionary.size());
+            column.dictionary.append(label);
         }
+        column.codes[hit.row] = it.value();
+        rows.append(hit.row);
     }
 
     beginResetModel();
-    m_filteredRows = matches;
+    const int existing = columnIndex(IOC_COLUMN) - m_store.headers().size();
+    if (existing >= 0)
+        m_virtualColumns[existing] = column;
+    else
+        m_virtualColumns.append(column);
+    m_iocSweep = sweep;
+    m_isIocView = true;
+    m_filter = FilterEngine();
+    m_filteredRows = rows;
     m_isFiltered = true;
+    m_isSorted = false;
+    m_spanCache.clear();
+    dropGroups();
     endResetModel();
+    emit groupingChanged();
+    return rows.size();
 }
 
-QString TimelineModel::getTagFilePath() const
+bool TimelineModel::isIocView() const { return m_isFiltered && m_isIocView; }
+
+bool TimelineModel::annotateIocHits(int srcRow, const QByteArray& raw)
 {
-    if (!ensureTagDirectory()) {
-        qWarning() << "Failed to create application data directory";
-        return QString(); // Return empty string on failure
+    const QVector<int> ids = m_iocSweep->match(raw);
+    if (ids.isEmpty())
+        return false;
+    VirtualColumn& column = m_virtualColumns[columnIndex(IOC_COLUMN) - m_store.headers().size()];
+    const QString label = m_iocSweep->describe(ids);
+    auto it = column.lookup.constFind(label);
+    if (it == column.lookup.constEnd()) {
+        it = column.lookup.insert(label, column.dictionary.size());
+        column.dictionary.append(label);
     }
-    
-    QFileInfo fileInfo(filePath);
-    if (!fileInfo.exists()) {
-        qWarning() << "Source timeline file no longer exists";
-        return QString();
+    column.codes[srcRow] = it.value();
+    return true;
+}
+
+bool TimelineModel::rowMatchesFilter(int srcRow, const QByteArray& raw) const
+{
+    if (const VirtualColumn* vc = virtualColumn(m_filter.column())) {
+        return srcRow < vc->codes.size()
+            && vc->dictionary[vc->codes[srcRow]].toLower().contains(m_filter.term());
     }
-    
-    QString baseName = sanitizeFileName(fileInfo.completeBaseName());
-    if (baseName.isEmpty()) {
-        qWarning() << "Unable to generate valid tag filename";
-        return QString();
+    return m_filter.matchesLine(raw);
+}
+
+const TimelineModel::VirtualColumn* TimelineModel::virtualColumn(int column) const
+{
+    const int v = column - m_store.headers().size();
+    if (column < 0 || v < 0 || v >= m_virtualColumns.size())
+        return nullptr;
+    return &m_virtualColumns[v];
+}
+
+bool TimelineModel::hasVirtualColumns() const { return !m_virtualColumns.isEmpty(); }
+
+bool TimelineModel::hasSysmonColumns() const
+{
+    return columnIndex(SysmonFields::defaultFields().first()) >= 0;
+}
+
+bool TimelineModel::isVirtualColumn(int column) const { return virtualColumn(column) != nullptr; }
+
+bool TimelineModel::isSorted() const { return m_isSorted; }
+
+void TimelineModel::extractSysmonColumns(const QStringList& fieldNames)
+{
+    if (type() != TimelineParser::Super || fieldNames.isEmpty() || columnIndex(fieldNames.first()) >= 0
+        || m_extractThread)
+        return;
+
+    m_extractCancel = false;
+    const int total = m_store.rowCount();
+    QThread* thread = QThread::create([this, fieldNames, total]() {
+        QElapsedTimer timer;
+        timer.start();
+        QVector<VirtualColumn> columns(fieldNames.size());
+        for (int c = 0; c < fieldNames.size(); ++c) {
+            columns[c].name = fieldNames[c];
+            columns[c].dictionary.append(QString());
+            columns[c].codes.fill(0, total);
+            columns[c].lookup.insert(QString(), 0);
+        }
+        bool scanned = true;
+        for (int first = 0; first < total && scanned; first += EXTRACT_CHUNK_ROWS) {
+            if (m_extractCancel) {
+                scanned = false;
+                break;
+            }
+            const int last = qMin(total, first + EXTRACT_CHUNK_ROWS);
+            scanned = m_store.scan(first, last, [&](int row, const QByteArray& raw) {
+                extractVirtualFields(columns, fieldNames, row, raw);
+            });
+            emit extractionProgress(last, total);
+        }
+        const qint64 elapsedMs = timer.elapsed();
+
+        QMetaObject::invokeMethod(this, [this, columns, fieldNames, total, scanned, elapsedMs]() mutable {
+            if (!scanned || m_extractCancel || columnIndex(fieldNames.first()) >= 0) {
+                emit extractionFinished(0);
+                return;
+            }
+            // Rows appended while the pass ran (follow mode) are few
+            const int rows = m_store.rowCount();
+            if (rows > total) {
+                for (VirtualColumn& vc : columns)
+                    vc.codes.resize(rows);
+                m_store.scan(total, rows, [&](int row, const QByteArray& raw) {
+                    extractVirtualFields(columns, fieldNames, row, raw);
+                });
+            }
+            const int first = columnCount();
+            beginInsertColumns(QModelIndex(), first, first + columns.size() - 1);
+            m_virtualColumns += columns;
+            endInsertColumns();
+            qDebug() << "TimelineModel: extracted" << columns.size() << "Sysmon columns in"
+                     << elapsedMs << "ms";
+            emit extractionFinished(static_cast<int>(columns.size()));
+        }, Qt::QueuedConnection);
+    });
+    thread->setParent(this);
+    connect(thread, &QThread::finished, this, [this, thread]() {
+        if (m_extractThread == thread)
+            m_extractThread = nullptr;
+        thread->deleteLater();
+    });
+    m_extractThread = thread;
+    thread->start();
+}
+
+void TimelineModel::cancelExtraction()
+{
+    m_extractCancel = true;
+}
+
+bool TimelineModel::isExtractionRunning() const
+{
+    return m_extractThread != nullptr;
+}
+
+void TimelineModel::extractVirtualFields(QVector<VirtualColumn>& columns, const QStringList& fieldNames,
+                                         int srcRow, const QByteArray& raw) const
+{
+    if (!SysmonFields::containsEventData(raw))
+        return;
+
+    QStringList fields;
+    try {
+        fields = FileUtils::parseCsvLine(QString::fromUtf8(raw.trimmed()));
+    } catch (...) {}
+
+    QStringList values;
+    if (fields.size() <= 4 || SysmonFields::extract(fields[4], fieldNames, values) == 0)
+        return;
+
+    for (int c = 0; c < columns.size(); ++c) {
+        if (values[c].isEmpty())
+            continue;
+        auto it = columns[c].lookup.constFind(values[c]);
+        if (it == columns[c].lookup.constEnd()) {
+            it = columns[c].lookup.insert(values[c], columns[c].dictionary.size());
+            columns[c].dictionary.append(values[c]);
+        }
+        columns[c].codes[srcRow] = it.value();
     }
-    
-    QString tagFileName = baseName + ".tags";
-    QString tagDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
-    
-    return tagDir + QDir::separator() + tagFileName;
-} 
\ No newline at end of file
+}
+
+bool TimelineModel::canFollow() const
+{
+    return m_store.canFollow();
+}
+
+int TimelineModel::appendNewRows()
+{
+    // A full scan yielding to the event loop (or a live search) has a fixed
+    // row count; new rows are picked up by the next call once it finishes.
+    if (!canFollow() || m_scanInProgress || m_liveRunning)
+        return 0;
+
+    // Evaluate the active filter and virtual columns on the new rows only
+    const int firstNew = m_store.rowCount();
+    QStringList names;
+    for (const VirtualColumn& vc : m_virtualColumns)
+        names << vc.name;
+    QVector<int> newMatches;
+    const RowStore::Append append = m_store.pollAppended([&](int row, const QByteArray& raw) {
+        if (!m_virtualColumns.isEmpty()) {
+            for (VirtualColumn& vc : m_virtualColumns)
+                vc.codes.resize(row + 1);
+            extractVirtualFields(m_virtualColumns, names, row, raw);
+        }
+        const bool iocHit = m_iocSweep && annotateIocHits(row, raw);
+        if (m_isFiltered && (m_isIocView ? iocHit : rowMatchesFilter(row, raw)))
+            newMatches.append(row);
+    });
+    const int newRows = append.offsets.size();
+
+    if (append.completedRow >= 0) {
+        m_formatCache.remove(append.completedRow);
+        m_rowCache.remove(append.completedRow);
+        for (int c = 0; c < columnCount(); ++c)
+            m_spanCache.remove((static_cast<quint64>(append.completedRow) << 16) | static_cast<quint16>(c));
+        ++m_rowCacheGeneration;
+        const int viewRow = toViewRow(append.completedRow);
+        if (viewRow >= 0)
+            emit dataChanged(createIndex(viewRow, 0), createIndex(viewRow, columnCount() - 1));
+    }
+
+    if (newRows == 0)
+        return 0;
+
+    // New rows come after every duplicate group, so they are inserted after
+    // the last view row even while grouped
+    const int first = rowCount();
+    if (m_isFiltered) {
+        m_store.commitAppended(append);
+        if (!newMatches.isEmpty()) {
+            beginInsertRows(QModelIndex(), first, first + newMatches.size() - 1);
+            m_filteredRows += newMatches;
+            endInsertRows();
+        }
+        if (m_liveScannedTo == firstNew)
+            m_liveScannedTo = m_store.rowCount();
+    } else if (m_isSorted) {
+        // New rows go after the sorted block until the next sort
+        beginInsertRows(QModelIndex(), first, first + newRows - 1);
+        m_store.commitAppended(append);
+        for (int k = 0; k < newRows; ++k)
+            m_filteredRows.append(firstNew + k);
+        endInsertRows();
+    } else {
+        beginInsertRows(QModelIndex(), first, first + newRows - 1);
+        m_store.commitAppended(append);
+        endInsertRows();
+    }
+    return newRows;
+}
+
+void TimelineModel::sort(int column, Qt::SortOrder order)
+{
+    const VirtualColumn* vc = virtualColumn(column);
+    if (!vc || m_liveRunning)  // a live search is still appending hits
+        return;
+
+    // Rank the distinct values once (numerically where both sides are
+    // numbers), so rows are ordered by integer comparison only.
+    const QVector<QString>& dict = vc->dictionary;
+    QVector<quint32> byValue(dict.size());
+    std::iota(byValue.begin(), byValue.end(), 0u);
+    std::sort(byValue.begin(), byValue.end(), [&dict](quint32 a, quint32 b) {
+        bool okA = false, okB = false;
+        const qlonglong na = dict[a].toLongLong(&okA);
+        const qlonglong nb = dict[b].toLongLong(&okB);
+        if (okA && okB)
+            return na < nb;
+        return dict[a].compare(dict[b], Qt::CaseInsensitive) < 0;
+    });
+    QVector<quint32> rank(dict.size());
+    for (int k = 0; k < byValue.size(); ++k)
+        rank[byValue[k]] = k;
+
+    QVector<int> rows;
+    if (m_isFiltered || m_isSorted) {
+        rows = m_filteredRows;
+    } else {
+        rows.resize(m_store.rowCount());
+        std::iota(rows.begin(), rows.end(), 0);
+    }
+    const QVector<quint32>& codes = vc->codes;
+    std::stable_sort(rows.begin(), rows.end(), [&](int a, int b) {
+        return order == Qt::AscendingOrder ? rank[codes[a]] < rank[codes[b]]
+                                           : rank[codes[a]] > rank[codes[b]];
+    });
+
+    beginResetModel();
+    m_filteredRows = rows;
+    m_isSorted = true;
+    dropGroups();
+    endResetModel();
+    emit groupingChanged();
+}
+
+void TimelineModel::restoreSourceOrder()
+{
+    if (!m_isSorted)
+        return;
+    beginResetModel();
+    if (m_isFiltered)
+        std::sort(m_filteredRows.begin(), m_filteredRows.end());
+    else
+        m_filteredRows.clear();
+    m_isSorted = false;
+    endResetModel();
+}
+
+bool TimelineModel::groupDuplicates(const DuplicateGroups::Key& key)
+{
+    if (m_isSorted || m_liveRunning || key.columns.isEmpty() || (m_isFiltered && m_filteredRows.isEmpty()))
+        return false;
+
+    // One pass at a time; a cancelled pass stops within CANCEL_CHECK_ROWS rows
+    cancelGrouping();
+    if (m_groupThread)
+        m_groupThread->wait();
+    m_groupCancel = false;
+
+    const QVector<int> rows = m_isFiltered ? m_filteredRows : QVector<int>();
+    const quint64 generation = m_groupGeneration;
+    QThread* thread = QThread::create([this, rows, key, generation]() {
+        QElapsedTimer timer;
+        timer.start();
+        const DuplicateGroups groups = DuplicateGroups::build(m_store, rows, key, m_groupCancel,
+            [this](int done, int total) { emit groupingProgress(done, total); });
+        const qint64 elapsedMs = timer.elapsed();
+
+        QMetaObject::invokeMethod(this, [this, groups, generation, elapsedMs]() {
+            if (generation != m_groupGeneration)
+                return;
+            beginResetModel();
+            m_groups = groups;
+            m_hasGroups = true;
+            m_isGrouped = !groups.isEmpty();
+            endResetModel();
+            qDebug() << "TimelineModel: grouped duplicates into" << groups.runCount() << "runs,"
+                     << groups.hiddenRows() << "rows collapsed in" << elapsedMs << "ms";
+            emit groupingChanged();
+        }, Qt::QueuedConnection);
+    });
+    thread->setParent(this);
+    connect(thread, &QThread::finished, this, [this, thread]() {
+        if (m_groupThread == thread)
+            m_groupThread = nullptr;
+        thread->deleteLater();
+    });
+    m_groupThread = thread;
+    thread->start();
+    return true;
+}
+
+void TimelineModel::cancelGrouping()
+{
+    m_groupCancel = true;
+    ++m_groupGeneration;
+}
+
+bool TimelineModel::isGroupingRunning() const
+{
+    return m_groupThread != nullptr;
+}
+
+void TimelineModel::dropGroups()
+{
+    cancelGrouping();
+    m_groups = DuplicateGroups();
+    m_hasGroups = false;
+    m_isGrouped = false;
+}
+
+bool TimelineModel::hasDuplicateGroups() const { return m_hasGroups; }
+
+bool TimelineModel::isGrouped() const { return m_isGrouped; }
+
+int TimelineModel::hiddenDuplicateRows() const
+{
+    return m_isGrouped ? m_groups.hiddenRows() : 0;
+}
+
+void TimelineModel::setGrouped(bool grouped)
+{
+    if (grouped == m_isGrouped || (grouped && m_groups.isEmpty()))
+        return;
+    beginResetModel();
+    m_isGrouped = grouped;
+    endResetModel();
+    emit groupingChanged();
+}
+
+int TimelineModel::groupLength(int viewRow) const
+{
+    if (!m_isGrouped || viewRow < 0 || viewRow >= rowCount())
+        return 1;
+    const int run = m_groups.runAt(m_groups.toPosition(viewRow));
+    return run < 0 ? 1 : m_groups.run(run).length;
+}
+
+void TimelineModel::toggleGroupExpanded(int viewRow)
+{
+    const int length = groupLength(viewRow);
+    if (length <= 1)
+        return;
+    const int run = m_groups.runAt(m_groups.toPosition(viewRow));
+
+    // The run's other rows sit right below its first row
+    if (m_groups.isExpanded(run)) {
+        beginRemoveRows(QModelIndex(), viewRow + 1, viewRow + length - 1);
+        m_groups.setExpanded(run, false);
+        endRemoveRows();
+    } else {
+        beginInsertRows(QModelIndex(), viewRow + 1, viewRow + length - 1);
+        m_groups.setExpanded(run, true);
+        endInsertRows();
+    }
+    emit headerDataChanged(Qt::Vertical, viewRow, viewRow);
+    emit groupingChanged();
+}
@@ -2,27 +2,44 @@
 #include <QAbstractTableModel>
 #include <QString>
 #include <QVector>
-#include <QFile>
-#include <QTextStream>
-#include <QSet>
-#include <QStandardPaths>
-#include <QDir>
-#include <QRegularExpression>
-#include <QMutex>
-#include <QMutexLocker>
+#include <QCache>
+#include <QHash>
+#include <QThreadPool>
+#include <QElapsedTimer>
+#include <QList>
+#include <atomic>
 #include <memory>
+#include "core/RowStore.h"
+#include "core/RowChunk.h"
+#include "core/FilterEngine.h"
+#include "core/TagStore.h"
+#include "core/DuplicateGroups.h"
+#include "core/IocSweep.h"
+#include "core/MatchEstimator.h"
+#include "utils/RangeExporter.h"
+#include "utils/PerfMetrics.h"
+
+class QThread;
 
 /**
  * @brief TimelineModel is a QAbstractTableModel backed by a timeline CSV file.
+ *
+ * Reading, indexing, searching and tagging are done by the timeline_core
+ * classes (RowStore, FilterEngine, TagStore); the model adds the view
+ * mapping, virtual columns and display formatting.
  */
 class TimelineModel : public QAbstractTableModel {
     Q_OBJECT
 public:
-    enum TimelineType {
-        Filesystem,
-        Super,
-        Unknown
-    };
+    using TimelineType = TimelineParser::TimelineType;
+    // Search hits in a cell's display text as a QList<int> of (start,
+    // length) pairs; invalid when the cell has none (see HighlightDelegate)
+    static constexpr int MatchSpansRole = Qt::UserRole + 1;
+    // The untruncated cell value, read from the file (for copying)
+    static constexpr int FullTextRole = Qt::UserRole + 2;
+    // Longer fields are shown cut to this many bytes, ending in "…"
+    static constexpr int DISPLAY_FIELD_BYTES = 512;
+
     TimelineModel(const QString& filePath, QObject* parent = nullptr);
     ~TimelineModel();
     int rowCount(const QModelIndex& parent = QModelIndex()) const override;
@@ -31,47 +48,246 @@ public:
     QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
     bool setData(const QModelIndex& index, const QVariant& value, int role = Qt::EditRole) override;
     Qt::ItemFlags flags(const QModelIndex& index) const override;
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override; // virtual columns only
     int columnIndex(const QString& name) const;
     TimelineType type() const;
     bool isRowTagged(int row) const;
+    QVector<int> taggedSourceRows() const; // ascending
     void setRowTagged(int row, bool tagged);
     bool hasUnsavedChanges() const;
     bool saveTaggedRows();
     QString getFilePath() const;
 
+    // Full cell text for the detail window. Unlike data(), fields are not
+    // truncated and message fields of Super timelines are pretty-printed;
+    // results are cached per source row.
+    QString formattedData(const QModelIndex& index) const;
+
+    // Source-row access, independent of any active filter or sort
+    int totalRowCount() const;
+    bool readRawLine(int srcRow, QByteArray& line) const;
+    QString cellText(int srcRow, int column) const;        // as shown in the table
+    qint64 rowTimestamp(int srcRow) const;                  // first column, see RowStore::timestamp()
+    QString fullCellText(int srcRow, int column) const;    // untruncated, read from the file
+    // Untruncated values of several cells of one row, in the order given;
+    // the row is read from the file once
+    QStringList fullRowText(int srcRow, const QVector<int>& columns) const;
+    // Bulk access for passes over many rows (search, export, statistics):
+    // decodes source rows [first, last) into columns with one read. Reuse
+    // the chunk across calls so its buffers are only allocated once.
+    bool decodeRows(int firstSrcRow, int lastSrcRow, RowChunk& chunk) const;
+    QString formattedCell(int srcRow, int column) const;   // as shown in the detail window
+    const QVector<int>& filteredSourceRows() const;        // ascending; valid while filtered and unsorted
+    QVector<int> visibleSourceRows() const;                // rows currently shown, in source order
+    int toSourceRow(int viewRow) const;                    // maps view row → source row
+    int toViewRow(int srcRow) const;                       // -1 if the row is not shown
+
+    // Byte ranges of the header plus the given (ascending) source rows, with
+    // adjacent rows merged into one span; input for RangeExporter
+    QVector<RangeExporter::Span> exportSpans(const QVector<int>& srcRows) const;
+    QString exportSourcePath() const;  // the file they refer to; empty if unavailable
+
+    // Analysis cache (see AnalysisCache): whether the model was opened from
+    // one, and conversion of this timeline into one. The conversion runs on
+    // the calling thread and only reads the file; it returns false if
+    // cancelled and throws std::runtime_error on failure.
+    bool isAnalysisCache() const;
+    bool writeAnalysisCache(const QString& outPath, const std::atomic<bool>& cancel,
+                            const std::function<void(int, int)>& progress = {}) const;
+
+    // A compressed timeline stored as one large zstd frame: every random read
+    // decodes the file from its start (see CompressedFile::seeksFromStart())
+    bool seeksFromStart() const;
+
+    // Rows [firstRow, lastRow] (view rows) are on screen. They are read in
+    // one batch and the next screen in the scroll direction is read ahead
+    // on a background thread, so data() is served from memory. There is no
+    // read-ahead when seeksFromStart(), as it would hold the decoder for as
+    // long as the visible rows take.
+    void setVisibleRange(int firstRow, int lastRow);
+
     // Filter (search) — scans the file with periodic processEvents() calls
     void applyFilter(const QString& column, const QString& term);
+
+    // Search-as-you-type — the scan runs on a background thread and matching
+    // rows are appended to the view in batches as they are found. A new term
+    // cancels the running scan; if it contains the previous term (same
+    // column), only the previous hits are checked again for the part of the
+    // file already scanned, and the rest is scanned as usual.
+    void startLiveFilter(const QString& column, const QString& term);
+    void cancelLiveFilter();
+    bool isLiveFilterRunning() const;
+
+    // Match-count preview — tests the term on a growing random sample of
+    // rows on a background thread, emitting matchEstimated() as it goes.
+    // Returns false for virtual columns, which are filtered at once anyway,
+    // and for compressed input, whose random reads would stall the scan.
+    bool estimateMatches(const QString& column, const QString& term);
+    void cancelEstimate();
+
     void clearFilter();
     bool isFiltered() const;
     int  filteredRowCount() const; // -1 when no filter is active
 
+    // IOC sweep — one multi-pattern pass over the file (see IocSweep). The
+    // view shows the rows containing any indicator, and an "ioc_hits"
+    // virtual column names the indicators found in each row; the column
+    // stays after the view is cleared and follows appended rows. Replaces
+    // any search filter; returns the number of rows hit.
+    static constexpr const char* IOC_COLUMN = "ioc_hits";
+    int applyIocSweep(const std::shared_ptr<const IocSweep>& sweep);
+    bool isIocView() const;
+
+    // Virtual columns — Sysmon <Data Name=...> values extracted from the
+    // message field of Super timelines and appended after the CSV columns.
+    // The extraction runs on a background thread; the columns are added and
+    // extractionFinished() emitted when it is done.
+    void extractSysmonColumns(const QStringList& fieldNames);
+    void cancelExtraction();
+    bool isExtractionRunning() const;
+    bool hasVirtualColumns() const;
+    bool hasSysmonColumns() const;
+    bool isVirtualColumn(int column) const;
+    bool isSorted() const;
+    void restoreSourceOrder();
+
+    // Duplicate grouping — a background pass hashes the key columns of the
+    // shown rows and collapses repeats into one row, whose vertical header
+    // shows the run length. Only unsorted views can be grouped; a new
+    // search or sort drops the groups. Once built, grouping is toggled and
+    // single runs expanded without reading the file again.
+    bool groupDuplicates(const DuplicateGroups::Key& key);  // false if the view cannot be grouped
+    void cancelGrouping();
+    bool isGroupingRunning() const;
+    bool hasDuplicateGroups() const;   // built for the current view
+    void setGrouped(bool grouped);
+    bool isGrouped() const;
+    int hiddenDuplicateRows() const;   // rows collapsed away while grouped
+    int groupLength(int viewRow) const;  // rows behind a grouped row, 1 otherwise
+    void toggleGroupExpanded(int viewRow);
+
+    // Follow mode — index lines appended to the file since the last call and
+    // insert them (or, while filtered, just the matching ones) into the view.
+    // Returns the number of new source rows.
+    bool canFollow() const;
+    int appendNewRows();
+
+    // Instrumentation for the Performance dialog; the snapshot adds the
+    // memory currently held by the index, filter and caches
+    PerfMetrics& metrics() const;
+    QJsonObject metricsSnapshot() const;
+
+    // Memory budget (see AppWindow). memoryBytes() is the total of the
+    // snapshot's memory_bytes figures; the release functions return the
+    // bytes they freed.
+    qint64 memoryBytes() const;
+    qint64 releaseCaches();       // row and format caches, refilled on demand
+    qint64 releaseDerivedData();  // virtual columns and duplicate groups not in use
+
 signals:
     void tagsModified(bool hasUnsavedChanges);
     void searchProgress(int linesScanned, int totalLines);
+    void extractionProgress(int linesScanned, int totalLines);  // emitted from the extraction thread
+    void extractionFinished(int columnsAdded);  // 0 if cancelled
+    void groupingProgress(int rowsHashed, int totalRows);  // emitted from the grouping thread
+    void groupingChanged();  // groups built or dropped, or grouping toggled
+    void liveFilterProgress(int matches, int rowsScanned, int totalRows, bool finished);
+    void matchEstimated(const MatchEstimator::Estimate& estimate);
 
 private:
-    // Security limits
-    static constexpr qint64 MAX_FILE_SIZE = 2LL * 1024 * 1024 * 1024;  // 2GB limit
-    static constexpr int MAX_LINE_COUNT = 10000000;  // 10 million lines
-    static constexpr qint64 MAX_INDEX_MEMORY = 500LL * 1024 * 1024;  // 500MB for index
-    QString filePath;
-    TimelineType timelineType;
-    QStringList headers;
-    QVector<qint64> lineOffsets; // File offsets for each line
-    mutable QFile file;
-    mutable QMutex fileMutex; // Protect file operations
-    QSet<int> taggedRows; // Set of tagged row indices
-    bool unsavedChanges;
-
-    // Search filter state
-    QVector<int> m_filteredRows; // source-row indices that match current search
+    static constexpr int FORMAT_CACHE_COST = 8 * 1024 * 1024;  // characters of formatted text kept
+    static constexpr int ROW_CACHE_ROWS = 4096;   // parsed rows kept around the viewport
+    static constexpr int MAX_RUN_GAP = 16;        // unwanted rows read to join two batches
+    static constexpr int ROW_CACHE_OVERHEAD = 256; // bytes per cached row besides its text
+    static constexpr int SPAN_CACHE_CELLS = 16384;  // cells whose match spans are kept
+    RowStore m_store;
+    TagStore m_tags;
+
+    // View state — m_filteredRows maps view rows to source rows whenever a
+    // search filter or a virtual-column sort is active
+    QVector<int> m_filteredRows;
     bool m_isFiltered = false;
-    int toSourceRow(int viewRow) const; // maps view row → source row
-
-    void detectFormat();
-    void buildLineIndex();
-    void loadTaggedRows();
-    QString getTagFilePath() const;
-    QString sanitizeFileName(const QString& fileName) const;
-    bool ensureTagDirectory() const;
-}; 
\ No newline at end of file
+    bool m_isSorted = false;
+    FilterEngine m_filter;     // kept so rows appended in follow mode can be tested
+    bool rowMatchesFilter(int srcRow, const QByteArray& raw) const;
+
+    // Search-as-you-type state (see startLiveFilter())
+    static constexpr int LIVE_CHUNK_ROWS = 16384;  // rows scanned between cancellation checks
+    static constexpr int LIVE_FLUSH_MS = 50;       // longest delay before found rows are shown
+    QList<QThread*> m_liveThreads;                 // live scans and estimates, possibly cancelled
+    std::shared_ptr<std::atomic<bool>> m_liveCancel;
+    quint64 m_liveGeneration = 0;
+    bool m_liveRunning = false;
+    int m_liveScannedTo = 0;  // m_filteredRows is final for rows [0, m_liveScannedTo)
+    QElapsedTimer m_liveTimer;
+    std::shared_ptr<std::atomic<bool>> m_estimateCancel;
+    quint64 m_estimateGeneration = 0;
+    void startBackgroundSearch(const std::function<void()>& work);
+    void applyLiveBatch(quint64 generation, const QVector<int>& rows, int scannedTo,
+                        bool finished, qint64 parseNs);
+
+    // Set while the ioc_hits column exists; m_isIocView while the filter
+    // is "rows with an IOC hit" rather than m_filter
+    std::shared_ptr<const IocSweep> m_iocSweep;
+    bool m_isIocView = false;
+    bool annotateIocHits(int srcRow, const QByteArray& raw);  // true if the row has hits
+
+    // Set while a full-file scan yields to the event loop
+    bool m_scanInProgress = false;
+    struct ScanGuard {
+        bool& flag;
+        explicit ScanGuard(bool& f) : flag(f) { flag = true; }
+        ~ScanGuard() { flag = false; }
+    };
+
+    // Duplicate groups over positions of the ungrouped view (indices into
+    // m_filteredRows while filtered, source rows otherwise)
+    DuplicateGroups m_groups;
+    bool m_hasGroups = false;
+    bool m_isGrouped = false;
+    QThread* m_groupThread = nullptr;
+    std::atomic<bool> m_groupCancel{false};
+    quint64 m_groupGeneration = 0;  // bumped when a pending result would be stale
+    void dropGroups();              // call between beginResetModel() and endResetModel()
+
+    // Sysmon extraction pass; checks for cancellation every EXTRACT_CHUNK_ROWS
+    static constexpr int EXTRACT_CHUNK_ROWS = 16384;
+    QThread* m_extractThread = nullptr;
+    std::atomic<bool> m_extractCancel{false};
+
+    // Parsed rows by source row (LRU), filled by batched and read-ahead
+    // reads. Fields are cut to DISPLAY_FIELD_BYTES. Only touched on the GUI
+    // thread; prefetch results are posted back.
+    mutable QCache<int, QStringList> m_rowCache{ROW_CACHE_ROWS};
+    quint64 m_rowCacheGeneration = 0;  // bumped when cached rows may be stale
+    int m_visibleFirst = -1;
+    bool m_prefetchPending = false;
+    QThreadPool m_prefetchPool;
+    bool rowFields(int srcRow, QStringList& fields) const;
+    QVector<int> sourceRows(int firstViewRow, int lastViewRow) const; // ascending
+    void loadRows(const QVector<int>& srcRows);
+    void prefetchRows(const QVector<int>& srcRows);
+
+    // Match spans of the current search by (source row, column), computed
+    // once per cell when it is first painted; cleared when the search changes
+    mutable QCache<quint64, QList<int>> m_spanCache{SPAN_CACHE_CELLS};
+    QVariant matchSpans(int srcRow, int column) const;
+
+    // Pretty-printed message fields, keyed by source row (LRU via QCache)
+    mutable QCache<int, QString> m_formatCache{FORMAT_CACHE_COST};
+
+    // Dictionary-encoded column: one code per source row, code 0 is ""
+    struct VirtualColumn {
+        QString name;
+        QVector<QString> dictionary;
+        QVector<quint32> codes;
+        QHash<QString, quint32> lookup; // value → code, shares strings with dictionary
+    };
+    QVector<VirtualColumn> m_virtualColumns;
+    const VirtualColumn* virtualColumn(int column) const;
+    qint64 virtualColumnBytes() const;
+    QJsonObject memoryUsage() const;  // bytes per structure
+    qint64 m_fileBytes = 0;           // at open; estimates the size of cached rows
+    void extractVirtualFields(QVector<VirtualColumn>& columns, const QStringList& fieldNames,
+                              int srcRow, const QByteArray& raw) const;
+};
@@ -0,0 +1,482 @@
+#include "TimelineServer.h"
+#include "core/RowStore.h"
+#include "core/FilterEngine.h"
+#include "core/TagStore.h"
+#include "core/IoBackend.h"
+#include "utils/FileUtils.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QThread>
+#include <QTimer>
+#include <QDebug>
+#include <stdexcept>
+#include <cstdio>
+
+bool TimelineServer::isServerInvocation(int argc, char* argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        if (QString::fromLocal8Bit(argv[i]).startsWith("--serve"))
+            return true;
+    }
+    return false;
+}
+
+TimelineServer::TimelineServer(const QStringList& arguments, QObject* parent)
+    : QObject(parent), m_arguments(arguments)
+{
+}
+
+TimelineServer::~TimelineServer()
+{
+    for (const Client& client : m_clients) {
+        for (const auto& cancel : client.scans)
+            *cancel = true;
+    }
+    for (QThread* thread : m_scanThreads) {
+        thread->wait();
+        delete thread;
+    }
+    saveTags();
+}
+
+bool TimelineServer::parseArguments(QString& error)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Timeline server: hosts indexed timelines for several viewers");
+    const QCommandLineOption serveOption("serve",
+        "Listen on the local socket <name>; viewers attach with File > Attach to Server.", "name");
+    const QCommandLineOption groupOption("group-access",
+        "Let members of the owner's group connect, not only the owner.");
+    const QCommandLineOption ioOption("io",
+        "How plain files are read: buffered, mmap or async (default: $TIMELINE_IO, else buffered).", "backend");
+    const QCommandLineOption debugOption("debug", "Enable debug logging.");
+    parser.addOptions({serveOption, groupOption, ioOption, debugOption});
+    parser.addPositionalArgument("files", "Timeline files to host.", "<file>...");
+
+    if (!parser.parse(m_arguments)) {
+        error = parser.errorText();
+        return false;
+    }
+    m_name = parser.value(serveOption);
+    if (m_name.isEmpty()) {
+        error = "--serve needs a socket name";
+        return false;
+    }
+    m_files = parser.positionalArguments();
+    if (m_files.isEmpty()) {
+        error = "No timeline files given";
+        return false;
+    }
+    m_groupAccess = parser.isSet(groupOption);
+    if (parser.isSet(ioOption)) {
+        IoBackend::Kind kind = IoBackend::Buffered;
+        if (!IoBackend::parseKind(parser.value(ioOption), &kind)) {
+            error = "--io needs buffered, mmap or async";
+            return false;
+        }
+        IoBackend::setDefaultKind(kind);
+    }
+    return true;
+}
+
+int TimelineServer::exec()
+{
+    QString error;
+    if (!parseArguments(error)) {
+        fprintf(stderr, "%s\n", error.toLocal8Bit().constData());
+        fprintf(stderr, "Usage: LinuxTimelineViewer --serve <name> [--group-access] [--io <backend>] <file>...\n");
+        return 2;
+    }
+
+    // Every timeline is indexed up front, so clients never wait for it
+    for (const QString& path : m_files) {
+        QElapsedTimer timer;
+        timer.start();
+        Timeline timeline;
+        timeline.path = path;
+        try {
+            timeline.store = std::make_unique<RowStore>(path);
+            timeline.store->open();
+        } catch (const std::exception& e) {
+            fprintf(stderr, "%s: %s\n", path.toLocal8Bit().constData(), e.what());
+            return 1;
+        }
+        timeline.tags = std::make_unique<TagStore>(path);
+        timeline.tags->load(timeline.store->rowCount());
+        QJsonObject loaded;
+        loaded["file"] = path;
+        loaded["rows"] = timeline.store->rowCount();
+        loaded["index_ms"] = timer.elapsed();
+        loaded["io"] = timeline.store->ioBackendName();
+        printJson(loaded);
+        m_timelines.push_back(std::move(timeline));
+    }
+
+    m_server = new QLocalServer(this);
+    QLocalServer::SocketOptions access = QLocalServer::UserAccessOption;
+    if (m_groupAccess)
+        access |= QLocalServer::GroupAccessOption;
+    m_server->setSocketOptions(access);
+    if (!m_server->listen(m_name) && m_server->serverError() == QAbstractSocket::AddressInUseError) {
+        // A server that did not shut down cleanly leaves its socket file
+        // behind; it is only removed if nothing answers on it
+        QLocalSocket probe;
+        probe.connectToServer(m_name);
+        if (probe.waitForConnected(1000)) {
+            fprintf(stderr, "A server is already listening on '%s'\n", m_name.toLocal8Bit().constData());
+            return 1;
+        }
+        QLocalServer::removeServer(m_name);
+        m_server->listen(m_name);
+    }
+    if (!m_server->isListening()) {
+        fprintf(stderr, "Cannot listen on '%s': %s\n", m_name.toLocal8Bit().constData(),
+                m_server->errorString().toLocal8Bit().constData());
+        return 1;
+    }
+    connect(m_server, &QLocalServer::newConnection, this, &TimelineServer::onNewConnection);
+
+    m_saveTimer = new QTimer(this);
+    m_saveTimer->setSingleShot(true);
+    m_saveTimer->setInterval(TAG_SAVE_DELAY_MS);
+    connect(m_saveTimer, &QTimer::timeout, this, &TimelineServer::saveTags);
+
+    QJsonObject listening;
+    listening["listening"] = m_server->fullServerName();
+    listening["timelines"] = static_cast<int>(m_timelines.size());
+    printJson(listening);
+    return QCoreApplication::exec();
+}
+
+void TimelineServer::onNewConnection()
+{
+    while (QLocalSocket* socket = m_server->nextPendingConnection()) {
+        m_clients.insert(socket, Client());
+        connect(socket, &QLocalSocket::readyRead, this, [this, socket]() { onReadyRead(socket); });
+        connect(socket, &QLocalSocket::disconnected, this, [this, socket]() { onDisconnected(socket); });
+        qDebug() << "TimelineServer: client connected," << m_clients.size() << "connected";
+    }
+}
+
+void TimelineServer::onReadyRead(QLocalSocket* socket)
+{
+    while (m_clients.contains(socket) && socket->canReadLine()) {
+        const QByteArray line = socket->readLine();
+        if (line.size() > MAX_REQUEST_BYTES) {
+            qWarning() << "TimelineServer: dropping a client that sent an overlong request";
+            socket->disconnectFromServer();
+            return;
+        }
+        const QJsonDocument document = QJsonDocument::fromJson(line);
+        if (!document.isObject()) {
+            send(socket, QJsonObject{{"error", "Malformed request"}});
+            continue;
+        }
+        handleRequest(socket, document.object());
+    }
+    if (m_clients.contains(socket) && socket->bytesAvailable() > MAX_REQUEST_BYTES) {
+        qWarning() << "TimelineServer: dropping a client that sent an overlong request";
+        socket->disconnectFromServer();
+    }
+}
+
+void TimelineServer::onDisconnected(QLocalSocket* socket)
+{
+    const auto it = m_clients.find(socket);
+    if (it == m_clients.end())
+        return;
+    for (const auto& cancel : it->scans)
+        *cancel = true;
+    m_clients.erase(it);
+    socket->deleteLater();
+    qDebug() << "TimelineServer: client disconnected," << m_clients.size() << "connected";
+}
+
+void TimelineServer::handleRequest(QLocalSocket* socket, const QJsonObject& request)
+{
+    const int id = request["id"].toInt(-1);
+    const QString op = request["op"].toString();
+    QJsonObject reply;
+    if (op == "list") {
+        reply = listTimelines();
+    } else if (op == "rows") {
+        reply = readRows(m_clients[socket], request);
+    } else if (op == "field") {
+        reply = readField(request);
+    } else if (op == "tag") {
+        reply = setTag(socket, request);
+    } else if (op == "filter") {
+        startFilter(socket, id, request);
+        return;
+    } else {
+        reply["error"] = QString("Unknown op '%1'").arg(op);
+    }
+    reply["id"] = id;
+    send(socket, reply);
+}
+
+QJsonObject TimelineServer::listTimelines() const
+{
+    QJsonArray timelines;
+    for (int t = 0; t < static_cast<int>(m_timelines.size()); ++t) {
+        const Timeline& timeline = m_timelines[t];
+        QJsonObject entry;
+        entry["timeline"] = t;
+        entry["name"] = QFileInfo(timeline.path).fileName();
+        entry["path"] = timeline.path;
+        entry["rows"] = timeline.store->rowCount();
+        entry["headers"] = QJsonArray::fromStringList(timeline.store->headers());
+        entry["type"] = static_cast<int>(timeline.store->type());
+        timelines.append(entry);
+    }
+    QJsonObject reply;
+    reply["protocol"] = PROTOCOL_VERSION;
+    reply["timelines"] = timelines;
+    return reply;
+}
+
+QJsonObject TimelineServer::readRows(const Client& client, const QJsonObject& request)
+{
+    QJsonObject reply;
+    QString error;
+    const int t = timelineOf(request, error);
+    if (t < 0) {
+        reply["error"] = error;
+        return reply;
+    }
+    const Timeline& timeline = m_timelines[t];
+
+    // View rows are source rows, or positions in this client's filter result
+    const QVector<int>* matches = nullptr;
+    if (request["filtered"].toBool()) {
+        const auto it = client.filters.constFind(t);
+        if (it == client.filters.cend()) {
+            reply["error"] = "No filter is applied to this timeline";
+            return reply;
+        }
+        matches = &*it;
+    }
+    const int total = matches ? matches->size() : timeline.store->rowCount();
+    const int first = qBound(0, request["first"].toInt(), total);
+    const int last = qMin(total, first + qBound(0, request["count"].toInt(), MAX_PAGE_ROWS));
+
+    // Runs of consecutive source rows are read with one request each
+    QVector<QPair<int, int>> ranges;
+    for (int i = first; i < last; ++i) {
+        const int row = matches ? (*matches)[i] : i;
+        if (!ranges.isEmpty() && ranges.last().second == row)
+            ++ranges.last().second;
+        else
+            ranges.append({row, row + 1});
+    }
+    QVector<QVector<QByteArray>> lines;
+    timeline.store->readRanges(ranges, lines);
+
+    QJsonArray rows;
+    for (int r = 0; r < ranges.size(); ++r) {
+        for (int row = ranges[r].first; row < ranges[r].second; ++row) {
+            QByteArray line;
+            const int k = row - ranges[r].first;
+            if (k < lines[r].size())
+                line = lines[r][k];
+            else
+                timeline.store->readRaw(row, line);  // the range was too large to read at once
+            QStringList fields;
+            try {
+                fields = FileUtils::parseCsvLinePrefix(line.trimmed(), FIELD_BYTES);
+            } catch (const std::exception& e) {
+                qWarning() << "TimelineServer: error parsing CSV line:" << e.what();
+            }
+            QJsonObject entry;
+            entry["row"] = row;
+            entry["fields"] = QJsonArray::fromStringList(fields);
+            if (timeline.tags->contains(row))
+                entry["tagged"] = true;
+            rows.append(entry);
+        }
+    }
+    reply["first"] = first;
+    reply["total"] = total;
+    reply["rows"] = rows;
+    return reply;
+}
+
+QJsonObject TimelineServer::readField(const QJsonObject& request)
+{
+    QJsonObject reply;
+    QString error;
+    const int t = timelineOf(request, error);
+    if (t < 0) {
+        reply["error"] = error;
+        return reply;
+    }
+    const int row = request["row"].toInt(-1);
+    const int column = request["column"].toInt(-1);
+    QStringList fields;
+    try {
+        if (!m_timelines[t].store->readFields(row, fields)) {
+            reply["error"] = QString("Cannot read row %1").arg(row);
+            return reply;
+        }
+    } catch (const std::exception& e) {
+        reply["error"] = QString::fromUtf8(e.what());
+        return reply;
+    }
+    reply["text"] = (column >= 0 && column < fields.size()) ? fields[column] : QString();
+    return reply;
+}
+
+QJsonObject TimelineServer::setTag(QLocalSocket* socket, const QJsonObject& request)
+{
+    QJsonObject reply;
+    QString error;
+    const int t = timelineOf(request, error);
+    if (t < 0) {
+        reply["error"] = error;
+        return reply;
+    }
+    Timeline& timeline = m_timelines[t];
+    const int row = request["row"].toInt(-1);
+    if (row < 0 || row >= timeline.store->rowCount()) {
+        reply["error"] = QString("No row %1").arg(row);
+        return reply;
+    }
+    const bool tagged = request["tagged"].toBool();
+    if (tagged && !timeline.tags->contains(row) && timeline.tags->size() >= TagStore::MAX_TAGS) {
+        reply["error"] = "Too many tagged rows";
+        return reply;
+    }
+    const bool changed = timeline.tags->set(row, tagged);
+    if (changed) {
+        const QJsonObject event{{"event", "tag"}, {"timeline", t}, {"row", row}, {"tagged", tagged}};
+        for (auto it = m_clients.cbegin(); it != m_clients.cend(); ++it) {
+            if (it.key() != socket)
+                send(it.key(), event);
+        }
+        m_saveTimer->start();
+    }
+    reply["changed"] = changed;
+    return reply;
+}
+
+void TimelineServer::startFilter(QLocalSocket* socket, int id, const QJsonObject& request)
+{
+    QString error;
+    const int t = timelineOf(request, error);
+    if (t < 0) {
+        send(socket, QJsonObject{{"id", id}, {"error", error}});
+        return;
+    }
+
+    // A new filter replaces the one still running, which gets no reply.
+    // The previous result stays until then, so the client can keep paging
+    // through the view it shows.
+    Client& client = m_clients[socket];
+    if (const auto running = client.scans.take(t))
+        *running = true;
+    const QString term = request["term"].toString();
+    if (term.isEmpty()) {
+        client.filters.remove(t);
+        send(socket, QJsonObject{{"id", id}, {"matches", -1}});
+        return;
+    }
+
+    const RowStore* store = m_timelines[t].store.get();
+    int column = request["column"].toInt(-1);
+    if (column >= store->headers().size())
+        column = -1;
+    const FilterEngine filter(column, term);
+    const auto cancel = std::make_shared<std::atomic<bool>>(false);
+    client.scans.insert(t, cancel);
+
+    // Progress events are only sent while the request is current; a client
+    // that disconnects has its scans cancelled, so the socket is still valid
+    QThread* thread = QThread::create([this, socket, id, t, store, filter, cancel]() {
+        QElapsedTimer sinceProgress;
+        sinceProgress.start();
+        QVector<int> rows;
+        QString error;
+        try {
+            rows = filter.scan(*store, [&](int scanned, int total) {
+                if (*cancel)
+                    throw std::runtime_error("Filter cancelled");
+                if (sinceProgress.elapsed() < PROGRESS_INTERVAL_MS)
+                    return;
+                sinceProgress.restart();
+                QMetaObject::invokeMethod(this, [socket, id, cancel, scanned, total]() {
+                    if (!*cancel)
+                        send(socket, QJsonObject{{"event", "progress"}, {"request", id},
+                                                 {"scanned", scanned}, {"total", total}});
+                }, Qt::QueuedConnection);
+            });
+        } catch (const std::exception& e) {
+            error = QString::fromUtf8(e.what());
+        }
+        QMetaObject::invokeMethod(this, [this, socket, id, t, cancel, rows, error]() {
+            finishFilter(socket, id, t, cancel, rows, error);
+        }, Qt::QueuedConnection);
+    });
+    m_scanThreads.insert(thread);
+    connect(thread, &QThread::finished, this, [this, thread]() {
+        m_scanThreads.remove(thread);
+        thread->deleteLater();
+    });
+    thread->start();
+}
+
+void TimelineServer::finishFilter(QLocalSocket* socket, int id, int timeline,
+                                  const std::shared_ptr<std::atomic<bool>>& cancel,
+                                  const QVector<int>& rows, const QString& error)
+{
+    // Cancelled filters were replaced, or their client is gone
+    if (*cancel)
+        return;
+    Client& client = m_clients[socket];
+    client.scans.remove(timeline);
+    QJsonObject reply;
+    reply["id"] = id;
+    if (!error.isEmpty()) {
+        reply["error"] = error;
+    } else {
+        client.filters.insert(timeline, rows);
+        reply["matches"] = static_cast<int>(rows.size());
+    }
+    send(socket, reply);
+}
+
+void TimelineServer::saveTags()
+{
+    for (Timeline& timeline : m_timelines) {
+        if (timeline.tags && timeline.tags->hasUnsavedChanges() && !timeline.tags->save())
+            qWarning() << "TimelineServer: failed to save the tags of" << timeline.path;
+    }
+}
+
+int TimelineServer::timelineOf(const QJsonObject& request, QString& error) const
+{
+    const int t = request["timeline"].toInt(-1);
+    if (t < 0 || t >= static_cast<int>(m_timelines.size())) {
+        error = QString("No timeline %1").arg(t);
+        return -1;
+    }
+    return t;
+}
+
+void TimelineServer::send(QLocalSocket* socket, const QJsonObject& object)
+{
+    socket->write(QJsonDocument(object).toJson(QJsonDocument::Compact) + '\n');
+}
+
+void TimelineServer::printJson(const QJsonObject& object)
+{
+    const QByteArray json = QJsonDocument(object).toJson(QJsonDocument::Compact);
+    fwrite(json.constData(), 1, json.size(), stdout);
+    fputc('\n', stdout);
+    fflush(stdout);
+}
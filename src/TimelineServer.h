@@ -0,0 +1,96 @@
+#pragma once
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QJsonObject>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+class QLocalServer;
+class QLocalSocket;
+class QThread;
+class QTimer;
+class RowStore;
+class TagStore;
+
+/**
+ * @brief TimelineServer hosts indexed timelines for several viewers at once.
+ *
+ * Each file is opened (and indexed) once, when the server starts; clients
+ * connect over a local (Unix domain) socket and page through rows, filter
+ * and tag without loading the timeline themselves. The protocol is one
+ * compact JSON object per line:
+ *  - requests carry an "id" and an "op" (list, rows, filter, field, tag),
+ *    and each gets one reply with the same id, holding "error" on failure
+ *  - objects with an "event" key are sent unasked: filter progress, and
+ *    tag changes made by other clients
+ * Filters run on a background thread per request and are kept per client,
+ * so every analyst has their own view; tags are shared and written to the
+ * usual .tags files shortly after they change.
+ */
+class TimelineServer : public QObject {
+    Q_OBJECT
+public:
+    static constexpr int PROTOCOL_VERSION = 1;
+    static constexpr int MAX_PAGE_ROWS = 1000;           // rows per "rows" reply
+    static constexpr int FIELD_BYTES = 512;              // fields in "rows" replies are cut to this
+    static constexpr qint64 MAX_REQUEST_BYTES = 65536;   // longer request lines drop the client
+    static constexpr int PROGRESS_INTERVAL_MS = 250;     // between filter progress events
+    static constexpr int TAG_SAVE_DELAY_MS = 2000;       // tag changes are saved in batches
+
+    // True if the arguments ask for server mode (--serve)
+    static bool isServerInvocation(int argc, char* argv[]);
+
+    explicit TimelineServer(const QStringList& arguments, QObject* parent = nullptr);
+    ~TimelineServer();
+    // Opens the timelines, starts listening and runs the event loop
+    int exec();
+
+private:
+    struct Timeline {
+        QString path;
+        std::unique_ptr<RowStore> store;
+        std::unique_ptr<TagStore> tags;
+    };
+    // Per connection: the rows its filter matched, per timeline, and the
+    // cancel flag of the filter still running on each
+    struct Client {
+        QHash<int, QVector<int>> filters;
+        QHash<int, std::shared_ptr<std::atomic<bool>>> scans;
+    };
+
+    QStringList m_arguments;
+    QStringList m_files;
+    QString m_name;
+    bool m_groupAccess = false;
+    std::vector<Timeline> m_timelines;
+    QLocalServer* m_server = nullptr;
+    QHash<QLocalSocket*, Client> m_clients;
+    QSet<QThread*> m_scanThreads;
+    QTimer* m_saveTimer = nullptr;
+
+    bool parseArguments(QString& error);
+    void onNewConnection();
+    void onReadyRead(QLocalSocket* socket);
+    void onDisconnected(QLocalSocket* socket);
+    void handleRequest(QLocalSocket* socket, const QJsonObject& request);
+
+    QJsonObject listTimelines() const;
+    QJsonObject readRows(const Client& client, const QJsonObject& request);
+    QJsonObject readField(const QJsonObject& request);
+    QJsonObject setTag(QLocalSocket* socket, const QJsonObject& request);
+    // Replies itself once the scan has finished (or at once for an empty term)
+    void startFilter(QLocalSocket* socket, int id, const QJsonObject& request);
+    void finishFilter(QLocalSocket* socket, int id, int timeline, const std::shared_ptr<std::atomic<bool>>& cancel,
+                      const QVector<int>& rows, const QString& error);
+    void saveTags();
+
+    // Index into m_timelines named by the request, or -1 with error set
+    int timelineOf(const QJsonObject& request, QString& error) const;
+    static void send(QLocalSocket* socket, const QJsonObject& object);
+    static void printJson(const QJsonObject& object);
+};
@@ -2,14 +2,292 @@
 #include <QHeaderView>
 #include <QFont>
 #include <QMenu>
+#include <QScrollBar>
+#include <QDialog>
+#include <QDialogButtonBox>
+#include <QLabel>
+#include <QListWidget>
+#include <QCheckBox>
+#include <QSpinBox>
+#include "utils/SysmonFields.h"
+#include "utils/JsonXmlFormatter.h"
+#include "PerformanceDialog.h"
+#include "HighlightDelegate.h"
+#include <QElapsedTimer>
+#include <QLocale>
+#include <QJsonArray>
+#include <QKeyEvent>
+#include <QClipboard>
+#include <QGuiApplication>
+#include <QItemSelectionModel>
+#include <QMap>
+#include <algorithm>
+#include <functional>
+#include <memory>
+
+namespace {
+
+// Times viewport paints for the Performance dialog, and hands Copy to the
+// tab (see TimelineTab::copySelection())
+class TimedTableView : public QTableView {
+public:
+    using QTableView::QTableView;
+    LatencyHistogram* paintLatency = nullptr;
+    std::function<void()> copySelection;
+
+protected:
+    void keyPressEvent(QKeyEvent* event) override
+    {
+        if (!event->matches(QKeySequence::Copy) || !copySelection) {
+            QTableView::keyPressEvent(event);
+            return;
+        }
+        copySelection();
+        event->accept();
+    }
+
+    void paintEvent(QPaintEvent* event) override
+    {
+        QElapsedTimer timer;
+        timer.start();
+        QTableView::paintEvent(event);
+        if (paintLatency)
+            paintLatency->record(timer.nsecsElapsed());
+    }
+};
+
+// "~12,300 estimated (95%: 11,900–12,700)"
+QString describeEstimate(const MatchEstimator::Estimate& e)
+{
+    const QLocale locale;
+    if (e.exact())
+        return QString("%1 matches").arg(locale.toString(qRound64(e.matches)));
+    return QString("~%1 estimated (95%: %2–%3)")
+        .arg(locale.toString(qRound64(e.matches)))
+        .arg(locale.toString(qRound64(e.low)))
+        .arg(locale.toString(qRound64(e.high)));
+}
+
+} // namespace
 
 TimelineTab::TimelineTab(const QString& filePath, QWidget* parent)
+    : QWidget(parent), files{filePath}
+{
+    model = new TimelineModel(filePath, this);
+    setupUi(model);
+    static_cast<TimedTableView*>(tableView)->paintLatency = &model->metrics().paintLatency;
+    connect(model, &TimelineModel::searchProgress, this, [this](int done, int total) {
+        statusBar->showMessage(QString("Searching… %1 / %2 rows scanned").arg(done).arg(total));
+    });
+    connect(model, &TimelineModel::extractionProgress, this, [this](int done, int total) {
+        statusBar->showMessage(QString("Extracting Sysmon fields… %1 / %2 rows scanned").arg(done).arg(total));
+    });
+    connect(model, &TimelineModel::extractionFinished, this, [this]() {
+        updateFilterBarColumns();
+        updateStatus();
+    });
+    connect(model, &TimelineModel::groupingProgress, this, [this](int done, int total) {
+        statusBar->showMessage(QString("Grouping duplicates… %1 / %2 rows hashed").arg(done).arg(total));
+    });
+    connect(model, &TimelineModel::groupingChanged, this, [this]() {
+        updateStatus();
+    });
+    connect(model, &TimelineModel::liveFilterProgress, this,
+            [this](int matches, int scanned, int total, bool finished) {
+        if (finished) {
+            model->cancelEstimate();
+            filterBar->setMatchStatus(QString("%1 matches").arg(matches));
+            updateStatus(QString("Matches: %1").arg(matches));
+            restoreTopRow();
+            return;
+        }
+        filterBar->setMatchStatus(matchEstimate.isEmpty()
+            ? QString("%1 matches…").arg(matches)
+            : QString("%1 found, %2").arg(matches).arg(matchEstimate));
+        statusBar->showMessage(QString("Searching… %1 matches, %2 / %3 rows scanned")
+            .arg(matches).arg(scanned).arg(total));
+    });
+    connect(model, &TimelineModel::matchEstimated, this, [this](const MatchEstimator::Estimate& estimate) {
+        matchEstimate = describeEstimate(estimate);
+        if (model->isLiveFilterRunning())
+            filterBar->setMatchStatus(QString("%1 found, %2").arg(model->filteredRowCount()).arg(matchEstimate));
+    });
+    connect(filterBar, &FilterBar::liveSearchRequested, this, &TimelineTab::onLiveSearchRequested);
+    // Double-clicking the count in the row header expands or collapses a group
+    connect(tableView->verticalHeader(), &QHeaderView::sectionDoubleClicked, this, [this](int section) {
+        model->toggleGroupExpanded(section);
+    });
+    // The scroll bar changes before the viewport repaints, so the rows about
+    // to be painted can be read in one batch first
+    connect(tableView->verticalScrollBar(), &QScrollBar::valueChanged, this, &TimelineTab::updateVisibleRange);
+    connect(tableView->verticalScrollBar(), &QScrollBar::rangeChanged, this, &TimelineTab::updateVisibleRange);
+    updateFilterBarColumns();
+    if (model->seeksFromStart())
+        updateStatus(QString("Rows: %1. This file is a single zstd frame, so scrolling decodes it from the start; "
+                             "recompress it in independent frames (e.g. with pzstd or t2sz) for fast scrolling.")
+                         .arg(model->rowCount()));
+    else
+        updateStatus();
+}
+
+TimelineTab::TimelineTab(const QStringList& filePaths, QWidget* parent)
+    : QWidget(parent), files(filePaths)
+{
+    mergedModel = new MergedTimelineModel(filePaths, this);
+    setupUi(mergedModel);
+    connect(mergedModel, &MergedTimelineModel::searchProgress, this, [this](int done, int total) {
+        statusBar->showMessage(QString("Searching… %1 / %2 rows scanned").arg(done).arg(total));
+    });
+    connect(mergedModel, &MergedTimelineModel::mergeProgress, this, [this](int done, int total) {
+        statusBar->showMessage(QString("Merging… %1 / %2 rows").arg(done).arg(total));
+    });
+    connect(mergedModel, &MergedTimelineModel::mergeFinished, this, [this]() {
+        updateStatus();
+        if (!pendingSession.isEmpty()) {
+            const QJsonObject state = pendingSession;
+            pendingSession = QJsonObject();
+            restoreSessionState(state);
+        }
+    });
+    filterBar->setLiveSearchEnabled(false);  // merged searches block until done
+    updateFilterBarColumns();
+    statusBar->showMessage(QString("Merging %1 files…").arg(filePaths.size()));
+}
+
+TimelineTab::TimelineTab(const QString& serverName, const RemoteTimelineModel::TimelineInfo& timeline,
+                         QWidget* parent)
     : QWidget(parent)
+{
+    remoteModel = new RemoteTimelineModel(serverName, timeline, this);
+    setupUi(remoteModel);
+    connect(remoteModel, &RemoteTimelineModel::searchProgress, this, [this](int done, int total) {
+        statusBar->showMessage(QString("Searching on the server… %1 / %2 rows scanned").arg(done).arg(total));
+    });
+    connect(remoteModel, &RemoteTimelineModel::filterFinished, this, [this](int matches) {
+        filterBar->setMatchStatus(matches > 0 ? QString("%1 matches").arg(matches) : QString("No matches"));
+        updateStatus(matches > 0 ? QString("Matches: %1").arg(matches) : QString("No matches found."));
+    });
+    connect(remoteModel, &RemoteTimelineModel::requestFailed, this, [this](const QString& error) {
+        updateStatus(QString("Server error: %1").arg(error));
+    });
+    connect(remoteModel, &RemoteTimelineModel::connectionLost, this, [this]() {
+        filterBar->setEnabled(false);
+        updateStatus("Disconnected from the server; close the tab and attach again.");
+    });
+    filterBar->setLiveSearchEnabled(false);  // every search is a round trip to the server
+    updateFilterBarColumns();
+    updateStatus();
+}
+
+void TimelineTab::copySelection()
+{
+    // The visible selected cells, grouped by row so each row is read once.
+    // The ranges are counted first: Select All on a large timeline would
+    // otherwise read the whole file on the GUI thread.
+    const QItemSelection selection = tableView->selectionModel()
+        ? tableView->selectionModel()->selection() : QItemSelection();
+    qint64 selectedRows = 0;
+    for (const QItemSelectionRange& range : selection)
+        selectedRows += range.height();
+    if (selectedRows > MAX_COPY_ROWS) {
+        statusBar->showMessage(QString("Selection too large to copy: %1 rows (at most %2); export the rows instead")
+                                   .arg(selectedRows).arg(MAX_COPY_ROWS));
+        return;
+    }
+    QMap<int, QVector<int>> columnsByRow;
+    for (const QItemSelectionRange& range : selection) {
+        for (int row = range.top(); row <= range.bottom(); ++row) {
+            for (int column = range.left(); column <= range.right(); ++column) {
+                if (!tableView->isColumnHidden(column))
+                    columnsByRow[row].append(column);
+            }
+        }
+    }
+    const QModelIndex current = tableView->currentIndex();
+    if (columnsByRow.isEmpty() && current.isValid())
+        columnsByRow[current.row()].append(current.column());
+    if (columnsByRow.isEmpty())
+        return;
+    for (QVector<int>& columns : columnsByRow) {
+        std::sort(columns.begin(), columns.end());
+        columns.erase(std::unique(columns.begin(), columns.end()), columns.end());
+    }
+    if (remoteModel) {
+        copyRemoteSelection(columnsByRow);
+        return;
+    }
+
+    // Tab-separated, one line per row, with the full values rather than
+    // the truncated display text
+    QStringList lines;
+    for (auto it = columnsByRow.cbegin(); it != columnsByRow.cend(); ++it) {
+        const QStringList values = model ? model->fullRowText(model->toSourceRow(it.key()), it.value())
+                                         : mergedModel->fullRowText(it.key(), it.value());
+        lines << values.join('\t');
+    }
+    QGuiApplication::clipboard()->setText(lines.join('\n'));
+}
+
+void TimelineTab::copyRemoteSelection(const QMap<int, QVector<int>>& columnsByRow)
+{
+    // Remote rows hold only the text cut on the server, so each cell is
+    // fetched whole; the clipboard is set once the last value has arrived
+    int cells = 0;
+    for (const QVector<int>& columns : columnsByRow)
+        cells += columns.size();
+    if (cells > MAX_REMOTE_COPY_CELLS) {
+        statusBar->showMessage(QString("Selection too large to copy from a server: %1 cells (at most %2)")
+                                   .arg(cells).arg(MAX_REMOTE_COPY_CELLS));
+        return;
+    }
+
+    struct PendingCopy {
+        QVector<QStringList> rows;
+        int waiting = 0;
+        bool abandoned = false;
+    };
+    auto copy = std::make_shared<PendingCopy>();
+    copy->waiting = cells;
+    for (const QVector<int>& columns : columnsByRow) {
+        QStringList values;
+        for (int i = 0; i < columns.size(); ++i)
+            values << QString();
+        copy->rows.append(values);
+    }
+
+    int r = 0;
+    for (auto it = columnsByRow.cbegin(); it != columnsByRow.cend(); ++it, ++r) {
+        const QVector<int>& columns = it.value();
+        for (int c = 0; c < columns.size(); ++c) {
+            const QModelIndex index = remoteModel->index(it.key(), columns[c]);
+            const bool sent = remoteModel->fetchFullText(index, [this, copy, r, c](const QString& text) {
+                copy->rows[r][c] = text;
+                if (copy->abandoned || --copy->waiting > 0)
+                    return;
+                QStringList lines;
+                for (const QStringList& values : copy->rows)
+                    lines << values.join('\t');
+                QGuiApplication::clipboard()->setText(lines.join('\n'));
+                statusBar->showMessage(QString("Copied %1 rows").arg(copy->rows.size()), 3000);
+            });
+            if (!sent) {
+                copy->abandoned = true;  // values already asked for are dropped
+                statusBar->showMessage("Cannot copy yet: some selected rows have not arrived from the server");
+                return;
+            }
+        }
+    }
+    statusBar->showMessage(QString("Copying %1 cells from the server…").arg(cells));
+}
+
+void TimelineTab::setupUi(QAbstractItemModel* viewModel)
 {
     filterBar = new FilterBar(this);
-    model = new TimelineModel(filePath, this);
-    tableView = new QTableView(this);
-    tableView->setModel(model);
+    auto* view = new TimedTableView(this);
+    view->copySelection = [this]() { copySelection(); };
+    tableView = view;
+    tableView->setModel(viewModel);
+    tableView->setItemDelegate(new HighlightDelegate(tableView));
     tableView->setSortingEnabled(false); // full sort requires reading all rows; disabled for large files
     tableView->horizontalHeader()->setSectionResizeMode(QHeaderView::Interactive);
     tableView->horizontalHeader()->setSectionsMovable(true);
@@ -24,24 +302,34 @@ TimelineTab::TimelineTab(const QString& filePath, QWidget* parent)
     setLayout(layout);
     connect(filterBar, &FilterBar::searchRequested, this, &TimelineTab::onSearchRequested);
     connect(tableView, &QTableView::doubleClicked, this, &TimelineTab::onTableDoubleClicked);
-    connect(model, &TimelineModel::searchProgress, this, [this](int done, int total) {
-        statusBar->showMessage(QString("Searching… %1 / %2 rows scanned").arg(done).arg(total));
-    });
-    updateFilterBarColumns();
-    updateStatus();
 }
 
-TimelineTab::~TimelineTab() {}
+void TimelineTab::updateVisibleRange()
+{
+    const int first = tableView->rowAt(0);
+    if (!model || first < 0)
+        return;
+    int last = tableView->rowAt(tableView->viewport()->height() - 1);
+    if (last < 0)
+        last = model->rowCount() - 1;
+    model->setVisibleRange(first, last);
+}
+
+TimelineTab::~TimelineTab()
+{
+    if (exportThread) {
+        exporter->cancel();
+        exportThread->wait();
+    }
+    if (convertThread) {
+        convertCancel = true;
+        convertThread->wait();
+    }
+}
 
 void TimelineTab::updateFilterBarColumns()
 {
-    QStringList cols = model->headerData(0, Qt::Horizontal, Qt::DisplayRole).toStringList();
-    if (cols.isEmpty())
-        cols = model->headerData(0, Qt::Horizontal, Qt::DisplayRole).toString().split(",");
-    if (cols.isEmpty())
-        cols = model->columnCount() > 0 ? QStringList() : QStringList();
-    for (int i = 0; i < model->columnCount(); ++i)
-        cols << model->headerData(i, Qt::Horizontal, Qt::DisplayRole).toString();
+    QStringList cols = columnNames();
     cols.removeDuplicates();
     cols.removeAll("");
     cols.prepend("All Columns");
@@ -50,35 +338,97 @@ void TimelineTab::updateFilterBarColumns()
 
 QStringList TimelineTab::columnNames() const
 {
+    const QAbstractItemModel* viewModel = tableView->model();
     QStringList cols;
-    for (int i = 0; i < model->columnCount(); ++i)
-        cols << model->headerData(i, Qt::Horizontal, Qt::DisplayRole).toString();
+    for (int i = 0; i < viewModel->columnCount(); ++i)
+        cols << viewModel->headerData(i, Qt::Horizontal, Qt::DisplayRole).toString();
     return cols;
 }
 
 void TimelineTab::onSearchRequested(const QString& column, const QString& term)
 {
+    if (model)
+        model->cancelEstimate();
+    if (remoteModel) {
+        search(column, term);  // the count arrives with filterFinished()
+        filterBar->setMatchStatus(term.isEmpty() ? QString() : QString("Searching…"));
+        if (term.isEmpty())
+            updateStatus();
+        return;
+    }
     bool found = search(column, term);
     if (term.isEmpty()) {
+        filterBar->setMatchStatus(QString());
         updateStatus();
     } else if (!found) {
+        filterBar->setMatchStatus("No matches");
         updateStatus("No matches found.");
     } else {
-        updateStatus(QString("Matches: %1").arg(model->filteredRowCount()));
+        filterBar->setMatchStatus(QString("%1 matches").arg(tableView->model()->rowCount()));
+        updateStatus(QString("Matches: %1").arg(tableView->model()->rowCount()));
     }
 }
 
-bool TimelineTab::search(const QString& column, const QString& term)
+void TimelineTab::onLiveSearchRequested(const QString& column, const QString& term)
 {
+    if (!model)
+        return;
+    searchColumn = column;
+    searchTerm = term;
+    matchEstimate.clear();
     if (term.isEmpty()) {
+        model->cancelEstimate();
         model->clearFilter();
+        filterBar->setMatchStatus(QString());
+        updateStatus();
+        return;
+    }
+    filterBar->setMatchStatus("Searching…");
+    // The sample runs alongside the scan, so the label shows a ballpark
+    // count long before a broad term has been scanned to the end
+    model->estimateMatches(column, term);
+    model->startLiveFilter(column, term);
+    if (!model->isLiveFilterRunning())  // virtual columns are filtered at once
+        filterBar->setMatchStatus(QString("%1 matches").arg(model->filteredRowCount()));
+}
+
+bool TimelineTab::search(const QString& column, const QString& term)
+{
+    searchColumn = column;
+    searchTerm = term;
+    if (term.isEmpty()) {
+        if (mergedModel)
+            mergedModel->clearFilter();
+        else if (remoteModel)
+            remoteModel->clearFilter();
+        else
+            model->clearFilter();
         return false;
     }
     statusBar->showMessage("Searching…");
+    if (remoteModel) {
+        remoteModel->applyFilter(column, term);
+        return true;
+    }
+    if (mergedModel) {
+        mergedModel->applyFilter(column, term);
+        return mergedModel->filteredRowCount() > 0;
+    }
     model->applyFilter(column, term);
     return model->filteredRowCount() > 0;
 }
 
+int TimelineTab::iocSweep(const std::shared_ptr<const IocSweep>& sweep)
+{
+    if (!model)
+        return -1;
+    statusBar->showMessage("Sweeping for indicators…");
+    const int hits = model->applyIocSweep(sweep);
+    updateFilterBarColumns();
+    updateStatus(QString("IOC hits: %1 rows").arg(hits));
+    return hits;
+}
+
 void TimelineTab::setFontSize(int pointSize)
 {
     fontSize = pointSize;
@@ -98,10 +448,22 @@ void TimelineTab::onTableDoubleClicked(const QModelIndex& index)
     if (!index.isValid()) return;
     
     // Get the column name for the title
-    QString columnName = model->headerData(index.column(), Qt::Horizontal, Qt::DisplayRole).toString();
+    QString columnName = tableView->model()->headerData(index.column(), Qt::Horizontal, Qt::DisplayRole).toString();
     
-    // Get the cell content (this will include XML/JSON formatting if applicable)
-    QString content = index.data(Qt::DisplayRole).toString();
+    // Remote cells are fetched from the server first
+    if (remoteModel) {
+        const bool isMessage = remoteModel->type() == TimelineParser::Super && index.column() == 4;
+        remoteModel->fetchFullText(index, [this, columnName, isMessage](const QString& text) {
+            const QString content = isMessage ? JsonXmlFormatter::formatIfApplicable(text) : text;
+            FieldDetailWindow* detailWindow = new FieldDetailWindow(columnName, content, this);
+            detailWindow->setAttribute(Qt::WA_DeleteOnClose);
+            detailWindow->show();
+        });
+        return;
+    }
+
+    // Get the full cell content (pretty-printed XML/JSON for message fields)
+    QString content = mergedModel ? mergedModel->formattedData(index) : model->formattedData(index);
     
     // Create and show the detail window
     FieldDetailWindow* detailWindow = new FieldDetailWindow(columnName, content, this);
@@ -114,8 +476,9 @@ void TimelineTab::onHeaderContextMenu(const QPoint& pos)
     QMenu menu(this);
     menu.setTitle("Show / hide columns");
 
-    for (int col = 0; col < model->columnCount(); ++col) {
-        QString name = model->headerData(col, Qt::Horizontal, Qt::DisplayRole).toString();
+    const QAbstractItemModel* viewModel = tableView->model();
+    for (int col = 0; col < viewModel->columnCount(); ++col) {
+        QString name = viewModel->headerData(col, Qt::Horizontal, Qt::DisplayRole).toString();
         QAction* action = menu.addAction(name);
         action->setCheckable(true);
         action->setChecked(!tableView->isColumnHidden(col));
@@ -126,26 +489,329 @@ void TimelineTab::onHeaderContextMenu(const QPoint& pos)
         });
     }
 
+    if (!model) {
+        menu.exec(tableView->horizontalHeader()->mapToGlobal(pos));
+        return;
+    }
+
+    // Sysmon virtual columns (Super timelines only)
+    const int clickedCol = tableView->horizontalHeader()->logicalIndexAt(pos);
+    if (model->type() == TimelineParser::Super && !model->hasSysmonColumns() && !model->isExtractionRunning()) {
+        menu.addSeparator();
+        QAction* extractAction = menu.addAction("Extract Sysmon fields as columns");
+        connect(extractAction, &QAction::triggered, this, &TimelineTab::onExtractSysmonFields);
+    }
+    if (model->isVirtualColumn(clickedCol)) {
+        menu.addSeparator();
+        QAction* ascAction = menu.addAction("Sort ascending");
+        QAction* descAction = menu.addAction("Sort descending");
+        connect(ascAction, &QAction::triggered, this, [this, clickedCol]() {
+            model->sort(clickedCol, Qt::AscendingOrder);
+            updateStatus();
+        });
+        connect(descAction, &QAction::triggered, this, [this, clickedCol]() {
+            model->sort(clickedCol, Qt::DescendingOrder);
+            updateStatus();
+        });
+    }
+    if (model->isSorted()) {
+        QAction* restoreAction = menu.addAction("Restore original order");
+        connect(restoreAction, &QAction::triggered, this, [this]() {
+            model->restoreSourceOrder();
+            updateStatus();
+        });
+    }
+
     menu.exec(tableView->horizontalHeader()->mapToGlobal(pos));
 }
 
+void TimelineTab::onExtractSysmonFields()
+{
+    model->extractSysmonColumns(SysmonFields::defaultFields());
+}
+
+bool TimelineTab::setFollowing(bool enabled)
+{
+    if (enabled == isFollowing())
+        return true;
+
+    if (!enabled) {
+        delete fileWatcher;
+        fileWatcher = nullptr;
+        delete followTimer;
+        followTimer = nullptr;
+        updateStatus();
+        return true;
+    }
+
+    if (!model || !model->canFollow())
+        return false;
+
+    // The watcher gives prompt updates on local disks; the poll timer covers
+    // network shares where change notifications are not delivered.
+    fileWatcher = new QFileSystemWatcher(QStringList{model->getFilePath()}, this);
+    connect(fileWatcher, &QFileSystemWatcher::fileChanged, this, &TimelineTab::onFollowTick);
+    followTimer = new QTimer(this);
+    followTimer->setInterval(FOLLOW_POLL_MS);
+    connect(followTimer, &QTimer::timeout, this, &TimelineTab::onFollowTick);
+    followTimer->start();
+    onFollowTick();
+    return true;
+}
+
+bool TimelineTab::isFollowing() const
+{
+    return followTimer != nullptr;
+}
+
+void TimelineTab::onFollowTick()
+{
+    // Writers that replace the file drop it from the watcher; re-arm it.
+    if (fileWatcher && !fileWatcher->files().contains(model->getFilePath()))
+        fileWatcher->addPath(model->getFilePath());
+
+    QScrollBar* vbar = tableView->verticalScrollBar();
+    const bool atBottom = vbar->value() == vbar->maximum();
+    const int added = model->appendNewRows();
+    if (added <= 0)
+        return;
+    if (atBottom)
+        tableView->scrollToBottom();
+    updateStatus(QString("Following: %1 new rows, %2 shown").arg(added).arg(model->rowCount()));
+}
+
+bool TimelineTab::exportRows(bool taggedOnly, const QString& outPath)
+{
+    if (!model || isExporting())
+        return false;
+
+    const QVector<int> rows = taggedOnly ? model->taggedSourceRows() : model->visibleSourceRows();
+    const int rowCount = rows.size();
+    exporter = new RangeExporter(model->exportSourcePath(), model->exportSpans(rows), outPath, this);
+    exportProgress = new QProgressDialog(QString("Exporting %1 rows…").arg(rowCount), "Cancel", 0, 1000, this);
+    exportProgress->setMinimumDuration(500);
+    exportProgress->setAutoClose(false);
+    exportProgress->setAutoReset(false);
+    connect(exporter, &RangeExporter::progress, exportProgress, [this](qint64 done, qint64 total) {
+        exportProgress->setValue(total > 0 ? static_cast<int>(done * 1000 / total) : 0);
+    });
+    connect(exportProgress, &QProgressDialog::canceled, this, [this]() {
+        exporter->cancel();
+    });
+
+    exportThread = QThread::create([worker = exporter]() { worker->run(); });
+    exportThread->setParent(this);
+    connect(exportThread, &QThread::finished, this, [this, rowCount, outPath]() {
+        if (exporter->errorString().isEmpty()) {
+            updateStatus(QString("Exported %1 rows (%2 MB) to %3")
+                .arg(rowCount).arg(exporter->bytesWritten() / 1048576.0, 0, 'f', 1).arg(outPath));
+        } else {
+            updateStatus(QString("Export failed: %1").arg(exporter->errorString()));
+        }
+        exportProgress->deleteLater();
+        exporter->deleteLater();
+        exportThread->deleteLater();
+        exportProgress = nullptr;
+        exporter = nullptr;
+        exportThread = nullptr;
+    });
+    exportThread->start();
+    updateStatus(QString("Exporting %1 rows to %2…").arg(rowCount).arg(outPath));
+    return true;
+}
+
+bool TimelineTab::convertToAnalysisCache(const QString& outPath)
+{
+    if (!model || isConverting())
+        return false;
+
+    convertCancel = false;
+    convertProgress = new QProgressDialog("Writing analysis cache…", "Cancel", 0, 1000, this);
+    convertProgress->setMinimumDuration(500);
+    convertProgress->setAutoClose(false);
+    convertProgress->setAutoReset(false);
+    connect(convertProgress, &QProgressDialog::canceled, this, [this]() {
+        convertCancel = true;
+    });
+
+    auto error = std::make_shared<QString>();
+    convertThread = QThread::create([this, outPath, error]() {
+        try {
+            model->writeAnalysisCache(outPath, convertCancel, [this](int done, int total) {
+                QMetaObject::invokeMethod(this, [this, done, total]() {
+                    if (convertProgress)
+                        convertProgress->setValue(total > 0 ? static_cast<int>(qint64(done) * 1000 / total) : 0);
+                }, Qt::QueuedConnection);
+            });
+        } catch (const std::exception& e) {
+            *error = QString::fromUtf8(e.what());
+        }
+    });
+    convertThread->setParent(this);
+    connect(convertThread, &QThread::finished, this, [this, outPath, error]() {
+        if (!error->isEmpty())
+            updateStatus(QString("Conversion failed: %1").arg(*error));
+        else if (convertCancel)
+            updateStatus("Conversion cancelled.");
+        else
+            updateStatus(QString("Wrote analysis cache %1").arg(outPath));
+        convertProgress->deleteLater();
+        convertThread->deleteLater();
+        convertProgress = nullptr;
+        convertThread = nullptr;
+    });
+    convertThread->start();
+    updateStatus(QString("Writing analysis cache %1…").arg(outPath));
+    return true;
+}
+
+bool TimelineTab::isConverting() const
+{
+    return convertThread != nullptr;
+}
+
+void TimelineTab::showPerformanceDialog()
+{
+    if (!model)
+        return;
+    PerformanceDialog* dialog = new PerformanceDialog(model, this);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    dialog->show();
+}
+
+bool TimelineTab::groupDuplicates()
+{
+    if (!model)
+        return false;
+    if (model->isSorted()) {
+        updateStatus("Restore the original order before grouping duplicates.");
+        return false;
+    }
+
+    QDialog dialog(this);
+    dialog.setWindowTitle("Group Duplicates");
+    QVBoxLayout* layout = new QVBoxLayout(&dialog);
+    QLabel* columnLabel = new QLabel("Rows are duplicates when these columns match:", &dialog);
+    QListWidget* columnList = new QListWidget(&dialog);
+    const bool isSuper = model->type() == TimelineParser::Super;
+    for (int col = 0; col < model->columnCount(); ++col) {
+        if (model->isVirtualColumn(col))
+            continue;
+        const QString name = model->headerData(col, Qt::Horizontal, Qt::DisplayRole).toString();
+        QListWidgetItem* item = new QListWidgetItem(name, columnList);
+        item->setData(Qt::UserRole, col);
+        // Super timelines: the event text and the file it came from; other
+        // timelines: everything but the timestamp
+        const bool checked = isSuper ? (name == "message" || name == "display_name") : col > 0;
+        item->setCheckState(checked ? Qt::Checked : Qt::Unchecked);
+    }
+    QCheckBox* maskNumbers = new QCheckBox("Ignore numbers (PIDs, ports, counters)", &dialog);
+    maskNumbers->setChecked(true);
+    QLabel* windowLabel = new QLabel("Longest repeating pattern (rows):", &dialog);
+    QSpinBox* windowBox = new QSpinBox(&dialog);
+    windowBox->setRange(1, DuplicateGroups::MAX_WINDOW);
+    windowBox->setValue(2);
+    windowBox->setToolTip("1 collapses consecutive duplicates only; 2 also collapses "
+                          "alternating pairs such as session opened / closed");
+    QDialogButtonBox* buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
+    layout->addWidget(columnLabel);
+    layout->addWidget(columnList);
+    layout->addWidget(maskNumbers);
+    layout->addWidget(windowLabel);
+    layout->addWidget(windowBox);
+    layout->addWidget(buttons);
+    connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+    if (dialog.exec() != QDialog::Accepted)
+        return false;
+
+    DuplicateGroups::Key key;
+    for (int i = 0; i < columnList->count(); ++i) {
+        if (columnList->item(i)->checkState() == Qt::Checked)
+            key.columns.append(columnList->item(i)->data(Qt::UserRole).toInt());
+    }
+    key.maskNumbers = maskNumbers->isChecked();
+    key.window = windowBox->value();
+    if (key.columns.isEmpty()) {
+        updateStatus("Select at least one column to compare.");
+        return false;
+    }
+    if (!model->groupDuplicates(key)) {
+        updateStatus("No rows to group.");
+        return false;
+    }
+    updateStatus("Grouping duplicates…");
+    return true;
+}
+
+bool TimelineTab::canCollapseDuplicates() const
+{
+    return model && model->hasDuplicateGroups();
+}
+
+bool TimelineTab::isCollapsingDuplicates() const
+{
+    return model && model->isGrouped();
+}
+
+void TimelineTab::setCollapseDuplicates(bool collapse)
+{
+    if (model)
+        model->setGrouped(collapse);
+}
+
+qint64 TimelineTab::memoryBytes() const
+{
+    if (remoteModel)
+        return remoteModel->memoryBytes();
+    return mergedModel ? mergedModel->memoryBytes() : model->memoryBytes();
+}
+
+qint64 TimelineTab::releaseCaches()
+{
+    if (remoteModel)
+        return remoteModel->releaseCaches();
+    return mergedModel ? mergedModel->releaseCaches() : model->releaseCaches();
+}
+
+qint64 TimelineTab::releaseDerivedData()
+{
+    if (!model)
+        return 0;
+    const int columns = model->columnCount();
+    const qint64 freed = model->releaseDerivedData();
+    if (model->columnCount() != columns) {
+        updateFilterBarColumns();
+        updateStatus("Sysmon columns were released to stay within the memory budget; extract them again to restore.");
+    }
+    return freed;
+}
+
+bool TimelineTab::isExporting() const
+{
+    return exportThread != nullptr;
+}
+
 void TimelineTab::updateStatus(const QString& msg)
 {
     if (!msg.isEmpty()) {
         statusBar->showMessage(msg);
+    } else if (model && model->isGrouped()) {
+        statusBar->showMessage(QString("Rows: %1 (%2 duplicates collapsed)")
+            .arg(model->rowCount()).arg(model->hiddenDuplicateRows()));
     } else {
-        statusBar->showMessage(QString("Rows: %1").arg(model->rowCount()));
+        statusBar->showMessage(QString("Rows: %1").arg(tableView->model()->rowCount()));
     }
 }
 
 bool TimelineTab::hasUnsavedChanges() const
 {
-    return model->hasUnsavedChanges();
+    return model && model->hasUnsavedChanges();
 }
 
 bool TimelineTab::saveChanges()
 {
-    return model->saveTaggedRows();
+    return model && model->saveTaggedRows();
 }
 
 TimelineModel* TimelineTab::getModel() const
@@ -155,5 +821,94 @@ TimelineModel* TimelineTab::getModel() const
 
 QString TimelineTab::getFilePath() const
 {
-    return model->getFilePath();
-} 
\ No newline at end of file
+    return model ? model->getFilePath() : QString();
+}
+
+bool TimelineTab::isMergedView() const
+{
+    return mergedModel != nullptr;
+}
+
+bool TimelineTab::isRemoteView() const
+{
+    return remoteModel != nullptr;
+}
+
+QStringList TimelineTab::sourceFiles() const
+{
+    return files;
+}
+
+QJsonObject TimelineTab::sessionState() const
+{
+    if (!pendingSession.isEmpty())
+        return pendingSession;
+    QJsonObject state;
+    if (remoteModel) {
+        // Not reopened at start (see AppWindow::restoreSession()); the
+        // server may not be running then
+        state["server"] = remoteModel->serverName();
+        state["timeline"] = remoteModel->timeline().path;
+        return state;
+    }
+    state["files"] = QJsonArray::fromStringList(files);
+    const bool searched = mergedModel ? mergedModel->filteredRowCount() >= 0
+                                      : model->isFiltered() && !model->isIocView();
+    if (searched && !searchTerm.isEmpty()) {
+        state["search_column"] = searchColumn;
+        state["search_term"] = searchTerm;
+    }
+
+    QJsonArray hidden;
+    const QStringList columns = columnNames();
+    for (int col = 0; col < columns.size(); ++col) {
+        if (tableView->isColumnHidden(col))
+            hidden.append(columns[col]);
+    }
+    state["hidden_columns"] = hidden;
+
+    const int top = tableView->rowAt(0);
+    if (top >= 0)
+        state["top_row"] = model ? model->toSourceRow(top) : top;
+    return state;
+}
+
+void TimelineTab::restoreSessionState(const QJsonObject& state)
+{
+    if (mergedModel && !mergedModel->isMerged()) {
+        pendingSession = state;  // searching needs the merged order
+        return;
+    }
+
+    // Columns are matched by name; Sysmon columns are not restored, so
+    // anything referring to them is dropped
+    const QStringList columns = columnNames();
+    for (const QJsonValue& name : state["hidden_columns"].toArray()) {
+        const int col = columns.indexOf(name.toString());
+        if (col >= 0)
+            tableView->setColumnHidden(col, true);
+    }
+
+    pendingTopRow = state["top_row"].toInt(-1);
+    const QString column = state["search_column"].toString();
+    const QString term = state["search_term"].toString();
+    if (!term.isEmpty() && filterBar->setSearch(column, term)) {
+        if (model)
+            onLiveSearchRequested(column, term);
+        else
+            onSearchRequested(column, term);
+    }
+    if (!model || !model->isLiveFilterRunning())
+        restoreTopRow();
+}
+
+void TimelineTab::restoreTopRow()
+{
+    if (pendingTopRow < 0)
+        return;
+    const int row = model ? model->toViewRow(pendingTopRow) : pendingTopRow;
+    pendingTopRow = -1;
+    const QAbstractItemModel* viewModel = tableView->model();
+    if (row >= 0 && row < viewModel->rowCount())
+        tableView->scrollTo(viewModel->index(row, 0), QAbstractItemView::PositionAtTop);
+}
@@ -3,39 +3,115 @@
 #include <QTableView>
 #include <QStatusBar>
 #include <QVBoxLayout>
+#include <QFileSystemWatcher>
+#include <QTimer>
+#include <QThread>
+#include <QProgressDialog>
+#include <QJsonObject>
+#include <QMap>
 #include "FilterBar.h"
 #include "TimelineModel.h"
+#include "MergedTimelineModel.h"
+#include "RemoteTimelineModel.h"
 #include "FieldDetailWindow.h"
+#include "utils/RangeExporter.h"
 
 /**
  * @brief TimelineTab represents a single tab with a loaded timeline file.
+ *
+ * A tab built from several files shows a read-only merged view instead,
+ * and one attached to a TimelineServer a remote view of a hosted timeline.
  */
 class TimelineTab : public QWidget {
     Q_OBJECT
 public:
     TimelineTab(const QString& filePath, QWidget* parent = nullptr);
+    TimelineTab(const QStringList& filePaths, QWidget* parent = nullptr);
+    // Throws std::runtime_error if the server cannot be reached
+    TimelineTab(const QString& serverName, const RemoteTimelineModel::TimelineInfo& timeline,
+                QWidget* parent = nullptr);
     ~TimelineTab();
     void setFontSize(int pointSize);
     void setLineHeight(int px);
     QStringList columnNames() const;
+    // Remote views search on the server and return true once the request
+    // is sent; the match count follows in the status bar
     bool search(const QString& column, const QString& term);
+    // Shows the rows hit by an IOC sweep; -1 for merged and remote views
+    int iocSweep(const std::shared_ptr<const IocSweep>& sweep);
     bool hasUnsavedChanges() const;
     bool saveChanges();
-    TimelineModel* getModel() const;
-    QString getFilePath() const;
+    TimelineModel* getModel() const;      // nullptr for merged and remote views
+    QString getFilePath() const;          // empty for merged and remote views
+    bool isMergedView() const;
+    bool isRemoteView() const;
+    // Follow (live tail) mode; returns false if the file cannot be followed
+    bool setFollowing(bool enabled);
+    bool isFollowing() const;
+    // Export the visible (filtered) or tagged rows in the background by
+    // copying their original bytes; returns false if an export is running
+    bool exportRows(bool taggedOnly, const QString& outPath);
+    bool isExporting() const;
+    // Writes an analysis cache of the timeline in the background (see
+    // AnalysisCache); returns false if one is already being written
+    bool convertToAnalysisCache(const QString& outPath);
+    bool isConverting() const;
+    void showPerformanceDialog();
+    // Duplicate grouping (single-file tabs): asks for the key columns and
+    // starts the background pass; the collapsed view is then toggled instantly
+    bool groupDuplicates();
+    bool canCollapseDuplicates() const;
+    bool isCollapsingDuplicates() const;
+    void setCollapseDuplicates(bool collapse);
+    // Memory budget (see AppWindow); the release functions return bytes freed
+    qint64 memoryBytes() const;
+    qint64 releaseCaches();
+    qint64 releaseDerivedData();  // single-file tabs only
+    // Session restore (see AppWindow): source files, search, hidden columns
+    // and scroll position. A restored search runs in the background and the
+    // scroll position is applied once it has finished.
+    QStringList sourceFiles() const;
+    QJsonObject sessionState() const;
+    void restoreSessionState(const QJsonObject& state);
 
 private slots:
     void onSearchRequested(const QString& column, const QString& term);
+    void onLiveSearchRequested(const QString& column, const QString& term);
     void onTableDoubleClicked(const QModelIndex& index);
     void onHeaderContextMenu(const QPoint& pos);
+    void onExtractSysmonFields();
+    void onFollowTick();
+    void updateVisibleRange();
 
 private:
     FilterBar* filterBar;
     QTableView* tableView;
     QStatusBar* statusBar;
-    TimelineModel* model;
+    TimelineModel* model = nullptr;
+    MergedTimelineModel* mergedModel = nullptr;
+    RemoteTimelineModel* remoteModel = nullptr;
+    QFileSystemWatcher* fileWatcher = nullptr;
+    QTimer* followTimer = nullptr;
+    static constexpr int FOLLOW_POLL_MS = 2000;
+    static constexpr int MAX_COPY_ROWS = 20000;  // larger selections are exported, not copied
+    static constexpr int MAX_REMOTE_COPY_CELLS = 2000;  // fetched one request each
+    QThread* exportThread = nullptr;
+    RangeExporter* exporter = nullptr;
+    QProgressDialog* exportProgress = nullptr;
+    QThread* convertThread = nullptr;
+    QProgressDialog* convertProgress = nullptr;
+    std::atomic<bool> convertCancel{false};
     int fontSize = 10;
     int lineHeight = 20;
+    QString matchEstimate;  // latest sample-based estimate of the live search
+    QStringList files;
+    QString searchColumn, searchTerm;  // last search applied, for the session
+    int pendingTopRow = -1;            // source row (view row when merged) to scroll to
+    QJsonObject pendingSession;        // merged views restore once the merge is done
+    void restoreTopRow();
+    void copySelection();
+    void copyRemoteSelection(const QMap<int, QVector<int>>& columnsByRow);
+    void setupUi(QAbstractItemModel* viewModel);
     void updateStatus(const QString& msg = QString());
     void updateFilterBarColumns();
 }; 
\ No newline at end of file
@@ -0,0 +1,127 @@
+#include "AhoCorasick.h"
+#include <QSet>
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+inline uchar foldCase(uchar c)
+{
+    return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+}
+
+} // namespace
+
+AhoCorasick::AhoCorasick(const QList<QByteArray>& patterns)
+    : m_patterns(patterns)
+{
+    // Byte classes: case-folded bytes that occur in some pattern (at most
+    // 230 distinct values, so they fit in a quint8)
+    qint64 totalBytes = 0;
+    for (const QByteArray& p : patterns) {
+        totalBytes += p.size();
+        for (char ch : p) {
+            const uchar c = foldCase(static_cast<uchar>(ch));
+            if (m_class[c] == 0) {
+                m_class[c] = static_cast<quint8>(m_classes++);
+                if (c >= 'a' && c <= 'z')
+                    m_class[c - ('a' - 'A')] = m_class[c];
+            }
+        }
+    }
+    if ((totalBytes + 1) * m_classes > MAX_TABLE_ENTRIES)
+        throw std::runtime_error("Pattern list is too large for one automaton");
+
+    // Trie of the patterns; -1 marks a missing transition
+    addState();
+    QSet<QByteArray> seen;
+    for (int id = 0; id < patterns.size(); ++id) {
+        const QByteArray& p = patterns[id];
+        if (p.isEmpty() || seen.contains(p.toLower()))
+            continue;
+        seen.insert(p.toLower());
+        int state = 0;
+        for (char ch : p) {
+            const int cls = m_class[static_cast<uchar>(ch)];
+            int next = m_next[state * m_classes + cls];
+            if (next < 0) {
+                next = addState();
+                m_next[state * m_classes + cls] = next;
+            }
+            state = next;
+        }
+        m_output[state] = id;
+    }
+
+    // Breadth-first: failure links, then missing transitions are filled in
+    // from the failure state, which turns the trie into a DFA
+    QVector<qint32> fail(m_output.size(), 0);
+    QVector<qint32> queue;
+    queue.reserve(m_output.size());
+    for (int cls = 0; cls < m_classes; ++cls) {
+        qint32& next = m_next[cls];
+        if (next < 0) {
+            next = 0;
+        } else {
+            fail[next] = 0;
+            queue.append(next);
+        }
+    }
+    for (int head = 0; head < queue.size(); ++head) {
+        const int state = queue[head];
+        for (int cls = 0; cls < m_classes; ++cls) {
+            const int viaFail = m_next[fail[state] * m_classes + cls];
+            qint32& next = m_next[state * m_classes + cls];
+            if (next < 0) {
+                next = viaFail;
+                continue;
+            }
+            fail[next] = viaFail;
+            m_outLink[next] = m_output[viaFail] >= 0 ? viaFail : m_outLink[viaFail];
+            queue.append(next);
+        }
+    }
+    m_next.squeeze();
+}
+
+int AhoCorasick::addState()
+{
+    const int state = m_output.size();
+    m_next.resize(m_next.size() + m_classes);
+    std::fill(m_next.end() - m_classes, m_next.end(), -1);
+    m_output.append(-1);
+    m_outLink.append(-1);
+    return state;
+}
+
+void AhoCorasick::findAll(const char* data, qsizetype size, const std::function<void(qsizetype, int)>& hit) const
+{
+    const qint32* next = m_next.constData();
+    int state = 0;
+    for (qsizetype i = 0; i < size; ++i) {
+        state = next[state * m_classes + m_class[static_cast<uchar>(data[i])]];
+        for (int s = m_output[state] >= 0 ? state : m_outLink[state]; s >= 0; s = m_outLink[s])
+            hit(i + 1, m_output[s]);
+    }
+}
+
+void AhoCorasick::matches(const char* data, qsizetype size, QVector<int>& ids) const
+{
+    ids.clear();
+    const qint32* next = m_next.constData();
+    int state = 0;
+    for (qsizetype i = 0; i < size; ++i) {
+        state = next[state * m_classes + m_class[static_cast<uchar>(data[i])]];
+        for (int s = m_output[state] >= 0 ? state : m_outLink[state]; s >= 0; s = m_outLink[s])
+            ids.append(m_output[s]);
+    }
+    if (ids.size() > 1) {
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    }
+}
+
+qint64 AhoCorasick::memoryBytes() const
+{
+    return (m_next.capacity() + m_output.capacity() + m_outLink.capacity()) * static_cast<qint64>(sizeof(qint32));
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <QByteArray>
+#include <QList>
+#include <QVector>
+#include <functional>
+
+/**
+ * @brief AhoCorasick finds any number of byte patterns in one pass over the text.
+ *
+ * Matching is ASCII case-insensitive. The automaton is a full DFA over byte
+ * classes (one class per distinct pattern byte, plus one for all others),
+ * so each text byte costs one table lookup however many patterns there are.
+ */
+class AhoCorasick {
+public:
+    static constexpr qint64 MAX_TABLE_ENTRIES = 32LL * 1024 * 1024;  // 128MB of transitions
+
+    // Empty and duplicate patterns are ignored; pattern ids are positions in
+    // 'patterns'. Throws std::runtime_error if the automaton would be too large.
+    explicit AhoCorasick(const QList<QByteArray>& patterns);
+
+    int patternCount() const { return m_patterns.size(); }
+    const QByteArray& pattern(int id) const { return m_patterns[id]; }
+
+    // Ids of the patterns occurring in the text, ascending and distinct
+    void matches(const char* data, qsizetype size, QVector<int>& ids) const;
+    // Every occurrence: hit(end, id), where end is one past its last byte
+    void findAll(const char* data, qsizetype size, const std::function<void(qsizetype, int)>& hit) const;
+
+    int stateCount() const { return m_output.size(); }
+    qint64 memoryBytes() const;
+
+private:
+    QList<QByteArray> m_patterns;
+    quint8 m_class[256] = {};  // byte → class; 0 is "in no pattern"
+    int m_classes = 1;
+    QVector<qint32> m_next;    // [state * m_classes + class] → state
+    QVector<qint32> m_output;  // id of the pattern ending at a state, -1 if none
+    QVector<qint32> m_outLink; // nearest suffix state with an output, -1 if none
+
+    int addState();
+};
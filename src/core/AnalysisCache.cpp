@@ -0,0 +1,491 @@
+#include "AnalysisCache.h"
+#include "RowStore.h"
+#include "RowChunk.h"
+#include "LineIndex.h"
+#include <QDataStream>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QSet>
+#include <QtEndian>
+#include <QDebug>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+// Start of the file, in the byte order of the machine that wrote it; the
+// arrays after it are too, so they can be used straight from the mapping
+struct FileHeader {
+    quint32 magic;
+    quint32 version;
+    quint32 byteOrder;  // BYTE_ORDER_MARK
+    quint32 reserved;
+    qint64 metaOffset;  // QDataStream: headers, source file, column layout
+    qint64 metaSize;
+};
+constexpr quint32 BYTE_ORDER_MARK = 0x01020304;
+constexpr int SLICE_ROWS = 8 * AnalysisCache::BLOCK_ROWS;  // rows converted between cancellation checks
+
+qint64 align8(qint64 offset)
+{
+    return (offset + 7) & ~qint64(7);
+}
+
+// Backslash-escapes the characters FileUtils::parseCsvLine() treats specially
+void appendCsvField(QByteArray& line, QByteArrayView value)
+{
+    for (char c : value) {
+        if (c == '\\' || c == '"' || c == ',')
+            line += '\\';
+        line += c;
+    }
+}
+
+[[noreturn]] void fail(const QString& message)
+{
+    throw std::runtime_error(message.toStdString());
+}
+
+void writeAt(QSaveFile& file, qint64 offset, const void* data, qint64 size)
+{
+    if (size == 0)
+        return;
+    if (!file.seek(offset) || file.write(static_cast<const char*>(data), size) != size)
+        fail(QString("Cannot write %1: %2").arg(file.fileName(), file.errorString()));
+}
+
+} // namespace
+
+bool AnalysisCache::isCacheFile(const QString& path)
+{
+    QFile file(path);
+    quint32 magic = 0;
+    return file.open(QIODevice::ReadOnly)
+        && file.read(reinterpret_cast<char*>(&magic), sizeof(magic)) == sizeof(magic)
+        && magic == MAGIC;
+}
+
+QString AnalysisCache::suggestedPath(const QString& sourcePath)
+{
+    return sourcePath + ".tlac";
+}
+
+bool AnalysisCache::convert(const RowStore& store, const QString& outPath, const std::atomic<bool>& cancel,
+                            const std::function<void(int, int)>& progress)
+{
+    if (store.analysisCache())
+        fail("The timeline is already an analysis cache");
+
+    QElapsedTimer timer;
+    timer.start();
+    const int rows = store.rowCount();
+    const int columns = store.headers().size();
+    const int blocks = (rows + BLOCK_ROWS - 1) / BLOCK_ROWS;
+    RowChunk chunk;
+
+    // Reads all rows a slice at a time, so cancellation is noticed quickly
+    auto pass = [&](int done, const std::function<void(const RowChunk&)>& visit) {
+        for (int first = 0; first < rows; first += SLICE_ROWS) {
+            if (cancel.load(std::memory_order_relaxed))
+                return false;
+            const int last = qMin(rows, first + SLICE_ROWS);
+            if (!store.scanChunks(first, last, chunk, visit))
+                fail(QString("Cannot read rows %1 to %2 of %3").arg(first).arg(last).arg(store.filePath()));
+            if (progress)
+                progress(done + last, 2 * rows);
+        }
+        return !cancel.load(std::memory_order_relaxed);
+    };
+
+    // Pass 1: columns with few distinct values are dictionary-coded
+    QVector<QSet<QByteArray>> distinct(columns);
+    QVector<bool> isDictionary(columns, true);
+    const bool counted = pass(0, [&](const RowChunk& c) {
+        for (int col = 0; col < columns; ++col) {
+            if (!isDictionary[col])
+                continue;
+            QSet<QByteArray>& values = distinct[col];
+            for (int r = 0; r < c.rowCount(); ++r) {
+                const QByteArrayView v = c.field(r, col);
+                if (values.contains(QByteArray::fromRawData(v.data(), v.size())))
+                    continue;
+                values.insert(v.toByteArray());
+                if (values.size() > MAX_DICTIONARY) {
+                    isDictionary[col] = false;
+                    values = QSet<QByteArray>();
+                    break;
+                }
+            }
+        }
+    });
+    if (!counted)
+        return false;
+
+    // Layout: the per-row arrays come first, so they can be filled in as
+    // the rows arrive; compressed blocks are appended after them
+    qint64 pos = sizeof(FileHeader);
+    const qint64 offsetsAt = pos;
+    pos += rows * qint64(sizeof(qint64));
+    const qint64 timestampsAt = pos;
+    pos += rows * qint64(sizeof(qint64));
+    QVector<QVector<QByteArray>> dictionaries(columns);
+    QVector<QHash<QByteArray, quint16>> codeOf(columns);
+    QVector<qint64> codesAt(columns, -1);
+    QVector<int> stringColumns;
+    for (int col = 0; col < columns; ++col) {
+        if (!isDictionary[col]) {
+            stringColumns.append(col);
+            continue;
+        }
+        dictionaries[col] = distinct[col].values();
+        std::sort(dictionaries[col].begin(), dictionaries[col].end());
+        for (int code = 0; code < dictionaries[col].size(); ++code)
+            codeOf[col].insert(dictionaries[col][code], static_cast<quint16>(code));
+        codesAt[col] = pos;
+        pos = align8(pos + rows * qint64(sizeof(quint16)));
+    }
+    distinct.clear();
+
+    QSaveFile file(outPath);
+    if (!file.open(QIODevice::WriteOnly))
+        fail(QString("Cannot create %1: %2").arg(outPath, file.errorString()));
+
+    // Pass 2: the data. String values are collected per block and written
+    // compressed once the block is complete.
+    qint64 payloadEnd = pos;
+    QVector<qint64> blockTimes(2 * blocks, TimelineParser::INVALID_TIMESTAMP);
+    QVector<QVector<qint64>> blockRefs(columns);
+    QVector<QVector<quint32>> valueEnds(columns);
+    QVector<QByteArray> valueBytes(columns);
+    for (int col : stringColumns)
+        blockRefs[col].resize(2 * blocks);
+    QVector<qint64> timestamps;
+    QVector<quint16> codes;
+    QByteArray raw;
+
+    auto flushBlock = [&](int block) {
+        for (int col : stringColumns) {
+            QVector<quint32>& ends = valueEnds[col];
+            raw.resize(0);
+            raw.append(reinterpret_cast<const char*>(ends.constData()), ends.size() * qsizetype(sizeof(quint32)));
+            raw.append(valueBytes[col]);
+            const QByteArray packed = qCompress(raw, COMPRESSION_LEVEL);
+            writeAt(file, payloadEnd, packed.constData(), packed.size());
+            blockRefs[col][2 * block] = payloadEnd;
+            blockRefs[col][2 * block + 1] = packed.size();
+            payloadEnd += packed.size();
+            ends.resize(0);
+            valueBytes[col].resize(0);
+        }
+    };
+
+    const bool written = pass(rows, [&](const RowChunk& c) {
+        const int first = c.firstRow();
+        const int n = c.rowCount();
+        const QVector<qint64> offsets = store.rowOffsets(first, first + n);
+        writeAt(file, offsetsAt + first * qint64(sizeof(qint64)), offsets.constData(),
+                offsets.size() * qint64(sizeof(qint64)));
+
+        timestamps.resize(n);
+        for (int r = 0; r < n; ++r) {
+            qint64 ts = TimelineParser::INVALID_TIMESTAMP;
+            if (columns > 0) {
+                const QByteArrayView f = c.field(r, 0);
+                ts = TimelineParser::parseTimestamp(QByteArray::fromRawData(f.data(), f.size()));
+            }
+            timestamps[r] = ts;
+            if (ts == TimelineParser::INVALID_TIMESTAMP)
+                continue;
+            qint64* range = blockTimes.data() + 2 * ((first + r) / BLOCK_ROWS);
+            if (range[0] == TimelineParser::INVALID_TIMESTAMP || ts < range[0])
+                range[0] = ts;
+            if (range[1] == TimelineParser::INVALID_TIMESTAMP || ts > range[1])
+                range[1] = ts;
+        }
+        writeAt(file, timestampsAt + first * qint64(sizeof(qint64)), timestamps.constData(),
+                n * qint64(sizeof(qint64)));
+
+        for (int col = 0; col < columns; ++col) {
+            if (!isDictionary[col])
+                continue;
+            codes.resize(n);
+            for (int r = 0; r < n; ++r) {
+                const QByteArrayView v = c.field(r, col);
+                codes[r] = codeOf[col].value(QByteArray::fromRawData(v.data(), v.size()));
+            }
+            writeAt(file, codesAt[col] + first * qint64(sizeof(quint16)), codes.constData(),
+                    n * qint64(sizeof(quint16)));
+        }
+
+        for (int r = 0; r < n; ++r) {
+            for (int col : stringColumns) {
+                valueBytes[col].append(c.field(r, col));
+                valueEnds[col].append(static_cast<quint32>(valueBytes[col].size()));
+            }
+            const int row = first + r;
+            if ((row + 1) % BLOCK_ROWS == 0 || row + 1 == rows)
+                flushBlock(row / BLOCK_ROWS);
+        }
+    });
+    if (!written) {
+        file.cancelWriting();
+        return false;
+    }
+
+    // Tables after the blocks, then the metadata that locates everything
+    pos = align8(payloadEnd);
+    const qint64 blockTimesAt = pos;
+    writeAt(file, pos, blockTimes.constData(), blockTimes.size() * qint64(sizeof(qint64)));
+    pos += blockTimes.size() * qint64(sizeof(qint64));
+    QVector<qint64> blocksAt(columns, -1);
+    for (int col : stringColumns) {
+        blocksAt[col] = pos;
+        writeAt(file, pos, blockRefs[col].constData(), blockRefs[col].size() * qint64(sizeof(qint64)));
+        pos += blockRefs[col].size() * qint64(sizeof(qint64));
+    }
+
+    const QFileInfo sourceInfo(store.filePath());
+    const QVector<qint64> firstOffset = store.rowOffsets(0, 1);
+    QByteArray meta;
+    {
+        QDataStream out(&meta, QIODevice::WriteOnly);
+        out.setVersion(QDataStream::Qt_6_0);
+        out << store.headers() << qint32(store.type()) << sourceInfo.absoluteFilePath() << sourceInfo.size()
+            << sourceInfo.lastModified().toMSecsSinceEpoch()
+            << (firstOffset.isEmpty() ? qint64(-1) : firstOffset.first())
+            << qint32(rows) << qint32(BLOCK_ROWS) << qint32(blocks)
+            << offsetsAt << timestampsAt << blockTimesAt << qint32(columns);
+        for (int col = 0; col < columns; ++col) {
+            out << bool(isDictionary[col]);
+            if (isDictionary[col])
+                out << dictionaries[col] << codesAt[col];
+            else
+                out << blocksAt[col];
+        }
+    }
+    writeAt(file, pos, meta.constData(), meta.size());
+
+    const FileHeader header{MAGIC, VERSION, BYTE_ORDER_MARK, 0, pos, meta.size()};
+    writeAt(file, 0, &header, sizeof(header));
+    if (!file.commit())
+        fail(QString("Cannot write %1: %2").arg(outPath, file.errorString()));
+
+    qDebug() << "AnalysisCache: wrote" << rows << "rows," << columns - stringColumns.size()
+             << "dictionary columns," << QFileInfo(outPath).size() << "bytes to" << outPath
+             << "in" << timer.elapsed() << "ms";
+    return true;
+}
+
+AnalysisCache::AnalysisCache(const QString& path)
+    : m_file(path)
+{
+    if (!m_file.open(QIODevice::ReadOnly))
+        fail(QString("Cannot open analysis cache: %1").arg(m_file.errorString()));
+    m_size = m_file.size();
+    if (m_size < qint64(sizeof(FileHeader)))
+        fail("Not an analysis cache");
+    m_map = m_file.map(0, m_size);
+    if (!m_map)
+        fail(QString("Cannot map analysis cache: %1").arg(m_file.errorString()));
+
+    FileHeader header;
+    std::memcpy(&header, m_map, sizeof(header));
+    if (header.magic != MAGIC || header.byteOrder != BYTE_ORDER_MARK)
+        fail("Not an analysis cache, or written on a machine of different byte order");
+    if (header.version != VERSION)
+        fail("Unsupported analysis cache version; convert the timeline again");
+    if (header.metaOffset < qint64(sizeof(FileHeader)) || header.metaSize < 0
+        || header.metaOffset > m_size - header.metaSize)
+        fail("Corrupt analysis cache (metadata)");
+
+    // Every array must lie inside the file, aligned for its element type
+    auto array = [this](qint64 at, qint64 count, qint64 elementSize) {
+        if (at < qint64(sizeof(FileHeader)) || at % elementSize != 0 || count < 0 || at > m_size
+            || count > (m_size - at) / elementSize)
+            fail("Corrupt analysis cache (layout)");
+        return m_map + at;
+    };
+
+    QDataStream in(QByteArray::fromRawData(reinterpret_cast<const char*>(m_map + header.metaOffset),
+                                           header.metaSize));
+    in.setVersion(QDataStream::Qt_6_0);
+    qint32 type = 0, rows = 0, blockRows = 0, blocks = 0, columns = 0;
+    qint64 offsetsAt = 0, timestampsAt = 0, blockTimesAt = 0;
+    in >> m_headers >> type >> m_sourcePath >> m_sourceSize >> m_sourceModified >> m_headerEnd
+       >> rows >> blockRows >> blocks >> offsetsAt >> timestampsAt >> blockTimesAt >> columns;
+    if (in.status() != QDataStream::Ok || rows < 0 || rows > LineIndex::MAX_LINE_COUNT
+        || blockRows != BLOCK_ROWS || blocks != (rows + BLOCK_ROWS - 1) / BLOCK_ROWS
+        || columns != m_headers.size() || type < TimelineParser::Filesystem || type > TimelineParser::Unknown)
+        fail("Corrupt analysis cache (metadata)");
+    m_type = static_cast<TimelineParser::TimelineType>(type);
+    m_rows = rows;
+    m_blocks = blocks;
+    m_offsets = reinterpret_cast<const qint64*>(array(offsetsAt, rows, sizeof(qint64)));
+    m_timestamps = reinterpret_cast<const qint64*>(array(timestampsAt, rows, sizeof(qint64)));
+    m_blockTimes = reinterpret_cast<const qint64*>(array(blockTimesAt, 2LL * blocks, sizeof(qint64)));
+
+    m_columns.resize(columns);
+    for (Column& column : m_columns) {
+        qint64 at = 0;
+        in >> column.dictionary;
+        if (column.dictionary) {
+            in >> column.values >> at;
+            if (in.status() != QDataStream::Ok || column.values.size() > MAX_DICTIONARY)
+                fail("Corrupt analysis cache (dictionary)");
+            column.codes = reinterpret_cast<const quint16*>(array(at, rows, sizeof(quint16)));
+        } else {
+            in >> at;
+            if (in.status() != QDataStream::Ok)
+                fail("Corrupt analysis cache (metadata)");
+            column.blocks = reinterpret_cast<const qint64*>(array(at, 2LL * blocks, sizeof(qint64)));
+        }
+    }
+    qDebug() << "AnalysisCache: opened" << path << "(" << m_rows << "rows, source" << m_sourcePath << ")";
+}
+
+AnalysisCache::~AnalysisCache()
+{
+    m_file.unmap(const_cast<uchar*>(m_map));
+}
+
+bool AnalysisCache::sourceUnchanged() const
+{
+    const QFileInfo info(m_sourcePath);
+    return info.exists() && info.size() == m_sourceSize
+        && info.lastModified().toMSecsSinceEpoch() == m_sourceModified;
+}
+
+QVector<int> AnalysisCache::rowsInTimeRange(qint64 from, qint64 to) const
+{
+    QVector<int> rows;
+    for (int b = 0; b < m_blocks; ++b) {
+        const qint64 min = blockMinTime(b);
+        if (min == TimelineParser::INVALID_TIMESTAMP || min > to || blockMaxTime(b) < from)
+            continue;
+        for (int row = blockFirst(b); row < blockLast(b); ++row) {
+            const qint64 ts = m_timestamps[row];
+            if (ts != TimelineParser::INVALID_TIMESTAMP && ts >= from && ts <= to)
+                rows.append(row);
+        }
+    }
+    return rows;
+}
+
+QByteArrayView AnalysisCache::StringBlock::value(int k) const
+{
+    const char* const base = data.constData();
+    const qsizetype begin = k > 0 ? qFromUnaligned<quint32>(base + 4 * (k - 1)) : 0;
+    const qsizetype end = qFromUnaligned<quint32>(base + 4 * k);
+    return QByteArrayView(base + 4 * qsizetype(count) + begin, end - begin);
+}
+
+AnalysisCache::StringBlock AnalysisCache::decodeBlock(int column, int block) const
+{
+    const qint64 offset = m_columns[column].blocks[2 * block];
+    const qint64 size = m_columns[column].blocks[2 * block + 1];
+    StringBlock out;
+    if (offset < qint64(sizeof(FileHeader)) || size < 4 || offset > m_size - size)
+        return out;
+    out.data = qUncompress(m_map + offset, size);
+
+    // The value ends must be ascending and inside the data
+    const int count = blockLast(block) - blockFirst(block);
+    const qsizetype bytes = out.data.size() - 4 * qsizetype(count);
+    if (bytes < 0)
+        return StringBlock();
+    quint32 previous = 0;
+    for (int k = 0; k < count; ++k) {
+        const quint32 end = qFromUnaligned<quint32>(out.data.constData() + 4 * k);
+        if (end < previous || end > bytes)
+            return StringBlock();
+        previous = end;
+    }
+    out.count = count;
+    return out;
+}
+
+AnalysisCache::StringBlock AnalysisCache::stringBlock(int column, int block) const
+{
+    const quint64 key = (quint64(column) << 32) | quint32(block);
+    {
+        QMutexLocker locker(&m_decodedMutex);
+        if (const StringBlock* cached = m_decoded.object(key))
+            return *cached;
+    }
+    // Decompressed without the lock; two threads may decode the same block
+    StringBlock decoded = decodeBlock(column, block);
+    if (decoded.count == 0) {
+        qWarning() << "AnalysisCache: corrupt block" << block << "of column" << column;
+        return decoded;
+    }
+    QMutexLocker locker(&m_decodedMutex);
+    m_decoded.insert(key, new StringBlock(decoded), qMax<qsizetype>(1, decoded.data.size()));
+    return decoded;
+}
+
+QByteArray AnalysisCache::value(int column, int row) const
+{
+    const Column& c = m_columns[column];
+    if (c.dictionary) {
+        const int code = c.codes[row];
+        return code < c.values.size() ? c.values[code] : QByteArray();
+    }
+    const int block = blockOf(row);
+    const StringBlock values = stringBlock(column, block);
+    return values.count > 0 ? values.value(row - blockFirst(block)).toByteArray() : QByteArray();
+}
+
+bool AnalysisCache::lines(int first, int last, const std::function<void(int, const QByteArray&)>& visit) const
+{
+    first = qMax(first, 0);
+    last = qMin(last, m_rows);
+    const int columns = m_columns.size();
+    QVector<StringBlock> blocks(columns);
+    QByteArray line;
+    while (first < last) {
+        const int block = blockOf(first);
+        for (int col = 0; col < columns; ++col) {
+            if (m_columns[col].dictionary)
+                continue;
+            blocks[col] = stringBlock(col, block);
+            if (blocks[col].count == 0)
+                return false;
+        }
+        const int end = qMin(last, blockLast(block));
+        for (int row = first; row < end; ++row) {
+            line.resize(0);
+            for (int col = 0; col < columns; ++col) {
+                const Column& c = m_columns[col];
+                if (col > 0)
+                    line += ',';
+                if (c.dictionary) {
+                    const int code = c.codes[row];
+                    if (code < c.values.size())
+                        appendCsvField(line, c.values[code]);
+                } else {
+                    appendCsvField(line, blocks[col].value(row - blockFirst(block)));
+                }
+            }
+            line += '\n';
+            visit(row, line);
+        }
+        first = end;
+    }
+    return true;
+}
+
+qint64 AnalysisCache::memoryBytes() const
+{
+    qint64 bytes = 0;
+    for (const Column& column : m_columns) {
+        for (const QByteArray& value : column.values)
+            bytes += value.capacity() + qint64(sizeof(QByteArray));
+    }
+    QMutexLocker locker(&m_decodedMutex);
+    return bytes + m_decoded.totalCost();
+}
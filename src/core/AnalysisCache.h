@@ -0,0 +1,134 @@
+#pragma once
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QCache>
+#include <QFile>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <atomic>
+#include <functional>
+#include "TimelineParser.h"
+
+class RowStore;
+
+/**
+ * @brief AnalysisCache is a binary, column-oriented copy of a timeline for repeated analysis.
+ *
+ * A .tlac file is written once from an indexed timeline and then opened in
+ * place of the CSV (RowStore does so transparently). It holds:
+ *  - the first column parsed to microseconds since the epoch, one qint64 per row
+ *  - columns with at most MAX_DICTIONARY distinct values as a dictionary
+ *    plus one quint16 code per row
+ *  - every other column as zlib-compressed blocks of BLOCK_ROWS values
+ *  - per block, the smallest and largest timestamp, so time ranges skip
+ *    whole blocks
+ *  - the byte offset of every row in the source CSV, for exports
+ * The file is memory-mapped read-only; only string blocks that are read
+ * are decompressed, and the most recent ones are kept (DECODED_CACHE_BYTES).
+ * Safe to read from several threads at once.
+ */
+class AnalysisCache {
+public:
+    static constexpr quint32 MAGIC = 0x544C4143;  // "TLAC"
+    static constexpr quint32 VERSION = 1;
+    static constexpr int BLOCK_ROWS = 8192;        // rows per compressed string block
+    static constexpr int MAX_DICTIONARY = 4096;    // distinct values of a dictionary-coded column
+    static constexpr int DECODED_CACHE_BYTES = 64 * 1024 * 1024;  // decompressed blocks kept
+    static constexpr int COMPRESSION_LEVEL = 3;    // zlib level of string blocks
+
+    // True if the file starts with the cache magic
+    static bool isCacheFile(const QString& path);
+    // <source>.tlac next to the source file
+    static QString suggestedPath(const QString& sourcePath);
+
+    // Writes a cache of every row of an opened store in two passes (column
+    // statistics, then data); progress() gets (rows done, 2 * rows). Runs on
+    // the calling thread. Returns false if cancelled, leaving no file;
+    // throws std::runtime_error if the file cannot be written.
+    static bool convert(const RowStore& store, const QString& outPath, const std::atomic<bool>& cancel,
+                        const std::function<void(int, int)>& progress = {});
+
+    // Maps the file and checks its layout; throws std::runtime_error
+    explicit AnalysisCache(const QString& path);
+    ~AnalysisCache();
+    AnalysisCache(const AnalysisCache&) = delete;
+    AnalysisCache& operator=(const AnalysisCache&) = delete;
+
+    const QStringList& headers() const { return m_headers; }
+    TimelineParser::TimelineType type() const { return m_type; }
+    int rowCount() const { return m_rows; }
+    int columnCount() const { return m_columns.size(); }
+
+    // The CSV the cache was written from. sourceUnchanged() is true while
+    // it still has the size and modification time it had then, i.e. while
+    // sourceOffset() can be used to copy rows out of it.
+    const QString& sourcePath() const { return m_sourcePath; }
+    bool sourceUnchanged() const;
+    qint64 sourceOffset(int row) const { return m_offsets[row]; }
+    qint64 sourceHeaderEnd() const { return m_headerEnd; }
+
+    qint64 timestamp(int row) const { return m_timestamps[row]; }  // or INVALID_TIMESTAMP
+    int blockCount() const { return m_blocks; }
+    int blockOf(int row) const { return row / BLOCK_ROWS; }
+    // Rows [blockFirst, blockLast) of a block and its timestamp range
+    // (INVALID_TIMESTAMP when no row of it has one)
+    int blockFirst(int block) const { return block * BLOCK_ROWS; }
+    int blockLast(int block) const { return qMin(m_rows, (block + 1) * BLOCK_ROWS); }
+    qint64 blockMinTime(int block) const { return m_blockTimes[2 * block]; }
+    qint64 blockMaxTime(int block) const { return m_blockTimes[2 * block + 1]; }
+    // Ascending rows with a timestamp in [from, to]; only blocks whose
+    // range overlaps it are looked at
+    QVector<int> rowsInTimeRange(qint64 from, qint64 to) const;
+
+    // Dictionary-coded columns: the values (UTF-8) and each row's code
+    bool isDictionary(int column) const { return m_columns[column].dictionary; }
+    const QVector<QByteArray>& dictionary(int column) const { return m_columns[column].values; }
+    int code(int column, int row) const { return m_columns[column].codes[row]; }
+
+    // Other columns: the decompressed values of one block. An empty block
+    // (count 0) means the data is corrupt.
+    struct StringBlock {
+        QByteArray data;  // count quint32 value ends, then the value bytes
+        int count = 0;
+        QByteArrayView value(int k) const;
+    };
+    StringBlock stringBlock(int column, int block) const;
+
+    QByteArray value(int column, int row) const;
+    // Rows [first, last) as CSV lines that FileUtils::parseCsvLine() splits
+    // back into the stored values, for code that reads raw rows. Returns
+    // false if a block is corrupt.
+    bool lines(int first, int last, const std::function<void(int, const QByteArray&)>& visit) const;
+
+    qint64 memoryBytes() const;  // dictionaries and decompressed blocks; mapped pages are not counted
+
+private:
+    struct Column {
+        bool dictionary = false;
+        QVector<QByteArray> values;       // dictionary columns
+        const quint16* codes = nullptr;   // dictionary columns, into the mapping
+        const qint64* blocks = nullptr;   // string columns: (offset, size) per block, into the mapping
+    };
+
+    QFile m_file;
+    const uchar* m_map = nullptr;
+    qint64 m_size = 0;
+    QStringList m_headers;
+    TimelineParser::TimelineType m_type = TimelineParser::Unknown;
+    QString m_sourcePath;
+    qint64 m_sourceSize = -1;
+    qint64 m_sourceModified = -1;
+    qint64 m_headerEnd = 0;
+    int m_rows = 0;
+    int m_blocks = 0;
+    const qint64* m_offsets = nullptr;
+    const qint64* m_timestamps = nullptr;
+    const qint64* m_blockTimes = nullptr;
+    QVector<Column> m_columns;
+
+    mutable QMutex m_decodedMutex;
+    mutable QCache<quint64, StringBlock> m_decoded{DECODED_CACHE_BYTES};
+    StringBlock decodeBlock(int column, int block) const;
+};
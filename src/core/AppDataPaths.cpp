@@ -0,0 +1,87 @@
+#include "AppDataPaths.h"
+#include <QStandardPaths>
+#include <QDir>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QCryptographicHash>
+#include <QDebug>
+
+namespace AppDataPaths {
+
+QString directory()
+{
+    const QString dataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir dir;
+    if (!dir.exists(dataDir) && !dir.mkpath(dataDir))
+        return QString();
+    return dataDir;
+}
+
+QString sanitizeFileName(const QString& fileName)
+{
+    QString sanitized = fileName;
+
+    sanitized.remove(QRegularExpression(R"([.]{2,})"));   // Remove .. sequences
+    sanitized.remove(QRegularExpression(R"([/\\])"));    // Remove path separators
+    sanitized.remove(QRegularExpression(R"([<>:"|?*])"));// Remove invalid filename chars
+
+    // Limit filename length
+    if (sanitized.length() > 200) {
+        sanitized = sanitized.left(200);
+    }
+
+    // Ensure we have a valid filename
+    if (sanitized.isEmpty()) {
+        sanitized = "timeline";
+    }
+
+    return sanitized;
+}
+
+QString indexCachePath(const QString& sourcePath)
+{
+    const QString dataDir = directory();
+    if (dataDir.isEmpty())
+        return QString();
+
+    // Include a hash of the absolute path so same-named files in different
+    // directories do not share a cache entry.
+    QFileInfo fileInfo(sourcePath);
+    const QByteArray pathHash = QCryptographicHash::hash(fileInfo.absoluteFilePath().toUtf8(),
+                                                         QCryptographicHash::Sha1).toHex().left(12);
+    QString baseName = sanitizeFileName(fileInfo.fileName());
+    return dataDir + QDir::separator() + baseName + "-" + QString::fromLatin1(pathHash) + ".idx";
+}
+
+QString tagFilePath(const QString& sourcePath)
+{
+    const QString dataDir = directory();
+    if (dataDir.isEmpty()) {
+        qWarning() << "Failed to create application data directory";
+        return QString(); // Return empty string on failure
+    }
+
+    QFileInfo fileInfo(sourcePath);
+    if (!fileInfo.exists()) {
+        qWarning() << "Source timeline file no longer exists";
+        return QString();
+    }
+
+    QString baseName = sanitizeFileName(fileInfo.completeBaseName());
+    if (baseName.isEmpty()) {
+        qWarning() << "Unable to generate valid tag filename";
+        return QString();
+    }
+
+    return dataDir + QDir::separator() + baseName + ".tags";
+}
+
+QString sessionFilePath()
+{
+    const QString dataDir = directory();
+    if (dataDir.isEmpty())
+        return QString();
+    return dataDir + QDir::separator() + "session.json";
+}
+
+} // namespace AppDataPaths
@@ -0,0 +1,18 @@
+#pragma once
+#include <QString>
+
+/**
+ * @brief AppDataPaths locates per-timeline files (tags, index caches) in the app data directory.
+ */
+namespace AppDataPaths {
+    // The writable app data directory, created on demand; empty on failure
+    QString directory();
+    QString sanitizeFileName(const QString& fileName);
+
+    // <name>-<hash of absolute path>.idx
+    QString indexCachePath(const QString& sourcePath);
+    // <complete base name>.tags
+    QString tagFilePath(const QString& sourcePath);
+    // session.json: the tabs open when the viewer was last closed
+    QString sessionFilePath();
+}
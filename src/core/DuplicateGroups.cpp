@@ -0,0 +1,191 @@
+#include "DuplicateGroups.h"
+#include "RowStore.h"
+#include "utils/FileUtils.h"
+#include <QHash>
+#include <algorithm>
+
+namespace {
+
+constexpr quint64 FNV_OFFSET = 1469598103934665603ULL;
+constexpr quint64 FNV_PRIME = 1099511628211ULL;
+
+inline void mix(quint64& h, quint64 value)
+{
+    h = (h ^ value) * FNV_PRIME;
+}
+
+} // namespace
+
+quint64 DuplicateGroups::keyHash(const QStringList& fields, const Key& key)
+{
+    // FNV-1a over the key columns; with maskNumbers a digit run hashes as
+    // one '#', so "sshd[1234]" and "sshd[987]" compare equal
+    quint64 h = FNV_OFFSET;
+    for (int column : key.columns) {
+        mix(h, 0x1F);  // column separator
+        if (column < 0 || column >= fields.size())
+            continue;
+        bool inDigits = false;
+        for (QChar c : fields[column]) {
+            if (key.maskNumbers && c.isDigit()) {
+                if (!inDigits)
+                    mix(h, '#');
+                inDigits = true;
+                continue;
+            }
+            inDigits = false;
+            mix(h, c.unicode());
+        }
+    }
+    return h;
+}
+
+DuplicateGroups DuplicateGroups::build(const RowStore& store, const QVector<int>& rows, const Key& key,
+                                       const std::atomic<bool>& cancel,
+                                       const std::function<void(int, int)>& progress)
+{
+    const bool allRows = rows.isEmpty();
+    const int total = allRows ? store.rowCount() : rows.size();
+
+    // One hash per row; only held until the runs are found
+    QVector<quint64> hashes;
+    hashes.reserve(total);
+    QStringList fields;
+    auto hashLine = [&](const QByteArray& raw) {
+        try {
+            fields = FileUtils::parseCsvLine(QString::fromUtf8(raw.trimmed()));
+        } catch (...) {
+            hashes.append(qHash(raw));  // unparsable lines only match identical lines
+            return;
+        }
+        hashes.append(keyHash(fields, key));
+    };
+
+    if (allRows) {
+        for (int first = 0; first < total; first += CANCEL_CHECK_ROWS) {
+            if (cancel.load(std::memory_order_relaxed))
+                return DuplicateGroups();
+            const int last = qMin(total, first + CANCEL_CHECK_ROWS);
+            if (!store.scan(first, last, [&](int, const QByteArray& raw) { hashLine(raw); }))
+                return DuplicateGroups();
+            if (progress)
+                progress(last, total);
+        }
+    } else {
+        QByteArray raw;
+        for (int i = 0; i < total; ++i) {
+            if (i % CANCEL_CHECK_ROWS == 0) {
+                if (cancel.load(std::memory_order_relaxed))
+                    return DuplicateGroups();
+                if (progress && i > 0)
+                    progress(i, total);
+            }
+            if (!store.readRaw(rows[i], raw))
+                raw.clear();
+            hashLine(raw);
+        }
+    }
+    if (cancel.load(std::memory_order_relaxed))
+        return DuplicateGroups();
+
+    // At each position, look for the shortest pattern (up to 'window' rows)
+    // that repeats right after itself, then extend the run while the rows
+    // keep following the pattern
+    DuplicateGroups groups;
+    const int window = qBound(1, key.window, MAX_WINDOW);
+    const int n = hashes.size();
+    for (int i = 0; i < n;) {
+        int period = 0;
+        for (int p = 1; p <= window && i + 2 * p <= n; ++p) {
+            if (std::equal(hashes.cbegin() + i, hashes.cbegin() + i + p, hashes.cbegin() + i + p)) {
+                period = p;
+                break;
+            }
+        }
+        if (period == 0) {
+            ++i;
+            continue;
+        }
+        int end = i + 2 * period;
+        while (end < n && hashes[end] == hashes[end - period])
+            ++end;
+        groups.m_runs.append({i, end - i});
+        i = end;
+    }
+    groups.m_runs.squeeze();
+    groups.m_expanded.resize(groups.m_runs.size());
+    groups.updateHidden();
+    return groups;
+}
+
+void DuplicateGroups::setExpanded(int runIndex, bool expanded)
+{
+    if (runIndex < 0 || runIndex >= m_runs.size() || isExpanded(runIndex) == expanded)
+        return;
+    m_expanded.setBit(runIndex, expanded);
+    updateHidden();
+}
+
+void DuplicateGroups::updateHidden()
+{
+    m_hiddenBefore.resize(m_runs.size());
+    int hiddenSoFar = 0;
+    for (int r = 0; r < m_runs.size(); ++r) {
+        m_hiddenBefore[r] = hiddenSoFar;
+        hiddenSoFar += hidden(r);
+    }
+    m_hiddenTotal = hiddenSoFar;
+}
+
+int DuplicateGroups::lastRunStartingAtOrBefore(int position) const
+{
+    const auto it = std::upper_bound(m_runs.cbegin(), m_runs.cend(), position,
+                                     [](int pos, const Run& run) { return pos < run.start; });
+    return static_cast<int>(it - m_runs.cbegin()) - 1;
+}
+
+int DuplicateGroups::toPosition(int viewRow) const
+{
+    // The view rows of the runs' first rows are strictly increasing
+    int lo = 0, hi = m_runs.size();
+    while (lo < hi) {
+        const int mid = (lo + hi) / 2;
+        if (m_runs[mid].start - m_hiddenBefore[mid] <= viewRow)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    const int r = lo - 1;
+    if (r < 0)
+        return viewRow;
+    if (viewRow == m_runs[r].start - m_hiddenBefore[r])
+        return m_runs[r].start;
+    return viewRow + m_hiddenBefore[r] + hidden(r);
+}
+
+int DuplicateGroups::toViewRow(int position) const
+{
+    const int r = lastRunStartingAtOrBefore(position);
+    if (r < 0)
+        return position;
+    const Run& run = m_runs[r];
+    if (position < run.start + run.length) {
+        if (position != run.start && !isExpanded(r))
+            return -1;
+        return position - m_hiddenBefore[r];
+    }
+    return position - m_hiddenBefore[r] - hidden(r);
+}
+
+int DuplicateGroups::runAt(int position) const
+{
+    const int r = lastRunStartingAtOrBefore(position);
+    return (r >= 0 && m_runs[r].start == position) ? r : -1;
+}
+
+qint64 DuplicateGroups::memoryBytes() const
+{
+    return m_runs.capacity() * static_cast<qint64>(sizeof(Run))
+         + m_hiddenBefore.capacity() * static_cast<qint64>(sizeof(int))
+         + m_expanded.size() / 8;
+}
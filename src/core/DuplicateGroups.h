@@ -0,0 +1,72 @@
+#pragma once
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QBitArray>
+#include <atomic>
+#include <functional>
+
+class RowStore;
+
+/**
+ * @brief DuplicateGroups collapses runs of repeated rows into one row each.
+ *
+ * Rows are compared by a hash of their key columns. A run is either a block
+ * of consecutive duplicates or, with a window above 1, a short pattern that
+ * repeats back to back (e.g. cron "session opened" / "session closed"
+ * pairs). Runs are stored run-length encoded over positions in the grouped
+ * row sequence, so collapsing or expanding them needs no re-scan.
+ */
+class DuplicateGroups {
+public:
+    static constexpr int MAX_WINDOW = 16;          // longest repeating pattern, in rows
+    static constexpr int CANCEL_CHECK_ROWS = 65536; // rows scanned between cancellation checks
+
+    struct Key {
+        QVector<int> columns;      // CSV columns compared; virtual columns are not supported
+        bool maskNumbers = true;   // digit runs (PIDs, ports, counters) compare equal
+        int window = 1;            // 1 = consecutive duplicates only
+    };
+
+    struct Run {
+        int start = 0;   // position of the first row of the run
+        int length = 0;  // rows in the run, at least 2
+    };
+
+    // Groups the given ascending source rows (all rows of the store when
+    // empty). Runs on the calling thread; progress() gets rows hashed so
+    // far. Returns an empty result if cancelled.
+    static DuplicateGroups build(const RowStore& store, const QVector<int>& rows, const Key& key,
+                                 const std::atomic<bool>& cancel,
+                                 const std::function<void(int, int)>& progress = {});
+
+    // Normalized key hash of one parsed row
+    static quint64 keyHash(const QStringList& fields, const Key& key);
+
+    bool isEmpty() const { return m_runs.isEmpty(); }
+    int runCount() const { return m_runs.size(); }
+    const Run& run(int index) const { return m_runs[index]; }
+    int hiddenRows() const { return m_hiddenTotal; }
+
+    // Expanded runs show all their rows; the mapping is updated in O(runs)
+    void setExpanded(int runIndex, bool expanded);
+    bool isExpanded(int runIndex) const { return m_expanded.testBit(runIndex); }
+
+    // Mapping between grouped view rows and positions in the row sequence
+    int viewCount(int positions) const { return positions - m_hiddenTotal; }
+    int toPosition(int viewRow) const;
+    int toViewRow(int position) const;    // -1 if the position is collapsed
+    int runAt(int position) const;        // run whose first row is at position, or -1
+
+    qint64 memoryBytes() const;
+
+private:
+    QVector<Run> m_runs;           // ascending, non-overlapping
+    QVector<int> m_hiddenBefore;   // per run, rows hidden by the runs before it
+    QBitArray m_expanded;
+    int m_hiddenTotal = 0;
+
+    int hidden(int runIndex) const { return isExpanded(runIndex) ? 0 : m_runs[runIndex].length - 1; }
+    int lastRunStartingAtOrBefore(int position) const;
+    void updateHidden();
+};
@@ -0,0 +1,289 @@
+#include "FilterEngine.h"
+#include "RowStore.h"
+#include "RowChunk.h"
+#include "AnalysisCache.h"
+#include "utils/FileUtils.h"
+#include <QElapsedTimer>
+#include <QThread>
+#include <QThreadPool>
+#include <atomic>
+#include <memory>
+
+namespace {
+
+inline char asciiLower(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+}
+
+bool isAscii(QByteArrayView text)
+{
+    for (char c : text) {
+        if (static_cast<uchar>(c) >= 0x80)
+            return false;
+    }
+    return true;
+}
+
+// term is lower-case ASCII
+bool containsAsciiNoCase(QByteArrayView text, const QByteArray& term)
+{
+    const qsizetype n = term.size();
+    if (text.size() < n)
+        return false;
+    const char first = term[0];
+    const char firstUpper = (first >= 'a' && first <= 'z') ? first - ('a' - 'A') : first;
+    const char* const end = text.data() + text.size() - n;
+    for (const char* p = text.data(); p <= end; ++p) {
+        if (*p != first && *p != firstUpper)
+            continue;
+        qsizetype k = 1;
+        while (k < n && asciiLower(p[k]) == term[k])
+            ++k;
+        if (k == n)
+            return true;
+    }
+    return false;
+}
+
+} // namespace
+
+FilterEngine::FilterEngine(int column, const QString& term)
+    : m_column(column), m_term(term.toLower()), m_termUtf8(m_term.toUtf8())
+{
+    m_asciiTerm = isAscii(m_termUtf8);
+}
+
+bool FilterEngine::matches(const QStringList& fields) const
+{
+    if (m_column < 0) {
+        for (const QString& f : fields) {
+            if (f.toLower().contains(m_term))
+                return true;
+        }
+        return false;
+    }
+    return m_column < fields.size() && fields[m_column].toLower().contains(m_term);
+}
+
+bool FilterEngine::matchesLine(const QByteArray& raw) const
+{
+    try {
+        return matches(FileUtils::parseCsvLine(QString::fromUtf8(raw.trimmed())));
+    } catch (...) {
+        return false;
+    }
+}
+
+bool FilterEngine::containsTerm(QByteArrayView text) const
+{
+    // Lower-casing only maps ASCII letters to ASCII letters, so an ASCII
+    // match stands; text with other characters gets the QString check too,
+    // since a few of them lower-case to ASCII (e.g. the Kelvin sign)
+    if (m_asciiTerm) {
+        if (m_termUtf8.isEmpty() || containsAsciiNoCase(text, m_termUtf8))
+            return true;
+        if (isAscii(text))
+            return false;
+    }
+    return QString::fromUtf8(text).toLower().contains(m_term);
+}
+
+bool FilterEngine::matches(const RowChunk& chunk, int r) const
+{
+    if (!chunk.isValid(r))
+        return false;
+    // A row's fields are '\0'-separated, so a term never matches across two
+    if (m_column < 0)
+        return containsTerm(chunk.row(r));
+    return m_column < chunk.columnCount() && containsTerm(chunk.field(r, m_column));
+}
+
+QVector<int> FilterEngine::scan(const RowStore& store, const std::function<void(int, int)>& progress) const
+{
+    QElapsedTimer searchTimer, phase;
+    searchTimer.start();
+    qint64 parseNs = 0, progressNs = 0;
+    const int total = store.rowCount();
+    QVector<int> matchingRows;
+
+    const auto reportProgress = [&](int row) {
+        if (!progress)
+            return;
+        QElapsedTimer timer;
+        timer.start();
+        progress(row, total);
+        progressNs += timer.nsecsElapsed();
+    };
+    if (const AnalysisCache* cache = store.analysisCache()) {
+        matchingRows = CacheScan(*this, *cache).rows(0, total, parseNs, reportProgress);
+    } else {
+        RowChunk chunk;
+        store.scanChunks(0, total, chunk, [&](const RowChunk& rows) {
+            phase.start();
+            for (int r = 0; r < rows.rowCount(); ++r) {
+                if (matches(rows, r))
+                    matchingRows.append(rows.firstRow() + r);
+            }
+            parseNs += phase.nsecsElapsed();
+        }, reportProgress);
+    }
+
+    // Whatever is neither matching nor the caller's progress handling is
+    // spent reading and decoding rows (decompressing, for a cache)
+    const qint64 readNs = qMax<qint64>(0, searchTimer.nsecsElapsed() - parseNs - progressNs);
+    store.metrics().recordSearch(searchTimer.elapsed(), readNs / 1000000, parseNs / 1000000,
+                                 total, matchingRows.size());
+    return matchingRows;
+}
+
+QVector<int> FilterEngine::scan(const RowStore& store, int threads,
+                                const std::function<void(int, int)>& progress) const
+{
+    const int total = store.rowCount();
+    const int chunks = (total + CHUNK_ROWS - 1) / CHUNK_ROWS;
+    if (threads <= 0)
+        threads = QThread::idealThreadCount();
+    if (!store.isPositional())
+        threads = 1;
+    threads = qBound(1, threads, qMax(1, chunks));
+    if (threads == 1)
+        return scan(store, progress);
+
+    QElapsedTimer searchTimer;
+    searchTimer.start();
+    std::unique_ptr<CacheScan> cacheScan;
+    if (const AnalysisCache* cache = store.analysisCache())
+        cacheScan.reset(new CacheScan(*this, *cache));
+
+    // Workers take the next range until none are left; each range's
+    // matches go to their own slot so the result stays in row order
+    QVector<QVector<int>> chunkRows(chunks);
+    std::atomic<int> nextChunk{0};
+    std::atomic<int> rowsDone{0};
+    std::atomic<qint64> matchNs{0};
+    auto work = [&]() {
+        RowChunk chunk;
+        QElapsedTimer phase;
+        for (int c = nextChunk++; c < chunks; c = nextChunk++) {
+            const int first = c * CHUNK_ROWS;
+            const int last = qMin(total, first + CHUNK_ROWS);
+            qint64 ns = 0;
+            if (cacheScan) {
+                chunkRows[c] = cacheScan->rows(first, last, ns);
+            } else {
+                store.scanChunks(first, last, chunk, [&](const RowChunk& rows) {
+                    phase.start();
+                    for (int r = 0; r < rows.rowCount(); ++r) {
+                        if (matches(rows, r))
+                            chunkRows[c].append(rows.firstRow() + r);
+                    }
+                    ns += phase.nsecsElapsed();
+                });
+            }
+            matchNs += ns;
+            rowsDone += last - first;
+        }
+    };
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(threads);
+    for (int t = 0; t < threads; ++t)
+        pool.start(work);
+    while (!pool.waitForDone(PROGRESS_MS)) {
+        if (progress)
+            progress(rowsDone.load(), total);
+    }
+
+    QVector<int> matchingRows;
+    for (const QVector<int>& part : chunkRows)
+        matchingRows += part;
+
+    // Matching time is summed over the workers; spread it over them
+    const qint64 searchMs = searchTimer.elapsed();
+    const qint64 matchMs = matchNs / threads / 1000000;
+    store.metrics().recordSearch(searchMs, qMax<qint64>(0, searchMs - matchMs), matchMs, total, matchingRows.size());
+    return matchingRows;
+}
+
+FilterEngine::CacheScan::CacheScan(const FilterEngine& filter, const AnalysisCache& cache)
+    : m_filter(filter), m_cache(cache), m_valueHits(cache.columnCount())
+{
+    if (filter.m_column < 0) {
+        for (int col = 0; col < cache.columnCount(); ++col)
+            m_columns.append(col);
+    } else if (filter.m_column < cache.columnCount()) {
+        m_columns.append(filter.m_column);
+    }
+    for (int col : m_columns) {
+        if (!cache.isDictionary(col))
+            continue;
+        const QVector<QByteArray>& values = cache.dictionary(col);
+        m_valueHits[col].resize(values.size());
+        for (int code = 0; code < values.size(); ++code)
+            m_valueHits[col][code] = filter.containsTerm(values[code]);
+    }
+}
+
+QVector<int> FilterEngine::CacheScan::rows(int first, int last, qint64& matchNs,
+                                           const std::function<void(int)>& progress) const
+{
+    first = qMax(first, 0);
+    last = qMin(last, m_cache.rowCount());
+    QVector<int> matchingRows;
+    QVector<quint8> hit;
+    QElapsedTimer phase;
+    while (first < last) {
+        // Rows [first, end) of one block; hit[] and the block values count
+        // from the block's first row
+        const int block = m_cache.blockOf(first);
+        const int base = m_cache.blockFirst(block);
+        const int end = qMin(last, m_cache.blockLast(block));
+        hit.fill(0, end - base);
+        int remaining = end - first;
+
+        phase.start();
+        for (int col : m_columns) {
+            if (!m_cache.isDictionary(col))
+                continue;
+            const QVector<bool>& hits = m_valueHits[col];
+            for (int row = first; row < end; ++row) {
+                if (hit[row - base])
+                    continue;
+                const int code = m_cache.code(col, row);
+                if (code < hits.size() && hits[code]) {
+                    hit[row - base] = 1;
+                    --remaining;
+                }
+            }
+        }
+        matchNs += phase.nsecsElapsed();
+
+        for (int col : m_columns) {
+            if (remaining == 0)
+                break;
+            if (m_cache.isDictionary(col))
+                continue;
+            const AnalysisCache::StringBlock values = m_cache.stringBlock(col, block);
+            if (values.count == 0)
+                continue;
+            phase.start();
+            for (int row = first; row < end; ++row) {
+                if (!hit[row - base] && m_filter.containsTerm(values.value(row - base))) {
+                    hit[row - base] = 1;
+                    --remaining;
+                }
+            }
+            matchNs += phase.nsecsElapsed();
+        }
+
+        for (int row = first; row < end; ++row) {
+            if (hit[row - base])
+                matchingRows.append(row);
+        }
+        if (progress)
+            progress(end);
+        first = end;
+    }
+    return matchingRows;
+}
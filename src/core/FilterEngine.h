@@ -0,0 +1,69 @@
+#pragma once
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QVector>
+#include <functional>
+
+class RowStore;
+class RowChunk;
+class AnalysisCache;
+
+/**
+ * @brief FilterEngine matches timeline rows against a case-insensitive search term.
+ *
+ * The term is searched in one column or, with column -1, in every column of
+ * the CSV row.
+ */
+class FilterEngine {
+public:
+    FilterEngine() = default;
+    FilterEngine(int column, const QString& term);
+
+    bool isActive() const { return !m_term.isEmpty(); }
+    int column() const { return m_column; }
+    const QString& term() const { return m_term; }  // lower-cased
+
+    bool matches(const QStringList& fields) const;
+    bool matchesLine(const QByteArray& raw) const;  // tokenizes first; unparsable lines never match
+    bool matches(const RowChunk& chunk, int r) const;  // same result as matchesLine() on the raw row
+
+    // Scans every row of the store, decoded a chunk at a time, and returns
+    // the matching rows in ascending order. Records the search in the
+    // store's metrics, split into read/decode and match time. An analysis
+    // cache is searched through a CacheScan instead.
+    QVector<int> scan(const RowStore& store, const std::function<void(int, int)>& progress = {}) const;
+    // Same, with the rows split into CHUNK_ROWS ranges shared out to up to
+    // threads workers (0: one per core), like IocSweep::scan(); progress()
+    // is then called on the calling thread every PROGRESS_MS. Compressed
+    // input is scanned on one thread, its reads being serialized anyway.
+    static constexpr int CHUNK_ROWS = 65536;
+    static constexpr int PROGRESS_MS = 50;
+    QVector<int> scan(const RowStore& store, int threads, const std::function<void(int, int)>& progress = {}) const;
+
+    // Search of an analysis cache that reads only the searched columns:
+    // each dictionary value is matched once, when the CacheScan is made,
+    // and string blocks are only decompressed for rows without a hit yet.
+    // The filter and cache must outlive it.
+    class CacheScan {
+    public:
+        CacheScan(const FilterEngine& filter, const AnalysisCache& cache);
+        // Matching rows of [first, last), ascending; progress() gets the row
+        // reached after each block, and the time spent matching is added to
+        // matchNs
+        QVector<int> rows(int first, int last, qint64& matchNs,
+                          const std::function<void(int)>& progress = {}) const;
+    private:
+        const FilterEngine& m_filter;
+        const AnalysisCache& m_cache;
+        QVector<int> m_columns;
+        QVector<QVector<bool>> m_valueHits;  // dictionary columns: by code
+    };
+
+private:
+    int m_column = -1;
+    QString m_term;
+    QByteArray m_termUtf8;     // m_term as UTF-8, for matching decoded chunks
+    bool m_asciiTerm = true;   // ASCII terms are matched on the bytes
+    bool containsTerm(QByteArrayView text) const;
+};
@@ -0,0 +1,604 @@
+#include "IoBackend.h"
+#include <QFile>
+#include <QMutex>
+#include <QSemaphore>
+#include <QThread>
+#include <QDebug>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef HAVE_LIBURING
+#include <liburing.h>
+#endif
+
+namespace {
+
+std::atomic<int> s_defaultKind{-1};  // -1: not set, use $TIMELINE_IO
+std::atomic<int> s_latencyUs{0};
+
+// Reads up to 'size' bytes at 'offset', retrying short and interrupted
+// reads; returns the number of bytes read, or -1 on error
+qint64 preadFully(int fd, char* data, qint64 size, qint64 offset)
+{
+    qint64 done = 0;
+    while (done < size) {
+        const ssize_t n = ::pread(fd, data + done, size - done, offset + done);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0)
+            return -1;
+        if (n == 0)
+            break;
+        done += n;
+    }
+    return done;
+}
+
+class BufferedBackend : public IoBackend {
+public:
+    using IoBackend::IoBackend;
+    Kind kind() const override { return Buffered; }
+
+    qint64 read(qint64 offset, char* data, qint64 size) const override
+    {
+        return preadFully(m_fd, data, size, offset);
+    }
+
+    bool stream(QVector<Request>& requests, const std::function<bool(int, Request&)>& visit) const override
+    {
+        beginStream();
+        const bool ok = IoBackend::stream(requests, visit);
+        endStream();
+        return ok;
+    }
+
+protected:
+    // Lets the kernel read further ahead than for random access; random
+    // reads (paging, tags) go back to normal read-ahead. Linux applies this
+    // to the whole file whatever the range.
+    void setSequential(bool sequential) const override
+    {
+        posix_fadvise(m_fd, 0, 0, sequential ? POSIX_FADV_SEQUENTIAL : POSIX_FADV_NORMAL);
+    }
+};
+
+class MmapBackend : public IoBackend {
+public:
+    explicit MmapBackend(int fd)
+        : IoBackend(fd)
+    {
+        // Rows appended later (follow mode) lie past the mapping and are
+        // read with pread(). A file truncated while mapped raises SIGBUS on
+        // access, so this backend is for evidence that no longer changes.
+        const qint64 length = IoBackend::size();
+        if (length <= 0)
+            return;
+        void* map = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+        if (map == MAP_FAILED) {
+            qWarning() << "IoBackend: mmap failed, reading with pread():" << strerror(errno);
+            return;
+        }
+        m_map = static_cast<const char*>(map);
+        m_mapSize = length;
+    }
+
+    ~MmapBackend() override
+    {
+        if (m_map)
+            ::munmap(const_cast<char*>(m_map), m_mapSize);
+    }
+
+    Kind kind() const override { return Mmap; }
+
+    qint64 read(qint64 offset, char* data, qint64 size) const override
+    {
+        if (offset < 0)
+            return -1;
+        qint64 done = 0;
+        if (m_map && offset < m_mapSize) {
+            done = qMin(size, m_mapSize - offset);
+            memcpy(data, m_map + offset, done);
+        }
+        if (done < size) {
+            const qint64 n = preadFully(m_fd, data + done, size - done, offset + done);
+            if (n < 0)
+                return -1;
+            done += n;
+        }
+        return done;
+    }
+
+    bool stream(QVector<Request>& requests, const std::function<bool(int, Request&)>& visit) const override
+    {
+        beginStream();
+        const bool ok = IoBackend::stream(requests, visit);
+        endStream();
+        return ok;
+    }
+
+    void advise(qint64 offset, qint64 length) const override
+    {
+        adviseMapping(offset, length, MADV_WILLNEED);
+    }
+
+protected:
+    // Sequential advice lets the kernel drop pages behind the scan, which
+    // random viewport reads of the mapping must not inherit
+    void setSequential(bool sequential) const override
+    {
+        adviseMapping(0, 0, sequential ? MADV_SEQUENTIAL : MADV_NORMAL);
+    }
+
+private:
+    const char* m_map = nullptr;
+    qint64 m_mapSize = 0;
+
+    void adviseMapping(qint64 offset, qint64 length, int advice) const
+    {
+        if (!m_map || offset >= m_mapSize)
+            return;
+        // madvise() needs a page-aligned start
+        static const qint64 pageSize = sysconf(_SC_PAGESIZE);
+        const qint64 begin = offset - offset % pageSize;
+        const qint64 end = (length > 0) ? qMin(offset + length, m_mapSize) : m_mapSize;
+        ::madvise(const_cast<char*>(m_map) + begin, end - begin, advice);
+    }
+};
+
+class AsyncBackend : public IoBackend {
+public:
+    static constexpr int RING_ENTRIES = 64;  // requests in flight for readBatch()
+
+    explicit AsyncBackend(int fd)
+        : IoBackend(fd)
+    {
+#ifdef HAVE_LIBURING
+        // io_uring can be missing (old kernel) or blocked (seccomp, some
+        // containers) even when the library is there; the probe ring is
+        // kept as the first one to use
+        if (io_uring* ring = takeRing()) {
+            m_uring = true;
+            returnRing(ring, true);
+        }
+#endif
+    }
+
+#ifdef HAVE_LIBURING
+    ~AsyncBackend() override
+    {
+        for (io_uring* ring : m_idleRings) {
+            io_uring_queue_exit(ring);
+            delete ring;
+        }
+    }
+#endif
+
+    Kind kind() const override { return Async; }
+
+    QString name() const override
+    {
+        return m_uring ? QString("async (io_uring)") : QString("async (pread threads)");
+    }
+
+    qint64 read(qint64 offset, char* data, qint64 size) const override
+    {
+        return preadFully(m_fd, data, size, offset);
+    }
+
+    bool readBatch(QVector<Request>& requests) const override
+    {
+#ifdef HAVE_LIBURING
+        if (m_uring) {
+            const int result = runRing(requests, nullptr);
+            if (result != RingUnavailable)
+                return result == RingDone;
+        }
+#endif
+        return readBatchPooled(requests);
+    }
+
+    bool stream(QVector<Request>& requests, const std::function<bool(int, Request&)>& visit) const override
+    {
+#ifdef HAVE_LIBURING
+        if (m_uring) {
+            const int result = runRing(requests, &visit);
+            if (result != RingUnavailable)
+                return result == RingDone;
+        }
+#endif
+        return streamPooled(requests, visit);
+    }
+
+private:
+    bool m_uring = false;
+
+#ifdef HAVE_LIBURING
+    enum { RingDone, RingFailed, RingUnavailable };
+    enum : quint8 { Pending, Done };
+
+    // Rings are set up once and kept for the next batch, since creating one
+    // costs a few syscalls and locked memory. Each batch holds its ring on
+    // its own, so concurrent batches (one per reader thread) get one each.
+    mutable QMutex m_ringMutex;
+    mutable QVector<io_uring*> m_idleRings;
+
+    io_uring* takeRing() const
+    {
+        {
+            QMutexLocker locker(&m_ringMutex);
+            if (!m_idleRings.isEmpty())
+                return m_idleRings.takeLast();
+        }
+        auto* ring = new io_uring;
+        if (io_uring_queue_init(RING_ENTRIES, ring, 0) < 0) {
+            delete ring;
+            return nullptr;
+        }
+        return ring;
+    }
+
+    // A ring that may still hold unsubmitted SQEs is not reused
+    void returnRing(io_uring* ring, bool clean) const
+    {
+        if (clean) {
+            QMutexLocker locker(&m_ringMutex);
+            m_idleRings.append(ring);
+            return;
+        }
+        io_uring_queue_exit(ring);
+        delete ring;
+    }
+
+    // A completion of res bytes (or -errno); short and interrupted reads
+    // are finished with pread()
+    void finishRead(Request& r, qint64 res) const
+    {
+        if (res == -EINTR || res == -EAGAIN) {
+            res = preadFully(m_fd, r.data.data(), r.size, r.offset);
+        } else if (res >= 0 && res < r.size) {
+            const qint64 more = preadFully(m_fd, r.data.data() + res, r.size - res, r.offset + res);
+            res = more < 0 ? -1 : res + more;
+        }
+        r.ok = res >= 0;
+        r.data.resize(r.ok ? res : 0);
+    }
+
+    // Runs the requests through a ring taken for the batch. With visit, they are
+    // visited in order with at most QUEUE_DEPTH read ahead; without, up to
+    // RING_ENTRIES are in flight at once. If the ring fails midway, what is
+    // left is read with pread().
+    int runRing(QVector<Request>& requests, const std::function<bool(int, Request&)>* visit) const
+    {
+        io_uring* ring = takeRing();
+        if (!ring)
+            return RingUnavailable;
+
+        const int n = requests.size();
+        QVector<quint8> state(n, Pending);
+        int prepared = 0;   // requests [0, prepared) have an SQE
+        int submitted = 0;  // of which [0, submitted) reached the kernel
+        int reaped = 0;
+        int next = 0;       // next request to visit
+        bool ringOk = true, stopped = false;
+
+        auto reapOne = [&]() {
+            io_uring_cqe* cqe = nullptr;
+            int rc;
+            do {
+                rc = io_uring_wait_cqe(ring, &cqe);
+            } while (rc == -EINTR);
+            if (rc < 0)
+                return false;
+            const int i = static_cast<int>(reinterpret_cast<quintptr>(io_uring_cqe_get_data(cqe)));
+            const int res = cqe->res;
+            io_uring_cqe_seen(ring, cqe);
+            ++reaped;
+            finishRead(requests[i], res);
+            state[i] = Done;
+            return true;
+        };
+
+        while (!stopped && (visit ? next < n : reaped < n)) {
+            while (prepared < n && (visit ? prepared < next + QUEUE_DEPTH : prepared - reaped < RING_ENTRIES)) {
+                io_uring_sqe* sqe = io_uring_get_sqe(ring);
+                if (!sqe)
+                    break;
+                Request& r = requests[prepared];
+                r.data.resize(r.size);
+                io_uring_prep_read(sqe, m_fd, r.data.data(), static_cast<unsigned>(r.size), r.offset);
+                io_uring_sqe_set_data(sqe, reinterpret_cast<void*>(static_cast<quintptr>(prepared)));
+                ++prepared;
+            }
+            if (prepared > submitted) {
+                const int rc = io_uring_submit(ring);
+                if (rc > 0)
+                    submitted += rc;
+                else if (submitted == reaped) {
+                    ringOk = false;  // nothing in flight to wait for
+                    break;
+                }
+            }
+            if (submitted > reaped && !reapOne()) {
+                ringOk = false;
+                break;
+            }
+            while (visit && next < n && state[next] == Done) {
+                Request& r = requests[next];
+                if (!r.ok || !(*visit)(next, r)) {
+                    stopped = true;
+                    break;
+                }
+                r.data = QByteArray();
+                ++next;
+            }
+        }
+
+        // The kernel may still write into buffers of requests in flight
+        while (submitted > reaped) {
+            if (!reapOne()) {
+                qFatal("IoBackend: lost track of io_uring reads in flight");
+            }
+        }
+        returnRing(ring, ringOk && prepared == submitted);
+        if (stopped)
+            return RingFailed;
+
+        bool ok = true;
+        if (!ringOk)
+            qWarning() << "IoBackend: io_uring failed, finishing with pread()";
+        for (int i = visit ? next : 0; i < n; ++i) {
+            Request& r = requests[i];
+            if (state[i] != Done)
+                readOne(r);
+            if (visit) {
+                if (!r.ok || !(*visit)(i, r))
+                    return RingFailed;
+                r.data = QByteArray();
+            } else {
+                ok = ok && r.ok;
+            }
+        }
+        return ok ? RingDone : RingFailed;
+    }
+#endif
+};
+
+// Adds a fixed delay to every read, as a stand-in for a high-latency share
+// in benchmarks. Reads of the async backend still overlap.
+class ThrottledBackend : public IoBackend {
+public:
+    ThrottledBackend(std::unique_ptr<IoBackend> inner, int latencyUs)
+        : IoBackend(-1), m_inner(std::move(inner)), m_latencyUs(latencyUs)
+    {
+    }
+
+    Kind kind() const override { return m_inner->kind(); }
+    QString name() const override { return QString("%1, +%2 µs per read").arg(m_inner->name()).arg(m_latencyUs); }
+    qint64 size() const override { return m_inner->size(); }
+    void advise(qint64 offset, qint64 length) const override { m_inner->advise(offset, length); }
+
+    qint64 read(qint64 offset, char* data, qint64 size) const override
+    {
+        QThread::usleep(m_latencyUs);
+        return m_inner->read(offset, data, size);
+    }
+
+    bool readBatch(QVector<Request>& requests) const override
+    {
+        return kind() == Async ? readBatchPooled(requests) : IoBackend::readBatch(requests);
+    }
+
+    bool stream(QVector<Request>& requests, const std::function<bool(int, Request&)>& visit) const override
+    {
+        return kind() == Async ? streamPooled(requests, visit) : IoBackend::stream(requests, visit);
+    }
+
+private:
+    std::unique_ptr<IoBackend> m_inner;
+    int m_latencyUs;
+};
+
+} // namespace
+
+std::unique_ptr<IoBackend> IoBackend::open(const QString& filePath, Kind kind)
+{
+    const int fd = ::open(QFile::encodeName(filePath).constData(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        throw std::runtime_error("File is not readable");
+
+    std::unique_ptr<IoBackend> backend;
+    switch (kind) {
+    case Mmap:
+        backend.reset(new MmapBackend(fd));
+        break;
+    case Async:
+        backend.reset(new AsyncBackend(fd));
+        break;
+    case Buffered:
+    default:
+        backend.reset(new BufferedBackend(fd));
+        break;
+    }
+    const int latencyUs = s_latencyUs.load();
+    if (latencyUs > 0)
+        backend.reset(new ThrottledBackend(std::move(backend), latencyUs));
+    return backend;
+}
+
+IoBackend::Kind IoBackend::defaultKind()
+{
+    const int kind = s_defaultKind.load();
+    if (kind >= 0)
+        return static_cast<Kind>(kind);
+    Kind fromEnv = Buffered;
+    const QString name = qEnvironmentVariable("TIMELINE_IO");
+    if (!name.isEmpty() && !parseKind(name, &fromEnv))
+        qWarning() << "Unknown TIMELINE_IO value" << name << "- using buffered reads";
+    return fromEnv;
+}
+
+void IoBackend::setDefaultKind(Kind kind)
+{
+    s_defaultKind = kind;
+}
+
+bool IoBackend::parseKind(const QString& name, Kind* kind)
+{
+    const QString n = name.trimmed().toLower();
+    if (n == "buffered")
+        *kind = Buffered;
+    else if (n == "mmap")
+        *kind = Mmap;
+    else if (n == "async")
+        *kind = Async;
+    else
+        return false;
+    return true;
+}
+
+QString IoBackend::kindName(Kind kind)
+{
+    switch (kind) {
+    case Mmap: return "mmap";
+    case Async: return "async";
+    case Buffered:
+    default: return "buffered";
+    }
+}
+
+void IoBackend::setSimulatedLatencyUs(int us)
+{
+    s_latencyUs = qMax(0, us);
+}
+
+IoBackend::IoBackend(int fd)
+    : m_fd(fd)
+{
+    m_pool.setMaxThreadCount(QUEUE_DEPTH);
+}
+
+IoBackend::~IoBackend()
+{
+    m_pool.waitForDone();
+    if (m_fd >= 0)
+        ::close(m_fd);
+}
+
+QString IoBackend::name() const
+{
+    return kindName(kind());
+}
+
+qint64 IoBackend::size() const
+{
+    struct stat st;
+    if (fstat(m_fd, &st) != 0)
+        return -1;
+    return st.st_size;
+}
+
+void IoBackend::advise(qint64 offset, qint64 length) const
+{
+    // A length of 0 advises up to the end of the file
+    posix_fadvise(m_fd, offset, qMax<qint64>(length, 0), POSIX_FADV_WILLNEED);
+}
+
+void IoBackend::beginStream() const
+{
+    QMutexLocker locker(&m_streamMutex);
+    if (m_streams++ == 0)
+        setSequential(true);
+}
+
+void IoBackend::endStream() const
+{
+    QMutexLocker locker(&m_streamMutex);
+    if (--m_streams == 0)
+        setSequential(false);
+}
+
+void IoBackend::setSequential(bool) const
+{
+}
+
+bool IoBackend::readOne(Request& request) const
+{
+    request.data.resize(request.size);
+    const qint64 n = read(request.offset, request.data.data(), request.size);
+    request.ok = n >= 0;
+    request.data.resize(qMax<qint64>(n, 0));
+    return request.ok;
+}
+
+bool IoBackend::readBatch(QVector<Request>& requests) const
+{
+    bool ok = true;
+    for (Request& request : requests)
+        ok = readOne(request) && ok;
+    return ok;
+}
+
+bool IoBackend::stream(QVector<Request>& requests, const std::function<bool(int, Request&)>& visit) const
+{
+    for (int i = 0; i < requests.size(); ++i) {
+        Request& request = requests[i];
+        if (!readOne(request) || !visit(i, request))
+            return false;
+        request.data = QByteArray();
+    }
+    return true;
+}
+
+bool IoBackend::readBatchPooled(QVector<Request>& requests) const
+{
+    QSemaphore done;
+    std::atomic<bool> ok{true};
+    for (Request& request : requests) {
+        Request* r = &request;
+        m_pool.start([this, r, &done, &ok]() {
+            if (!readOne(*r))
+                ok = false;
+            done.release();
+        });
+    }
+    done.acquire(requests.size());
+    return ok;
+}
+
+bool IoBackend::streamPooled(QVector<Request>& requests, const std::function<bool(int, Request&)>& visit) const
+{
+    const int n = requests.size();
+    std::unique_ptr<QSemaphore[]> ready(new QSemaphore[n]);
+    Request* first = requests.data();
+    int submitted = 0;
+
+    bool ok = true;
+    int i = 0;
+    for (; i < n; ++i) {
+        while (submitted < n && submitted < i + QUEUE_DEPTH) {
+            Request* r = first + submitted;
+            QSemaphore* sem = &ready[submitted];
+            m_pool.start([this, r, sem]() {
+                readOne(*r);
+                sem->release();
+            });
+            ++submitted;
+        }
+        ready[i].acquire();
+        if (!first[i].ok || !visit(i, first[i])) {
+            ok = false;
+            ++i;
+            break;
+        }
+        first[i].data = QByteArray();
+    }
+    // Reads still in flight write into the requests
+    for (; i < submitted; ++i)
+        ready[i].acquire();
+    return ok;
+}
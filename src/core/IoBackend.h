@@ -0,0 +1,92 @@
+#pragma once
+#include <QString>
+#include <QByteArray>
+#include <QVector>
+#include <QMutex>
+#include <QThreadPool>
+#include <functional>
+#include <memory>
+
+/**
+ * @brief IoBackend reads byte ranges of a plain (uncompressed) timeline file.
+ *
+ * RowStore does all reads of plain files through one of these, so the way
+ * the file is read can be chosen per platform and storage:
+ *  - Buffered: synchronous pread() through the page cache (the default)
+ *  - Mmap: copies out of a read-only mapping of the file
+ *  - Async: keeps several reads in flight, with io_uring when the build has
+ *    liburing and the kernel allows it, otherwise with a small pool of
+ *    pread() threads. Worth it where each read waits on the network or a
+ *    slow device (NFS, USB evidence drives) rather than on the CPU.
+ * Every backend is safe to use from several threads at once.
+ */
+class IoBackend {
+public:
+    enum Kind { Buffered, Mmap, Async };
+    static constexpr int QUEUE_DEPTH = 8;  // reads kept in flight by the async backend
+
+    struct Request {
+        qint64 offset = 0;
+        qint64 size = 0;
+        QByteArray data;  // filled in; shorter than size at the end of the file
+        bool ok = false;
+    };
+
+    // Opens the file read-only; throws std::runtime_error
+    static std::unique_ptr<IoBackend> open(const QString& filePath, Kind kind = defaultKind());
+
+    // $TIMELINE_IO (buffered, mmap or async) unless set with setDefaultKind()
+    static Kind defaultKind();
+    static void setDefaultKind(Kind kind);
+    static bool parseKind(const QString& name, Kind* kind);
+    static QString kindName(Kind kind);
+
+    // Benchmarks only: every read request waits this long first, as on a
+    // high-latency network share; requests in flight wait in parallel
+    static void setSimulatedLatencyUs(int us);
+
+    virtual ~IoBackend();
+    virtual Kind kind() const = 0;
+    virtual QString name() const;  // kind name plus the mechanism in use
+    virtual qint64 size() const;   // current file size, -1 on error
+
+    // Reads up to size bytes at offset; returns the bytes read (fewer at the
+    // end of the file), or -1 on error
+    virtual qint64 read(qint64 offset, char* data, qint64 size) const = 0;
+
+    // Reads every request; the async backend has them all in flight at once.
+    // Returns false if any request failed.
+    virtual bool readBatch(QVector<Request>& requests) const;
+
+    // Reads the requests in order and hands each to visit() as soon as it
+    // and all before it are complete; the async backend reads up to
+    // QUEUE_DEPTH requests ahead. A request's data is released after its
+    // visit. Stops and returns false on a read error or when visit() does.
+    virtual bool stream(QVector<Request>& requests,
+                        const std::function<bool(int, Request&)>& visit) const;
+
+    // Hints that [offset, offset + length) will be read soon
+    virtual void advise(qint64 offset, qint64 length) const;
+
+protected:
+    explicit IoBackend(int fd);
+    bool readOne(Request& request) const;
+
+    // Parallel versions of readBatch() and stream() over m_pool
+    bool readBatchPooled(QVector<Request>& requests) const;
+    bool streamPooled(QVector<Request>& requests, const std::function<bool(int, Request&)>& visit) const;
+
+    // Read-ahead advice applies to the whole open file, which the threads
+    // of a parallel scan share; it is switched to sequential when the first
+    // concurrent stream() starts and back when the last one ends
+    void beginStream() const;
+    void endStream() const;
+    virtual void setSequential(bool sequential) const;
+
+    const int m_fd;
+    mutable QThreadPool m_pool;
+
+private:
+    mutable QMutex m_streamMutex;
+    mutable int m_streams = 0;  // stream() calls running
+};
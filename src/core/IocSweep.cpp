@@ -0,0 +1,118 @@
+#include "IocSweep.h"
+#include "RowStore.h"
+#include <QFile>
+#include <QStringList>
+#include <QSet>
+#include <QThread>
+#include <QThreadPool>
+#include <QElapsedTimer>
+#include <atomic>
+#include <stdexcept>
+
+QList<QByteArray> IocSweep::loadPatterns(const QString& path, int* skipped)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        throw std::runtime_error("Cannot open the indicator file");
+
+    QList<QByteArray> patterns;
+    QSet<QByteArray> seen;
+    int dropped = 0;
+    while (!file.atEnd()) {
+        const QByteArray line = file.readLine().trimmed();
+        if (line.isEmpty() || line.startsWith('#'))
+            continue;
+        if (line.size() < MIN_PATTERN_LENGTH || seen.contains(line.toLower())) {
+            ++dropped;
+            continue;
+        }
+        if (patterns.size() >= MAX_PATTERNS)
+            throw std::runtime_error("Too many indicators in one file (limit 200000)");
+        seen.insert(line.toLower());
+        patterns.append(line);
+    }
+    if (patterns.isEmpty())
+        throw std::runtime_error("The indicator file contains no usable indicators");
+    if (skipped)
+        *skipped = dropped;
+    return patterns;
+}
+
+IocSweep::IocSweep(const QList<QByteArray>& patterns)
+    : m_matcher(patterns)
+{
+}
+
+QString IocSweep::describe(const QVector<int>& ids) const
+{
+    QStringList names;
+    for (int id : ids)
+        names << patternText(id);
+    return names.join(", ");
+}
+
+QVector<int> IocSweep::match(const QByteArray& line) const
+{
+    QVector<int> ids;
+    m_matcher.matches(line.constData(), line.size(), ids);
+    return ids;
+}
+
+QVector<IocSweep::Hit> IocSweep::scan(const RowStore& store, int threads,
+                                      const std::function<void(int, int)>& progress) const
+{
+    QElapsedTimer sweepTimer;
+    sweepTimer.start();
+    const int total = store.rowCount();
+    const int chunks = (total + CHUNK_ROWS - 1) / CHUNK_ROWS;
+    if (threads <= 0)
+        threads = QThread::idealThreadCount();
+    if (!store.isPositional())
+        threads = 1;  // compressed reads are serialized anyway
+    threads = qBound(1, threads, qMax(1, chunks));
+
+    // Workers take the next chunk until none are left; each chunk's hits
+    // go to their own slot so the result stays in row order
+    QVector<QVector<Hit>> chunkHits(chunks);
+    std::atomic<int> nextChunk{0};
+    std::atomic<int> rowsDone{0};
+    std::atomic<qint64> matchNs{0};
+    auto work = [&]() {
+        QVector<int> ids;
+        QElapsedTimer timer;
+        for (int c = nextChunk++; c < chunks; c = nextChunk++) {
+            const int first = c * CHUNK_ROWS;
+            const int last = qMin(total, first + CHUNK_ROWS);
+            qint64 ns = 0;
+            store.scan(first, last, [&](int row, const QByteArray& raw) {
+                timer.start();
+                m_matcher.matches(raw.constData(), raw.size(), ids);
+                if (!ids.isEmpty())
+                    chunkHits[c].append({row, ids});
+                ns += timer.nsecsElapsed();
+            });
+            matchNs += ns;
+            rowsDone += last - first;
+        }
+    };
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(threads);
+    for (int t = 0; t < threads; ++t)
+        pool.start(work);
+    while (!pool.waitForDone(PROGRESS_MS)) {
+        if (progress)
+            progress(rowsDone.load(), total);
+    }
+
+    QVector<Hit> hits;
+    for (const QVector<Hit>& part : chunkHits)
+        hits += part;
+
+    // Matching time is summed over the workers; spread it over them to
+    // split the wall time into read and match time like FilterEngine does
+    const qint64 sweepMs = sweepTimer.elapsed();
+    const qint64 matchMs = matchNs / threads / 1000000;
+    store.metrics().recordSearch(sweepMs, qMax<qint64>(0, sweepMs - matchMs), matchMs, total, hits.size());
+    return hits;
+}
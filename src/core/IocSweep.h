@@ -0,0 +1,53 @@
+#pragma once
+#include <QString>
+#include <QList>
+#include <QVector>
+#include <QByteArray>
+#include <functional>
+#include "AhoCorasick.h"
+
+class RowStore;
+
+/**
+ * @brief IocSweep checks every row of a timeline against a list of indicators in one pass.
+ *
+ * The indicators (hashes, IPs, paths, user names...) are compiled into one
+ * AhoCorasick automaton, so the cost of a sweep does not grow with the
+ * number of patterns. Rows are scanned in chunks by a pool of threads.
+ */
+class IocSweep {
+public:
+    static constexpr int MIN_PATTERN_LENGTH = 3;  // shorter indicators would hit most rows
+    static constexpr int MAX_PATTERNS = 200000;
+    static constexpr int CHUNK_ROWS = 65536;      // rows per work item
+    static constexpr int PROGRESS_MS = 50;        // progress() interval while the workers run
+
+    struct Hit {
+        int row = 0;
+        QVector<int> patterns;  // ids, ascending
+    };
+
+    // One indicator per line; blank lines and lines starting with '#' are
+    // skipped, as are duplicates and indicators shorter than
+    // MIN_PATTERN_LENGTH (counted in 'skipped'). Throws std::runtime_error.
+    static QList<QByteArray> loadPatterns(const QString& path, int* skipped = nullptr);
+
+    explicit IocSweep(const QList<QByteArray>& patterns);
+
+    int patternCount() const { return m_matcher.patternCount(); }
+    QString patternText(int id) const { return QString::fromUtf8(m_matcher.pattern(id)); }
+    QString describe(const QVector<int>& ids) const;  // "pattern, pattern"
+    const AhoCorasick& matcher() const { return m_matcher; }
+
+    QVector<int> match(const QByteArray& line) const;
+
+    // Scans every row with up to 'threads' workers (0 = all cores; compressed
+    // files use one). progress(rowsDone, total) is called on the calling
+    // thread every PROGRESS_MS. Hits are in row order. Records the sweep as a
+    // search in the store's metrics.
+    QVector<Hit> scan(const RowStore& store, int threads = 0,
+                      const std::function<void(int, int)>& progress = {}) const;
+
+private:
+    AhoCorasick m_matcher;
+};
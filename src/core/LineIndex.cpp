@@ -0,0 +1,180 @@
+#include "LineIndex.h"
+#include "IoBackend.h"
+#include "utils/CompressedFile.h"
+#include <QDataStream>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QFile>
+#include <QSaveFile>
+#include <QDebug>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+
+void LineIndex::build(QIODevice& device, const std::function<void(int)>& progress)
+{
+    m_offsets.clear();
+    device.seek(0);
+
+    // As in the IoBackend overload, but the size of a compressed stream is
+    // only known at its end: a newline ending a block is held back until
+    // more data shows it was not the last one
+    QByteArray block(static_cast<int>(BUILD_BLOCK_BYTES), Qt::Uninitialized);
+    qint64 offset = 0;        // of the block in the device
+    qint64 lineStart = -1;    // held back from the previous block
+    for (;;) {
+        const qint64 n = device.read(block.data(), block.size());
+        if (n < 0)
+            throw std::runtime_error("Failed to read file");
+        if (n == 0)
+            break;
+        const int reported = m_offsets.size() / PROGRESS_INTERVAL;
+        if (lineStart >= 0)
+            addLine(lineStart, progress);
+        lineStart = -1;
+
+        const char* data = block.constData();
+        const char* end = data + n;
+        for (const char* p = data; (p = static_cast<const char*>(memchr(p, '\n', end - p))); ++p) {
+            if (p + 1 == end) {
+                lineStart = offset + n;
+                break;
+            }
+            addLine(offset + (p - data) + 1, progress);
+        }
+        offset += n;
+        // The callback may have let other readers move the device
+        if (progress && m_offsets.size() / PROGRESS_INTERVAL != reported)
+            device.seek(offset);
+    }
+    if (offset == 0)
+        throw std::runtime_error("File appears to be empty or corrupted");
+    device.seek(0);
+}
+
+void LineIndex::build(const IoBackend& io, const std::function<void(int)>& progress)
+{
+    m_offsets.clear();
+    const qint64 size = io.size();
+    if (size <= 0)
+        throw std::runtime_error("File appears to be empty or corrupted");
+
+    QVector<IoBackend::Request> requests;
+    requests.reserve(static_cast<int>((size + BUILD_BLOCK_BYTES - 1) / BUILD_BLOCK_BYTES));
+    for (qint64 offset = 0; offset < size; offset += BUILD_BLOCK_BYTES) {
+        IoBackend::Request request;
+        request.offset = offset;
+        request.size = qMin(BUILD_BLOCK_BYTES, size - offset);
+        requests.append(request);
+    }
+
+    // Every newline but the last ends a line, so the byte after it starts a
+    // data line; the first one ends the header. Errors are carried out of
+    // stream() rather than thrown through it.
+    std::exception_ptr error;
+    const bool ok = io.stream(requests, [&](int, IoBackend::Request& request) {
+        try {
+            const char* data = request.data.constData();
+            const char* end = data + request.data.size();
+            for (const char* p = data; (p = static_cast<const char*>(memchr(p, '\n', end - p))); ++p) {
+                const qint64 next = request.offset + (p - data) + 1;
+                if (next >= size)
+                    break;
+                addLine(next, progress);
+            }
+        } catch (...) {
+            error = std::current_exception();
+            return false;
+        }
+        return true;
+    });
+    if (error)
+        std::rethrow_exception(error);
+    if (!ok)
+        throw std::runtime_error("Failed to read file");
+}
+
+void LineIndex::addLine(qint64 offset, const std::function<void(int)>& progress)
+{
+    if (m_offsets.size() >= MAX_LINE_COUNT)
+        throw std::runtime_error("File exceeds maximum line count limit (10 million lines)");
+    if (m_offsets.size() * static_cast<qint64>(sizeof(qint64)) > MAX_INDEX_MEMORY)
+        throw std::runtime_error("File index exceeds memory limit (500MB)");
+    m_offsets.append(offset);
+    if (progress && m_offsets.size() % PROGRESS_INTERVAL == 0)
+        progress(m_offsets.size());
+}
+
+bool LineIndex::loadCache(const QString& cachePath, const QString& sourcePath, QIODevice& device)
+{
+    if (cachePath.isEmpty())
+        return false;
+    QFile cacheFile(cachePath);
+    if (!cacheFile.open(QIODevice::ReadOnly))
+        return false;
+
+    QFileInfo fileInfo(sourcePath);
+    QDataStream in(&cacheFile);
+    quint32 magic = 0, version = 0;
+    qint64 sourceSize = -1, sourceModified = -1;
+    in >> magic >> version >> sourceSize >> sourceModified;
+    if (in.status() != QDataStream::Ok || magic != CACHE_MAGIC || version != CACHE_VERSION
+        || sourceSize != fileInfo.size() || sourceModified != fileInfo.lastModified().toMSecsSinceEpoch())
+        return false;
+
+    QVector<qint64> offsets;
+    QByteArray checkpoints;
+    in >> offsets >> checkpoints;
+    if (in.status() != QDataStream::Ok || offsets.size() > MAX_LINE_COUNT)
+        return false;
+    for (int i = 1; i < offsets.size(); ++i) {
+        if (offsets[i] <= offsets[i - 1])
+            return false;
+    }
+
+    if (auto* compressed = qobject_cast<CompressedFile*>(&device)) {
+        if (!compressed->loadIndex(checkpoints))
+            return false;
+    }
+    m_offsets = offsets;
+    return true;
+}
+
+void LineIndex::saveCache(const QString& cachePath, const QString& sourcePath, const QIODevice& device) const
+{
+    if (cachePath.isEmpty())
+        return;
+
+    QByteArray checkpoints;
+    if (auto* compressed = qobject_cast<const CompressedFile*>(&device)) {
+        checkpoints = compressed->saveIndex();
+        if (checkpoints.isEmpty())
+            return; // decoder did not reach the end; index would be partial
+    }
+
+    // Written to a temporary file and renamed into place, so a tab opening
+    // the file meanwhile never reads a half-written cache
+    QFileInfo fileInfo(sourcePath);
+    QSaveFile cacheFile(cachePath);
+    if (!cacheFile.open(QIODevice::WriteOnly)) {
+        qWarning() << "Failed to write line index cache (check permissions)";
+        return;
+    }
+    QDataStream out(&cacheFile);
+    out << CACHE_MAGIC << CACHE_VERSION << fileInfo.size()
+        << fileInfo.lastModified().toMSecsSinceEpoch() << m_offsets << checkpoints;
+    if (out.status() != QDataStream::Ok || !cacheFile.commit()) {
+        qWarning() << "Error occurred while writing line index cache";
+        cacheFile.cancelWriting();
+    }
+}
+
+void LineIndex::append(const QVector<qint64>& offsets)
+{
+    m_offsets += offsets;
+}
+
+qint64 LineIndex::memoryBytes() const
+{
+    return m_offsets.capacity() * static_cast<qint64>(sizeof(qint64));
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <QIODevice>
+#include <QString>
+#include <QVector>
+#include <functional>
+
+class IoBackend;
+
+/**
+ * @brief LineIndex holds the byte offset of every data line of a timeline.
+ *
+ * Offsets are positions in the device the index was built from, i.e.
+ * uncompressed offsets for .gz/.zst input. The header line is not indexed.
+ */
+class LineIndex {
+public:
+    // Security limits
+    static constexpr int MAX_LINE_COUNT = 10000000;  // 10 million lines
+    static constexpr qint64 MAX_INDEX_MEMORY = 500LL * 1024 * 1024;  // 500MB for index
+
+    // Reads the whole device from the start in BUILD_BLOCK_BYTES blocks and
+    // splits them on '\n', with no text decoding; throws std::runtime_error
+    // on an empty file or when a limit is exceeded. The callback, if any, is
+    // called every PROGRESS_INTERVAL lines with the number indexed so far.
+    static constexpr int PROGRESS_INTERVAL = 50000;
+    static constexpr qint64 BUILD_BLOCK_BYTES = 1024 * 1024;
+    void build(QIODevice& device, const std::function<void(int)>& progress = {});
+    // Same for plain files, streaming the raw bytes through the backend
+    void build(const IoBackend& io, const std::function<void(int)>& progress = {});
+
+    // On-disk cache of the offsets (plus compressed checkpoints), valid while
+    // the source file's size and modification time are unchanged
+    bool loadCache(const QString& cachePath, const QString& sourcePath, QIODevice& device);
+    void saveCache(const QString& cachePath, const QString& sourcePath, const QIODevice& device) const;
+
+    int size() const { return m_offsets.size(); }
+    bool isEmpty() const { return m_offsets.isEmpty(); }
+    qint64 offset(int row) const { return m_offsets[row]; }
+    const QVector<qint64>& offsets() const { return m_offsets; }
+    void append(const QVector<qint64>& offsets);
+    qint64 memoryBytes() const;
+
+private:
+    static constexpr quint32 CACHE_MAGIC = 0x544C5649;  // "TLVI"
+    static constexpr quint32 CACHE_VERSION = 2;  // 2: offsets counted in file bytes
+    QVector<qint64> m_offsets;
+
+    // Appends the start of a data line, enforcing the limits
+    void addLine(qint64 offset, const std::function<void(int)>& progress);
+};
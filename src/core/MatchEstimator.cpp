@@ -0,0 +1,107 @@
+#include "MatchEstimator.h"
+#include "RowStore.h"
+#include "FilterEngine.h"
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QSet>
+#include <QVector>
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+MatchEstimator::Estimate MatchEstimator::fromSample(int sampled, int hits, int totalRows)
+{
+    Estimate e;
+    e.sampled = sampled;
+    e.hits = hits;
+    e.totalRows = totalRows;
+    if (sampled <= 0 || totalRows <= 0) {
+        e.high = totalRows;
+        return e;
+    }
+    if (e.exact()) {
+        e.matches = e.low = e.high = hits;
+        return e;
+    }
+
+    // Wilson score interval for the match rate; the finite population
+    // correction narrows it as the sample approaches the whole file
+    const double n = sampled;
+    const double p = hits / n;
+    const double fpc = (totalRows - n) / (totalRows - 1.0);
+    const double z2 = Z_95 * Z_95 * fpc;
+    const double denom = 1.0 + z2 / n;
+    const double center = (p + z2 / (2 * n)) / denom;
+    const double half = std::sqrt(z2 * (p * (1 - p) / n + z2 / (4 * n * n))) / denom;
+
+    // The sampled rows themselves are known to match or not
+    e.matches = p * totalRows;
+    e.low = qMax<double>(hits, (center - half) * totalRows);
+    e.high = qMin<double>(totalRows - (sampled - hits), (center + half) * totalRows);
+    return e;
+}
+
+MatchEstimator::Estimate MatchEstimator::run(const RowStore& store, const FilterEngine& filter,
+                                             const std::atomic<bool>& cancel,
+                                             const std::function<void(const Estimate&)>& update)
+{
+    const int total = store.rowCount();
+    if (!store.isPositional())
+        return fromSample(0, 0, total);
+    const int target = qMin(total, MAX_SAMPLES);
+    QRandomGenerator rng(QRandomGenerator::global()->generate());
+
+    // Small files are shuffled outright; large ones are sampled by rejecting
+    // rows already drawn, which stays cheap while the sample is a small
+    // fraction of the file
+    QVector<int> order;
+    if (target == total) {
+        order.resize(total);
+        std::iota(order.begin(), order.end(), 0);
+        std::shuffle(order.begin(), order.end(), rng);
+    }
+    QSet<int> drawn;
+
+    int sampled = 0, hits = 0;
+    QVector<int> batch;
+    QByteArray raw;
+    QElapsedTimer sinceUpdate;
+    sinceUpdate.start();
+    while (sampled < target) {
+        if (cancel.load(std::memory_order_relaxed))
+            return fromSample(sampled, hits, total);
+
+        // Reading a batch in file order keeps the seeks short
+        const int batchSize = qMin(BATCH_ROWS, target - sampled);
+        batch.clear();
+        if (!order.isEmpty()) {
+            batch = order.mid(sampled, batchSize);
+        } else {
+            while (batch.size() < batchSize) {
+                const int row = static_cast<int>(rng.bounded(total));
+                if (!drawn.contains(row)) {
+                    drawn.insert(row);
+                    batch.append(row);
+                }
+            }
+        }
+        std::sort(batch.begin(), batch.end());
+
+        for (int row : batch) {
+            if (store.readRaw(row, raw) && filter.matchesLine(raw))
+                ++hits;
+        }
+        const bool firstBatch = (sampled == 0);
+        sampled += batch.size();
+
+        if (update && (firstBatch || sinceUpdate.elapsed() >= UPDATE_MS)) {
+            update(fromSample(sampled, hits, total));
+            sinceUpdate.restart();
+        }
+    }
+
+    const Estimate result = fromSample(sampled, hits, total);
+    if (update)
+        update(result);
+    return result;
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <atomic>
+#include <functional>
+
+class RowStore;
+class FilterEngine;
+
+/**
+ * @brief MatchEstimator predicts how many rows a search will match from a random sample.
+ *
+ * Rows are drawn uniformly without replacement and tested with the same
+ * FilterEngine a full scan would use. The estimate comes with a 95% Wilson
+ * score interval (with a finite population correction) and tightens as the
+ * sample grows; a file no larger than the sample is counted exactly.
+ */
+class MatchEstimator {
+public:
+    static constexpr int BATCH_ROWS = 256;      // rows drawn, sorted and read per batch
+    static constexpr int MAX_SAMPLES = 50000;   // sample size at which the estimate stops
+    static constexpr int UPDATE_MS = 100;       // interval between update() calls
+    static constexpr double Z_95 = 1.959964;
+
+    struct Estimate {
+        int sampled = 0;       // rows tested
+        int hits = 0;          // rows of the sample that matched
+        int totalRows = 0;
+        double matches = 0;    // expected matches in the whole file
+        double low = 0;        // 95% interval
+        double high = 0;
+        bool exact() const { return sampled >= totalRows; }
+    };
+
+    // Scales a sample result to the whole file
+    static Estimate fromSample(int sampled, int hits, int totalRows);
+
+    // Samples the store on the calling thread, calling update() after the
+    // first batch, then every UPDATE_MS and once more with the final
+    // estimate. Returns early, without the final update, when cancel is set.
+    // Compressed input (!store.isPositional()) is not sampled: each random
+    // row would be decoded from a checkpoint, under the decoder lock a
+    // running scan needs. An empty estimate is returned without update().
+    static Estimate run(const RowStore& store, const FilterEngine& filter,
+                        const std::atomic<bool>& cancel,
+                        const std::function<void(const Estimate&)>& update = {});
+};
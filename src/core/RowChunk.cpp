@@ -0,0 +1,113 @@
+#include "RowChunk.h"
+#include "utils/FileUtils.h"
+
+namespace {
+
+// Whitespace as QByteArray::trimmed() sees it
+inline bool isSpace(char c)
+{
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+// parseCsvLine() limits count UTF-16 code units, which never exceed the
+// UTF-8 byte count, so the exact count is only needed for long input
+bool exceeds(const char* data, qint64 size, int limit)
+{
+    return size > limit && QString::fromUtf8(data, size).size() > limit;
+}
+
+} // namespace
+
+void RowChunk::reset(int firstRow, int maxRows, int columns)
+{
+    m_firstRow = firstRow;
+    m_rows = 0;
+    m_stride = maxRows;
+    m_columns = columns;
+    m_bytes.resize(0);
+    m_begins.resize(static_cast<qsizetype>(columns) * maxRows);
+    m_ends.resize(m_begins.size());
+    m_rowBegins.resize(maxRows);
+    m_rowEnds.resize(maxRows);
+    m_valid.resize(maxRows);
+}
+
+void RowChunk::appendLine(const char* data, qint64 size)
+{
+    const int r = m_rows++;
+    while (size > 0 && isSpace(data[0])) {
+        ++data;
+        --size;
+    }
+    while (size > 0 && isSpace(data[size - 1]))
+        --size;
+
+    // Unescaped fields are never longer than the line, and there are at
+    // most size + 1 of them, so this is room for the worst case
+    const qint64 start = m_bytes.size();
+    const qint64 needed = start + 2 * size + 1;
+    if (m_bytes.capacity() < needed)
+        m_bytes.reserve(qMax(needed, 2 * m_bytes.capacity()));
+    m_bytes.resize(needed);
+    char* const base = m_bytes.data();
+    char* out = base + start;
+
+    bool valid = !exceeds(data, size, FileUtils::MAX_LINE_LENGTH);
+    int fields = 0;
+    char* fieldStart = out;
+    auto endField = [&]() {
+        if (exceeds(fieldStart, out - fieldStart, FileUtils::MAX_FIELD_LENGTH))
+            valid = false;
+        if (fields < m_columns) {
+            const int i = fields * m_stride + r;
+            m_begins[i] = static_cast<quint32>(fieldStart - base);
+            m_ends[i] = static_cast<quint32>(out - base);
+        }
+        *out++ = '\0';
+        fieldStart = out;
+        ++fields;
+    };
+
+    bool inQuotes = false;
+    bool escapeNext = false;
+    for (qint64 i = 0; i < size && valid; ++i) {
+        const char c = data[i];
+        if (escapeNext) {
+            *out++ = c;
+            escapeNext = false;
+        } else if (c == '\\') {
+            escapeNext = true;
+        } else if (c == '"') {
+            inQuotes = !inQuotes;
+        } else if (c == ',' && !inQuotes) {
+            endField();
+            if (fields >= FileUtils::MAX_FIELDS_PER_LINE)
+                valid = false;
+        } else {
+            *out++ = c;
+        }
+    }
+    if (valid)
+        endField();
+
+    if (!valid) {
+        out = base + start;
+        fields = 0;
+    }
+    for (int c = fields; c < m_columns; ++c) {
+        const int i = c * m_stride + r;
+        m_begins[i] = m_ends[i] = static_cast<quint32>(out - base);
+    }
+    m_rowBegins[r] = static_cast<quint32>(start);
+    m_rowEnds[r] = static_cast<quint32>(out - base);
+    m_valid[r] = valid;
+    m_bytes.resize(out - base);
+}
+
+qint64 RowChunk::memoryBytes() const
+{
+    return m_bytes.capacity()
+         + (m_begins.capacity() + m_ends.capacity() + m_rowBegins.capacity() + m_rowEnds.capacity())
+               * static_cast<qint64>(sizeof(quint32))
+         + m_valid.capacity();
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief RowChunk holds a block of rows tokenized into columns.
+ *
+ * The field bytes of all rows (UTF-8, with CSV quotes and escapes removed,
+ * each field followed by a '\0') go into one shared buffer; per column,
+ * the chunk keeps where each row's field starts and ends in it. A chunk is
+ * meant to be reused: reset() keeps every buffer, so once the first chunk
+ * has sized them, bulk passes decode rows without allocating.
+ */
+class RowChunk {
+public:
+    // Starts an empty chunk for up to maxRows rows from firstRow on
+    void reset(int firstRow, int maxRows, int columns);
+
+    // Tokenizes one raw line into the next row, as FileUtils::parseCsvLine()
+    // would after trimming it. A line parseCsvLine() rejects gives an invalid
+    // row with empty fields.
+    void appendLine(const char* data, qint64 size);
+    bool isFull() const { return m_rows >= m_stride; }
+
+    int firstRow() const { return m_firstRow; }
+    int rowCount() const { return m_rows; }
+    int columnCount() const { return m_columns; }
+    qint64 byteSize() const { return m_bytes.size(); }
+
+    // r counts from firstRow(). Columns a row lacks are empty.
+    bool isValid(int r) const { return m_valid[r]; }
+    QByteArrayView field(int r, int column) const
+    {
+        const int i = column * m_stride + r;
+        return QByteArrayView(m_bytes.constData() + m_begins[i], m_ends[i] - m_begins[i]);
+    }
+    QString text(int r, int column) const { return QString::fromUtf8(field(r, column)); }
+    // Every field of the row, each followed by '\0', including fields past
+    // columnCount() in malformed rows
+    QByteArrayView row(int r) const
+    {
+        return QByteArrayView(m_bytes.constData() + m_rowBegins[r], m_rowEnds[r] - m_rowBegins[r]);
+    }
+
+    qint64 memoryBytes() const;
+
+private:
+    int m_firstRow = 0;
+    int m_rows = 0;
+    int m_stride = 0;  // rows the offset arrays have room for
+    int m_columns = 0;
+    QByteArray m_bytes;
+    QVector<quint32> m_begins, m_ends;        // column-major: [column * m_stride + r]
+    QVector<quint32> m_rowBegins, m_rowEnds;
+    QVector<quint8> m_valid;
+};
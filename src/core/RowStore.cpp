@@ -0,0 +1,784 @@
+#include "RowStore.h"
+#include "RowChunk.h"
+#include "AnalysisCache.h"
+#include "AppDataPaths.h"
+#include "utils/CompressedFile.h"
+#include "utils/FileUtils.h"
+#include <QFileInfo>
+#include <QTextStream>
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <QReadLocker>
+#include <QWriteLocker>
+#include <QDebug>
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+
+static QIODevice* createTimelineDevice(const QString& filePath)
+{
+    if (CompressedFile::isCompressedPath(filePath))
+        return new CompressedFile(filePath);
+    return new QFile(filePath);
+}
+
+static bool deviceSeeksFromStart(const QIODevice& device)
+{
+    auto* compressed = qobject_cast<const CompressedFile*>(&device);
+    return compressed && compressed->seeksFromStart();
+}
+
+RowStore::RowStore(const QString& filePath, IoBackend::Kind io)
+    : m_filePath(filePath), m_file(createTimelineDevice(filePath))
+{
+    // Validate file size before processing
+    QFileInfo fileInfo(filePath);
+    if (fileInfo.size() > MAX_FILE_SIZE) {
+        throw std::runtime_error("File size exceeds maximum limit (2GB)");
+    }
+
+    if (!fileInfo.exists()) {
+        throw std::runtime_error("File does not exist");
+    }
+
+    if (!fileInfo.isReadable()) {
+        throw std::runtime_error("File is not readable");
+    }
+
+    if (AnalysisCache::isCacheFile(filePath)) {
+        m_cache = std::make_unique<AnalysisCache>(filePath);
+    } else if (auto* compressed = qobject_cast<CompressedFile*>(m_file.get())) {
+        if (!CompressedFile::isSupported(compressed->codec()))
+            throw std::runtime_error("This build was compiled without zstd support");
+    } else {
+        m_io = IoBackend::open(filePath, io);
+    }
+    m_metrics.ioBackend = ioBackendName();
+}
+
+RowStore::~RowStore()
+{
+    m_file->close();
+}
+
+QString RowStore::ioBackendName() const
+{
+    if (m_cache)
+        return QString("analysis cache (mmap)");
+    return m_io ? m_io->name() : QString("compressed");
+}
+
+bool RowStore::ensureOpen() const
+{
+    if (m_file->isOpen())
+        return true;
+    if (!m_file->open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qWarning() << "Failed to open file for reading";
+        return false;
+    }
+    return true;
+}
+
+void RowStore::readHeader()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QTextStream in(m_file.get());
+    const QString headerLine = in.readLine();
+    try {
+        m_headers = FileUtils::parseCsvLine(headerLine);
+        m_type = TimelineParser::detectFormat(m_headers);
+    } catch (const std::exception& e) {
+        qWarning() << "Error parsing CSV header:" << e.what();
+        m_type = TimelineParser::Unknown;
+    }
+    m_file->seek(0);
+    qDebug() << "RowStore: format detection took" << timer.elapsed() << "ms, type:"
+             << (m_type == TimelineParser::Filesystem ? "Filesystem" :
+                 m_type == TimelineParser::Super      ? "Super"      : "Unknown");
+}
+
+void RowStore::open(const std::function<void(int)>& indexProgress)
+{
+    if (m_cache) {
+        // Headers and rows come from the cache; there is no line index
+        m_headers = m_cache->headers();
+        m_type = m_cache->type();
+        m_metrics.indexBuildMs = 0;
+        m_metrics.indexFromCache = true;
+        m_rowCount.store(m_cache->rowCount(), std::memory_order_release);
+        return;
+    }
+
+    QMutexLocker locker(&m_deviceMutex);
+    if (!ensureOpen())
+        throw std::runtime_error("Failed to open file for reading");
+    readHeader();
+
+    // The index is built aside and swapped in, so readers never see it
+    // half-built
+    LineIndex index;
+    QElapsedTimer timer;
+    timer.start();
+    const QString cachePath = AppDataPaths::indexCachePath(m_filePath);
+    if (index.loadCache(cachePath, m_filePath, *m_file)) {
+        m_metrics.indexBuildMs = timer.elapsed();
+        m_metrics.indexFromCache = true;
+        qDebug() << "RowStore: loaded cached line index for" << m_filePath << "("
+                 << index.size() << "lines) in" << timer.elapsed() << "ms";
+        m_seeksFromStart.store(deviceSeeksFromStart(*m_file), std::memory_order_release);
+        QWriteLocker indexLocker(&m_indexLock);
+        m_index = index;
+        m_rowCount.store(m_index.size(), std::memory_order_release);
+        return;
+    }
+    qDebug() << "RowStore: building line index for" << m_filePath;
+
+    const auto progress = [&](int lines) {
+        qDebug() << "RowStore: indexed" << lines << "lines so far...";
+        if (!indexProgress)
+            return;
+        locker.unlock();
+        indexProgress(lines);
+        locker.relock();
+    };
+    if (m_io)
+        index.build(*m_io, progress);
+    else
+        index.build(*m_file, progress);
+
+    m_metrics.indexBuildMs = timer.elapsed();
+    m_metrics.indexFromCache = false;
+    qDebug() << "RowStore: indexed" << index.size() << "lines in" << timer.elapsed()
+             << "ms, index memory:" << index.memoryBytes() << "bytes";
+    index.saveCache(cachePath, m_filePath, *m_file);
+    m_seeksFromStart.store(deviceSeeksFromStart(*m_file), std::memory_order_release);
+    QWriteLocker indexLocker(&m_indexLock);
+    m_index = index;
+    m_rowCount.store(m_index.size(), std::memory_order_release);
+}
+
+int RowStore::rowCount() const
+{
+    return m_rowCount.load(std::memory_order_acquire);
+}
+
+qint64 RowStore::memoryBytes() const
+{
+    if (m_cache)
+        return m_cache->memoryBytes();
+    QReadLocker locker(&m_indexLock);
+    return m_index.memoryBytes();
+}
+
+qint64 RowStore::rowEnd(int row) const
+{
+    // The last indexed row runs to the tail found by follow mode, if any
+    return row + 1 < m_index.size() ? m_index.offset(row + 1) : m_tailOffset.load();
+}
+
+bool RowStore::readRawAt(qint64 begin, qint64 end, QByteArray& line) const
+{
+    if (!m_io) {
+        QMutexLocker locker(&m_deviceMutex);
+        if (!ensureOpen())
+            return false;
+        if (!m_file->seek(begin)) {
+            qWarning() << "Failed to seek to file position";
+            return false;
+        }
+        line = m_file->readLine();
+        return true;
+    }
+
+    if (end >= begin) {
+        line.resize(end - begin);
+        const qint64 n = m_io->read(begin, line.data(), line.size());
+        if (n < 0)
+            return false;
+        line.resize(n);
+        return true;
+    }
+
+    // End not known yet (last row before follow mode found the tail): read
+    // until the newline or the end of the file
+    constexpr qint64 CHUNK = 4096;
+    line.clear();
+    for (qint64 pos = begin;;) {
+        const qint64 old = line.size();
+        line.resize(old + CHUNK);
+        const qint64 n = m_io->read(pos, line.data() + old, CHUNK);
+        if (n < 0)
+            return false;
+        line.resize(old + n);
+        const qint64 newline = line.indexOf('\n', old);
+        if (newline >= 0) {
+            line.truncate(newline + 1);
+            return true;
+        }
+        if (n < CHUNK)
+            return true;
+        pos += n;
+    }
+}
+
+bool RowStore::readRaw(int row, QByteArray& line) const
+{
+    if (m_cache) {
+        if (row < 0 || row >= rowCount() || !m_cache->lines(row, row + 1, [&](int, const QByteArray& raw) { line = raw; }))
+            return false;
+        m_metrics.linesRead.fetch_add(1, std::memory_order_relaxed);
+        m_metrics.bytesRead.fetch_add(line.size(), std::memory_order_relaxed);
+        return true;
+    }
+
+    qint64 begin = 0, end = -1;
+    {
+        QReadLocker locker(&m_indexLock);
+        if (row < 0 || row >= m_index.size())
+            return false;
+        begin = m_index.offset(row);
+        end = rowEnd(row);
+    }
+
+    if (!readRawAt(begin, end, line))
+        return false;
+    m_metrics.linesRead.fetch_add(1, std::memory_order_relaxed);
+    m_metrics.bytesRead.fetch_add(line.size(), std::memory_order_relaxed);
+    return true;
+}
+
+bool RowStore::readFields(int row, QStringList& fields) const
+{
+    QByteArray raw;
+    if (!readRaw(row, raw))
+        return false;
+
+    try {
+        fields = FileUtils::parseCsvLine(QString::fromUtf8(raw.trimmed()));
+    } catch (const std::exception& e) {
+        qWarning() << "Error parsing CSV line:" << e.what();
+        return false;
+    }
+    return true;
+}
+
+RowStore::BlockPlan RowStore::planBlock(int first, int last, bool withStarts) const
+{
+    // Row starts are copied out, since the index may grow (follow mode)
+    // once the lock is released
+    BlockPlan plan;
+    plan.first = first;
+    plan.last = last;
+    QReadLocker locker(&m_indexLock);
+    plan.begin = m_index.offset(first);
+    if (withStarts)
+        plan.starts = m_index.offsets().mid(first, last - first);
+    plan.end = rowEnd(last - 1);
+    plan.endKnown = plan.end >= 0;
+    return plan;
+}
+
+bool RowStore::planIoRequest(BlockPlan& plan, IoBackend::Request& request) const
+{
+    if (!plan.endKnown)
+        plan.end = m_io->size();
+    if (plan.end < plan.begin || plan.end - plan.begin > MAX_BATCH_BYTES)
+        return false;
+    request.offset = plan.begin;
+    request.size = plan.end - plan.begin;
+    return true;
+}
+
+bool RowStore::rowInBlock(const BlockPlan& plan, const QByteArray& block, int k, qint64& from, qint64& to)
+{
+    const int count = plan.last - plan.first;
+    from = plan.starts[k] - plan.begin;
+    if (from >= block.size())
+        return false;
+    to = k + 1 < count ? qMin<qint64>(plan.starts[k + 1] - plan.begin, block.size()) : block.size();
+    if (k + 1 == count && !plan.endKnown) {
+        // The tail is not known yet; the last row ends at its newline
+        const qint64 newline = block.indexOf('\n', from);
+        if (newline >= 0)
+            to = newline + 1;
+    }
+    return true;
+}
+
+void RowStore::recordBatch(int rows, qint64 bytes) const
+{
+    m_metrics.linesRead.fetch_add(rows, std::memory_order_relaxed);
+    m_metrics.bytesRead.fetch_add(bytes, std::memory_order_relaxed);
+    m_metrics.batchReads.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool RowStore::splitBlock(const BlockPlan& plan, const QByteArray& block, QVector<QByteArray>& lines) const
+{
+    const int count = plan.last - plan.first;
+    lines.reserve(lines.size() + count);
+    int split = 0;
+    for (qint64 from = 0, to = 0; split < count && rowInBlock(plan, block, split, from, to); ++split)
+        lines.append(block.mid(from, to - from));
+    recordBatch(split, block.size());
+    return split == count;
+}
+
+bool RowStore::readBlock(int first, int last, QVector<QByteArray>& lines) const
+{
+    if (m_cache) {
+        qint64 bytes = 0;
+        lines.reserve(lines.size() + last - first);
+        const bool ok = m_cache->lines(first, last, [&](int, const QByteArray& raw) {
+            lines.append(raw);
+            bytes += raw.size();
+        });
+        recordBatch(last - first, bytes);
+        return ok;
+    }
+
+    BlockPlan plan = planBlock(first, last, true);
+    QByteArray block;
+    if (m_io) {
+        IoBackend::Request request;
+        if (!planIoRequest(plan, request))
+            return false;
+        block.resize(request.size);
+        const qint64 n = m_io->read(request.offset, block.data(), block.size());
+        if (n < 0)
+            return false;
+        block.resize(n);
+    } else {
+        QMutexLocker locker(&m_deviceMutex);
+        if (!ensureOpen())
+            return false;
+        if (!plan.endKnown)
+            plan.end = m_file->size();
+        if (plan.end < plan.begin || plan.end - plan.begin > MAX_BATCH_BYTES)
+            return false;
+        if (!m_file->seek(plan.begin)) {
+            qWarning() << "Failed to seek to file position";
+            return false;
+        }
+        block = m_file->read(plan.end - plan.begin);
+    }
+    return splitBlock(plan, block, lines);
+}
+
+bool RowStore::readRange(int first, int last, QVector<QByteArray>& lines) const
+{
+    lines.clear();
+    first = qMax(first, 0);
+    last = qMin(last, rowCount());
+    if (first >= last)
+        return true;
+    return readBlock(first, last, lines);
+}
+
+bool RowStore::readRanges(const QVector<QPair<int, int>>& ranges, QVector<QVector<QByteArray>>& lines) const
+{
+    lines.clear();
+    lines.resize(ranges.size());
+    bool ok = true;
+    if (!m_io) {
+        for (int i = 0; i < ranges.size(); ++i)
+            ok = readRange(ranges[i].first, ranges[i].second, lines[i]) && ok;
+        return ok;
+    }
+
+    const int count = rowCount();
+    QVector<BlockPlan> plans;
+    QVector<IoBackend::Request> requests;
+    QVector<int> owners;
+    for (int i = 0; i < ranges.size(); ++i) {
+        const int first = qMax(ranges[i].first, 0);
+        const int last = qMin(ranges[i].second, count);
+        if (first >= last)
+            continue;
+        BlockPlan plan = planBlock(first, last, true);
+        IoBackend::Request request;
+        if (!planIoRequest(plan, request)) {
+            ok = false;
+            continue;
+        }
+        plans.append(plan);
+        requests.append(request);
+        owners.append(i);
+    }
+    if (requests.isEmpty())
+        return ok;
+
+    m_io->readBatch(requests);
+    for (int k = 0; k < requests.size(); ++k) {
+        QVector<QByteArray>& out = lines[owners[k]];
+        if (!requests[k].ok || !splitBlock(plans[k], requests[k].data, out)) {
+            out.clear();
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+void RowStore::adviseRange(int first, int last) const
+{
+    if (!m_io)
+        return;
+    qint64 begin = 0, end = -1;
+    {
+        QReadLocker locker(&m_indexLock);
+        first = qMax(first, 0);
+        last = qMin(last, m_index.size());
+        if (first >= last)
+            return;
+        begin = m_index.offset(first);
+        end = rowEnd(last - 1);
+    }
+    // A length of 0 advises up to the end of the file
+    m_io->advise(begin, end > begin ? end - begin : 0);
+}
+
+bool RowStore::scan(int first, int last, const std::function<void(int, const QByteArray&)>& visit,
+                    const std::function<void(int)>& progress) const
+{
+    first = qMax(first, 0);
+    last = qMin(last, rowCount());
+
+    if (m_cache) {
+        return m_cache->lines(first, last, [&](int row, const QByteArray& raw) {
+            m_metrics.bytesRead.fetch_add(raw.size(), std::memory_order_relaxed);
+            visit(row, raw);
+            if (progress && row % SCAN_YIELD_ROWS == 0)
+                progress(row);
+        });
+    }
+
+    if (!m_io) {
+        QMutexLocker locker(&m_deviceMutex);
+        if (!ensureOpen())
+            return false;
+        for (int i = first; i < last; ++i) {
+            qint64 offset = 0;
+            {
+                QReadLocker indexLocker(&m_indexLock);
+                offset = m_index.offset(i);
+            }
+            m_file->seek(offset);
+            const QByteArray raw = m_file->readLine();
+            m_metrics.bytesRead.fetch_add(raw.size(), std::memory_order_relaxed);
+            visit(i, raw);
+
+            if (progress && i % SCAN_YIELD_ROWS == 0) {
+                locker.unlock();
+                progress(i);
+                locker.relock();
+            }
+        }
+        return true;
+    }
+
+    // Plain files: split the streamed blocks into rows
+    QVector<QByteArray> lines;
+    int row = first;
+    return streamBlocks(first, last, [&](const BlockPlan& plan, const QByteArray& block) {
+        lines.clear();
+        const bool complete = splitBlock(plan, block, lines);
+        for (const QByteArray& raw : lines) {
+            visit(row, raw);
+            if (progress && row % SCAN_YIELD_ROWS == 0)
+                progress(row);
+            ++row;
+        }
+        return complete;
+    });
+}
+
+bool RowStore::streamBlocks(int first, int last,
+                            const std::function<bool(const BlockPlan&, const QByteArray&)>& visit) const
+{
+    // Blocks of about SCAN_BLOCK_BYTES of whole rows. Row starts are only
+    // copied out of the index when a block is visited.
+    QVector<int> blockEnds;
+    {
+        QReadLocker locker(&m_indexLock);
+        const QVector<qint64>& offsets = m_index.offsets();
+        for (int row = first; row < last;) {
+            const auto limit = std::lower_bound(offsets.begin() + row + 1, offsets.begin() + last,
+                                                offsets[row] + SCAN_BLOCK_BYTES);
+            row = qMax(row + 1, static_cast<int>(limit - offsets.begin()));
+            blockEnds.append(row);
+        }
+    }
+    QVector<BlockPlan> plans;
+    QVector<IoBackend::Request> requests(blockEnds.size());
+    plans.reserve(blockEnds.size());
+    for (int k = 0, row = first; k < blockEnds.size(); row = blockEnds[k++]) {
+        plans.append(planBlock(row, blockEnds[k], false));
+        // A row larger than a batch gets an empty read and is read on its own
+        if (!planIoRequest(plans[k], requests[k]))
+            requests[k].offset = plans[k].begin;
+    }
+
+    // visit() must not throw out of stream(), which may still have reads
+    // in flight
+    std::exception_ptr error;
+    const bool ok = m_io->stream(requests, [&](int k, IoBackend::Request& request) {
+        BlockPlan& plan = plans[k];
+        {
+            QReadLocker locker(&m_indexLock);
+            plan.starts = m_index.offsets().mid(plan.first, plan.last - plan.first);
+        }
+        if (request.size == 0 || request.data.size() < request.size) {
+            // An oversized row, or a short read: join the rows read one by
+            // one into a block of their own
+            request.data.clear();
+            plan.endKnown = true;
+            QByteArray raw;
+            for (int r = plan.first; r < plan.last; ++r) {
+                plan.starts[r - plan.first] = plan.begin + request.data.size();
+                if (readRaw(r, raw))
+                    request.data += raw;
+            }
+        }
+        bool more = false;
+        try {
+            more = visit(plan, request.data);
+        } catch (...) {
+            error = std::current_exception();
+        }
+        plan.starts = QVector<qint64>();
+        return more;
+    });
+    if (error)
+        std::rethrow_exception(error);
+    return ok;
+}
+
+bool RowStore::readChunk(int first, int last, RowChunk& chunk) const
+{
+    first = qMax(first, 0);
+    last = qMax(first, qMin(last, rowCount()));
+    chunk.reset(first, last - first, m_headers.size());
+    if (first >= last)
+        return true;
+
+    // One block read, or row by row if the rows do not fit a batch
+    QVector<QByteArray> lines;
+    if (!readBlock(first, last, lines)) {
+        lines.clear();
+        QByteArray raw;
+        for (int r = first; r < last && readRaw(r, raw); ++r)
+            lines.append(raw);
+    }
+    for (const QByteArray& raw : lines)
+        chunk.appendLine(raw.constData(), raw.size());
+    return chunk.rowCount() == last - first;
+}
+
+bool RowStore::scanChunks(int first, int last, RowChunk& chunk, const std::function<void(const RowChunk&)>& visit,
+                          const std::function<void(int)>& progress) const
+{
+    first = qMax(first, 0);
+    last = qMin(last, rowCount());
+    const int columns = m_headers.size();
+
+    if (!m_io) {
+        // Compressed input and analysis caches: rows arrive one at a time;
+        // a chunk is passed on when it is full or holds about
+        // SCAN_BLOCK_BYTES. progress() goes through scan(), which releases
+        // the device lock around it.
+        chunk.reset(first, CHUNK_ROWS, columns);
+        const bool ok = scan(first, last, [&](int row, const QByteArray& raw) {
+            if (chunk.isFull() || chunk.byteSize() >= SCAN_BLOCK_BYTES) {
+                visit(chunk);
+                chunk.reset(row, CHUNK_ROWS, columns);
+            }
+            chunk.appendLine(raw.constData(), raw.size());
+        }, progress);
+        if (chunk.rowCount() > 0)
+            visit(chunk);
+        return ok;
+    }
+
+    // Plain files: one chunk per streamed block, decoded straight from it
+    return streamBlocks(first, last, [&](const BlockPlan& plan, const QByteArray& block) {
+        const int count = plan.last - plan.first;
+        chunk.reset(plan.first, count, columns);
+        for (qint64 from = 0, to = 0; chunk.rowCount() < count
+             && rowInBlock(plan, block, chunk.rowCount(), from, to);) {
+            chunk.appendLine(block.constData() + from, to - from);
+        }
+        recordBatch(chunk.rowCount(), block.size());
+        visit(chunk);
+        if (progress)
+            progress(plan.first + chunk.rowCount());
+        return chunk.rowCount() == count;
+    });
+}
+
+qint64 RowStore::timestamp(int row) const
+{
+    if (m_cache)
+        return row >= 0 && row < rowCount() ? m_cache->timestamp(row) : TimelineParser::INVALID_TIMESTAMP;
+    QByteArray raw;
+    if (!readRaw(row, raw))
+        return TimelineParser::INVALID_TIMESTAMP;
+    return TimelineParser::parseTimestamp(TimelineParser::firstField(raw));
+}
+
+QVector<int> RowStore::rowsInTimeRange(qint64 from, qint64 to) const
+{
+    if (m_cache)
+        return m_cache->rowsInTimeRange(from, to);
+    QVector<int> rows;
+    if (m_headers.isEmpty())
+        return rows;
+    RowChunk chunk;
+    scanChunks(0, rowCount(), chunk, [&](const RowChunk& c) {
+        for (int r = 0; r < c.rowCount(); ++r) {
+            const QByteArrayView field = c.field(r, 0);
+            const qint64 ts = TimelineParser::parseTimestamp(QByteArray::fromRawData(field.data(), field.size()));
+            if (ts != TimelineParser::INVALID_TIMESTAMP && ts >= from && ts <= to)
+                rows.append(c.firstRow() + r);
+        }
+    });
+    return rows;
+}
+
+QVector<RangeExporter::Span> RowStore::exportSpans(const QVector<int>& rows) const
+{
+    QVector<RangeExporter::Span> spans;
+    if (m_cache) {
+        // Rows of the source CSV, each running to the next one's offset
+        const int count = m_cache->rowCount();
+        spans.append({0, m_cache->sourceHeaderEnd()});
+        for (int row : rows) {
+            if (row < 0 || row >= count)
+                continue;
+            const qint64 begin = m_cache->sourceOffset(row);
+            const qint64 end = row + 1 < count ? m_cache->sourceOffset(row + 1) : -1;
+            if (spans.last().end == begin)
+                spans.last().end = end;
+            else
+                spans.append({begin, end});
+        }
+        return spans;
+    }
+
+    QReadLocker locker(&m_indexLock);
+    const QVector<qint64>& offsets = m_index.offsets();
+
+    // A row runs to the next row's offset; the last indexed row runs to the
+    // tail found by follow mode, or to the end of the file.
+    spans.append({0, offsets.isEmpty() ? m_tailOffset.load() : offsets.first()});
+    for (int row : rows) {
+        if (row < 0 || row >= offsets.size())
+            continue;
+        if (spans.last().end == offsets[row])
+            spans.last().end = rowEnd(row);
+        else
+            spans.append({offsets[row], rowEnd(row)});
+    }
+    return spans;
+}
+
+QString RowStore::exportSourcePath() const
+{
+    if (!m_cache)
+        return m_filePath;
+    return m_cache->sourceUnchanged() ? m_cache->sourcePath() : QString();
+}
+
+QVector<qint64> RowStore::rowOffsets(int first, int last) const
+{
+    first = qMax(first, 0);
+    last = qMin(last, rowCount());
+    QVector<qint64> offsets;
+    if (first >= last)
+        return offsets;
+    if (m_cache) {
+        offsets.reserve(last - first);
+        for (int row = first; row < last; ++row)
+            offsets.append(m_cache->sourceOffset(row));
+        return offsets;
+    }
+    QReadLocker locker(&m_indexLock);
+    return m_index.offsets().mid(first, last - first);
+}
+
+bool RowStore::canFollow() const
+{
+    // Appending to a compressed stream cannot be tracked incrementally
+    return m_io != nullptr;
+}
+
+void RowStore::locateTail()
+{
+    // Re-read the last indexed line (or the header) to find exactly where
+    // unindexed data starts. Only the following thread changes the index,
+    // so reading it here needs no index lock.
+    const qint64 lastStart = m_index.isEmpty() ? 0 : m_index.offsets().last();
+    if (!m_file->seek(lastStart)) {
+        m_tailOffset = -1;
+        return;
+    }
+    const QByteArray raw = m_file->readLine();
+    m_tailOffset = lastStart + raw.size();
+    m_lastRowPartial = !m_index.isEmpty() && !raw.endsWith('\n');
+}
+
+RowStore::Append RowStore::pollAppended(const std::function<void(int, const QByteArray&)>& visit)
+{
+    Append append;
+    if (!canFollow())
+        return append;
+
+    QMutexLocker locker(&m_deviceMutex);
+    if (!ensureOpen())
+        return append;
+    if (m_tailOffset < 0)
+        locateTail();
+    if (m_tailOffset < 0)
+        return append;
+
+    const qint64 size = m_file->size();
+    if (size < m_tailOffset) {
+        qWarning() << "RowStore: file shrank while following; reopen it to re-index";
+        return append;
+    }
+
+    // A last row that was still being written when indexed is refreshed
+    // once its newline arrives.
+    if (m_lastRowPartial) {
+        locateTail();
+        if (m_lastRowPartial)
+            return append;
+        append.completedRow = m_index.size() - 1;
+    }
+
+    // Index only complete lines; a trailing partial line is picked up on a
+    // later call.
+    qint64 offset = m_tailOffset;
+    m_file->seek(offset);
+    while (offset < size && m_index.size() + append.offsets.size() < LineIndex::MAX_LINE_COUNT) {
+        const QByteArray raw = m_file->readLine();
+        if (raw.isEmpty() || !raw.endsWith('\n'))
+            break;
+        if (visit)
+            visit(m_index.size() + append.offsets.size(), raw);
+        append.offsets.append(offset);
+        offset += raw.size();
+    }
+    append.tailOffset = offset;
+    return append;
+}
+
+void RowStore::commitAppended(const Append& append)
+{
+    if (append.tailOffset < 0)
+        return;
+    QWriteLocker locker(&m_indexLock);
+    m_index.append(append.offsets);
+    m_tailOffset = append.tailOffset;
+    m_rowCount.store(m_index.size(), std::memory_order_release);
+}
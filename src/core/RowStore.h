@@ -0,0 +1,169 @@
+#pragma once
+#include <QIODevice>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QMutex>
+#include <QReadWriteLock>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include "LineIndex.h"
+#include "IoBackend.h"
+#include "TimelineParser.h"
+#include "utils/RangeExporter.h"
+#include "utils/PerfMetrics.h"
+
+class RowChunk;
+class AnalysisCache;
+
+/**
+ * @brief RowStore gives random access to the data rows of one timeline file.
+ *
+ * Plain files are read through an IoBackend (pread() by default) on a
+ * private descriptor, so any number of threads can read rows at once; index
+ * builds and scans stream large blocks through it, which the async backend
+ * reads several at a time. The line index is behind a read/write
+ * lock that is only taken exclusively when follow mode appends rows.
+ * Compressed input (.gz/.zst) is read through one CompressedFile device,
+ * whose decoder state is serialized by a mutex. An analysis cache (.tlac,
+ * see AnalysisCache) is read from its mapping instead; its rows are served
+ * as CSV lines re-encoded from the stored columns.
+ */
+class RowStore {
+public:
+    static constexpr qint64 MAX_FILE_SIZE = 2LL * 1024 * 1024 * 1024;  // 2GB limit
+    static constexpr int SCAN_YIELD_ROWS = 10000;  // rows between scan() progress calls
+    static constexpr qint64 MAX_BATCH_BYTES = 16LL * 1024 * 1024;  // largest readRange() span
+    static constexpr qint64 SCAN_BLOCK_BYTES = 4LL * 1024 * 1024;  // read size of scan() on plain files
+    static constexpr int CHUNK_ROWS = 16384;  // rows per scanChunks() chunk of compressed input
+
+    // Validates the file; throws std::runtime_error if it cannot be opened.
+    // The I/O backend applies to plain files only. Analysis caches are
+    // recognized by their magic.
+    explicit RowStore(const QString& filePath, IoBackend::Kind io = IoBackend::defaultKind());
+    ~RowStore();
+
+    // Reads the header and builds (or loads) the line index. The callback is
+    // called with the lines indexed so far, without the device lock held.
+    void open(const std::function<void(int)>& indexProgress = {});
+
+    QString filePath() const { return m_filePath; }
+    TimelineParser::TimelineType type() const { return m_type; }
+    const QStringList& headers() const { return m_headers; }
+    int rowCount() const;
+    bool isPositional() const { return m_io || m_cache; }  // lock-free positional reads
+    // Compressed input that can only be decoded from its start (see
+    // CompressedFile::seeksFromStart()); known once open() returns
+    bool seeksFromStart() const { return m_seeksFromStart.load(std::memory_order_acquire); }
+    QString ioBackendName() const;
+    const AnalysisCache* analysisCache() const { return m_cache.get(); }  // nullptr for CSV input
+
+    bool readRaw(int row, QByteArray& line) const;
+    bool readFields(int row, QStringList& fields) const;  // tokenized with FileUtils::parseCsvLine
+
+    // Reads rows [first, last) with one contiguous read; lines[i] is row
+    // first + i. Fails if the span is larger than MAX_BATCH_BYTES.
+    bool readRange(int first, int last, QVector<QByteArray>& lines) const;
+    // Reads several such ranges; lines[i] holds range i (empty if it
+    // failed). On plain files all reads are handed to the backend at once,
+    // so the async backend overlaps them.
+    bool readRanges(const QVector<QPair<int, int>>& ranges, QVector<QVector<QByteArray>>& lines) const;
+    // Asks the kernel to start reading rows [first, last) into the page
+    // cache (WILLNEED advice); a no-op for compressed input
+    void adviseRange(int first, int last) const;
+
+    // Reads rows [first, last) in order, calling visit() for each, and
+    // progress() with the current row every SCAN_YIELD_ROWS rows. Plain files
+    // are streamed in SCAN_BLOCK_BYTES blocks without holding any lock; for
+    // compressed input the device lock is released around progress().
+    bool scan(int first, int last, const std::function<void(int, const QByteArray&)>& visit,
+              const std::function<void(int)>& progress = {}) const;
+
+    // Bulk decoding into columns (see RowChunk), reusing the chunk's buffers.
+    // readChunk() decodes rows [first, last) with one read. scanChunks()
+    // passes rows [first, last) to visit() a chunk at a time, one chunk per
+    // streamed block on plain files; progress() is called after each chunk
+    // (every SCAN_YIELD_ROWS rows for compressed input).
+    bool readChunk(int first, int last, RowChunk& chunk) const;
+    bool scanChunks(int first, int last, RowChunk& chunk, const std::function<void(const RowChunk&)>& visit,
+                    const std::function<void(int)>& progress = {}) const;
+
+    // First-column timestamps (see TimelineParser::parseTimestamp()).
+    // timestamp() is INVALID_TIMESTAMP for rows without one.
+    // rowsInTimeRange() returns the ascending rows with a timestamp in
+    // [from, to]; an analysis cache only looks at the blocks overlapping
+    // the range, other input is scanned.
+    qint64 timestamp(int row) const;
+    QVector<int> rowsInTimeRange(qint64 from, qint64 to) const;
+
+    // Byte ranges of the header plus the given (ascending) rows, with adjacent
+    // rows merged into one span; input for RangeExporter
+    QVector<RangeExporter::Span> exportSpans(const QVector<int>& rows) const;
+    // The file those spans are copied from: the timeline itself, or for an
+    // analysis cache its source CSV (empty if that has changed or is gone)
+    QString exportSourcePath() const;
+    // Byte offsets of rows [first, last) in the (uncompressed) source
+    QVector<qint64> rowOffsets(int first, int last) const;
+
+    // Follow mode. pollAppended() finds complete lines written since the last
+    // commit and passes each to visit() (row numbers continue the index); the
+    // index itself only grows in commitAppended(), so callers can announce
+    // the new rows first.
+    struct Append {
+        QVector<qint64> offsets;
+        qint64 tailOffset = -1;
+        int completedRow = -1;   // last row, now that its newline has arrived
+    };
+    bool canFollow() const;
+    Append pollAppended(const std::function<void(int, const QByteArray&)>& visit = {});
+    void commitAppended(const Append& append);
+
+    PerfMetrics& metrics() const { return m_metrics; }
+    qint64 memoryBytes() const;
+
+private:
+    QString m_filePath;
+    TimelineParser::TimelineType m_type = TimelineParser::Unknown;
+    QStringList m_headers;
+    std::unique_ptr<IoBackend> m_io;  // plain files only
+    std::unique_ptr<AnalysisCache> m_cache;  // .tlac input only
+
+    // The QIODevice is used to build the index, to follow the file and, for
+    // compressed input, for every row read
+    mutable std::unique_ptr<QIODevice> m_file;
+    mutable QMutex m_deviceMutex;
+
+    LineIndex m_index;
+    mutable QReadWriteLock m_indexLock;
+    std::atomic<int> m_rowCount{0};  // m_index.size(), readable without the lock
+    std::atomic<bool> m_seeksFromStart{false};
+    mutable PerfMetrics m_metrics;
+
+    // Follow mode state
+    std::atomic<qint64> m_tailOffset{-1};  // byte offset just past the last indexed line
+    bool m_lastRowPartial = false;         // last indexed line had no newline yet
+
+    bool ensureOpen() const;  // caller holds m_deviceMutex
+    qint64 rowEnd(int row) const;  // caller holds m_indexLock; -1 if unknown
+    // One row, or the block holding rows [first, last) split into lines
+    bool readRawAt(qint64 begin, qint64 end, QByteArray& line) const;
+    bool readBlock(int first, int last, QVector<QByteArray>& lines) const;
+    struct BlockPlan {
+        int first = 0, last = 0;
+        qint64 begin = 0, end = -1;  // end is -1 until follow mode finds the tail
+        bool endKnown = false;
+        QVector<qint64> starts;      // row offsets, if asked for
+    };
+    BlockPlan planBlock(int first, int last, bool withStarts) const;
+    bool planIoRequest(BlockPlan& plan, IoBackend::Request& request) const;  // plain files
+    static bool rowInBlock(const BlockPlan& plan, const QByteArray& block, int k, qint64& from, qint64& to);
+    bool splitBlock(const BlockPlan& plan, const QByteArray& block, QVector<QByteArray>& lines) const;
+    void recordBatch(int rows, qint64 bytes) const;  // metrics of one block read
+    // Plain files: streams rows [first, last) through the I/O backend in
+    // blocks of whole rows; visit() gets each block with its row starts
+    bool streamBlocks(int first, int last,
+                      const std::function<bool(const BlockPlan&, const QByteArray&)>& visit) const;
+    void readHeader();
+    void locateTail();        // caller holds m_deviceMutex
+};
@@ -0,0 +1,107 @@
+#include "TagStore.h"
+#include "AppDataPaths.h"
+#include <QFile>
+#include <QTextStream>
+#include <QDebug>
+#include <algorithm>
+
+TagStore::TagStore(const QString& sourcePath)
+    : m_sourcePath(sourcePath)
+{
+}
+
+void TagStore::load(int rowLimit)
+{
+    QString tagFilePath = AppDataPaths::tagFilePath(m_sourcePath);
+    if (tagFilePath.isEmpty()) {
+        return; // No valid tag file path
+    }
+
+    QFile tagFile(tagFilePath);
+
+    if (!tagFile.exists()) {
+        return; // No tag file exists, start with empty set
+    }
+
+    if (!tagFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qWarning() << "Failed to open tag file for reading (check permissions)";
+        return;
+    }
+
+    QTextStream in(&tagFile);
+    int loadedCount = 0;
+
+    while (!in.atEnd() && loadedCount < MAX_TAGS) {
+        QString line = in.readLine().trimmed();
+        if (line.length() > 20) { // Sanity check - row numbers shouldn't be this long
+            qWarning() << "Invalid tag data detected, skipping";
+            continue;
+        }
+
+        bool ok;
+        int row = line.toInt(&ok);
+        if (ok && row >= 0 && row < rowLimit) {
+            m_rows.insert(row);
+            loadedCount++;
+        } else if (ok) {
+            qWarning() << "Tag references invalid row number, skipping";
+        }
+    }
+
+    if (loadedCount >= MAX_TAGS) {
+        qWarning() << "Tag file contains too many entries, some may not be loaded";
+    }
+}
+
+bool TagStore::save()
+{
+    QString tagFilePath = AppDataPaths::tagFilePath(m_sourcePath);
+    if (tagFilePath.isEmpty()) {
+        qWarning() << "Failed to determine tag file path";
+        return false;
+    }
+
+    QFile tagFile(tagFilePath);
+
+    if (!tagFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qWarning() << "Failed to open tag file for writing (check permissions)";
+        return false;
+    }
+
+    QTextStream out(&tagFile);
+    for (int row : m_rows) {
+        out << row << "\n";
+    }
+
+    if (out.status() != QTextStream::Ok) {
+        qWarning() << "Error occurred while writing tag file";
+        return false;
+    }
+
+    m_unsavedChanges = false;
+    return true;
+}
+
+bool TagStore::set(int row, bool tagged)
+{
+    if (tagged == m_rows.contains(row))
+        return false;
+    if (tagged)
+        m_rows.insert(row);
+    else
+        m_rows.remove(row);
+    m_unsavedChanges = true;
+    return true;
+}
+
+QVector<int> TagStore::sortedRows() const
+{
+    QVector<int> rows(m_rows.begin(), m_rows.end());
+    std::sort(rows.begin(), rows.end());
+    return rows;
+}
+
+qint64 TagStore::memoryBytes() const
+{
+    return m_rows.size() * static_cast<qint64>(sizeof(int) * 4);
+}
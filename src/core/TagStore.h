@@ -0,0 +1,30 @@
+#pragma once
+#include <QString>
+#include <QSet>
+#include <QVector>
+
+/**
+ * @brief TagStore holds the tagged rows of one timeline and persists them to its .tags file.
+ */
+class TagStore {
+public:
+    static constexpr int MAX_TAGS = 1000000;  // Limit number of tags to prevent memory issues
+
+    explicit TagStore(const QString& sourcePath);
+
+    // Reads the tag file, ignoring rows outside [0, rowLimit)
+    void load(int rowLimit);
+    bool save();
+
+    bool contains(int row) const { return m_rows.contains(row); }
+    bool set(int row, bool tagged);  // true if the tag state changed
+    QVector<int> sortedRows() const;
+    int size() const { return m_rows.size(); }
+    bool hasUnsavedChanges() const { return m_unsavedChanges; }
+    qint64 memoryBytes() const;
+
+private:
+    QString m_sourcePath;
+    QSet<int> m_rows;
+    bool m_unsavedChanges = false;
+};
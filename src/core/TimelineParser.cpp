@@ -0,0 +1,127 @@
+#include "TimelineParser.h"
+#include <QDate>
+
+namespace {
+
+constexpr qint64 MICROS_PER_SECOND = 1000000;
+constexpr qint64 SECONDS_PER_DAY = 86400;
+constexpr qint64 UNIX_EPOCH_JULIAN_DAY = 2440588;
+
+// Reads exactly 'count' digits at 'pos'; returns -1 on failure
+int readDigits(const QByteArray& text, int pos, int count)
+{
+    if (pos + count > text.size())
+        return -1;
+    int value = 0;
+    for (int i = pos; i < pos + count; ++i) {
+        const char c = text[i];
+        if (c < '0' || c > '9')
+            return -1;
+        value = value * 10 + (c - '0');
+    }
+    return value;
+}
+
+qint64 toMicros(int year, int month, int day, int hour, int minute, int second)
+{
+    const QDate date(year, month, day);
+    if (!date.isValid() || hour > 23 || minute > 59 || second > 60)
+        return TimelineParser::INVALID_TIMESTAMP;
+    const qint64 days = date.toJulianDay() - UNIX_EPOCH_JULIAN_DAY;
+    return (days * SECONDS_PER_DAY + hour * 3600 + minute * 60 + second) * MICROS_PER_SECOND;
+}
+
+// 2023-03-16T00:00:01.000000+00:00
+qint64 parseIso(const QByteArray& text)
+{
+    const int year = readDigits(text, 0, 4);
+    const int month = readDigits(text, 5, 2);
+    const int day = readDigits(text, 8, 2);
+    const int hour = readDigits(text, 11, 2);
+    const int minute = readDigits(text, 14, 2);
+    const int second = readDigits(text, 17, 2);
+    if (year < 0 || month < 0 || day < 0 || hour < 0 || minute < 0 || second < 0
+        || text[4] != '-' || text[7] != '-' || (text[10] != 'T' && text[10] != ' '))
+        return TimelineParser::INVALID_TIMESTAMP;
+
+    qint64 micros = toMicros(year, month, day, hour, minute, second);
+    if (micros == TimelineParser::INVALID_TIMESTAMP)
+        return micros;
+
+    int pos = 19;
+    if (pos < text.size() && text[pos] == '.') {
+        qint64 scale = MICROS_PER_SECOND / 10;
+        for (++pos; pos < text.size() && text[pos] >= '0' && text[pos] <= '9'; ++pos) {
+            micros += (text[pos] - '0') * scale;
+            scale /= 10;
+        }
+    }
+    if (pos + 6 <= text.size() && (text[pos] == '+' || text[pos] == '-')) {
+        const int offHour = readDigits(text, pos + 1, 2);
+        const int offMinute = readDigits(text, pos + 4, 2);
+        if (offHour >= 0 && offMinute >= 0) {
+            const qint64 offset = (offHour * 3600 + offMinute * 60) * MICROS_PER_SECOND;
+            micros += (text[pos] == '+') ? -offset : offset;
+        }
+    }
+    return micros;
+}
+
+// Wed Mar 15 2023 00:00:20
+qint64 parseMactime(const QByteArray& text)
+{
+    static const char* const months[] = {
+        "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
+    };
+    const QList<QByteArray> parts = text.split(' ');
+    if (parts.size() < 5)
+        return TimelineParser::INVALID_TIMESTAMP;
+
+    int month = 0;
+    for (int m = 0; m < 12; ++m) {
+        if (parts[1] == months[m]) {
+            month = m + 1;
+            break;
+        }
+    }
+    const QByteArray& time = parts[4];
+    const int day = parts[2].toInt();
+    const int year = parts[3].toInt();
+    const int hour = readDigits(time, 0, 2);
+    const int minute = readDigits(time, 3, 2);
+    const int second = readDigits(time, 6, 2);
+    if (month == 0 || hour < 0 || minute < 0 || second < 0)
+        return TimelineParser::INVALID_TIMESTAMP;
+    return toMicros(year, month, day, hour, minute, second);
+}
+
+} // namespace
+
+TimelineParser::TimelineType TimelineParser::detectFormat(const QStringList& headerFields)
+{
+    if (headerFields == QStringList({"Date","Size","Type","Mode","UID","GID","Meta","File Name"}))
+        return Filesystem;
+    if (headerFields == QStringList({"datetime","timestamp_desc","source","source_long","message","parser","display_name","tag"}))
+        return Super;
+    return Unknown;
+}
+
+qint64 TimelineParser::parseTimestamp(const QByteArray& field)
+{
+    if (field.size() < 19)
+        return INVALID_TIMESTAMP;
+    if (field[0] >= '0' && field[0] <= '9')
+        return parseIso(field);
+    return parseMactime(field);
+}
+
+QByteArray TimelineParser::firstField(const QByteArray& line)
+{
+    int end = line.indexOf(',');
+    if (end < 0)
+        end = line.size();
+    QByteArray field = line.left(end).trimmed();
+    if (field.size() >= 2 && field.startsWith('"') && field.endsWith('"'))
+        field = field.mid(1, field.size() - 2);
+    return field;
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <QStringList>
+#include <QByteArray>
+#include <limits>
+
+/**
+ * @brief TimelineParser provides static utilities for timeline format detection.
+ */
+class TimelineParser {
+public:
+    enum TimelineType {
+        Filesystem,
+        Super,
+        Unknown
+    };
+    static constexpr qint64 INVALID_TIMESTAMP = std::numeric_limits<qint64>::min();
+
+    static TimelineType detectFormat(const QStringList& headerFields);
+
+    // Parses the first-column timestamp of either format to microseconds
+    // since the epoch (UTC): ISO 8601 as written by psort, or mactime's
+    // "Wed Mar 15 2023 00:00:20". Returns INVALID_TIMESTAMP otherwise.
+    static qint64 parseTimestamp(const QByteArray& field);
+    // The raw first field of a CSV line, without quotes
+    static QByteArray firstField(const QByteArray& line);
+};
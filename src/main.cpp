@@ -6,7 +6,10 @@
 #include <QStandardPaths>
 #include <QDir>
 #include <QtGlobal>
+#include <QTimer>
 #include "AppWindow.h"
+#include "HeadlessRunner.h"
+#include "TimelineServer.h"
 
 static bool       s_debugMode  = false;
 static QFile*     s_logFile    = nullptr;
@@ -42,6 +45,31 @@ static void messageHandler(QtMsgType type, const QMessageLogContext&, const QStr
         abort();
 }
 
+static void openDebugLog()
+{
+    QString logDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir().mkpath(logDir);
+    QString logPath = logDir + "/debug.log";
+    s_logFile = new QFile(logPath);
+    if (s_logFile->open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Append)) {
+        s_logStream = new QTextStream(s_logFile);
+        fprintf(stderr, "Debug log: %s\n", logPath.toLocal8Bit().constData());
+    }
+    qDebug() << "=== Session started ===";
+    qDebug() << "Qt version:" << QT_VERSION_STR;
+}
+
+static void closeDebugLog()
+{
+    delete s_logStream;
+    s_logStream = nullptr;
+    if (s_logFile) {
+        s_logFile->close();
+        delete s_logFile;
+        s_logFile = nullptr;
+    }
+}
+
 int main(int argc, char *argv[])
 {
     for (int i = 1; i < argc; ++i) {
@@ -53,6 +81,30 @@ int main(int argc, char *argv[])
 
     qInstallMessageHandler(messageHandler);
 
+    // --serve hosts timelines for other viewers until it is stopped
+    if (TimelineServer::isServerInvocation(argc, argv)) {
+        QCoreApplication app(argc, argv);
+        if (s_debugMode)
+            openDebugLog();
+        int result = 0;
+        {
+            TimelineServer server(app.arguments());
+            result = server.exec();
+        }
+        closeDebugLog();
+        return result;
+    }
+
+    // --index / --search / --export run the engine without a display
+    if (HeadlessRunner::isHeadlessInvocation(argc, argv)) {
+        QCoreApplication app(argc, argv);
+        if (s_debugMode)
+            openDebugLog();
+        const int result = HeadlessRunner(app.arguments()).exec();
+        closeDebugLog();
+        return result;
+    }
+
     // On GNOME Wayland sessions Qt probes for a Wayland compositor before
     // falling back to XCB, which blocks the event loop briefly and produces
     // the "Ignoring XDG_SESSION_TYPE=wayland" warning. Setting the platform
@@ -64,29 +116,16 @@ int main(int argc, char *argv[])
     app.setWindowIcon(QIcon(":/icons/appicon.png"));
 
     if (s_debugMode) {
-        QString logDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
-        QDir().mkpath(logDir);
-        QString logPath = logDir + "/debug.log";
-        s_logFile = new QFile(logPath);
-        if (s_logFile->open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Append)) {
-            s_logStream = new QTextStream(s_logFile);
-            fprintf(stderr, "Debug log: %s\n", logPath.toLocal8Bit().constData());
-        }
-        qDebug() << "=== Session started ===";
-        qDebug() << "Qt version:" << QT_VERSION_STR;
+        openDebugLog();
         qDebug() << "Platform:" << app.platformName();
     }
 
     AppWindow window;
     window.show();
+    // After the first paint, so the window appears before any file is read
+    QTimer::singleShot(0, &window, &AppWindow::restoreSession);
     int result = app.exec();
 
-    delete s_logStream;
-    s_logStream = nullptr;
-    if (s_logFile) {
-        s_logFile->close();
-        delete s_logFile;
-        s_logFile = nullptr;
-    }
+    closeDebugLog();
     return result;
 }
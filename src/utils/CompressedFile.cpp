@@ -0,0 +1,619 @@
+#include "CompressedFile.h"
+#include <QDataStream>
+#include <QDebug>
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+#include <zlib.h>
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace {
+
+constexpr qint64 DECODE_CHUNK = 64 * 1024;       // output produced per decodeMore()
+constexpr qint64 INPUT_CHUNK = 256 * 1024;       // compressed bytes read at a time
+constexpr qint64 HISTORY_KEEP = 1024 * 1024;     // decoded bytes retained behind the decoder
+constexpr int DEFLATE_WINDOW = 32 * 1024;        // deflate back-reference window
+constexpr int GZIP_AUTO_HEADER = 15 + 32;        // windowBits: detect gzip/zlib header
+constexpr int RAW_DEFLATE = -15;                 // windowBits: headerless deflate
+constexpr quint32 INDEX_MAGIC = 0x544C5643;      // "TLVC"
+constexpr quint32 INDEX_VERSION = 1;
+
+// zstd seekable format: the file ends with a skippable frame holding one
+// entry per frame (compressed size, decompressed size, optional checksum)
+// and a footer (frame count, descriptor, magic)
+constexpr quint32 SKIPPABLE_SEEK_MAGIC = 0x184D2A5E;
+constexpr quint32 SEEKABLE_MAGIC = 0x8F92EAB1;
+constexpr int SKIPPABLE_HEADER = 8;             // magic, frame size
+constexpr int SEEK_FOOTER = 9;
+constexpr quint32 MAX_SEEK_FRAMES = 0x8000000;  // format limit on the frame count
+constexpr uchar SEEK_CHECKSUM_FLAG = 0x80;
+constexpr uchar SEEK_RESERVED_BITS = 0x7C;
+
+} // namespace
+
+struct CompressedFile::Decoder {
+    z_stream zs;
+    bool zsInitialised = false;
+    bool rawDeflate = false;    // restored from a checkpoint: no gzip header/trailer handling
+    bool memberStart = true;    // nothing decoded yet from the current gzip member
+#ifdef HAVE_ZSTD
+    ZSTD_DCtx* zstd = nullptr;
+    ZSTD_inBuffer zin{nullptr, 0, 0};
+    bool frameComplete = true;  // the last ZSTD_decompressStream() call finished a frame
+#endif
+    QByteArray inBuf;
+    qint64 inFileOffset = 0;    // compressed offset just past the data in inBuf
+    bool finished = false;      // end of stream (or an error) reached
+
+    Decoder() { std::memset(&zs, 0, sizeof(zs)); }
+    ~Decoder()
+    {
+        if (zsInitialised)
+            inflateEnd(&zs);
+#ifdef HAVE_ZSTD
+        if (zstd)
+            ZSTD_freeDCtx(zstd);
+#endif
+    }
+};
+
+bool CompressedFile::isCompressedPath(const QString& path)
+{
+    return path.endsWith(".gz", Qt::CaseInsensitive) || path.endsWith(".zst", Qt::CaseInsensitive);
+}
+
+bool CompressedFile::isSupported(Codec codec)
+{
+#ifdef HAVE_ZSTD
+    Q_UNUSED(codec);
+    return true;
+#else
+    return codec == Gzip;
+#endif
+}
+
+CompressedFile::CompressedFile(const QString& path, QObject* parent)
+    : QIODevice(parent),
+      m_codec(path.endsWith(".zst", Qt::CaseInsensitive) ? Zstd : Gzip),
+      m_source(path)
+{
+}
+
+CompressedFile::~CompressedFile()
+{
+    close();
+}
+
+CompressedFile::Codec CompressedFile::codec() const
+{
+    return m_codec;
+}
+
+bool CompressedFile::open(OpenMode mode)
+{
+    if (mode & (WriteOnly | Append | Truncate)) {
+        setErrorString("Compressed timelines are read-only");
+        return false;
+    }
+    if (!isSupported(m_codec)) {
+        setErrorString("This build has no zstd support");
+        return false;
+    }
+    if (!m_source.open(QIODevice::ReadOnly)) {
+        setErrorString(m_source.errorString());
+        return false;
+    }
+
+    m_dec.reset(new Decoder);
+    m_dec->inBuf.resize(INPUT_CHUNK);
+#ifdef HAVE_ZSTD
+    if (m_codec == Zstd) {
+        m_dec->zstd = ZSTD_createDCtx();
+        if (!m_dec->zstd) {
+            m_source.close();
+            setErrorString("Failed to create zstd decoder");
+            return false;
+        }
+        // Checkpoints restored by loadIndex() are kept
+        if (m_checkpoints.isEmpty())
+            readSeekTable();
+        m_source.seek(0);
+    }
+#endif
+    if (m_codec == Gzip) {
+        if (inflateInit2(&m_dec->zs, GZIP_AUTO_HEADER) != Z_OK) {
+            m_source.close();
+            setErrorString("Failed to initialise zlib");
+            return false;
+        }
+        m_dec->zsInitialised = true;
+    }
+
+    m_history.clear();
+    m_historyStart = 0;
+    m_decodedPos = 0;
+    m_pos = 0;
+    // Reads are served from m_history, so QIODevice's own buffer would only
+    // duplicate data and desynchronise positions.
+    return QIODevice::open(mode | QIODevice::Unbuffered);
+}
+
+void CompressedFile::close()
+{
+    if (!isOpen())
+        return;
+    QIODevice::close();
+    m_dec.reset();
+    m_source.close();
+    m_history.clear();
+}
+
+bool CompressedFile::isSequential() const
+{
+    return false;
+}
+
+bool CompressedFile::seek(qint64 pos)
+{
+    if (!QIODevice::seek(pos))
+        return false;
+    m_pos = pos;
+    return true;
+}
+
+qint64 CompressedFile::pos() const
+{
+    return m_pos;
+}
+
+qint64 CompressedFile::size() const
+{
+    return m_totalSize >= 0 ? m_totalSize : m_decodedPos;
+}
+
+bool CompressedFile::atEnd() const
+{
+    if (!isOpen())
+        return true;
+    // Decoding ahead does not change the logical position.
+    return !const_cast<CompressedFile*>(this)->ensureAvailable(m_pos);
+}
+
+qint64 CompressedFile::bytesAvailable() const
+{
+    if (atEnd())
+        return 0;
+    if (m_totalSize >= 0)
+        return m_totalSize - m_pos;
+    return m_decodedPos - m_pos;
+}
+
+bool CompressedFile::isIndexComplete() const
+{
+    return m_totalSize >= 0;
+}
+
+bool CompressedFile::seeksFromStart() const
+{
+    return m_codec == Zstd && isIndexComplete() && m_checkpoints.isEmpty() && m_totalSize > CHECKPOINT_SPAN;
+}
+
+qint64 CompressedFile::readData(char* data, qint64 maxSize)
+{
+    qint64 total = 0;
+    while (total < maxSize && ensureAvailable(m_pos)) {
+        const qint64 n = qMin(m_decodedPos - m_pos, maxSize - total);
+        std::memcpy(data + total, m_history.constData() + (m_pos - m_historyStart), n);
+        total += n;
+        m_pos += n;
+    }
+    if (total == 0 && m_dec && m_dec->finished && m_totalSize < 0)
+        return -1; // stopped on a decode error rather than at the end
+    return total;
+}
+
+qint64 CompressedFile::readLineData(char* data, qint64 maxSize)
+{
+    qint64 total = 0;
+    while (total < maxSize && ensureAvailable(m_pos)) {
+        const char* src = m_history.constData() + (m_pos - m_historyStart);
+        const qint64 avail = qMin(m_decodedPos - m_pos, maxSize - total);
+        const void* newline = std::memchr(src, '\n', static_cast<size_t>(avail));
+        const qint64 n = newline ? (static_cast<const char*>(newline) - src + 1) : avail;
+        std::memcpy(data + total, src, n);
+        total += n;
+        m_pos += n;
+        if (newline)
+            break;
+    }
+    return total;
+}
+
+qint64 CompressedFile::writeData(const char*, qint64)
+{
+    return -1;
+}
+
+bool CompressedFile::ensureAvailable(qint64 target)
+{
+    if (!m_dec || target < 0)
+        return false;
+    if (target >= m_historyStart && target < m_decodedPos)
+        return true;
+    if (m_totalSize >= 0 && target >= m_totalSize)
+        return false;
+
+    // Restart from the closest checkpoint at or before the target if we would
+    // otherwise have to go backwards or decode past that checkpoint anyway.
+    auto it = std::upper_bound(m_checkpoints.cbegin(), m_checkpoints.cend(), target,
+                               [](qint64 value, const Checkpoint& cp) { return value < cp.out; });
+    const Checkpoint* best = (it == m_checkpoints.cbegin()) ? nullptr : &*(it - 1);
+    if (target < m_historyStart || (best && best->out > m_decodedPos)) {
+        if (!restartAt(best))
+            return false;
+    }
+
+    while (target >= m_decodedPos) {
+        if (!decodeMore())
+            return false;
+    }
+    return target >= m_historyStart;
+}
+
+bool CompressedFile::restartAt(const Checkpoint* cp)
+{
+    Decoder& d = *m_dec;
+    d.finished = false;
+    d.memberStart = (cp == nullptr);
+    m_history.clear();
+
+    const qint64 sourcePos = cp ? cp->in - (cp->bits ? 1 : 0) : 0;
+    if (!m_source.seek(sourcePos)) {
+        fail("Failed to seek in compressed file");
+        return false;
+    }
+    d.inFileOffset = sourcePos;
+
+    if (m_codec == Gzip) {
+        d.zs.avail_in = 0;
+        d.rawDeflate = (cp != nullptr);
+        if (inflateReset2(&d.zs, d.rawDeflate ? RAW_DEFLATE : GZIP_AUTO_HEADER) != Z_OK) {
+            fail("Failed to reset zlib stream");
+            return false;
+        }
+        if (cp) {
+            if (cp->bits) {
+                char c;
+                if (!m_source.getChar(&c)) {
+                    fail("Failed to read checkpoint byte");
+                    return false;
+                }
+                ++d.inFileOffset;
+                inflatePrime(&d.zs, cp->bits, static_cast<uchar>(c) >> (8 - cp->bits));
+            }
+            m_history = qUncompress(cp->window);
+            inflateSetDictionary(&d.zs, reinterpret_cast<const Bytef*>(m_history.constData()),
+                                 static_cast<uInt>(m_history.size()));
+        }
+    }
+#ifdef HAVE_ZSTD
+    if (m_codec == Zstd) {
+        ZSTD_DCtx_reset(d.zstd, ZSTD_reset_session_only);
+        d.zin = ZSTD_inBuffer{d.inBuf.constData(), 0, 0};
+        d.frameComplete = true;
+    }
+#endif
+
+    m_decodedPos = cp ? cp->out : 0;
+    m_historyStart = m_decodedPos - m_history.size();
+    return true;
+}
+
+bool CompressedFile::decodeMore()
+{
+    if (!m_dec || m_dec->finished)
+        return false;
+
+    trimHistory();
+    const qint64 oldSize = m_history.size();
+    m_history.resize(oldSize + DECODE_CHUNK);
+    qint64 produced = 0;
+    const bool ok = (m_codec == Gzip)
+        ? decodeGzip(m_history.data() + oldSize, DECODE_CHUNK, produced)
+        : decodeZstd(m_history.data() + oldSize, DECODE_CHUNK, produced);
+    m_history.resize(oldSize + produced);
+    m_decodedPos += produced;
+
+    if (ok && m_dec->finished && m_totalSize < 0) {
+        m_totalSize = m_decodedPos;
+        qDebug() << "CompressedFile: decoded" << m_totalSize << "bytes," << m_checkpoints.size() << "checkpoints";
+        // zstd can only resume at a frame start, and the zstd tool writes a
+        // single frame by default
+        if (seeksFromStart())
+            qWarning() << "CompressedFile:" << m_source.fileName()
+                       << "is a single zstd frame, so every seek decodes from the start;"
+                       << "recompress it in independent frames (e.g. with pzstd or t2sz) for fast scrolling";
+    }
+    return produced > 0;
+}
+
+bool CompressedFile::refillInput()
+{
+    Decoder& d = *m_dec;
+    const qint64 n = m_source.read(d.inBuf.data(), d.inBuf.size());
+    if (n <= 0)
+        return false;
+    d.inFileOffset += n;
+    if (m_codec == Gzip) {
+        d.zs.next_in = reinterpret_cast<Bytef*>(d.inBuf.data());
+        d.zs.avail_in = static_cast<uInt>(n);
+    }
+#ifdef HAVE_ZSTD
+    if (m_codec == Zstd)
+        d.zin = ZSTD_inBuffer{d.inBuf.constData(), static_cast<size_t>(n), 0};
+#endif
+    return true;
+}
+
+bool CompressedFile::decodeGzip(char* out, qint64 capacity, qint64& produced)
+{
+    Decoder& d = *m_dec;
+    z_stream& zs = d.zs;
+    zs.next_out = reinterpret_cast<Bytef*>(out);
+    zs.avail_out = static_cast<uInt>(capacity);
+
+    while (zs.avail_out > 0) {
+        // Even with no input left, inflate() may still hold output to flush
+        bool inputExhausted = false;
+        if (zs.avail_in == 0)
+            inputExhausted = !refillInput();
+
+        const uInt outBefore = zs.avail_out;
+        const uInt inBefore = zs.avail_in;
+        int ret = inflate(&zs, Z_BLOCK);
+        if (outBefore != zs.avail_out)
+            d.memberStart = false;
+        if (ret == Z_NEED_DICT)
+            ret = Z_DATA_ERROR;
+        if (ret == Z_DATA_ERROR && d.memberStart && !d.rawDeflate) {
+            // Trailing garbage or zero padding after the last member
+            d.finished = true;
+            produced = capacity - zs.avail_out;
+            return true;
+        }
+        if (ret == Z_MEM_ERROR || ret == Z_DATA_ERROR || ret == Z_STREAM_ERROR) {
+            produced = capacity - zs.avail_out;
+            fail(QString("zlib error: %1").arg(QString::fromUtf8(zs.msg ? zs.msg : "unknown")));
+            return false;
+        }
+
+        if (ret == Z_STREAM_END) {
+            // End of a gzip member. A stream restored from a checkpoint is
+            // raw deflate, so its 8-byte trailer has to be skipped by hand.
+            if (d.rawDeflate) {
+                int skip = 8;
+                while (skip > 0) {
+                    if (zs.avail_in == 0 && !refillInput())
+                        break;
+                    const uInt n = qMin<uInt>(zs.avail_in, static_cast<uInt>(skip));
+                    zs.next_in += n;
+                    zs.avail_in -= n;
+                    skip -= static_cast<int>(n);
+                }
+            }
+            d.rawDeflate = false;
+            d.memberStart = true;
+            inflateReset2(&zs, GZIP_AUTO_HEADER);
+            continue;
+        }
+
+        if (inputExhausted && outBefore == zs.avail_out && inBefore == zs.avail_in) {
+            // Out of input with nothing left to flush. Only a closed-off
+            // member is a clean end.
+            d.finished = true;
+            produced = capacity - zs.avail_out;
+            if (!d.memberStart) {
+                fail("Compressed stream is truncated");
+                return false;
+            }
+            return true;
+        }
+
+        // Deflate block boundary that is not the last block: a valid
+        // place to resume decoding from later.
+        if ((zs.data_type & 128) && !(zs.data_type & 64)) {
+            const qint64 outPos = m_decodedPos + (capacity - zs.avail_out);
+            maybeAddCheckpoint(outPos, d.inFileOffset - zs.avail_in, zs.data_type & 7);
+        }
+    }
+    produced = capacity;
+    return true;
+}
+
+bool CompressedFile::decodeZstd(char* out, qint64 capacity, qint64& produced)
+{
+#ifdef HAVE_ZSTD
+    Decoder& d = *m_dec;
+    ZSTD_outBuffer zout{out, static_cast<size_t>(capacity), 0};
+
+    while (zout.pos < zout.size) {
+        // Frames decode independently, so every frame start is a checkpoint
+        // candidate.
+        bool inputExhausted = false;
+        if (d.zin.pos == d.zin.size) {
+            if (d.frameComplete)
+                maybeAddCheckpoint(m_decodedPos + static_cast<qint64>(zout.pos), d.inFileOffset, 0);
+            inputExhausted = !refillInput();
+            if (inputExhausted && d.frameComplete) {
+                d.finished = true;
+                produced = static_cast<qint64>(zout.pos);
+                return true;
+            }
+        } else if (d.frameComplete) {
+            maybeAddCheckpoint(m_decodedPos + static_cast<qint64>(zout.pos),
+                               d.inFileOffset - static_cast<qint64>(d.zin.size - d.zin.pos), 0);
+        }
+
+        const size_t outBefore = zout.pos;
+        const size_t ret = ZSTD_decompressStream(d.zstd, &zout, &d.zin);
+        if (ZSTD_isError(ret)) {
+            produced = static_cast<qint64>(zout.pos);
+            fail(QString("zstd error: %1").arg(QString::fromUtf8(ZSTD_getErrorName(ret))));
+            return false;
+        }
+        d.frameComplete = (ret == 0);
+        if (inputExhausted && zout.pos == outBefore && !d.frameComplete) {
+            d.finished = true;
+            produced = static_cast<qint64>(zout.pos);
+            fail("Compressed stream is truncated");
+            return false;
+        }
+    }
+    produced = capacity;
+    return true;
+#else
+    Q_UNUSED(out);
+    Q_UNUSED(capacity);
+    produced = 0;
+    fail("This build has no zstd support");
+    return false;
+#endif
+}
+
+void CompressedFile::maybeAddCheckpoint(qint64 outPos, qint64 inPos, int bits)
+{
+    // Checkpoints are kept in increasing order; revisiting a region that is
+    // already covered adds nothing.
+    const qint64 lastOut = m_checkpoints.isEmpty() ? 0 : m_checkpoints.last().out;
+    if (outPos < lastOut + CHECKPOINT_SPAN)
+        return;
+
+    Checkpoint cp;
+    cp.out = outPos;
+    cp.in = inPos;
+    cp.bits = bits;
+    if (m_codec == Gzip) {
+        // History up to outPos is the tail of m_history at this moment
+        const qint64 historyEnd = outPos - m_historyStart;
+        const qint64 len = qMin<qint64>(DEFLATE_WINDOW, historyEnd);
+        cp.window = qCompress(m_history.mid(historyEnd - len, len), 1);
+    }
+    m_checkpoints.append(cp);
+}
+
+void CompressedFile::readSeekTable()
+{
+    const qint64 fileSize = m_source.size();
+    if (fileSize < SKIPPABLE_HEADER + SEEK_FOOTER || !m_source.seek(fileSize - SEEK_FOOTER))
+        return;
+    const QByteArray footer = m_source.read(SEEK_FOOTER);
+    if (footer.size() != SEEK_FOOTER || qFromLittleEndian<quint32>(footer.constData() + 5) != SEEKABLE_MAGIC)
+        return; // not a seekable file
+
+    const quint32 frames = qFromLittleEndian<quint32>(footer.constData());
+    const uchar descriptor = static_cast<uchar>(footer[4]);
+    const int entrySize = (descriptor & SEEK_CHECKSUM_FLAG) ? 12 : 8;
+    const qint64 tableSize = static_cast<qint64>(frames) * entrySize + SEEK_FOOTER;
+    const qint64 tableStart = fileSize - SKIPPABLE_HEADER - tableSize;
+    if ((descriptor & SEEK_RESERVED_BITS) || frames >= MAX_SEEK_FRAMES || tableStart < 0
+        || !m_source.seek(tableStart)) {
+        qWarning() << "CompressedFile: ignoring invalid zstd seek table in" << m_source.fileName();
+        return;
+    }
+    const QByteArray table = m_source.read(SKIPPABLE_HEADER + tableSize - SEEK_FOOTER);
+    if (table.size() != SKIPPABLE_HEADER + tableSize - SEEK_FOOTER
+        || qFromLittleEndian<quint32>(table.constData()) != SKIPPABLE_SEEK_MAGIC
+        || qFromLittleEndian<quint32>(table.constData() + 4) != tableSize) {
+        qWarning() << "CompressedFile: ignoring invalid zstd seek table in" << m_source.fileName();
+        return;
+    }
+
+    // Frame starts become checkpoints, spaced as maybeAddCheckpoint() would
+    QVector<Checkpoint> checkpoints;
+    qint64 in = 0, out = 0, lastOut = 0;
+    for (quint32 i = 0; i < frames; ++i) {
+        if (out >= lastOut + CHECKPOINT_SPAN) {
+            Checkpoint cp;
+            cp.out = out;
+            cp.in = in;
+            checkpoints.append(cp);
+            lastOut = out;
+        }
+        const char* entry = table.constData() + SKIPPABLE_HEADER + static_cast<qint64>(i) * entrySize;
+        in += qFromLittleEndian<quint32>(entry);
+        out += qFromLittleEndian<quint32>(entry + 4);
+    }
+    // The frames must tile the file up to the seek table
+    if (in != tableStart) {
+        qWarning() << "CompressedFile: ignoring zstd seek table that does not match the frames in"
+                   << m_source.fileName();
+        return;
+    }
+    qDebug() << "CompressedFile: read zstd seek table," << frames << "frames," << checkpoints.size() << "checkpoints";
+    m_checkpoints = checkpoints;
+}
+
+void CompressedFile::trimHistory()
+{
+    // Keep enough decoded data behind the decoder for the deflate window and
+    // for short backward reads (e.g. re-reading the current line).
+    // Trimming is batched so the memmove cost stays small per decoded byte.
+    if (m_history.size() <= 4 * HISTORY_KEEP)
+        return;
+    const qint64 drop = m_history.size() - HISTORY_KEEP;
+    m_history.remove(0, drop);
+    m_historyStart += drop;
+}
+
+void CompressedFile::fail(const QString& message)
+{
+    qWarning() << "CompressedFile:" << message << "in" << m_source.fileName();
+    setErrorString(message);
+    if (m_dec)
+        m_dec->finished = true;
+}
+
+QByteArray CompressedFile::saveIndex() const
+{
+    QByteArray blob;
+    if (!isIndexComplete())
+        return blob;
+    QDataStream out(&blob, QIODevice::WriteOnly);
+    out << INDEX_MAGIC << INDEX_VERSION << static_cast<qint32>(m_codec) << m_totalSize
+        << static_cast<qint32>(m_checkpoints.size());
+    for (const Checkpoint& cp : m_checkpoints)
+        out << cp.out << cp.in << static_cast<qint32>(cp.bits) << cp.window;
+    return blob;
+}
+
+bool CompressedFile::loadIndex(const QByteArray& blob)
+{
+    QDataStream in(blob);
+    quint32 magic = 0, version = 0;
+    qint32 codec = -1, count = 0;
+    qint64 totalSize = -1;
+    in >> magic >> version >> codec >> totalSize >> count;
+    if (in.status() != QDataStream::Ok || magic != INDEX_MAGIC || version != INDEX_VERSION
+        || codec != static_cast<qint32>(m_codec) || totalSize < 0 || count < 0)
+        return false;
+
+    QVector<Checkpoint> checkpoints;
+    checkpoints.reserve(count);
+    qint64 lastOut = -1;
+    for (qint32 i = 0; i < count; ++i) {
+        Checkpoint cp;
+        qint32 bits = 0;
+        in >> cp.out >> cp.in >> bits >> cp.window;
+        if (in.status() != QDataStream::Ok || cp.out <= lastOut || cp.out > totalSize
+            || cp.in < 0 || bits < 0 || bits > 7)
+            return false;
+        cp.bits = bits;
+        lastOut = cp.out;
+        checkpoints.append(cp);
+    }
+    m_checkpoints = checkpoints;
+    m_totalSize = totalSize;
+    return true;
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include <QIODevice>
+#include <QFile>
+#include <QByteArray>
+#include <QVector>
+#include <QString>
+#include <memory>
+
+/**
+ * @brief CompressedFile is a random-access QIODevice over a gzip or zstd file.
+ *
+ * Positions are uncompressed byte offsets. While data is decoded the device
+ * records checkpoints roughly every CHECKPOINT_SPAN bytes (zran-style deflate
+ * block boundaries for gzip, frame boundaries for zstd), so a later seek only
+ * decompresses from the nearest checkpoint. The checkpoint index can be saved
+ * and restored with saveIndex()/loadIndex(). A zstd file in the seekable
+ * format (as written by t2sz) gets its checkpoints from the seek table
+ * when opened. A zstd file written as one frame (the zstd tool's default)
+ * has no checkpoints, so every seek in it decodes from the start; see
+ * seeksFromStart().
+ */
+class CompressedFile : public QIODevice {
+    Q_OBJECT
+public:
+    enum Codec {
+        Gzip,
+        Zstd
+    };
+
+    static constexpr qint64 CHECKPOINT_SPAN = 1024 * 1024;  // uncompressed bytes between checkpoints
+
+    static bool isCompressedPath(const QString& path);
+    static bool isSupported(Codec codec);
+
+    explicit CompressedFile(const QString& path, QObject* parent = nullptr);
+    ~CompressedFile() override;
+
+    Codec codec() const;
+    bool open(OpenMode mode) override;
+    void close() override;
+    bool isSequential() const override;
+    bool seek(qint64 pos) override;
+    qint64 pos() const override;
+    qint64 size() const override;
+    bool atEnd() const override;
+    qint64 bytesAvailable() const override;
+
+    // True once the whole stream has been decoded, i.e. size() is exact and
+    // the checkpoint list covers the file.
+    bool isIndexComplete() const;
+    // True for a fully decoded zstd file larger than CHECKPOINT_SPAN that has
+    // no checkpoints (a single frame): random reads are slow in it
+    bool seeksFromStart() const;
+    QByteArray saveIndex() const;
+    bool loadIndex(const QByteArray& blob);
+
+protected:
+    qint64 readData(char* data, qint64 maxSize) override;
+    qint64 readLineData(char* data, qint64 maxSize) override;
+    qint64 writeData(const char* data, qint64 maxSize) override;
+
+private:
+    struct Checkpoint {
+        qint64 out = 0;     // uncompressed offset
+        qint64 in = 0;      // compressed offset of the first whole byte
+        int bits = 0;       // gzip: unused bits of the byte before 'in'
+        QByteArray window;  // gzip: qCompress()ed 32K history preceding 'out'
+    };
+    struct Decoder;
+
+    Codec m_codec;
+    QFile m_source;
+    std::unique_ptr<Decoder> m_dec;
+    QVector<Checkpoint> m_checkpoints;
+    qint64 m_totalSize = -1;
+    qint64 m_pos = 0;
+
+    // Decoded bytes [m_historyStart, m_decodedPos) currently held in memory
+    QByteArray m_history;
+    qint64 m_historyStart = 0;
+    qint64 m_decodedPos = 0;
+
+    bool ensureAvailable(qint64 target);
+    bool decodeMore();
+    bool decodeGzip(char* out, qint64 capacity, qint64& produced);
+    bool decodeZstd(char* out, qint64 capacity, qint64& produced);
+    bool restartAt(const Checkpoint* cp);
+    bool refillInput();
+    void maybeAddCheckpoint(qint64 outPos, qint64 inPos, int bits);
+    void readSeekTable();  // zstd seekable format; caller seeks m_source afterwards
+    void trimHistory();
+    void fail(const QString& message);
+};
@@ -82,4 +82,60 @@ QStringList parseCsvLine(const QString& line)
     return fields;
 }
 
+QStringList parseCsvLinePrefix(const QByteArray& line, int maxFieldBytes)
+{
+    // Quotes, commas and backslashes are ASCII, so the line can be split on
+    // its bytes; only the kept prefix of each field is decoded
+    QStringList fields;
+    QByteArray current;
+    current.reserve(maxFieldBytes);
+    bool truncated = false;
+    bool inQuotes = false;
+    bool escapeNext = false;
+
+    auto append = [&](char c) {
+        if (current.size() < maxFieldBytes)
+            current += c;
+        else
+            truncated = true;
+    };
+    auto finishField = [&]() {
+        if (!truncated) {
+            fields.append(QString::fromUtf8(current));
+        } else {
+            // Drop a multi-byte character cut in half
+            int lead = current.size() - 1;
+            while (lead > 0 && (static_cast<uchar>(current[lead]) & 0xC0) == 0x80)
+                --lead;
+            const uchar b = lead >= 0 ? static_cast<uchar>(current[lead]) : 0;
+            const int length = b >= 0xF0 ? 4 : b >= 0xE0 ? 3 : b >= 0xC0 ? 2 : 1;
+            if (lead >= 0 && lead + length > current.size())
+                current.truncate(lead);
+            fields.append(QString::fromUtf8(current) + QChar(0x2026));
+        }
+        current.resize(0);  // keeps the reserved buffer
+        truncated = false;
+    };
+
+    for (const char c : line) {
+        if (escapeNext) {
+            append(c);
+            escapeNext = false;
+        } else if (c == '\\') {
+            escapeNext = true;
+        } else if (c == '"') {
+            inQuotes = !inQuotes;
+        } else if (c == ',' && !inQuotes) {
+            finishField();
+            if (fields.size() >= MAX_FIELDS_PER_LINE) {
+                throw std::runtime_error("CSV line exceeds maximum field count limit");
+            }
+        } else {
+            append(c);
+        }
+    }
+    finishField();
+    return fields;
+}
+
 } // namespace FileUtils 
\ No newline at end of file
@@ -15,6 +15,10 @@ namespace FileUtils {
     QString baseName(const QString& path);
     QStringList sniffCsvHeader(const QString& filePath);
     QStringList parseCsvLine(const QString& line);
+    // Tokenizes raw UTF-8 like parseCsvLine(), but decodes at most
+    // maxFieldBytes of each field; longer fields end in "…". Long lines and
+    // fields are not rejected, as only their prefix is kept.
+    QStringList parseCsvLinePrefix(const QByteArray& line, int maxFieldBytes);
     
     // Security validation functions
     void validateCsvLine(const QString& line);
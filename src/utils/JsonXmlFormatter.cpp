@@ -1,9 +1,67 @@
 #include "JsonXmlFormatter.h"
-#include <QJsonDocument>
-#include <QJsonParseError>
-#include <QDomDocument>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+#include <QVector>
 #include <QDebug>
 
+namespace {
+
+constexpr int JSON_INDENT = 4;
+constexpr int XML_INDENT = 2;
+
+void appendIndent(QString& out, int depth)
+{
+    out += '\n';
+    for (int k = 0; k < depth * JSON_INDENT; ++k)
+        out += ' ';
+}
+
+bool isJsonWhitespace(QChar c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+bool isAsciiDigit(QChar c)
+{
+    return c >= '0' && c <= '9';
+}
+
+// true, false, null or a number: -?(0|[1-9]\d*)(\.\d+)?([eE][+-]?\d+)?
+bool isJsonLiteral(QStringView token)
+{
+    if (token == u"true" || token == u"false" || token == u"null")
+        return true;
+    qsizetype i = 0;
+    const qsizetype n = token.size();
+    auto digits = [&]() {
+        const qsizetype start = i;
+        while (i < n && isAsciiDigit(token[i]))
+            ++i;
+        return i > start;
+    };
+    if (i < n && token[i] == '-')
+        ++i;
+    if (i < n && token[i] == '0')
+        ++i;
+    else if (!digits())
+        return false;
+    if (i < n && token[i] == '.') {
+        ++i;
+        if (!digits())
+            return false;
+    }
+    if (i < n && (token[i] == 'e' || token[i] == 'E')) {
+        ++i;
+        if (i < n && (token[i] == '+' || token[i] == '-'))
+            ++i;
+        if (!digits())
+            return false;
+    }
+    return i == n;
+}
+
+} // namespace
+
 bool JsonXmlFormatter::isValidForParsing(const QString& text)
 {
     // Check size limit
@@ -17,21 +75,7 @@ bool JsonXmlFormatter::isValidForParsing(const QString& text)
         return false;
     }
     
-    // Check for excessive nesting in XML-like content
-    int nestingLevel = 0;
-    int maxNesting = 0;
-    for (const QChar& c : text) {
-        if (c == '<') {
-            nestingLevel++;
-            maxNesting = qMax(maxNesting, nestingLevel);
-            if (maxNesting > MAX_XML_DEPTH) {
-                return false;
-            }
-        } else if (c == '>') {
-            nestingLevel = qMax(0, nestingLevel - 1);
-        }
-    }
-    
+    // Nesting depth is enforced by the streaming formatters themselves.
     return true;
 }
 
@@ -42,38 +86,190 @@ QString JsonXmlFormatter::formatIfApplicable(const QString& rawText)
         qDebug() << "Content too large or potentially malicious for parsing, returning as-is";
         return rawText;
     }
-    
-    // Try JSON
-    QJsonParseError jsonError;
-    QJsonDocument jsonDoc = QJsonDocument::fromJson(rawText.toUtf8(), &jsonError);
-    if (jsonError.error == QJsonParseError::NoError && !jsonDoc.isNull()) {
-        QString formatted = jsonDoc.toJson(QJsonDocument::Indented);
-        // Additional size check on output
-        if (formatted.size() > MAX_PARSE_SIZE * 2) {
+
+    // Dispatch on the first significant character so plain text is never
+    // run through either formatter.
+    int start = 0;
+    while (start < rawText.size() && isJsonWhitespace(rawText[start]))
+        ++start;
+    if (start == rawText.size())
+        return rawText;
+
+    QString formatted;
+    const QChar first = rawText[start];
+    if (first == '{' || first == '[') {
+        if (formatJson(rawText, formatted))
+            return formatted;
+    } else if (first == '<') {
+        if (formatXml(rawText, formatted))
+            return formatted;
+    }
+
+    // Not JSON or XML, or parsing failed
+    return rawText;
+}
+
+bool JsonXmlFormatter::formatJson(const QString& text, QString& out)
+{
+    // Token-level re-indenter. A small state machine checks the structure as
+    // it goes so that bracketed plain text ("[CRON] [123]: ...") is rejected.
+    enum Expect { Value, Key, Colon, CommaOrEnd, Done };
+
+    QVector<QChar> stack; // open brackets
+    Expect expect = Value;
+    const int n = text.size();
+    out.clear();
+    out.reserve(n + n / 2);
+
+    auto afterValue = [&]() { expect = stack.isEmpty() ? Done : CommaOrEnd; };
+
+    for (int i = 0; i < n; ++i) {
+        const QChar c = text[i];
+        if (isJsonWhitespace(c))
+            continue;
+        if (expect == Done)
+            return false;
+
+        if (c == '{' || c == '[') {
+            if (expect != Value || stack.size() >= MAX_JSON_DEPTH)
+                return false;
+            const QChar close = (c == '{') ? '}' : ']';
+            out += c;
+            int j = i + 1;
+            while (j < n && isJsonWhitespace(text[j]))
+                ++j;
+            if (j < n && text[j] == close) {
+                out += close; // empty container stays on one line
+                i = j;
+                afterValue();
+                continue;
+            }
+            stack.append(c);
+            appendIndent(out, stack.size());
+            expect = (c == '{') ? Key : Value;
+        } else if (c == '}' || c == ']') {
+            if (expect != CommaOrEnd || stack.isEmpty())
+                return false;
+            if (stack.last() != (c == '}' ? '{' : '['))
+                return false;
+            stack.removeLast();
+            appendIndent(out, stack.size());
+            out += c;
+            afterValue();
+        } else if (c == ',') {
+            if (expect != CommaOrEnd)
+                return false;
+            out += ',';
+            appendIndent(out, stack.size());
+            expect = (stack.last() == '{') ? Key : Value;
+        } else if (c == ':') {
+            if (expect != Colon)
+                return false;
+            out += ": ";
+            expect = Value;
+        } else if (c == '"') {
+            if (expect != Value && expect != Key)
+                return false;
+            int j = i + 1;
+            while (j < n && text[j] != '"') {
+                if (text[j] == '\\')
+                    ++j;
+                ++j;
+            }
+            if (j >= n)
+                return false; // unterminated string
+            out += QStringView(text).mid(i, j - i + 1);
+            i = j;
+            if (expect == Key)
+                expect = Colon;
+            else
+                afterValue();
+        } else {
+            if (expect != Value)
+                return false;
+            int j = i;
+            while (j < n && !isJsonWhitespace(text[j]) && text[j] != ',' && text[j] != ':'
+                   && text[j] != ']' && text[j] != '}' && text[j] != '[' && text[j] != '{'
+                   && text[j] != '"')
+                ++j;
+            const QStringView token = QStringView(text).mid(i, j - i);
+            if (!isJsonLiteral(token))
+                return false;
+            out += token;
+            i = j - 1;
+            afterValue();
+        }
+
+        if (out.size() > MAX_PARSE_SIZE * 2) {
             qDebug() << "Formatted JSON too large, returning original";
-            return rawText;
+            return false;
         }
-        return formatted;
     }
-    
-    // Try XML (with entity resolution disabled for security)
-    QDomDocument xmlDoc;
-    QString xmlErrMsg;
-    int xmlErrLine, xmlErrCol;
-    
-    // Configure XML parser to be more secure
-    xmlDoc.setContent(rawText, false, &xmlErrMsg, &xmlErrLine, &xmlErrCol);  // Disable namespace processing
-    
-    if (xmlErrMsg.isEmpty()) {
-        QString formatted = xmlDoc.toString(2);
-        // Additional size check on output
-        if (formatted.size() > MAX_PARSE_SIZE * 2) {
+    return expect == Done;
+}
+
+bool JsonXmlFormatter::formatXml(const QString& text, QString& out)
+{
+    QXmlStreamReader reader(text);
+    out.clear();
+    out.reserve(text.size() + text.size() / 2);
+    QXmlStreamWriter writer(&out);
+    writer.setAutoFormatting(true);
+    writer.setAutoFormattingIndent(XML_INDENT);
+
+    int depth = 0;
+    while (!reader.atEnd()) {
+        switch (reader.readNext()) {
+        case QXmlStreamReader::DTD:
+        case QXmlStreamReader::EntityReference:
+            return false; // refuse anything that could expand entities
+        case QXmlStreamReader::StartDocument:
+        case QXmlStreamReader::EndDocument:
+            continue;
+        case QXmlStreamReader::StartElement:
+            if (++depth > MAX_XML_DEPTH)
+                return false;
+            break;
+        case QXmlStreamReader::EndElement:
+            --depth;
+            break;
+        case QXmlStreamReader::Characters:
+            if (reader.isWhitespace())
+                continue; // the writer re-indents
+            break;
+        default:
+            break;
+        }
+        writer.writeCurrentToken(reader);
+
+        if (out.size() > MAX_PARSE_SIZE * 2) {
             qDebug() << "Formatted XML too large, returning original";
-            return rawText;
+            return false;
         }
-        return formatted;
     }
-    
-    // Not JSON or XML, or parsing failed
-    return rawText;
-} 
\ No newline at end of file
+    if (reader.hasError())
+        return false;
+
+    // The writer leaves a trailing newline after the root element.
+    while (out.endsWith('\n'))
+        out.chop(1);
+    return true;
+}
+
+QString JsonXmlFormatter::toSingleLine(const QString& rawText)
+{
+    QString result;
+    result.reserve(rawText.size());
+    bool lastWasBreak = false;
+    for (const QChar& c : rawText) {
+        if (c == '\n' || c == '\r' || c == '\t') {
+            if (!lastWasBreak)
+                result += ' ';
+            lastWasBreak = true;
+        } else {
+            result += c;
+            lastWasBreak = false;
+        }
+    }
+    return result;
+}
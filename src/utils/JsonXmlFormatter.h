@@ -3,13 +3,26 @@
 
 /**
  * @brief JsonXmlFormatter provides pretty-printing for embedded JSON or XML.
+ *
+ * Both formatters work in a single streaming pass over the input and never
+ * build a document tree, so memory use is bounded by the size of the output.
  */
 class JsonXmlFormatter {
 public:
     // Security limits for parsing
-    static constexpr int MAX_PARSE_SIZE = 1024 * 1024;  // 1MB limit
-    static constexpr int MAX_XML_DEPTH = 100;            // XML nesting limit
+    static constexpr int MAX_PARSE_SIZE = 16 * 1024 * 1024;  // 16MB limit
+    static constexpr int MAX_XML_DEPTH = 100;                // XML nesting limit
+    static constexpr int MAX_JSON_DEPTH = 100;               // JSON nesting limit
     
     static QString formatIfApplicable(const QString& rawText);
+    // Cheap one-pass rendering for table cells: line breaks and tabs become
+    // single spaces. Never parses, so it is safe to call on every repaint.
+    static QString toSingleLine(const QString& rawText);
     static bool isValidForParsing(const QString& text);
-}; 
\ No newline at end of file
+
+private:
+    // Each returns false (leaving out unspecified) if the input is not
+    // well-formed or breaks one of the limits above.
+    static bool formatJson(const QString& text, QString& out);
+    static bool formatXml(const QString& text, QString& out);
+};
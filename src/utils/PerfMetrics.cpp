@@ -0,0 +1,179 @@
+#include "PerfMetrics.h"
+#include <QJsonArray>
+#include <QStringList>
+#include <cmath>
+
+void LatencyHistogram::record(qint64 nsecs)
+{
+    const quint64 us = static_cast<quint64>(qMax<qint64>(0, nsecs)) / 1000;
+    int bucket = 0;
+    if (us > 0)
+        bucket = qMin(BUCKETS - 1, 64 - __builtin_clzll(us));  // bit length of us
+    m_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    m_totalNs.fetch_add(static_cast<quint64>(qMax<qint64>(0, nsecs)), std::memory_order_relaxed);
+}
+
+void LatencyHistogram::reset()
+{
+    for (auto& b : m_buckets)
+        b.store(0, std::memory_order_relaxed);
+    m_totalNs.store(0, std::memory_order_relaxed);
+}
+
+quint64 LatencyHistogram::count() const
+{
+    quint64 n = 0;
+    for (const auto& b : m_buckets)
+        n += b.load(std::memory_order_relaxed);
+    return n;
+}
+
+double LatencyHistogram::totalMs() const
+{
+    return m_totalNs.load(std::memory_order_relaxed) / 1e6;
+}
+
+double LatencyHistogram::percentileUs(double p) const
+{
+    const quint64 n = count();
+    if (n == 0)
+        return 0;
+    const quint64 target = static_cast<quint64>(std::ceil(p * n));
+    quint64 seen = 0;
+    for (int i = 0; i < BUCKETS; ++i) {
+        seen += m_buckets[i].load(std::memory_order_relaxed);
+        if (seen >= target)
+            return std::ldexp(1.0, i);  // upper bound: 2^i µs
+    }
+    return std::ldexp(1.0, BUCKETS - 1);
+}
+
+QJsonObject LatencyHistogram::toJson() const
+{
+    QJsonObject o;
+    QJsonArray buckets;
+    for (const auto& b : m_buckets)
+        buckets.append(static_cast<qint64>(b.load(std::memory_order_relaxed)));
+    o["count"] = static_cast<qint64>(count());
+    o["total_ms"] = totalMs();
+    o["p50_us"] = percentileUs(0.50);
+    o["p90_us"] = percentileUs(0.90);
+    o["p99_us"] = percentileUs(0.99);
+    o["buckets_log2_us"] = buckets;
+    return o;
+}
+
+void PerfMetrics::resetCounters()
+{
+    linesRead = 0;
+    bytesRead = 0;
+    batchReads = 0;
+    rowCacheHits = 0;
+    rowCacheMisses = 0;
+    prefetchedRows = 0;
+    formatCacheHits = 0;
+    formatCacheMisses = 0;
+    dataLatency.reset();
+    paintLatency.reset();
+}
+
+void PerfMetrics::recordSearch(qint64 ms, qint64 readMs, qint64 parseMs, qint64 rows, qint64 matches)
+{
+    QMutexLocker locker(&m_searchMutex);
+    ++m_search.count;
+    m_search.ms = ms;
+    m_search.readMs = readMs;
+    m_search.parseMs = parseMs;
+    m_search.rows = rows;
+    m_search.matches = matches;
+}
+
+PerfMetrics::SearchStats PerfMetrics::lastSearch() const
+{
+    QMutexLocker locker(&m_searchMutex);
+    return m_search;
+}
+
+QJsonObject PerfMetrics::toJson() const
+{
+    QJsonObject index;
+    index["build_ms"] = indexBuildMs;
+    index["from_cache"] = indexFromCache;
+
+    QJsonObject io;
+    io["backend"] = ioBackend;
+    io["lines_read"] = static_cast<qint64>(linesRead.load());
+    io["bytes_read"] = static_cast<qint64>(bytesRead.load());
+    io["batch_reads"] = static_cast<qint64>(batchReads.load());
+
+    const SearchStats last = lastSearch();
+    QJsonObject search;
+    search["count"] = static_cast<qint64>(last.count);
+    search["last_ms"] = last.ms;
+    search["last_read_ms"] = last.readMs;
+    search["last_parse_ms"] = last.parseMs;
+    search["last_rows"] = last.rows;
+    search["last_matches"] = last.matches;
+
+    QJsonObject cache;
+    const quint64 hits = formatCacheHits.load(), misses = formatCacheMisses.load();
+    cache["hits"] = static_cast<qint64>(hits);
+    cache["misses"] = static_cast<qint64>(misses);
+    cache["hit_rate"] = hits + misses > 0 ? double(hits) / (hits + misses) : 0.0;
+
+    QJsonObject rows;
+    const quint64 rowHits = rowCacheHits.load(), rowMisses = rowCacheMisses.load();
+    rows["hits"] = static_cast<qint64>(rowHits);
+    rows["misses"] = static_cast<qint64>(rowMisses);
+    rows["hit_rate"] = rowHits + rowMisses > 0 ? double(rowHits) / (rowHits + rowMisses) : 0.0;
+    rows["prefetched"] = static_cast<qint64>(prefetchedRows.load());
+
+    QJsonObject o;
+    o["index"] = index;
+    o["io"] = io;
+    o["row_cache"] = rows;
+    o["search"] = search;
+    o["format_cache"] = cache;
+    o["data_latency"] = dataLatency.toJson();
+    o["paint_latency"] = paintLatency.toJson();
+    return o;
+}
+
+QString PerfMetrics::summary() const
+{
+    QStringList lines;
+    lines << QString("Index build:        %1 ms%2").arg(indexBuildMs)
+                 .arg(indexFromCache ? QString(" (loaded from cache)") : QString());
+    lines << QString("Rows read:          %1 (%2 MB, %3 batched reads, %4)").arg(linesRead.load())
+                 .arg(bytesRead.load() / 1048576.0, 0, 'f', 1).arg(batchReads.load()).arg(ioBackend);
+    lines << QString("Row cache:          %1 hits, %2 misses, %3 rows prefetched")
+                 .arg(rowCacheHits.load()).arg(rowCacheMisses.load()).arg(prefetchedRows.load());
+    const SearchStats last = lastSearch();
+    if (last.ms >= 0) {
+        lines << QString("Last search:        %1 ms over %2 rows, %3 matches")
+                     .arg(last.ms).arg(last.rows).arg(last.matches);
+        lines << QString("  read / parse:     %1 ms / %2 ms").arg(last.readMs).arg(last.parseMs);
+    }
+    const quint64 hits = formatCacheHits.load(), misses = formatCacheMisses.load();
+    lines << QString("Format cache:       %1 hits, %2 misses").arg(hits).arg(misses);
+    lines << QString("data() calls:       %1, %2 ms total, p50 %3 µs, p99 %4 µs")
+                 .arg(dataLatency.count()).arg(dataLatency.totalMs(), 0, 'f', 1)
+                 .arg(dataLatency.percentileUs(0.5)).arg(dataLatency.percentileUs(0.99));
+    lines << QString("Paints:             %1, %2 ms total, p50 %3 µs, p99 %4 µs")
+                 .arg(paintLatency.count()).arg(paintLatency.totalMs(), 0, 'f', 1)
+                 .arg(paintLatency.percentileUs(0.5)).arg(paintLatency.percentileUs(0.99));
+
+    // A rough verdict: where did the time of the slow paths go?
+    QStringList verdict;
+    if (last.ms > 0 && last.readMs + last.parseMs > 0)
+        verdict << (last.readMs > last.parseMs ? "search is I/O-bound" : "search is parse-bound");
+    if (paintLatency.count() > 0) {
+        const double dataShare = dataLatency.totalMs() / qMax(paintLatency.totalMs(), 1e-3);
+        verdict << (dataShare > 0.5 ? "scrolling is dominated by row reads (data())"
+                                    : "scrolling is dominated by painting");
+    }
+    if (verdict.isEmpty())
+        verdict << "not enough data yet";
+    lines << QString("Verdict:            %1").arg(verdict.join("; "));
+    return lines.join('\n');
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <QJsonObject>
+#include <QMutex>
+#include <QString>
+#include <array>
+#include <atomic>
+
+/**
+ * @brief LatencyHistogram counts durations in power-of-two microsecond buckets.
+ *
+ * Bucket 0 holds calls under 1µs, bucket i holds [2^(i-1), 2^i) µs and the
+ * last bucket everything slower. Recording is a relaxed atomic increment, so
+ * it is cheap enough for per-call use and safe from worker threads.
+ */
+class LatencyHistogram {
+public:
+    static constexpr int BUCKETS = 24;  // last bucket: >= ~4s
+
+    void record(qint64 nsecs);
+    void reset();
+    quint64 count() const;
+    double totalMs() const;
+    double percentileUs(double p) const;  // upper bound of the bucket holding p
+    QJsonObject toJson() const;
+
+private:
+    std::array<std::atomic<quint64>, BUCKETS> m_buckets{};
+    std::atomic<quint64> m_totalNs{0};
+};
+
+/**
+ * @brief PerfMetrics collects per-timeline counters for the Performance dialog.
+ *
+ * Counters are updated on the hot paths (row reads, data(), search, paint);
+ * memory figures are filled in by the owner when a snapshot is taken.
+ */
+struct PerfMetrics {
+    // Line index
+    qint64 indexBuildMs = -1;
+    bool indexFromCache = false;
+
+    // Row reads through the file device
+    QString ioBackend;                      // IoBackend in use, or "compressed"
+    std::atomic<quint64> linesRead{0};
+    std::atomic<quint64> bytesRead{0};
+    std::atomic<quint64> batchReads{0};     // contiguous multi-row reads
+
+    // Parsed rows kept for the viewport, and rows read ahead of scrolling
+    std::atomic<quint64> rowCacheHits{0};
+    std::atomic<quint64> rowCacheMisses{0};
+    std::atomic<quint64> prefetchedRows{0};
+
+    // Last full-file search, split into read and parse/match time. Searches
+    // finish on worker threads, so the figures are kept together under a
+    // mutex and read as one snapshot.
+    struct SearchStats {
+        quint64 count = 0;
+        qint64 ms = -1;
+        qint64 readMs = 0;
+        qint64 parseMs = 0;
+        qint64 rows = 0;
+        qint64 matches = 0;
+    };
+    void recordSearch(qint64 ms, qint64 readMs, qint64 parseMs, qint64 rows, qint64 matches);
+    SearchStats lastSearch() const;
+
+    // Detail-window format cache
+    std::atomic<quint64> formatCacheHits{0};
+    std::atomic<quint64> formatCacheMisses{0};
+
+    LatencyHistogram dataLatency;   // TimelineModel::data(), DisplayRole
+    LatencyHistogram paintLatency;  // table viewport paint events
+
+    void resetCounters();
+    QJsonObject toJson() const;
+    QString summary() const;  // plain-text report, one figure per line
+
+private:
+    mutable QMutex m_searchMutex;
+    SearchStats m_search;
+};
@@ -0,0 +1,196 @@
+#include "RangeExporter.h"
+#include "CompressedFile.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <cerrno>
+#include <cstring>
+#include <cstdio>
+#include <limits>
+
+RangeExporter::RangeExporter(const QString& sourcePath, const QVector<Span>& spans,
+                             const QString& outPath, QObject* parent)
+    : QObject(parent), m_sourcePath(sourcePath), m_spans(spans), m_outPath(outPath)
+{
+}
+
+void RangeExporter::cancel() { m_cancelled = true; }
+
+QString RangeExporter::errorString() const { return m_error; }
+
+qint64 RangeExporter::bytesWritten() const { return m_written; }
+
+bool RangeExporter::fail(const QString& message)
+{
+    m_error = message;
+    return false;
+}
+
+bool RangeExporter::run()
+{
+    QElapsedTimer timer;
+    timer.start();
+    m_written = 0;
+    m_error.clear();
+
+    // Write to a temporary name and rename on success, so a cancelled or
+    // failed export never leaves a truncated CSV behind.
+    const QByteArray outPath = QFile::encodeName(m_outPath);
+    const QByteArray partPath = outPath + ".part";
+    const int outFd = ::open(partPath.constData(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (outFd < 0)
+        return fail(QString("Cannot create %1: %2").arg(m_outPath, QString::fromLocal8Bit(strerror(errno))));
+
+    const bool ok = CompressedFile::isCompressedPath(m_sourcePath) ? copyDecoded(outFd) : copyPlain(outFd);
+    if (::close(outFd) != 0 && ok)
+        m_error = QString("Cannot write %1: %2").arg(m_outPath, QString::fromLocal8Bit(strerror(errno)));
+    if (!ok || !m_error.isEmpty() || ::rename(partPath.constData(), outPath.constData()) != 0) {
+        if (m_error.isEmpty())
+            m_error = QString("Cannot rename to %1: %2").arg(m_outPath, QString::fromLocal8Bit(strerror(errno)));
+        ::unlink(partPath.constData());
+        return false;
+    }
+
+    qDebug() << "RangeExporter: wrote" << m_written << "bytes in" << m_spans.size() << "spans to"
+             << m_outPath << "in" << timer.elapsed() << "ms";
+    return true;
+}
+
+bool RangeExporter::copyPlain(int outFd)
+{
+    const int inFd = ::open(QFile::encodeName(m_sourcePath).constData(), O_RDONLY | O_CLOEXEC);
+    if (inFd < 0)
+        return fail(QString("Cannot open %1: %2").arg(m_sourcePath, QString::fromLocal8Bit(strerror(errno))));
+    struct stat st;
+    if (::fstat(inFd, &st) != 0) {
+        ::close(inFd);
+        return fail(QString("Cannot stat %1").arg(m_sourcePath));
+    }
+    const qint64 fileSize = st.st_size;
+#ifdef POSIX_FADV_SEQUENTIAL
+    ::posix_fadvise(inFd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    m_total = 0;
+    for (const Span& span : m_spans)
+        m_total += qMax<qint64>(0, (span.end < 0 ? fileSize : span.end) - span.begin);
+
+    qint64 outPos = 0;
+    bool useCopyRange = true;
+    QByteArray buffer;
+    for (const Span& span : m_spans) {
+        off_t inPos = span.begin;
+        qint64 remaining = (span.end < 0 ? fileSize : span.end) - span.begin;
+        while (remaining > 0) {
+            if (m_cancelled) {
+                ::close(inFd);
+                return fail("Export cancelled");
+            }
+            ssize_t n = -1;
+#ifdef __linux__
+            if (useCopyRange) {
+                off_t outOff = outPos;
+                n = ::copy_file_range(inFd, &inPos, outFd, &outOff, qMin(remaining, COPY_CHUNK), 0);
+                if (n < 0 && (errno == EXDEV || errno == ENOSYS || errno == EINVAL || errno == EOPNOTSUPP)) {
+                    // Cross-filesystem copies on older kernels, or filesystems
+                    // without support: copy through a buffer from here on.
+                    useCopyRange = false;
+                    continue;
+                }
+                if (n > 0)
+                    outPos = outOff;
+            } else
+#endif
+            {
+                if (buffer.isEmpty())
+                    buffer.resize(BUFFER_SIZE);
+                n = ::pread(inFd, buffer.data(), qMin(remaining, BUFFER_SIZE), inPos);
+                if (n > 0) {
+                    if (!writeAll(outFd, buffer.constData(), n, outPos)) {
+                        ::close(inFd);
+                        return false;
+                    }
+                    inPos += n;
+                }
+            }
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n < 0) {
+                const QString reason = QString::fromLocal8Bit(strerror(errno));
+                ::close(inFd);
+                return fail(QString("Copy failed: %1").arg(reason));
+            }
+            if (n == 0)
+                break; // file shrank underneath us; keep what was copied
+            remaining -= n;
+            reportProgress(n);
+        }
+    }
+    ::close(inFd);
+    return true;
+}
+
+bool RangeExporter::copyDecoded(int outFd)
+{
+    // Spans are ascending, so seeking forward through the device decodes the
+    // compressed stream at most once.
+    CompressedFile source(m_sourcePath);
+    if (!source.open(QIODevice::ReadOnly))
+        return fail(QString("Cannot open %1: %2").arg(m_sourcePath, source.errorString()));
+
+    m_total = 0;
+    for (const Span& span : m_spans)
+        m_total += span.end < 0 ? 0 : span.end - span.begin;
+
+    qint64 outPos = 0;
+    QByteArray buffer(BUFFER_SIZE, Qt::Uninitialized);
+    for (const Span& span : m_spans) {
+        if (!source.seek(span.begin))
+            return fail(QString("Cannot seek in %1").arg(m_sourcePath));
+        qint64 remaining = span.end < 0 ? std::numeric_limits<qint64>::max() : span.end - span.begin;
+        while (remaining > 0) {
+            if (m_cancelled)
+                return fail("Export cancelled");
+            const qint64 n = source.read(buffer.data(), qMin(remaining, BUFFER_SIZE));
+            if (n < 0)
+                return fail(QString("Cannot read %1: %2").arg(m_sourcePath, source.errorString()));
+            if (n == 0)
+                break;
+            if (!writeAll(outFd, buffer.constData(), n, outPos))
+                return false;
+            remaining -= n;
+            reportProgress(n);
+        }
+    }
+    return true;
+}
+
+bool RangeExporter::writeAll(int fd, const char* data, qint64 size, qint64& outPos)
+{
+    while (size > 0) {
+        const ssize_t n = ::pwrite(fd, data, size, outPos);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return fail(QString("Cannot write %1: %2").arg(m_outPath, QString::fromLocal8Bit(strerror(errno))));
+        data += n;
+        size -= n;
+        outPos += n;
+    }
+    return true;
+}
+
+void RangeExporter::reportProgress(qint64 bytes)
+{
+    // Roughly every 16MB; each emit is a queued event when run() is on a
+    // worker thread
+    const qint64 step = 16 * 1024 * 1024;
+    const bool crossed = (m_written / step) != ((m_written + bytes) / step);
+    m_written += bytes;
+    if (crossed || m_written == m_total)
+        emit progress(m_written, m_total);
+}
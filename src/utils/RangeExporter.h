@@ -0,0 +1,51 @@
+#pragma once
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <atomic>
+
+/**
+ * @brief RangeExporter copies byte ranges of a timeline file into a new file.
+ *
+ * Plain files are copied with copy_file_range() (falling back to pread/pwrite
+ * across filesystems), so the data never passes through user space when the
+ * kernel can avoid it. Compressed files are decoded once, front to back.
+ * run() blocks; call it from a worker thread and connect to progress().
+ */
+class RangeExporter : public QObject {
+    Q_OBJECT
+public:
+    struct Span {
+        qint64 begin = 0;
+        qint64 end = -1;    // exclusive; -1 = to the end of the file
+    };
+
+    RangeExporter(const QString& sourcePath, const QVector<Span>& spans,
+                  const QString& outPath, QObject* parent = nullptr);
+
+    bool run();
+    void cancel();
+    QString errorString() const;
+    qint64 bytesWritten() const;
+
+signals:
+    void progress(qint64 bytesDone, qint64 bytesTotal);
+
+private:
+    static constexpr qint64 COPY_CHUNK = 64 * 1024 * 1024;  // bytes per copy_file_range call
+    static constexpr qint64 BUFFER_SIZE = 1024 * 1024;      // pread/pwrite and decode buffer
+
+    QString m_sourcePath;
+    QVector<Span> m_spans;
+    QString m_outPath;
+    QString m_error;
+    qint64 m_written = 0;
+    qint64 m_total = 0;
+    std::atomic<bool> m_cancelled{false};
+
+    bool copyPlain(int outFd);
+    bool copyDecoded(int outFd);
+    bool writeAll(int fd, const char* data, qint64 size, qint64& outPos);
+    void reportProgress(qint64 bytes);
+    bool fail(const QString& message);
+};
@@ -0,0 +1,88 @@
+#include "SysmonFields.h"
+
+namespace SysmonFields {
+
+namespace {
+
+const QLatin1String DATA_OPEN("<Data Name=");
+const QLatin1String DATA_CLOSE("</Data>");
+
+QString unescapeXml(QStringView text)
+{
+    if (!text.contains(u'&'))
+        return text.toString();
+    QString result = text.toString();
+    result.replace(QLatin1String("&lt;"), QLatin1String("<"));
+    result.replace(QLatin1String("&gt;"), QLatin1String(">"));
+    result.replace(QLatin1String("&quot;"), QLatin1String("\""));
+    result.replace(QLatin1String("&apos;"), QLatin1String("'"));
+    result.replace(QLatin1String("&amp;"), QLatin1String("&"));
+    return result;
+}
+
+} // namespace
+
+const QStringList& defaultFields()
+{
+    static const QStringList fields = {
+        "Image", "ProcessId", "User", "DestinationIp", "DestinationPort"
+    };
+    return fields;
+}
+
+bool containsEventData(const QByteArray& rawLine)
+{
+    return rawLine.contains("<Data Name=");
+}
+
+int extract(QStringView message, const QStringList& names, QStringList& values)
+{
+    values.fill(QString(), names.size());
+    int found = 0;
+    qsizetype pos = 0;
+
+    while ((pos = message.indexOf(DATA_OPEN, pos)) >= 0) {
+        pos += DATA_OPEN.size();
+        if (pos >= message.size())
+            break;
+
+        // The attribute value is normally quoted, but the CSV reader strips
+        // doubled quotes, so bare names (<Data Name=Image>) are accepted too.
+        qsizetype nameStart = pos;
+        qsizetype nameEnd = pos;
+        const QChar quote = message[pos];
+        if (quote == '"' || quote == '\'') {
+            nameStart = pos + 1;
+            nameEnd = message.indexOf(quote, nameStart);
+            if (nameEnd < 0)
+                break;
+            pos = nameEnd + 1;
+        } else {
+            while (nameEnd < message.size() && message[nameEnd] != '>'
+                   && message[nameEnd] != '/' && !message[nameEnd].isSpace())
+                ++nameEnd;
+            pos = nameEnd;
+        }
+
+        const qsizetype tagEnd = message.indexOf(u'>', pos);
+        if (tagEnd < 0)
+            break;
+        const bool selfClosing = message[tagEnd - 1] == '/';
+        const int slot = names.indexOf(message.mid(nameStart, nameEnd - nameStart));
+        pos = tagEnd + 1;
+        if (selfClosing)
+            continue;
+
+        const qsizetype valueEnd = message.indexOf(DATA_CLOSE, pos);
+        if (valueEnd < 0)
+            break;
+        if (slot >= 0 && values[slot].isEmpty() && valueEnd > pos) {
+            values[slot] = unescapeXml(message.mid(pos, valueEnd - pos));
+            ++found;
+        }
+        pos = valueEnd + DATA_CLOSE.size();
+    }
+    return found;
+}
+
+} // namespace SysmonFields
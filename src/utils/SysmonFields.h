@@ -0,0 +1,21 @@
+#pragma once
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <QStringView>
+
+/**
+ * @brief SysmonFields pulls named <Data Name=...> values out of Sysmon EventData XML
+ * with a lightweight scanner (no XML parser, no DOM).
+ */
+namespace SysmonFields {
+    // Fields offered as virtual columns by default
+    const QStringList& defaultFields();
+
+    // Cheap byte-level pre-check used before decoding and parsing a line
+    bool containsEventData(const QByteArray& rawLine);
+
+    // Fills values[i] with the content of <Data Name="names[i]">. Missing
+    // fields are left empty. Returns the number of fields found.
+    int extract(QStringView message, const QStringList& names, QStringList& values);
+}
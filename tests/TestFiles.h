@@ -0,0 +1,41 @@
+#pragma once
+#include <QByteArray>
+#include <QDir>
+#include <QFile>
+#include <QList>
+#include <QString>
+#include <QTemporaryDir>
+
+/**
+ * @brief TestFiles writes the small timelines the timeline_core tests run on.
+ */
+namespace TestFiles {
+    inline const QByteArray SUPER_HEADER =
+        "datetime,timestamp_desc,source,source_long,message,parser,display_name,tag\n";
+
+    // Writes content to <dir>/<name>; returns the path, empty on error
+    inline QString write(const QTemporaryDir& dir, const QString& name, const QByteArray& content)
+    {
+        const QString path = QDir(dir.path()).filePath(name);
+        QFile file(path);
+        if (!file.open(QIODevice::WriteOnly) || file.write(content) != content.size())
+            return QString();
+        return path;
+    }
+
+    // A Super timeline: the header, then one line per row
+    inline QByteArray superTimeline(const QList<QByteArray>& rows)
+    {
+        QByteArray content = SUPER_HEADER;
+        for (const QByteArray& row : rows)
+            content += row + '\n';
+        return content;
+    }
+
+    // A Super row at 2023-03-15 00:00:<second> with the given message
+    inline QByteArray superRow(int second, const QByteArray& message, const QByteArray& source = "LOG")
+    {
+        return QByteArray("2023-03-15T00:00:") + QByteArray::number(second % 60).rightJustified(2, '0')
+             + "+00:00,Content Modification Time," + source + ",syslog,\"" + message + "\",syslog,/var/log/syslog,";
+    }
+}
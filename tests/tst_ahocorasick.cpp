@@ -0,0 +1,139 @@
+#include "core/AhoCorasick.h"
+#include <QRandomGenerator>
+#include <QtTest>
+#include <algorithm>
+#include <stdexcept>
+
+// AhoCorasick against a brute-force search: overlapping patterns, patterns
+// that are suffixes of others, case folding and ignored patterns
+class TestAhoCorasick : public QObject {
+    Q_OBJECT
+
+private:
+    using Hit = QPair<qsizetype, int>;  // (end, id)
+
+    // Every occurrence of every pattern kept by the automaton (the first of
+    // case-insensitive duplicates, no empty ones)
+    static QVector<Hit> bruteForce(const QList<QByteArray>& patterns, const QByteArray& text)
+    {
+        QVector<Hit> hits;
+        QList<QByteArray> kept;
+        const QByteArray lowerText = text.toLower();
+        for (int id = 0; id < patterns.size(); ++id) {
+            const QByteArray p = patterns[id].toLower();
+            if (p.isEmpty() || kept.contains(p))
+                continue;
+            kept.append(p);
+            for (qsizetype at = lowerText.indexOf(p); at >= 0; at = lowerText.indexOf(p, at + 1))
+                hits.append({at + p.size(), id});
+        }
+        std::sort(hits.begin(), hits.end());
+        return hits;
+    }
+
+    static QVector<Hit> findAll(const AhoCorasick& automaton, const QByteArray& text)
+    {
+        QVector<Hit> hits;
+        automaton.findAll(text.constData(), text.size(), [&](qsizetype end, int id) { hits.append({end, id}); });
+        std::sort(hits.begin(), hits.end());
+        return hits;
+    }
+
+    static QVector<int> matches(const AhoCorasick& automaton, const QByteArray& text)
+    {
+        QVector<int> ids;
+        automaton.matches(text.constData(), text.size(), ids);
+        return ids;
+    }
+
+private slots:
+    void overlapping()
+    {
+        const QList<QByteArray> patterns = {"he", "she", "his", "hers"};
+        const AhoCorasick automaton(patterns);
+        const QByteArray text = "ushers";
+        QCOMPARE(findAll(automaton, text), (QVector<Hit>{{4, 0}, {4, 1}, {6, 3}}));
+        QCOMPARE(findAll(automaton, text), bruteForce(patterns, text));
+        QCOMPARE(matches(automaton, text), QVector<int>({0, 1, 3}));
+        QCOMPARE(matches(automaton, "nothing here"), QVector<int>({0}));
+        QCOMPARE(matches(automaton, "xyz"), QVector<int>());
+    }
+
+    void caseInsensitive()
+    {
+        const AhoCorasick automaton(QList<QByteArray>{"Mimikatz", "psexec.EXE"});
+        QCOMPARE(matches(automaton, "C:\\Tools\\MIMIKATZ.exe"), QVector<int>({0}));
+        QCOMPARE(matches(automaton, "c:\\windows\\PsExec.exe -s"), QVector<int>({1}));
+        // Only ASCII letters are folded
+        const AhoCorasick accented(QList<QByteArray>{"\xc3\xa9t\xc3\xa9"});
+        QCOMPARE(matches(accented, "\xc3\xa9T\xc3\xa9"), QVector<int>({0}));
+        QCOMPARE(matches(accented, "\xc3\x89T\xc3\x89"), QVector<int>());
+    }
+
+    void ignoredPatterns()
+    {
+        const AhoCorasick automaton(QList<QByteArray>{"", "evil", "EVIL", "bad"});
+        QCOMPARE(automaton.patternCount(), 4);
+        QCOMPARE(automaton.pattern(2), QByteArray("EVIL"));
+        QCOMPARE(matches(automaton, "Evil and bad"), QVector<int>({1, 3}));
+        QCOMPARE(findAll(automaton, "evilevil"), (QVector<Hit>{{4, 1}, {8, 1}}));
+        QCOMPARE(matches(AhoCorasick(QList<QByteArray>()), "anything"), QVector<int>());
+    }
+
+    void binaryText()
+    {
+        const QList<QByteArray> patterns = {QByteArray("\x00\x01", 2), "\xff", "a\nb"};
+        const AhoCorasick automaton(patterns);
+        const QByteArray text("x\x00\x01\xff" "a\nb\x00", 8);
+        QCOMPARE(findAll(automaton, text), bruteForce(patterns, text));
+        QCOMPARE(matches(automaton, text), QVector<int>({0, 1, 2}));
+    }
+
+    // Random patterns over a small alphabet overlap in every possible way
+    void randomAgainstBruteForce()
+    {
+        QRandomGenerator rng(20230315);
+        auto randomText = [&](int length) {
+            QByteArray text;
+            for (int i = 0; i < length; ++i)
+                text += "abcAB"[rng.bounded(5)];
+            return text;
+        };
+        for (int round = 0; round < 50; ++round) {
+            QList<QByteArray> patterns;
+            const int count = 1 + rng.bounded(12);
+            for (int i = 0; i < count; ++i)
+                patterns.append(randomText(rng.bounded(6)));
+            const AhoCorasick automaton(patterns);
+            const QByteArray text = randomText(200);
+
+            const QVector<Hit> expected = bruteForce(patterns, text);
+            QCOMPARE(findAll(automaton, text), expected);
+            QVector<int> ids;
+            for (const Hit& hit : expected)
+                ids.append(hit.second);
+            std::sort(ids.begin(), ids.end());
+            ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+            QCOMPARE(matches(automaton, text), ids);
+        }
+    }
+
+    void tooLarge()
+    {
+        // A pattern with every byte value, long enough to exceed the table limit
+        QByteArray allBytes;
+        for (int c = 0; c < 256; ++c)
+            allBytes += static_cast<char>(c);
+        const int copies = static_cast<int>(AhoCorasick::MAX_TABLE_ENTRIES / (230LL * allBytes.size())) + 1;
+        bool thrown = false;
+        try {
+            AhoCorasick automaton(QList<QByteArray>{allBytes.repeated(copies)});
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        QVERIFY(thrown);
+    }
+};
+
+QTEST_GUILESS_MAIN(TestAhoCorasick)
+#include "tst_ahocorasick.moc"
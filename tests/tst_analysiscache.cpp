@@ -0,0 +1,148 @@
+#include "TestFiles.h"
+#include "core/AnalysisCache.h"
+#include "core/FilterEngine.h"
+#include "core/RowStore.h"
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QtTest>
+#include <atomic>
+#include <memory>
+
+// A timeline converted to an analysis cache and opened through RowStore
+// must read back exactly like the CSV it came from
+class TestAnalysisCache : public QObject {
+    Q_OBJECT
+
+private:
+    // Spans two string blocks, the second one partial
+    static constexpr int ROWS = AnalysisCache::BLOCK_ROWS + 1000;
+    QTemporaryDir m_dir;
+    std::unique_ptr<RowStore> m_source;
+    std::unique_ptr<RowStore> m_cached;
+    QString m_cachePath;
+
+    // Row i is i seconds after 2023-03-15T00:00:00
+    static QByteArray row(int i)
+    {
+        const QByteArray time = QString("2023-03-15T%1:%2:%3+00:00")
+                                    .arg(i / 3600, 2, 10, QChar('0'))
+                                    .arg(i / 60 % 60, 2, 10, QChar('0'))
+                                    .arg(i % 60, 2, 10, QChar('0'))
+                                    .toUtf8();
+        QByteArray message = "event " + QByteArray::number(i);
+        if (i % 10 == 0)
+            message += ", with \\\"quotes\\\" and a \\\\ backslash";
+        if (i % 100 == 0)
+            message += " caf\xc3\xa9";
+        const QByteArray source = (i % 3 == 0) ? "AUTH" : "LOG";  // a dictionary column
+        return time + ",Content Modification Time," + source + ",syslog,\"" + message + "\",syslog,/var/log/syslog,";
+    }
+
+private slots:
+    void initTestCase()
+    {
+        QStandardPaths::setTestModeEnabled(true);
+        QVERIFY(m_dir.isValid());
+        QList<QByteArray> rows;
+        for (int i = 0; i < ROWS; ++i)
+            rows.append(row(i));
+        rows[5] = "not a time,Content Modification Time,LOG,syslog,no timestamp,syslog,/var/log/syslog,";
+        const QString path = TestFiles::write(m_dir, "source.csv", TestFiles::superTimeline(rows));
+        QVERIFY(!path.isEmpty());
+        m_source = std::make_unique<RowStore>(path);
+        m_source->open();
+        QCOMPARE(m_source->rowCount(), ROWS);
+
+        m_cachePath = QDir(m_dir.path()).filePath("source.tlac");
+        const std::atomic<bool> cancel{false};
+        int lastDone = -1;
+        QVERIFY(AnalysisCache::convert(*m_source, m_cachePath, cancel, [&](int done, int total) {
+            QCOMPARE(total, 2 * ROWS);
+            QVERIFY(done >= lastDone);
+            lastDone = done;
+        }));
+        QCOMPARE(lastDone, 2 * ROWS);
+        QVERIFY(AnalysisCache::isCacheFile(m_cachePath));
+        QVERIFY(!AnalysisCache::isCacheFile(path));
+
+        m_cached = std::make_unique<RowStore>(m_cachePath);
+        m_cached->open();
+        QVERIFY(m_cached->analysisCache());
+    }
+
+    void cleanupTestCase()
+    {
+        m_cached.reset();
+        m_source.reset();
+    }
+
+    void layout()
+    {
+        const AnalysisCache* cache = m_cached->analysisCache();
+        QCOMPARE(m_cached->headers(), m_source->headers());
+        QCOMPARE(m_cached->type(), m_source->type());
+        QCOMPARE(m_cached->rowCount(), m_source->rowCount());
+        QCOMPARE(cache->blockCount(), 2);
+        QCOMPARE(QFileInfo(cache->sourcePath()).canonicalFilePath(),
+                 QFileInfo(m_source->filePath()).canonicalFilePath());
+        QVERIFY(cache->sourceUnchanged());
+        QVERIFY(cache->isDictionary(2));
+        QVERIFY(!cache->isDictionary(4));
+    }
+
+    void readBack()
+    {
+        for (int r = 0; r < ROWS; ++r) {
+            QStringList expected, actual;
+            QVERIFY(m_source->readFields(r, expected));
+            QVERIFY(m_cached->readFields(r, actual));
+            QCOMPARE(actual, expected);
+            QCOMPARE(m_cached->timestamp(r), m_source->timestamp(r));
+        }
+        QCOMPARE(m_cached->timestamp(5), TimelineParser::INVALID_TIMESTAMP);
+        QCOMPARE(m_cached->rowOffsets(0, ROWS), m_source->rowOffsets(0, ROWS));
+    }
+
+    void timeRange()
+    {
+        const qint64 from = m_source->timestamp(100);
+        const qint64 to = m_source->timestamp(AnalysisCache::BLOCK_ROWS + 10);
+        const QVector<int> rows = m_cached->rowsInTimeRange(from, to);
+        QCOMPARE(rows, m_source->rowsInTimeRange(from, to));
+        QCOMPARE(rows.first(), 100);
+        QCOMPARE(rows.last(), AnalysisCache::BLOCK_ROWS + 10);
+    }
+
+    // Searching the cache (through a CacheScan) finds the same rows
+    void filter_data()
+    {
+        QTest::addColumn<int>("column");
+        QTest::addColumn<QString>("term");
+        QTest::newRow("string column") << 4 << "quotes";
+        QTest::newRow("dictionary column") << 2 << "auth";
+        QTest::newRow("all columns") << -1 << QString::fromUtf8("CAFÉ");
+        QTest::newRow("timestamp column") << 0 << "T01:";
+    }
+
+    void filter()
+    {
+        QFETCH(int, column);
+        QFETCH(QString, term);
+        const FilterEngine engine(column, term);
+        const QVector<int> expected = engine.scan(*m_source);
+        QVERIFY(!expected.isEmpty());
+        QCOMPARE(engine.scan(*m_cached), expected);
+        QCOMPARE(engine.scan(*m_cached, 4), expected);
+    }
+
+    void cancelledConvert()
+    {
+        const QString path = QDir(m_dir.path()).filePath("cancelled.tlac");
+        const std::atomic<bool> cancel{true};
+        QVERIFY(!AnalysisCache::convert(*m_source, path, cancel));
+        QVERIFY(!QFile::exists(path));
+    }
+};
+
+QTEST_GUILESS_MAIN(TestAnalysisCache)
+#include "tst_analysiscache.moc"
@@ -0,0 +1,121 @@
+#include "utils/FileUtils.h"
+#include <QtTest>
+#include <stdexcept>
+
+// FileUtils::parseCsvLine(), and parseCsvLinePrefix() which must split lines
+// the same way while keeping only a prefix of each field
+class TestCsvParsing : public QObject {
+    Q_OBJECT
+
+private:
+    static bool throwsOnParse(const QString& line)
+    {
+        try {
+            FileUtils::parseCsvLine(line);
+        } catch (const std::runtime_error&) {
+            return true;
+        }
+        return false;
+    }
+
+private slots:
+    void parse_data()
+    {
+        QTest::addColumn<QString>("line");
+        QTest::addColumn<QStringList>("fields");
+        QTest::newRow("plain") << "a,b,c" << QStringList{"a", "b", "c"};
+        QTest::newRow("empty fields") << ",a,," << QStringList{"", "a", "", ""};
+        QTest::newRow("empty line") << "" << QStringList{""};
+        QTest::newRow("quoted comma") << "a,\"b,c\",d" << QStringList{"a", "b,c", "d"};
+        QTest::newRow("quotes inside a field") << "a\"b\"c" << QStringList{"abc"};
+        QTest::newRow("doubled quotes") << "\"say \"\"hi\"\"\"" << QStringList{"say hi"};
+        QTest::newRow("escaped comma") << "a\\,b,c" << QStringList{"a,b", "c"};
+        QTest::newRow("escaped quote") << "\"a\\\"b\",c" << QStringList{"a\"b", "c"};
+        QTest::newRow("escaped backslash") << "a\\\\,b" << QStringList{"a\\", "b"};
+        QTest::newRow("non-ASCII") << QString::fromUtf8("é,\"€,✓\"") << QStringList{QString::fromUtf8("é"), QString::fromUtf8("€,✓")};
+    }
+
+    void parse()
+    {
+        QFETCH(QString, line);
+        QFETCH(QStringList, fields);
+        QCOMPARE(FileUtils::parseCsvLine(line), fields);
+        // With room for every field, the prefix parser agrees
+        QCOMPARE(FileUtils::parseCsvLinePrefix(line.toUtf8(), 1024), fields);
+    }
+
+    void limits()
+    {
+        const QString maxFields = QString(",").repeated(FileUtils::MAX_FIELDS_PER_LINE - 1);
+        QCOMPARE(int(FileUtils::parseCsvLine(maxFields).size()), FileUtils::MAX_FIELDS_PER_LINE);
+        QVERIFY(throwsOnParse(maxFields + ","));
+
+        const QString maxField(FileUtils::MAX_FIELD_LENGTH, 'x');
+        QCOMPARE(int(FileUtils::parseCsvLine(maxField + ",y").first().size()), FileUtils::MAX_FIELD_LENGTH);
+        QVERIFY(throwsOnParse(maxField + "x,y"));
+        QVERIFY(throwsOnParse("y," + maxField + "x"));
+        QVERIFY(throwsOnParse(QString(FileUtils::MAX_LINE_LENGTH + 1, ',')));
+
+        // The prefix parser keeps its field count limit but not the length ones
+        bool thrown = false;
+        try {
+            FileUtils::parseCsvLinePrefix(maxFields.toUtf8() + ",", 16);
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        QVERIFY(thrown);
+        const QStringList longField = FileUtils::parseCsvLinePrefix(maxField.toUtf8() + "x,y", 16);
+        QCOMPARE(longField, QStringList({QString(16, 'x') + QChar(0x2026), "y"}));
+    }
+
+    void prefix_data()
+    {
+        QTest::addColumn<QByteArray>("line");
+        QTest::addColumn<int>("maxFieldBytes");
+        QTest::addColumn<QStringList>("fields");
+        const QString ellipsis(QChar(0x2026));
+        QTest::newRow("fits") << QByteArray("abc,de") << 3 << QStringList{"abc", "de"};
+        QTest::newRow("cut") << QByteArray("abcd,de") << 3 << QStringList{"abc" + ellipsis, "de"};
+        QTest::newRow("quotes not counted") << QByteArray("\"abc\",\"de,f\"") << 3
+                                            << QStringList{"abc", "de," + ellipsis};
+        QTest::newRow("escape not counted") << QByteArray("a\\,bc,d") << 4 << QStringList{"a,bc", "d"};
+        // "é" is two bytes and "€" three: a character cut in half is dropped
+        QTest::newRow("two-byte cut") << QByteArray("a\xc3\xa9z") << 2 << QStringList{"a" + ellipsis};
+        QTest::newRow("two-byte kept") << QByteArray("a\xc3\xa9z") << 3 << QStringList{QString::fromUtf8("aé") + ellipsis};
+        QTest::newRow("three-byte cut") << QByteArray("\xe2\x82\xac\xe2\x82\xac") << 5
+                                        << QStringList{QString::fromUtf8("€") + ellipsis};
+        QTest::newRow("zero bytes") << QByteArray("abc,,d") << 0 << QStringList{ellipsis, "", ellipsis};
+    }
+
+    void prefix()
+    {
+        QFETCH(QByteArray, line);
+        QFETCH(int, maxFieldBytes);
+        QFETCH(QStringList, fields);
+        QCOMPARE(FileUtils::parseCsvLinePrefix(line, maxFieldBytes), fields);
+    }
+
+    // Every field of the prefix parse is the full field, or a prefix of it
+    // followed by "…"
+    void prefixAgreesWithFullParse()
+    {
+        const QByteArray line = "2023-03-15T00:00:01+00:00,\"long, quoted \\\"message\\\" here\",x,,"
+                                "\xc3\xa9\xc3\xa9\xc3\xa9\xc3\xa9,\xe2\x82\xac\xe2\x82\xac\xe2\x82\xac";
+        const QStringList full = FileUtils::parseCsvLine(QString::fromUtf8(line));
+        for (int maxFieldBytes = 0; maxFieldBytes <= 40; ++maxFieldBytes) {
+            const QStringList prefix = FileUtils::parseCsvLinePrefix(line, maxFieldBytes);
+            QCOMPARE(prefix.size(), full.size());
+            for (int i = 0; i < full.size(); ++i) {
+                if (prefix[i] == full[i])
+                    continue;
+                QVERIFY2(prefix[i].endsWith(QChar(0x2026)), qPrintable(prefix[i]));
+                const QString kept = prefix[i].chopped(1);
+                QVERIFY(full[i].startsWith(kept));
+                QVERIFY(kept.toUtf8().size() <= maxFieldBytes);
+            }
+        }
+    }
+};
+
+QTEST_GUILESS_MAIN(TestCsvParsing)
+#include "tst_csvparsing.moc"
@@ -0,0 +1,146 @@
+#include "TestFiles.h"
+#include "core/DuplicateGroups.h"
+#include "core/RowStore.h"
+#include <QStandardPaths>
+#include <QtTest>
+#include <atomic>
+#include <memory>
+
+// DuplicateGroups run detection and the view row ↔ position mapping as
+// runs are collapsed and expanded
+class TestDuplicateGroups : public QObject {
+    Q_OBJECT
+
+private:
+    static constexpr int MESSAGE = 4;
+    QTemporaryDir m_dir;
+    std::unique_ptr<RowStore> m_store;
+
+    DuplicateGroups build(int window, bool maskNumbers = true, const QVector<int>& rows = {}) const
+    {
+        DuplicateGroups::Key key;
+        key.columns = {MESSAGE};
+        key.maskNumbers = maskNumbers;
+        key.window = window;
+        const std::atomic<bool> cancel{false};
+        return DuplicateGroups::build(*m_store, rows, key, cancel);
+    }
+
+    static QVector<QPair<int, int>> runs(const DuplicateGroups& groups)
+    {
+        QVector<QPair<int, int>> result;
+        for (int i = 0; i < groups.runCount(); ++i)
+            result.append({groups.run(i).start, groups.run(i).length});
+        return result;
+    }
+
+    static QVector<int> viewRows(const DuplicateGroups& groups, int positions)
+    {
+        QVector<int> result;
+        for (int position = 0; position < positions; ++position)
+            result.append(groups.toViewRow(position));
+        return result;
+    }
+
+    // Every view row maps to a visible position and back
+    static void verifyRoundTrip(const DuplicateGroups& groups, int positions)
+    {
+        for (int viewRow = 0; viewRow < groups.viewCount(positions); ++viewRow) {
+            const int position = groups.toPosition(viewRow);
+            QVERIFY(position >= 0 && position < positions);
+            QCOMPARE(groups.toViewRow(position), viewRow);
+        }
+    }
+
+private slots:
+    void initTestCase()
+    {
+        QStandardPaths::setTestModeEnabled(true);
+        QVERIFY(m_dir.isValid());
+        const QList<QByteArray> messages = {
+            "a",
+            "sshd[101] dup", "sshd[2] dup", "sshd[3003] dup",
+            "b",
+            "session opened", "session closed", "session opened", "session closed",
+            "c", "c",
+            "d",
+        };
+        QList<QByteArray> rows;
+        for (int i = 0; i < messages.size(); ++i)
+            rows.append(TestFiles::superRow(i, messages[i]));
+        const QString path = TestFiles::write(m_dir, "duplicates.csv", TestFiles::superTimeline(rows));
+        QVERIFY(!path.isEmpty());
+        m_store = std::make_unique<RowStore>(path);
+        m_store->open();
+        QCOMPARE(m_store->rowCount(), 12);
+    }
+
+    void cleanupTestCase()
+    {
+        m_store.reset();
+    }
+
+    void consecutiveDuplicates()
+    {
+        const DuplicateGroups groups = build(1);
+        QCOMPARE(runs(groups), (QVector<QPair<int, int>>{{1, 3}, {9, 2}}));
+        QCOMPARE(groups.hiddenRows(), 3);
+
+        const DuplicateGroups unmasked = build(1, false);
+        QCOMPARE(runs(unmasked), (QVector<QPair<int, int>>{{9, 2}}));
+    }
+
+    void repeatingPatterns()
+    {
+        DuplicateGroups groups = build(2);
+        QCOMPARE(runs(groups), (QVector<QPair<int, int>>{{1, 3}, {5, 4}, {9, 2}}));
+        QCOMPARE(groups.hiddenRows(), 6);
+        QCOMPARE(groups.viewCount(12), 6);
+        QCOMPARE(viewRows(groups, 12), QVector<int>({0, 1, -1, -1, 2, 3, -1, -1, -1, 4, -1, 5}));
+        QCOMPARE(groups.toPosition(2), 4);
+        QCOMPARE(groups.toPosition(4), 9);
+        QCOMPARE(groups.toPosition(5), 11);
+        verifyRoundTrip(groups, 12);
+
+        QCOMPARE(groups.runAt(5), 1);
+        QCOMPARE(groups.runAt(6), -1);
+        QCOMPARE(groups.runAt(0), -1);
+
+        groups.setExpanded(1, true);
+        QVERIFY(groups.isExpanded(1));
+        QCOMPARE(groups.hiddenRows(), 3);
+        QCOMPARE(groups.viewCount(12), 9);
+        QCOMPARE(viewRows(groups, 12), QVector<int>({0, 1, -1, -1, 2, 3, 4, 5, 6, 7, -1, 8}));
+        verifyRoundTrip(groups, 12);
+
+        groups.setExpanded(0, true);
+        groups.setExpanded(2, true);
+        QCOMPARE(groups.hiddenRows(), 0);
+        QCOMPARE(viewRows(groups, 12), QVector<int>({0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11}));
+        verifyRoundTrip(groups, 12);
+
+        groups.setExpanded(1, false);
+        QCOMPARE(groups.hiddenRows(), 3);
+        verifyRoundTrip(groups, 12);
+    }
+
+    // Positions count in the given rows, not in the file
+    void subsetOfRows()
+    {
+        const DuplicateGroups groups = build(1, true, {0, 2, 3, 9, 11});
+        QCOMPARE(runs(groups), (QVector<QPair<int, int>>{{1, 2}}));
+        QCOMPARE(viewRows(groups, 5), QVector<int>({0, 1, -1, 2, 3}));
+        verifyRoundTrip(groups, 5);
+    }
+
+    void cancelled()
+    {
+        DuplicateGroups::Key key;
+        key.columns = {MESSAGE};
+        const std::atomic<bool> cancel{true};
+        QVERIFY(DuplicateGroups::build(*m_store, {}, key, cancel).isEmpty());
+    }
+};
+
+QTEST_GUILESS_MAIN(TestDuplicateGroups)
+#include "tst_duplicategroups.moc"
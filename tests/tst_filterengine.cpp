@@ -0,0 +1,108 @@
+#include "TestFiles.h"
+#include "core/FilterEngine.h"
+#include "core/RowChunk.h"
+#include "core/RowStore.h"
+#include <QStandardPaths>
+#include <QtTest>
+#include <memory>
+
+// FilterEngine::scan(), single- and multi-threaded, must find exactly the
+// rows matchesLine() accepts one at a time
+class TestFilterEngine : public QObject {
+    Q_OBJECT
+
+private:
+    QTemporaryDir m_dir;
+    std::unique_ptr<RowStore> m_store;
+
+    QVector<int> expectedRows(const FilterEngine& filter) const
+    {
+        QVector<int> rows;
+        for (int row = 0; row < m_store->rowCount(); ++row) {
+            QByteArray raw;
+            if (m_store->readRaw(row, raw) && filter.matchesLine(raw))
+                rows.append(row);
+        }
+        return rows;
+    }
+
+private slots:
+    void initTestCase()
+    {
+        QStandardPaths::setTestModeEnabled(true);
+        QVERIFY(m_dir.isValid());
+
+        // More rows than FilterEngine::CHUNK_ROWS, so the threaded scan
+        // shares out several ranges
+        QList<QByteArray> rows;
+        for (int i = 0; i < FilterEngine::CHUNK_ROWS + 5000; ++i) {
+            QByteArray message = "event " + QByteArray::number(i);
+            if (i % 97 == 0)
+                message += " Failed LOGIN for root";
+            if (i % 1000 == 1)
+                message += " caf\xc3\xa9 \xc3\x89T\xc3\x89";
+            rows.append(TestFiles::superRow(i, message, i % 3 == 0 ? "AUTH" : "LOG"));
+        }
+        rows[10] = "not,\"closed";  // tokenizes to two fields
+        rows[11] = QByteArray(",").repeated(300) + "login";  // too many fields: never matches
+        const QString path = TestFiles::write(m_dir, "filter.csv", TestFiles::superTimeline(rows));
+        QVERIFY(!path.isEmpty());
+        m_store = std::make_unique<RowStore>(path);
+        m_store->open();
+        QCOMPARE(m_store->rowCount(), int(rows.size()));
+    }
+
+    void cleanupTestCase()
+    {
+        m_store.reset();
+    }
+
+    void scan_data()
+    {
+        QTest::addColumn<int>("column");
+        QTest::addColumn<QString>("term");
+        QTest::newRow("all columns") << -1 << "login";
+        QTest::newRow("case-insensitive") << -1 << "FAILED login";
+        QTest::newRow("one column") << 4 << "root";
+        QTest::newRow("other column") << 2 << "auth";
+        QTest::newRow("column without the term") << 2 << "root";
+        QTest::newRow("column past the end") << 20 << "event";
+        QTest::newRow("non-ASCII") << -1 << QString::fromUtf8("CAFÉ");
+        QTest::newRow("non-ASCII upper case") << 4 << QString::fromUtf8("été");
+        QTest::newRow("quote") << -1 << "closed";
+        QTest::newRow("no match") << -1 << "no such text";
+    }
+
+    void scan()
+    {
+        QFETCH(int, column);
+        QFETCH(QString, term);
+        const FilterEngine filter(column, term);
+        const QVector<int> expected = expectedRows(filter);
+
+        int lastProgress = -1;
+        QCOMPARE(filter.scan(*m_store, [&](int scanned, int total) {
+            QCOMPARE(total, m_store->rowCount());
+            QVERIFY(scanned >= lastProgress);
+            lastProgress = scanned;
+        }), expected);
+        QCOMPARE(filter.scan(*m_store, 4), expected);
+        QCOMPARE(filter.scan(*m_store, 0), expected);
+    }
+
+    // matches() on a decoded chunk agrees with matchesLine() on the raw row
+    void chunkMatches()
+    {
+        const FilterEngine filter(-1, "login");
+        RowChunk chunk;
+        QVERIFY(m_store->readChunk(0, 200, chunk));
+        for (int r = 0; r < chunk.rowCount(); ++r) {
+            QByteArray raw;
+            QVERIFY(m_store->readRaw(r, raw));
+            QCOMPARE(filter.matches(chunk, r), filter.matchesLine(raw));
+        }
+    }
+};
+
+QTEST_GUILESS_MAIN(TestFilterEngine)
+#include "tst_filterengine.moc"
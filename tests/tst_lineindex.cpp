@@ -0,0 +1,144 @@
+#include "TestFiles.h"
+#include "core/IoBackend.h"
+#include "core/LineIndex.h"
+#include <QBuffer>
+#include <QStandardPaths>
+#include <QtTest>
+#include <stdexcept>
+
+// Both LineIndex::build() overloads: the QIODevice one (used for decoded
+// compressed input) and the IoBackend one (plain files) must give the same
+// offsets as a byte-by-byte reference.
+class TestLineIndex : public QObject {
+    Q_OBJECT
+
+private:
+    QTemporaryDir m_dir;
+    int m_files = 0;
+
+    // Start of every line after the first, except an empty one at the end
+    static QVector<qint64> expectedOffsets(const QByteArray& content)
+    {
+        QVector<qint64> offsets;
+        for (qint64 i = 0; i < content.size(); ++i) {
+            if (content[i] == '\n' && i + 1 < content.size())
+                offsets.append(i + 1);
+        }
+        return offsets;
+    }
+
+    static QVector<qint64> buildFromDevice(const QByteArray& content)
+    {
+        QByteArray data = content;
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::ReadOnly);
+        LineIndex index;
+        index.build(buffer);
+        return index.offsets();
+    }
+
+    QVector<qint64> buildFromBackend(const QByteArray& content, IoBackend::Kind kind)
+    {
+        const QString path = TestFiles::write(m_dir, QString("lines-%1.csv").arg(m_files++), content);
+        const std::unique_ptr<IoBackend> io = IoBackend::open(path, kind);
+        LineIndex index;
+        index.build(*io);
+        return index.offsets();
+    }
+
+private slots:
+    void initTestCase()
+    {
+        QStandardPaths::setTestModeEnabled(true);
+        QVERIFY(m_dir.isValid());
+    }
+
+    void build_data()
+    {
+        QTest::addColumn<QByteArray>("content");
+        QTest::newRow("trailing newline") << QByteArray("h\nA\nBB\n");
+        QTest::newRow("no trailing newline") << QByteArray("h\nA\nBB");
+        QTest::newRow("CRLF") << QByteArray("h\r\nA\r\nBB\r\n");
+        QTest::newRow("header only") << QByteArray("h\n");
+        QTest::newRow("empty lines") << QByteArray("h\n\n\nA\n");
+        QTest::newRow("non-UTF-8 bytes") << QByteArray("h\n\xff\xfe,\xc3\n\xe2\x82\xac\n");
+
+        // Lines across block boundaries, and a newline as the last byte of
+        // the first block
+        QByteArray many = "header\n";
+        for (int i = 0; many.size() < 3 * LineIndex::BUILD_BLOCK_BYTES; ++i)
+            many += "row " + QByteArray::number(i) + ",value\n";
+        QTest::newRow("several blocks") << many;
+        QByteArray edge = "h\n" + QByteArray(LineIndex::BUILD_BLOCK_BYTES - 3, 'x') + "\ntail\n";
+        QVERIFY(edge.indexOf('\n', 2) == LineIndex::BUILD_BLOCK_BYTES - 1);
+        QTest::newRow("newline at block end") << edge;
+    }
+
+    void build()
+    {
+        QFETCH(QByteArray, content);
+        const QVector<qint64> expected = expectedOffsets(content);
+        QCOMPARE(buildFromDevice(content), expected);
+        for (IoBackend::Kind kind : {IoBackend::Buffered, IoBackend::Mmap, IoBackend::Async})
+            QCOMPARE(buildFromBackend(content, kind), expected);
+    }
+
+    void emptyFileThrows()
+    {
+        bool thrown = false;
+        try {
+            buildFromDevice(QByteArray());
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        QVERIFY(thrown);
+
+        thrown = false;
+        try {
+            buildFromBackend(QByteArray(), IoBackend::Buffered);
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        QVERIFY(thrown);
+    }
+
+    void progress()
+    {
+        QByteArray content = "h\n";
+        for (int i = 0; i < 2 * LineIndex::PROGRESS_INTERVAL + 10; ++i)
+            content += "r\n";
+        QByteArray data = content;
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::ReadOnly);
+        QVector<int> reported;
+        LineIndex index;
+        index.build(buffer, [&](int lines) { reported.append(lines); });
+        QCOMPARE(reported, QVector<int>({LineIndex::PROGRESS_INTERVAL, 2 * LineIndex::PROGRESS_INTERVAL}));
+        QCOMPARE(index.size(), 2 * LineIndex::PROGRESS_INTERVAL + 9);
+    }
+
+    void cacheRoundTrip()
+    {
+        const QByteArray content = "h\nA\nBB\nCCC\n";
+        const QString path = TestFiles::write(m_dir, "cached.csv", content);
+        const QString cachePath = path + ".idx";
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        LineIndex built;
+        built.build(file);
+        built.saveCache(cachePath, path, file);
+
+        LineIndex loaded;
+        QVERIFY(loaded.loadCache(cachePath, path, file));
+        QCOMPARE(loaded.offsets(), built.offsets());
+
+        // A changed source invalidates the cache
+        file.close();
+        QVERIFY(!TestFiles::write(m_dir, "cached.csv", content + "DDDD\n").isEmpty());
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        QVERIFY(!loaded.loadCache(cachePath, path, file));
+    }
+};
+
+QTEST_GUILESS_MAIN(TestLineIndex)
+#include "tst_lineindex.moc"
@@ -0,0 +1,115 @@
+#include "TestFiles.h"
+#include "core/FilterEngine.h"
+#include "core/MatchEstimator.h"
+#include "core/RowStore.h"
+#include <QStandardPaths>
+#include <QtTest>
+#include <atomic>
+
+// MatchEstimator::fromSample() bounds, and run() on a file small enough to
+// be counted exactly
+class TestMatchEstimator : public QObject {
+    Q_OBJECT
+
+private:
+    QTemporaryDir m_dir;
+
+private slots:
+    void initTestCase()
+    {
+        QStandardPaths::setTestModeEnabled(true);
+        QVERIFY(m_dir.isValid());
+    }
+
+    void exact()
+    {
+        const MatchEstimator::Estimate e = MatchEstimator::fromSample(500, 37, 500);
+        QVERIFY(e.exact());
+        QCOMPARE(e.matches, 37.0);
+        QCOMPARE(e.low, 37.0);
+        QCOMPARE(e.high, 37.0);
+    }
+
+    void noSample()
+    {
+        const MatchEstimator::Estimate e = MatchEstimator::fromSample(0, 0, 1000);
+        QVERIFY(!e.exact());
+        QCOMPARE(e.matches, 0.0);
+        QCOMPARE(e.low, 0.0);
+        QCOMPARE(e.high, 1000.0);
+
+        const MatchEstimator::Estimate empty = MatchEstimator::fromSample(0, 0, 0);
+        QVERIFY(empty.exact());
+        QCOMPARE(empty.high, 0.0);
+    }
+
+    void interval_data()
+    {
+        QTest::addColumn<int>("sampled");
+        QTest::addColumn<int>("hits");
+        QTest::addColumn<int>("total");
+        QTest::newRow("no hits") << 1000 << 0 << 1000000;
+        QTest::newRow("all hits") << 1000 << 1000 << 1000000;
+        QTest::newRow("one hit") << 256 << 1 << 5000000;
+        QTest::newRow("half") << 50000 << 25000 << 10000000;
+        QTest::newRow("most of the file") << 9990 << 300 << 10000;
+        QTest::newRow("all but one row") << 9999 << 5000 << 10000;
+    }
+
+    // The interval holds the point estimate (up to rounding) and never
+    // claims fewer matches than the sample found, or more than the rows not
+    // known to miss
+    void interval()
+    {
+        QFETCH(int, sampled);
+        QFETCH(int, hits);
+        QFETCH(int, total);
+        const MatchEstimator::Estimate e = MatchEstimator::fromSample(sampled, hits, total);
+        QVERIFY(!e.exact());
+        QCOMPARE(e.matches, double(hits) / sampled * total);
+        QVERIFY(e.low <= e.matches + 1e-6);
+        QVERIFY(e.matches <= e.high + 1e-6);
+        QVERIFY(e.low >= hits);
+        QVERIFY(e.high <= total - (sampled - hits));
+        if (hits > 0 && hits < sampled)
+            QVERIFY(e.low < e.high);
+    }
+
+    // A larger sample gives a narrower interval
+    void narrows()
+    {
+        const int total = 1000000;
+        double lastWidth = total;
+        for (int sampled = 100; sampled <= 51200; sampled *= 2) {
+            const MatchEstimator::Estimate e = MatchEstimator::fromSample(sampled, sampled / 10, total);
+            const double width = e.high - e.low;
+            QVERIFY2(width < lastWidth, qPrintable(QString("%1 rows sampled").arg(sampled)));
+            lastWidth = width;
+        }
+    }
+
+    void runCountsSmallFilesExactly()
+    {
+        QList<QByteArray> rows;
+        for (int i = 0; i < 300; ++i)
+            rows.append(TestFiles::superRow(i, i % 7 == 0 ? "Accepted password" : "session opened"));
+        const QString path = TestFiles::write(m_dir, "estimate.csv", TestFiles::superTimeline(rows));
+        QVERIFY(!path.isEmpty());
+        RowStore store(path);
+        store.open();
+
+        const FilterEngine filter(-1, "accepted");
+        const std::atomic<bool> cancel{false};
+        int updates = 0;
+        const MatchEstimator::Estimate e = MatchEstimator::run(store, filter, cancel,
+                                                               [&](const MatchEstimator::Estimate&) { ++updates; });
+        QVERIFY(e.exact());
+        QCOMPARE(e.hits, 43);
+        QCOMPARE(e.matches, 43.0);
+        QCOMPARE(int(filter.scan(store).size()), e.hits);
+        QVERIFY(updates >= 2);
+    }
+};
+
+QTEST_GUILESS_MAIN(TestMatchEstimator)
+#include "tst_matchestimator.moc"
@@ -0,0 +1,128 @@
+#include "TestFiles.h"
+#include "core/RowChunk.h"
+#include "core/RowStore.h"
+#include "utils/FileUtils.h"
+#include <QStandardPaths>
+#include <QtTest>
+
+// RowChunk must tokenize each line exactly as FileUtils::parseCsvLine() does
+// after trimming it, since bulk passes and single-row reads have to agree
+class TestRowChunk : public QObject {
+    Q_OBJECT
+
+private:
+    QTemporaryDir m_dir;
+
+    static void append(RowChunk& chunk, const QByteArray& line)
+    {
+        chunk.appendLine(line.constData(), line.size());
+    }
+
+private slots:
+    void initTestCase()
+    {
+        QStandardPaths::setTestModeEnabled(true);
+        QVERIFY(m_dir.isValid());
+    }
+
+    void matchesParseCsvLine_data()
+    {
+        QTest::addColumn<QByteArray>("line");
+        QTest::newRow("plain") << QByteArray("a,b,c");
+        QTest::newRow("surrounding space") << QByteArray("  a, b ,c \r");
+        QTest::newRow("quoted") << QByteArray("\"a,b\",\"say \"\"hi\"\"\",c");
+        QTest::newRow("escapes") << QByteArray("a\\,b,\\\"c\\\\,d");
+        QTest::newRow("empty fields") << QByteArray(",,");
+        QTest::newRow("fewer columns") << QByteArray("only");
+        QTest::newRow("more columns") << QByteArray("a,b,c,d,e");
+        QTest::newRow("UTF-8") << QByteArray("\xc3\xa9t\xc3\xa9,\xe2\x82\xac,\xe2\x9c\x93");
+        QTest::newRow("empty line") << QByteArray();
+    }
+
+    void matchesParseCsvLine()
+    {
+        QFETCH(QByteArray, line);
+        const int columns = 3;
+        RowChunk chunk;
+        chunk.reset(100, 4, columns);
+        append(chunk, "x,y,z");
+        append(chunk, line);
+        QCOMPARE(chunk.firstRow(), 100);
+        QCOMPARE(chunk.rowCount(), 2);
+        QVERIFY(chunk.isValid(1));
+
+        const QStringList expected = FileUtils::parseCsvLine(QString::fromUtf8(line.trimmed()));
+        for (int c = 0; c < columns; ++c)
+            QCOMPARE(chunk.text(1, c), expected.value(c));
+
+        // row() holds every field, including those past columnCount()
+        QByteArray joined;
+        for (const QString& field : expected)
+            joined += field.toUtf8() + '\0';
+        QCOMPARE(chunk.row(1).toByteArray(), joined);
+
+        // The row before is untouched
+        QCOMPARE(chunk.text(0, 0), QString("x"));
+        QCOMPARE(chunk.text(0, 2), QString("z"));
+    }
+
+    void invalidRows()
+    {
+        RowChunk chunk;
+        chunk.reset(0, 3, 2);
+        append(chunk, QByteArray(",").repeated(FileUtils::MAX_FIELDS_PER_LINE));
+        append(chunk, QByteArray(FileUtils::MAX_FIELD_LENGTH + 1, 'x') + ",y");
+        append(chunk, "a,b");
+        QVERIFY(chunk.isFull());
+        QVERIFY(!chunk.isValid(0));
+        QVERIFY(!chunk.isValid(1));
+        for (int r = 0; r < 2; ++r) {
+            QVERIFY(chunk.field(r, 0).isEmpty());
+            QVERIFY(chunk.field(r, 1).isEmpty());
+            QVERIFY(chunk.row(r).isEmpty());
+        }
+        QVERIFY(chunk.isValid(2));
+        QCOMPARE(chunk.text(2, 1), QString("b"));
+    }
+
+    void reuse()
+    {
+        RowChunk chunk;
+        chunk.reset(0, 2, 1);
+        append(chunk, "first");
+        append(chunk, "second");
+        chunk.reset(2, 2, 1);
+        QCOMPARE(chunk.rowCount(), 0);
+        QCOMPARE(chunk.byteSize(), qint64(0));
+        append(chunk, "third");
+        QCOMPARE(chunk.firstRow(), 2);
+        QCOMPARE(chunk.text(0, 0), QString("third"));
+    }
+
+    // RowStore::readChunk() and readFields() decode the same rows
+    void readChunkMatchesReadFields()
+    {
+        QList<QByteArray> rows;
+        for (int i = 0; i < 50; ++i)
+            rows.append(TestFiles::superRow(i, "message " + QByteArray::number(i) + ", with \\\"quotes\\\""));
+        const QString path = TestFiles::write(m_dir, "chunk.csv", TestFiles::superTimeline(rows));
+        QVERIFY(!path.isEmpty());
+        RowStore store(path);
+        store.open();
+        QCOMPARE(store.rowCount(), int(rows.size()));
+
+        RowChunk chunk;
+        QVERIFY(store.readChunk(10, 40, chunk));
+        QCOMPARE(chunk.firstRow(), 10);
+        QCOMPARE(chunk.rowCount(), 30);
+        for (int r = 0; r < chunk.rowCount(); ++r) {
+            QStringList fields;
+            QVERIFY(store.readFields(chunk.firstRow() + r, fields));
+            for (int c = 0; c < chunk.columnCount(); ++c)
+                QCOMPARE(chunk.text(r, c), fields.value(c));
+        }
+    }
+};
+
+QTEST_GUILESS_MAIN(TestRowChunk)
+#include "tst_rowchunk.moc"
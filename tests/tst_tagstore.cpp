@@ -0,0 +1,93 @@
+#include "TestFiles.h"
+#include "core/AppDataPaths.h"
+#include "core/TagStore.h"
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QtTest>
+
+// TagStore save/load round trip through the .tags file in the (test mode)
+// application data directory
+class TestTagStore : public QObject {
+    Q_OBJECT
+
+private:
+    QTemporaryDir m_dir;
+    QString m_source;
+
+private slots:
+    void initTestCase()
+    {
+        QStandardPaths::setTestModeEnabled(true);
+        QVERIFY(m_dir.isValid());
+        // Tag files are named after the source's base name only, so use one
+        // no other run shares
+        const QString name = "tags-" + QFileInfo(m_dir.path()).fileName() + ".csv";
+        m_source = TestFiles::write(m_dir, name, TestFiles::superTimeline({TestFiles::superRow(0, "a")}));
+        QVERIFY(!m_source.isEmpty());
+    }
+
+    void cleanup()
+    {
+        QFile::remove(AppDataPaths::tagFilePath(m_source));
+    }
+
+    void setTracksChanges()
+    {
+        TagStore tags(m_source);
+        QVERIFY(!tags.hasUnsavedChanges());
+        QVERIFY(tags.set(5, true));
+        QVERIFY(!tags.set(5, true));
+        QVERIFY(tags.contains(5));
+        QVERIFY(tags.hasUnsavedChanges());
+        QVERIFY(tags.set(5, false));
+        QVERIFY(!tags.contains(5));
+        QVERIFY(!tags.set(7, false));
+        QCOMPARE(tags.size(), 0);
+    }
+
+    void roundTrip()
+    {
+        TagStore tags(m_source);
+        tags.load(100);
+        QCOMPARE(tags.size(), 0);
+        for (int row : {42, 3, 99, 0, 17})
+            tags.set(row, true);
+        tags.set(17, false);
+        QVERIFY(tags.save());
+        QVERIFY(!tags.hasUnsavedChanges());
+        QCOMPARE(tags.sortedRows(), QVector<int>({0, 3, 42, 99}));
+
+        TagStore loaded(m_source);
+        loaded.load(100);
+        QCOMPARE(loaded.sortedRows(), tags.sortedRows());
+        QVERIFY(!loaded.hasUnsavedChanges());
+
+        // Rows past the limit (e.g. the file was truncated) are dropped
+        TagStore limited(m_source);
+        limited.load(42);
+        QCOMPARE(limited.sortedRows(), QVector<int>({0, 3}));
+    }
+
+    void ignoresBadLines()
+    {
+        QFile file(AppDataPaths::tagFilePath(m_source));
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Text));
+        file.write("4\n-1\nnot a row\n\n123456789012345678901234\n 8 \n");
+        file.close();
+
+        TagStore tags(m_source);
+        tags.load(10);
+        QCOMPARE(tags.sortedRows(), QVector<int>({4, 8}));
+    }
+
+    void missingFile()
+    {
+        TagStore tags(m_source);
+        tags.load(10);
+        QCOMPARE(tags.size(), 0);
+        QVERIFY(!tags.hasUnsavedChanges());
+    }
+};
+
+QTEST_GUILESS_MAIN(TestTagStore)
+#include "tst_tagstore.moc"